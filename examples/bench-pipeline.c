@@ -0,0 +1,294 @@
+/**
+ * @file bench-pipeline.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief End to end throughput benchmark of the sequence pipeline. Synthetic inputs are
+ * generated for every resolution and GOP length, then each mode (packet read, frame decode,
+ * full encode and random splice) is measured at several cut densities.
+ * Results are written as CSV and JSON in the output directory so runs can be compared.
+ * usage: bin/examples/bench-pipeline out_dir [seconds] (or: make bench)
+ */
+
+#include <sys/stat.h>
+#include <errno.h>
+#include "OutputContext.h"
+#include "SyntheticMedia.h"
+
+#define BENCH_FPS 30
+#define BENCH_SAMPLE_RATE 48000
+#define BENCH_SEED 1234
+
+typedef struct BenchResult {
+    const char *mode;
+    int width, height, gop, cut_every;
+    int64_t frames;
+    int64_t wall_ns;
+} BenchResult;
+
+/* synthetic input matrix */
+int bench_sizes[][2] = {{320, 180}, {640, 360}, {1280, 720}};
+int bench_gops[] = {1, 12, 60};
+/* cut the sequence every n frames (0 for a single clip) */
+int bench_cuts[] = {0, 30, 5};
+
+#define NB_ELEMS(arr) ((int) (sizeof(arr) / sizeof(arr[0])))
+
+/**
+ * Get monotonic time in nanoseconds
+ * @return nanoseconds
+ */
+int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Generate a synthetic input: moving gradient video (MPEG-4 part 2) and a sine tone (AAC)
+ * @param  filename output filename
+ * @param  width    width of video
+ * @param  height   height of video
+ * @param  gop      distance between key frames
+ * @param  seconds  duration
+ * @return          >= 0 on success
+ */
+int generate_input(char *filename, int width, int height, int gop, int seconds) {
+    SyntheticParams p;
+    set_synthetic_params_default(&p);
+    p.width = width;
+    p.height = height;
+    p.fps = (AVRational){BENCH_FPS, 1};
+    p.gop_size = gop;
+    p.bit_rate = (int64_t) width * height * 4;
+    p.duration = seconds;
+    p.sample_rate = BENCH_SAMPLE_RATE;
+    return generate_synthetic_media(filename, &p);
+}
+
+/**
+ * Create a sequence of a single input, cut every cut_every frames
+ * @param  seq       Sequence to initialize
+ * @param  filename  input file
+ * @param  cut_every cut length in frames (0 for no cuts)
+ * @return           >= 0 on success
+ */
+int open_bench_sequence(Sequence *seq, char *filename, int cut_every) {
+    init_sequence(seq, BENCH_FPS, BENCH_SAMPLE_RATE);
+    Clip *clip = seq_alloc_clip(seq, filename);
+    if(clip == NULL) {
+        return -1;
+    }
+    sequence_append_clip(seq, clip);
+    if(cut_every > 0) {
+        int64_t dur = get_sequence_duration(seq);
+        for(int64_t f = cut_every; f < dur; f += cut_every) {
+            cut_clip(seq, f);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Create a random splice of an input: random segments (about cut_len frames each) appended
+ * until the duration of the input is reached. Seeded, so every run is the same edit
+ * @param  seq      Sequence to initialize
+ * @param  filename input file
+ * @param  cut_len  average length of segments in frames
+ * @return          >= 0 on success
+ */
+int open_random_splice(Sequence *seq, char *filename, int cut_len) {
+    init_sequence(seq, BENCH_FPS, BENCH_SAMPLE_RATE);
+    Clip *src = seq_alloc_clip(seq, filename);
+    if(src == NULL) {
+        return -1;
+    }
+    int64_t src_frames = get_clip_end_frame_idx(src);
+    srand(BENCH_SEED);
+    int64_t total = 0;
+    bool first = true;
+    while(total < src_frames) {
+        int64_t len = FFMAX(1, cut_len / 2 + rand() % (cut_len + 1));
+        len = FFMIN(len, src_frames);
+        int64_t start = rand() % (src_frames - len + 1);
+        Clip *clip = first ? src : copy_clip_vc(src);
+        if(clip == NULL) {
+            return -1;
+        }
+        set_clip_bounds_pts(clip, get_video_frame_pts(clip->vid_ctx, start),
+                            get_video_frame_pts(clip->vid_ctx, start + len));
+        sequence_append_clip(seq, clip);
+        total += len;
+        first = false;
+    }
+    return 0;
+}
+
+/**
+ * Get output parameters matching the first clip of a sequence
+ * @param  op       OutputParameters to set
+ * @param  seq      Sequence
+ * @param  filename output filename
+ * @return          >= 0 on success
+ */
+int get_bench_output_params(OutputParameters *op, Sequence *seq, char *filename) {
+    Clip *clip1 = (Clip *) seq->clips.head->data;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    return set_output_params(op, filename, vp, ap);
+}
+
+/**
+ * Run one benchmark mode on an input
+ * @param  mode       "packet_read", "frame_decode", "full_encode" or "random_splice"
+ * @param  input      input filename
+ * @param  output     output filename (encode modes)
+ * @param  cut_every  cut density in frames (0 for no cuts)
+ * @param  res        result (frames and wall time are set)
+ * @return            >= 0 on success
+ */
+int run_bench_mode(const char *mode, char *input, char *output, int cut_every, BenchResult *res) {
+    Sequence seq;
+    bool splice = strcmp(mode, "random_splice") == 0;
+    int ret = splice ? open_random_splice(&seq, input, cut_every > 0 ? cut_every : BENCH_FPS)
+                     : open_bench_sequence(&seq, input, cut_every);
+    if(ret < 0) {
+        free_sequence(&seq);
+        return ret;
+    }
+    res->mode = mode;
+    res->frames = 0;
+    int64_t t = now_ns();
+    if(strcmp(mode, "packet_read") == 0) {
+        // example_sequence_read_packets() without printing
+        AVPacket pkt;
+        sequence_seek(&seq, 0);
+        while(sequence_read_packet(&seq, &pkt, false) >= 0) {
+            Clip *clip = get_current_clip(&seq);
+            if(clip != NULL && pkt.stream_index == clip->vid_ctx->video_stream_idx) {
+                ++(res->frames);
+            }
+            av_packet_unref(&pkt);
+        }
+    } else if(strcmp(mode, "frame_decode") == 0) {
+        // example_sequence_read_frames() without printing
+        enum AVMediaType type;
+        AVFrame *frame = av_frame_alloc();
+        sequence_seek(&seq, 0);
+        while(sequence_read_frame(&seq, frame, &type, false) >= 0) {
+            if(type == AVMEDIA_TYPE_VIDEO) {
+                ++(res->frames);
+            }
+        }
+        av_frame_free(&frame);
+    } else {
+        OutputParameters op;
+        ret = get_bench_output_params(&op, &seq, output);
+        if(ret >= 0) {
+            sequence_seek(&seq, 0);
+            ret = write_sequence(&seq, &op, 1);
+            free_output_params(&op);
+        }
+        res->frames = get_sequence_duration(&seq);
+    }
+    res->wall_ns = now_ns() - t;
+    free_sequence(&seq);
+    return ret;
+}
+
+/**
+ * Write results as CSV and JSON
+ * @param  dir      output directory
+ * @param  results  array of results
+ * @param  nb       number of results
+ * @return          >= 0 on success
+ */
+int write_bench_results(char *dir, BenchResult *results, int nb) {
+    char csv_name[1024], json_name[1024];
+    snprintf(csv_name, sizeof(csv_name), "%s/bench-pipeline.csv", dir);
+    snprintf(json_name, sizeof(json_name), "%s/bench-pipeline.json", dir);
+    FILE *csv = fopen(csv_name, "w");
+    FILE *json = fopen(json_name, "w");
+    if(csv == NULL || json == NULL) {
+        fprintf(stderr, "write_bench_results() error: Failed to open results in[%s]\n", dir);
+        if(csv != NULL) fclose(csv);
+        if(json != NULL) fclose(json);
+        return -1;
+    }
+    fprintf(csv, "mode,width,height,gop,cut_every,frames,wall_ms,fps\n");
+    fprintf(json, "[");
+    for(int i = 0; i < nb; i++) {
+        BenchResult *r = &(results[i]);
+        double ms = r->wall_ns / 1000000.0;
+        double fps = r->wall_ns > 0 ? r->frames * 1000000000.0 / r->wall_ns : 0;
+        fprintf(csv, "%s,%d,%d,%d,%d,%ld,%.3f,%.1f\n", r->mode, r->width, r->height, r->gop,
+                r->cut_every, r->frames, ms, fps);
+        fprintf(json, "%s\n  {\"mode\": \"%s\", \"width\": %d, \"height\": %d, \"gop\": %d, "
+                "\"cut_every\": %d, \"frames\": %ld, \"wall_ms\": %.3f, \"fps\": %.1f}",
+                i > 0 ? "," : "", r->mode, r->width, r->height, r->gop, r->cut_every, r->frames, ms, fps);
+    }
+    fprintf(json, "\n]\n");
+    fclose(csv);
+    fclose(json);
+    printf("Results written to %s and %s\n", csv_name, json_name);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s out_dir [seconds]\n", argv[0]);
+        printf("out_dir: synthetic inputs, outputs and results (bench-pipeline.csv/json) are written here\n");
+        printf("seconds: duration of each synthetic input (default 4)\n");
+        return -1;
+    }
+    char *dir = argv[1];
+    int seconds = argc > 2 ? atoi(argv[2]) : 4;
+    if(mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Failed to create directory[%s]\n", dir);
+        return -1;
+    }
+    set_log_level(LOG_LEVEL_WARNING);
+    const char *modes[] = {"packet_read", "frame_decode", "full_encode", "random_splice"};
+    int max_results = NB_ELEMS(bench_sizes) * NB_ELEMS(bench_gops) * NB_ELEMS(bench_cuts) * NB_ELEMS(modes);
+    BenchResult *results = malloc(sizeof(BenchResult) * max_results);
+    if(results == NULL) {
+        return -1;
+    }
+    int nb = 0;
+    char input[1024], output[1024];
+    snprintf(output, sizeof(output), "%s/bench-out.mov", dir);
+    printf("%-14s %5s %5s %4s %4s %8s %12s %10s\n", "mode", "width", "height", "gop", "cut",
+            "frames", "wall_ms", "fps");
+    for(int s = 0; s < NB_ELEMS(bench_sizes); s++) {
+        for(int g = 0; g < NB_ELEMS(bench_gops); g++) {
+            int w = bench_sizes[s][0], h = bench_sizes[s][1], gop = bench_gops[g];
+            snprintf(input, sizeof(input), "%s/input-%dx%d-gop%d.mov", dir, w, h, gop);
+            if(generate_input(input, w, h, gop, seconds) < 0) {
+                continue;
+            }
+            for(int c = 0; c < NB_ELEMS(bench_cuts); c++) {
+                for(int m = 0; m < NB_ELEMS(modes); m++) {
+                    BenchResult *r = &(results[nb]);
+                    r->width = w;
+                    r->height = h;
+                    r->gop = gop;
+                    r->cut_every = bench_cuts[c];
+                    if(run_bench_mode(modes[m], input, output, bench_cuts[c], r) < 0) {
+                        fprintf(stderr, "%s failed on[%s]\n", modes[m], input);
+                        continue;
+                    }
+                    printf("%-14s %5d %5d %4d %4d %8ld %12.3f %10.1f\n", r->mode, w, h, gop, r->cut_every,
+                            r->frames, r->wall_ns / 1000000.0,
+                            r->wall_ns > 0 ? r->frames * 1000000000.0 / r->wall_ns : 0);
+                    ++nb;
+                }
+            }
+        }
+    }
+    int ret = write_bench_results(dir, results, nb);
+    free(results);
+    return ret < 0 ? -1 : 0;
+}
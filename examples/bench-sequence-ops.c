@@ -0,0 +1,438 @@
+/**
+ * @file bench-sequence-ops.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief Micro-benchmark of editing operations on the Sequence and LinkedList APIs from
+ * 10^2 up to 10^6 clips. Operations that never touch media run on synthetic metadata:
+ * every clip points to one VideoContext holding only stream parameters (no demuxer),
+ * so only the cost of the editing data structures is measured. Operations that seek
+ * (sequence_seek(), and cut_clip() which seeks the new clip) run on clips of a synthetic
+ * media file generated by the benchmark. Reports ns/op and heap bytes/op (memory in use
+ * after the operation minus before, from mallinfo2(): every allocation of the process,
+ * FFmpeg included).
+ * Operations that walk the list run at most BENCH_MAX_OPS times per size, and
+ * print_sequence() and free_sequence() run once per size (reported per clip).
+ * usage: bin/examples/bench-sequence-ops [max_clips] [results.csv] [synthetic.mov]
+ */
+
+#include <malloc.h>
+#include <sys/resource.h>
+#include "Sequence.h"
+#include "SyntheticMedia.h"
+
+#define BENCH_FPS 30
+#define BENCH_SAMPLE_RATE 48000
+/* length of every synthetic clip in frames */
+#define BENCH_CLIP_FRAMES 10
+#define BENCH_MAX_OPS 1000
+/* print_sequence() grows its string with strcat, skip it on larger sequences */
+#define BENCH_PRINT_MAX_CLIPS 10000
+
+typedef struct OpResult {
+    const char *op;
+    int clips;
+    int64_t ops, time_ns, heap_bytes;
+} OpResult;
+
+/**
+ * Get the heap memory in use by the process (allocated chunks and mmapped blocks).
+ * Without mallinfo2() (glibc < 2.33, other libc) the peak resident memory is used
+ * instead, which only shows growth
+ * @return bytes in use
+ */
+int64_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    return (int64_t) (mi.uordblks + mi.hblkhd);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (int64_t) usage.ru_maxrss * 1024;
+#endif
+}
+
+/**
+ * Get monotonic time in nanoseconds
+ * @return nanoseconds
+ */
+int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Seeded pseudo random number (same sequence every run)
+ * @param  state generator state
+ * @return       random number in [0, 2^31)
+ */
+uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1103515245 + 12345;
+    return (*state >> 1) & 0x7FFFFFFF;
+}
+
+/**
+ * Allocate an open VideoContext without a file or demuxer: 30fps video (time base 1/30)
+ * and 48kHz audio streams of nb_frames frames. Clips of it must never be seeked or read
+ * @param  url       name of the synthetic file
+ * @param  nb_frames duration of the video stream in frames
+ * @return           VideoContext with clip_count of 1 (owned by the caller), NULL on fail
+ */
+VideoContext *alloc_metadata_video_context(char *url, int64_t nb_frames) {
+    VideoContext *vc = malloc(sizeof(struct VideoContext));
+    if(vc == NULL) {
+        return NULL;
+    }
+    memset(vc, 0, sizeof(struct VideoContext));
+    init_video_context(vc);
+    vc->url = strdup(url);
+    vc->fmt_ctx = avformat_alloc_context();
+    if(vc->url == NULL || vc->fmt_ctx == NULL) {
+        avformat_free_context(vc->fmt_ctx);
+        vc->fmt_ctx = NULL;
+        free_video_context(&vc);
+        return NULL;
+    }
+    AVStream *video = avformat_new_stream(vc->fmt_ctx, NULL);
+    AVStream *audio = avformat_new_stream(vc->fmt_ctx, NULL);
+    if(video == NULL || audio == NULL) {
+        avformat_free_context(vc->fmt_ctx);
+        vc->fmt_ctx = NULL;
+        free_video_context(&vc);
+        return NULL;
+    }
+    video->time_base = (AVRational){1, BENCH_FPS};
+    video->avg_frame_rate = (AVRational){BENCH_FPS, 1};
+    video->duration = nb_frames;
+    video->nb_frames = nb_frames;
+    audio->time_base = (AVRational){1, BENCH_SAMPLE_RATE};
+    audio->duration = nb_frames * BENCH_SAMPLE_RATE / BENCH_FPS;
+    vc->video_stream_idx = video->index;
+    vc->audio_stream_idx = audio->index;
+    vc->video_time_base = video->time_base;
+    vc->audio_time_base = audio->time_base;
+    vc->fps = BENCH_FPS;
+    vc->open = true;
+    vc->clip_count = 1;
+    return vc;
+}
+
+/**
+ * Allocate a clip sharing a VideoContext. Bounds are set without seeking
+ * (set_clip_bounds_pts() seeks, and metadata VideoContexts cannot seek)
+ * @param  vc          VideoContext from alloc_metadata_video_context() or of a synthetic file
+ * @param  start_frame first frame of clip in the source
+ * @param  nb_frames   length of clip in frames
+ * @return             Clip, NULL on fail
+ */
+Clip *alloc_bench_clip(VideoContext *vc, int64_t start_frame, int64_t nb_frames) {
+    Clip *clip = alloc_clip_internal();
+    if(clip == NULL) {
+        return NULL;
+    }
+    clip->vid_ctx = vc;
+    ++(vc->clip_count);
+    clip->orig_start_pts = get_video_frame_pts(vc, start_frame);
+    clip->orig_end_pts = get_video_frame_pts(vc, start_frame + nb_frames);
+    if(clip->orig_start_pts < 0 || clip->orig_end_pts < 0) {
+        free_clip(&clip);
+        return NULL;
+    }
+    return clip;
+}
+
+/**
+ * Allocate n clips of BENCH_CLIP_FRAMES frames, clip i starting at source frame
+ * offset + i * spacing (wrapped to the start of the source after src_frames)
+ * @param  vc         VideoContext from alloc_metadata_video_context() or of a synthetic file
+ * @param  n          number of clips
+ * @param  spacing    distance between clips in the source (frames)
+ * @param  offset     source frame of the first clip
+ * @param  src_frames frames in the source
+ * @return            array of clips (to be freed by caller), NULL on fail
+ */
+Clip **alloc_bench_clips(VideoContext *vc, int n, int64_t spacing, int64_t offset, int64_t src_frames) {
+    Clip **clips = malloc(sizeof(Clip *) * n);
+    if(clips == NULL) {
+        return NULL;
+    }
+    int64_t wrap = src_frames - BENCH_CLIP_FRAMES + 1;
+    for(int i = 0; i < n; i++) {
+        clips[i] = alloc_bench_clip(vc, (offset + i * spacing) % wrap, BENCH_CLIP_FRAMES);
+        if(clips[i] == NULL) {
+            while(--i >= 0) {
+                free_clip(&(clips[i]));
+            }
+            free(clips);
+            return NULL;
+        }
+    }
+    return clips;
+}
+
+/**
+ * Start measuring an operation
+ * @param r     result to start
+ * @param op    name of operation
+ * @param clips number of clips in sequence
+ */
+void start_op(OpResult *r, const char *op, int clips) {
+    r->op = op;
+    r->clips = clips;
+    r->ops = 0;
+    r->heap_bytes = heap_in_use();
+    r->time_ns = now_ns();
+}
+
+/**
+ * Stop measuring an operation and print its result
+ * @param r   result started by start_op()
+ * @param ops number of operations done
+ * @param csv results file (NULL for none)
+ */
+void finish_op(OpResult *r, int64_t ops, FILE *csv) {
+    r->time_ns = now_ns() - r->time_ns;
+    r->heap_bytes = heap_in_use() - r->heap_bytes;
+    r->ops = ops;
+    double ns_op = ops > 0 ? r->time_ns / (double) ops : 0;
+    double bytes_op = ops > 0 ? r->heap_bytes / (double) ops : 0;
+    printf("%-30s %8d %8ld %14.1f %12.1f\n", r->op, r->clips, ops, ns_op, bytes_op);
+    if(csv != NULL) {
+        fprintf(csv, "%s,%d,%ld,%ld,%ld,%.1f,%.1f\n", r->op, r->clips, ops, r->time_ns,
+                r->heap_bytes, ns_op, bytes_op);
+    }
+}
+
+/**
+ * Benchmark append, lookup, ripple delete, print and free on a sequence of n clips
+ * @param  vc  VideoContext from alloc_metadata_video_context()
+ * @param  n   number of clips
+ * @param  csv results file (NULL for none)
+ * @return     >= 0 on success
+ */
+int bench_sequence_ops(VideoContext *vc, int n, FILE *csv) {
+    Sequence seq;
+    OpResult r;
+    uint32_t rand_state = n;
+    int k = FFMIN(n, BENCH_MAX_OPS);
+    Clip **clips = alloc_bench_clips(vc, n, BENCH_CLIP_FRAMES, 0, get_video_stream(vc)->nb_frames);
+    if(clips == NULL) {
+        return -1;
+    }
+    init_sequence(&seq, BENCH_FPS, BENCH_SAMPLE_RATE);
+
+    start_op(&r, "sequence_append_clip", n);
+    for(int i = 0; i < n; i++) {
+        sequence_append_clip(&seq, clips[i]);
+    }
+    finish_op(&r, n, csv);
+    free(clips);
+
+    int duration = get_sequence_duration(&seq);
+    int64_t found = 0;
+    start_op(&r, "find_clip_at_index", n);
+    for(int i = 0; i < k; i++) {
+        Clip *clip;
+        if(find_clip_at_index(&seq, bench_rand(&rand_state) % duration, &clip) >= 0) {
+            ++found;
+        }
+    }
+    finish_op(&r, k, csv);
+    if(found != k) {
+        log_error("bench_sequence_ops() error: %ld lookups failed\n", k - found);
+    }
+
+    // delete k clips spread over the sequence
+    Clip **deletes = malloc(sizeof(Clip *) * k);
+    if(deletes == NULL) {
+        free_sequence(&seq);
+        return -1;
+    }
+    int stride = seq.clips.length / k, nb_deletes = 0;
+    Node *node = seq.clips.head;
+    for(int i = 0; node != NULL && nb_deletes < k; i++, node = node->next) {
+        if(i % stride == 0) {
+            deletes[nb_deletes++] = (Clip *) node->data;
+        }
+    }
+    start_op(&r, "sequence_ripple_delete_clip", n);
+    for(int i = 0; i < nb_deletes; i++) {
+        sequence_ripple_delete_clip(&seq, deletes[i]);
+    }
+    finish_op(&r, nb_deletes, csv);
+    free(deletes);
+
+    int length = seq.clips.length;
+    if(n <= BENCH_PRINT_MAX_CLIPS) {
+        start_op(&r, "print_sequence (per clip)", n);
+        char *str = print_sequence(&seq);
+        finish_op(&r, length, csv);
+        free(str);
+    } else {
+        printf("%-30s %8d %8s\n", "print_sequence (per clip)", n, "skipped");
+    }
+
+    start_op(&r, "free_sequence (per clip)", n);
+    free_sequence(&seq);
+    finish_op(&r, length, csv);
+    return 0;
+}
+
+/**
+ * Benchmark sorted insertion (by date and orig_start_pts) into a sequence of n clips
+ * @param  vc  VideoContext from alloc_metadata_video_context()
+ * @param  n   number of clips
+ * @param  csv results file (NULL for none)
+ * @return     >= 0 on success
+ */
+int bench_insert_sorted(VideoContext *vc, int n, FILE *csv) {
+    Sequence seq;
+    OpResult r;
+    uint32_t rand_state = n;
+    int k = FFMIN(n, BENCH_MAX_OPS);
+    // sequence clips at even slots of the source, inserted clips fill random odd slots
+    Clip **clips = alloc_bench_clips(vc, n, 2 * BENCH_CLIP_FRAMES, 0, get_video_stream(vc)->nb_frames);
+    Clip **inserts = malloc(sizeof(Clip *) * k);
+    if(clips == NULL || inserts == NULL) {
+        free(clips);
+        free(inserts);
+        return -1;
+    }
+    init_sequence_cmp(&seq, BENCH_FPS, BENCH_SAMPLE_RATE, &list_compare_clips_sequential);
+    for(int i = 0; i < n; i++) {
+        sequence_append_clip(&seq, clips[i]);
+    }
+    free(clips);
+    for(int i = 0; i < k; i++) {
+        int64_t slot = bench_rand(&rand_state) % n;
+        inserts[i] = alloc_bench_clip(vc, slot * 2 * BENCH_CLIP_FRAMES + BENCH_CLIP_FRAMES, BENCH_CLIP_FRAMES);
+        if(inserts[i] == NULL) {
+            k = i;
+            break;
+        }
+    }
+    start_op(&r, "sequence_insert_clip_sorted", n);
+    for(int i = 0; i < k; i++) {
+        sequence_insert_clip_sorted(&seq, inserts[i]);
+    }
+    finish_op(&r, k, csv);
+    free(inserts);
+    free_sequence(&seq);
+    return 0;
+}
+
+/**
+ * Benchmark sequence_seek() and cut_clip() on a sequence of n clips of a synthetic file
+ * (clips share the VideoContext of the file, so every seek is a seek in the file)
+ * @param  vc         opened VideoContext of a synthetic file
+ * @param  src_frames frames in the synthetic file
+ * @param  n          number of clips
+ * @param  csv        results file (NULL for none)
+ * @return            >= 0 on success
+ */
+int bench_media_ops(VideoContext *vc, int64_t src_frames, int n, FILE *csv) {
+    Sequence seq;
+    OpResult r;
+    uint32_t rand_state = n;
+    int k = FFMIN(n, BENCH_MAX_OPS);
+    Clip **clips = alloc_bench_clips(vc, n, BENCH_CLIP_FRAMES, 0, src_frames);
+    if(clips == NULL) {
+        return -1;
+    }
+    init_sequence(&seq, BENCH_FPS, BENCH_SAMPLE_RATE);
+    for(int i = 0; i < n; i++) {
+        sequence_append_clip(&seq, clips[i]);
+    }
+    free(clips);
+
+    int duration = get_sequence_duration(&seq);
+    int seek_failed = 0;
+    start_op(&r, "sequence_seek", n);
+    for(int i = 0; i < k; i++) {
+        if(sequence_seek(&seq, bench_rand(&rand_state) % duration) < 0) {
+            ++seek_failed;
+        }
+    }
+    finish_op(&r, k, csv);
+    if(seek_failed > 0) {
+        log_error("bench_media_ops() error: %d seeks failed\n", seek_failed);
+    }
+
+    // cut the middle of k different clips
+    int cut_failed = 0;
+    start_op(&r, "cut_clip", n);
+    for(int i = 0; i < k; i++) {
+        int clip_idx = (int) ((int64_t) i * n / k);
+        if(cut_clip(&seq, clip_idx * BENCH_CLIP_FRAMES + BENCH_CLIP_FRAMES / 2) < 0) {
+            ++cut_failed;
+        }
+    }
+    finish_op(&r, k, csv);
+    if(cut_failed > 0) {
+        log_error("bench_media_ops() error: %d cuts failed\n", cut_failed);
+    }
+    free_sequence(&seq);
+    return seek_failed > 0 || cut_failed > 0 ? -1 : 0;
+}
+
+int main(int argc, char **argv) {
+    int max_clips = argc > 1 ? atoi(argv[1]) : 1000000;
+    FILE *csv = NULL;
+    char *synth_url = argc > 3 ? argv[3] : "bench-sequence-ops.mov";
+    if(max_clips < 100) {
+        printf("usage: %s [max_clips >= 100] [results.csv] [synthetic.mov]\n", argv[0]);
+        return -1;
+    }
+    if(argc > 2 && (csv = fopen(argv[2], "w")) == NULL) {
+        fprintf(stderr, "Failed to open results[%s]\n", argv[2]);
+        return -1;
+    }
+    set_log_level(LOG_LEVEL_ERROR);
+    // small file with a short GOP: seeks land close to the frame wanted
+    SyntheticParams p;
+    set_synthetic_params_default(&p);
+    p.width = 320;
+    p.height = 180;
+    p.audio_codec_id = AV_CODEC_ID_NONE;
+    if(generate_synthetic_media(synth_url, &p) < 0) {
+        return -1;
+    }
+    Clip *synth = alloc_clip(synth_url);
+    if(synth == NULL || open_clip(synth) < 0) {
+        fprintf(stderr, "Failed to open synthetic file[%s]\n", synth_url);
+        if(synth != NULL) {
+            free_clip(&synth);
+        }
+        return -1;
+    }
+    int64_t synth_frames = synth->orig_end_pts / get_video_frame_pts(synth->vid_ctx, 1);
+    // long enough for max_clips clips spaced by two clip lengths
+    VideoContext *vc = alloc_metadata_video_context("metadata.mov", (int64_t) max_clips * 2 * BENCH_CLIP_FRAMES + BENCH_CLIP_FRAMES);
+    if(vc == NULL) {
+        free_clip(&synth);
+        return -1;
+    }
+    if(csv != NULL) {
+        fprintf(csv, "op,clips,ops,time_ns,heap_bytes,ns_op,bytes_op\n");
+    }
+    printf("%-30s %8s %8s %14s %12s\n", "op", "clips", "ops", "ns/op", "bytes/op");
+    int ret = 0;
+    for(int n = 100; n <= max_clips && ret >= 0; n *= 10) {
+        ret = bench_sequence_ops(vc, n, csv);
+        if(ret >= 0) {
+            ret = bench_insert_sorted(vc, n, csv);
+        }
+        if(ret >= 0) {
+            ret = bench_media_ops(synth->vid_ctx, synth_frames, n, csv);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("peak resident memory: %ld KB\n", usage.ru_maxrss);
+    free_video_context(&vc);
+    free_clip(&synth);
+    if(csv != NULL) {
+        fclose(csv);
+    }
+    return ret < 0 ? -1 : 0;
+}
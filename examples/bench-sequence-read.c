@@ -0,0 +1,377 @@
+/**
+ * @file bench-sequence-read.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief Micro-benchmark of the per-packet overhead of the sequence read and
+ * encode drivers (sequence_read_packet(), sequence_read_frame() and sequence_encode_frame()).
+ * Each driver is compared with the recursive driver it replaced: the recursive drivers
+ * below keep the control flow from before the drivers became loops (one call per skipped
+ * packet, clip change and encoder send/receive), on top of the same clip and encoder
+ * primitives, so the difference is the cost of the driver alone. Both drivers read the
+ * same sequence BENCH_ROUNDS times in turn and the fastest run of each is reported,
+ * with the deepest recursion reached by the recursive driver
+ * usage: bin/examples/bench-sequence-read out.mov clip_len_frames file1.mov [file2.mov ...]
+ */
+
+#include "OutputContext.h"
+
+/* number of runs of each driver (the fastest is kept) */
+#define BENCH_ROUNDS 3
+
+/*
+    Fastest run of a driver
+ */
+typedef struct BenchResult {
+    int64_t count, time_ns;
+    int max_depth;
+} BenchResult;
+
+/**
+ * Get monotonic time in nanoseconds
+ * @return nanoseconds
+ */
+int64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Print benchmark result line
+ * @param name  name of benchmark
+ * @param count number of packets/frames processed
+ * @param ns    total time in nanoseconds
+ */
+void print_result(char *name, int64_t count, int64_t ns) {
+    printf("%-34s %10ld items %12.3fms %10.1f ns/item\n", name, count, ns / 1000000.0,
+            count > 0 ? ns / (double)count : 0.0);
+}
+
+/**
+ * Keep a run when it is the fastest of its driver
+ * @param r         BenchResult of driver
+ * @param count     number of packets/frames processed
+ * @param ns        time of run in nanoseconds
+ * @param max_depth deepest recursion of run
+ */
+void keep_fastest(BenchResult *r, int64_t count, int64_t ns, int max_depth) {
+    if(r->count == 0 || ns < r->time_ns) {
+        r->count = count;
+        r->time_ns = ns;
+    }
+    r->max_depth = FFMAX(r->max_depth, max_depth);
+}
+
+/**
+ * Print the loop driver against the recursive driver it replaced
+ * @param name      name of driver
+ * @param loop      BenchResult of loop driver
+ * @param recursive BenchResult of recursive driver
+ */
+void print_comparison(char *name, BenchResult *loop, BenchResult *recursive) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s (loop)", name);
+    print_result(label, loop->count, loop->time_ns);
+    snprintf(label, sizeof(label), "%s (recursive)", name);
+    print_result(label, recursive->count, recursive->time_ns);
+    if(loop->count != recursive->count) {
+        printf("  warning: drivers returned %ld and %ld items\n", loop->count, recursive->count);
+    }
+    double loop_item = loop->count > 0 ? loop->time_ns / (double)loop->count : 0;
+    double rec_item = recursive->count > 0 ? recursive->time_ns / (double)recursive->count : 0;
+    printf("  per item: %+.1f ns (%+.1f%%), recursion depth %d -> 0\n", loop_item - rec_item,
+            rec_item > 0 ? (loop_item - rec_item) * 100 / rec_item : 0.0, recursive->max_depth);
+}
+
+/*************** RECURSIVE DRIVERS (BASELINE) ***************/
+/**
+ * clip_read_packet() as a recursive driver: every packet skipped (finished stream)
+ * is one more call
+ * @param  clip      Clip to read packets
+ * @param  pkt       output packet
+ * @param  depth     depth of this call
+ * @param  max_depth deepest call (updated)
+ * @return           >= 0 on success, < 0 at the end of clip or error
+ */
+int recursive_clip_read_packet(Clip *clip, AVPacket *pkt, int depth, int *max_depth) {
+    *max_depth = FFMAX(*max_depth, depth);
+    AVPacket tmpPkt;
+    VideoContext *vid_ctx = clip->vid_ctx;
+    int64_t video_end_pts = clip->orig_end_pts;
+    int64_t audio_end_pts = cov_video_to_audio_pts(vid_ctx, video_end_pts);
+    int ret;
+    if(clip->read_cycle_done && (ret = reset_packet_counter(clip)) < 0) {
+        return ret;
+    }
+    if(clip->done_reading_video && clip->done_reading_audio) {
+        // same end of read cycle as clip_read_packet()
+        bool dropped = clip->read_ahead_lost || is_stream_discarded(vid_ctx, vid_ctx->video_stream_idx) ||
+                        is_stream_discarded(vid_ctx, vid_ctx->audio_stream_idx);
+        vid_ctx->read_end_pts = dropped ? -1 : clip->orig_end_pts;
+        vid_ctx->seek_pts = -1;
+        clip->read_cycle_done = true;
+        return -1;
+    }
+    if((ret = read_video_context_packet(vid_ctx, &tmpPkt)) < 0) {
+        *pkt = tmpPkt;
+        reset_packet_counter(clip);
+        return ret;
+    }
+    if(done_curr_pkt_stream(clip, &tmpPkt)) {
+        keep_clip_read_ahead(clip, &tmpPkt);
+        return recursive_clip_read_packet(clip, pkt, depth + 1, max_depth);
+    }
+    if(tmpPkt.stream_index == vid_ctx->video_stream_idx) {
+        if(tmpPkt.pts >= video_end_pts) {
+            clip->done_reading_video = true;
+            keep_clip_read_ahead(clip, &tmpPkt);
+            return recursive_clip_read_packet(clip, pkt, depth + 1, max_depth);
+        }
+        vid_ctx->curr_pts = tmpPkt.pts;
+    } else if(tmpPkt.pts >= audio_end_pts) {
+        clip->done_reading_audio = true;
+        keep_clip_read_ahead(clip, &tmpPkt);
+        return recursive_clip_read_packet(clip, pkt, depth + 1, max_depth);
+    }
+    *pkt = tmpPkt;
+    return 0;
+}
+
+/**
+ * sequence_read_packet() as a recursive driver: every clip change is one more call
+ * @param  seq       Sequence
+ * @param  pkt       output packet
+ * @param  depth     depth of this call
+ * @param  max_depth deepest call (updated)
+ * @return           >= 0 on success, < 0 at the end of sequence or error
+ */
+int recursive_sequence_read_packet(Sequence *seq, AVPacket *pkt, int depth, int *max_depth) {
+    *max_depth = FFMAX(*max_depth, depth);
+    Node *currNode = seq->clips_iter.current;
+    if(currNode == NULL) {
+        return -1;
+    }
+    int ret = recursive_clip_read_packet((Clip *) currNode->data, pkt, depth + 1, max_depth);
+    if(ret >= 0) {
+        return pkt->stream_index;
+    }
+    nextElement(&(seq->clips_iter));
+    Node *next = seq->clips_iter.current;
+    if(next == NULL) {
+        sequence_seek(seq, 0);
+        return -1;
+    }
+    ret = open_clip((Clip *) next->data);
+    if(ret < 0) {
+        return ret;
+    }
+    return recursive_sequence_read_packet(seq, pkt, depth + 1, max_depth);
+}
+
+/**
+ * sequence_read_frame() as a recursive driver (clips only, no transitions or tracks):
+ * every clip change is one more call
+ * @param  seq       Sequence
+ * @param  frame     output frame
+ * @param  type      output type of frame
+ * @param  depth     depth of this call
+ * @param  max_depth deepest call (updated)
+ * @return           >= 0 on success, < 0 at the end of sequence or error
+ */
+int recursive_sequence_read_frame(Sequence *seq, AVFrame *frame, enum AVMediaType *type, int depth, int *max_depth) {
+    *max_depth = FFMAX(*max_depth, depth);
+    Node *currNode = seq->clips_iter.current;
+    if(currNode == NULL) {
+        return -1;
+    }
+    Clip *curr_clip = (Clip *) currNode->data;
+    int ret;
+    if(is_vc_out_bounds(curr_clip) && (ret = resume_clip_read(curr_clip)) < 0) {
+        return ret;
+    }
+    ret = clip_read_frame(curr_clip, frame, type);
+    if(ret >= 0) {
+        seq_frame_to_seq_ts(seq, curr_clip, frame, *type);
+        return 0;
+    }
+    nextElement(&(seq->clips_iter));
+    Node *next = seq->clips_iter.current;
+    if(next == NULL) {
+        sequence_seek(seq, 0);
+        return -1;
+    }
+    open_clip((Clip *) next->data);
+    return recursive_sequence_read_frame(seq, frame, type, depth + 1, max_depth);
+}
+
+/**
+ * sequence_encode_frame() as a recursive driver: every frame sent to an encoder
+ * and every encoder found flushed is one more call
+ * @param  oc        opened OutputContext
+ * @param  seq       Sequence
+ * @param  pkt       output encoded packet
+ * @param  depth     depth of this call
+ * @param  max_depth deepest call (updated)
+ * @return           >= 0 on success, < 0 at the end of sequence or error
+ */
+int recursive_sequence_encode_frame(OutputContext *oc, Sequence *seq, AVPacket *pkt, int depth, int *max_depth) {
+    *max_depth = FFMAX(*max_depth, depth);
+    if(oc->video.done_flush && oc->audio.done_flush) {
+        return AVERROR_EOF;
+    }
+    int ret;
+    OutputStream *os = seq_get_drain_stream(oc);
+    if(os != NULL) {
+        ret = seq_receive_enc_packet(os, pkt);
+        if(ret == AVERROR_EOF) {
+            return recursive_sequence_encode_frame(oc, seq, pkt, depth + 1, max_depth);
+        } else if(ret != AVERROR(EAGAIN)) {
+            return ret;
+        }
+    }
+    ret = seq_send_frame_to_encoder(oc, seq);
+    if(ret < 0) {
+        return ret;
+    }
+    return recursive_sequence_encode_frame(oc, seq, pkt, depth + 1, max_depth);
+}
+
+/*************** BENCHMARKS ***************/
+int64_t bench_read_packets(Sequence *seq, bool recursive, int *max_depth) {
+    AVPacket pkt;
+    int64_t count = 0;
+    sequence_seek(seq, 0);
+    while((recursive ? recursive_sequence_read_packet(seq, &pkt, 0, max_depth)
+                     : sequence_read_packet(seq, &pkt, false)) >= 0) {
+        ++count;
+        av_packet_unref(&pkt);
+    }
+    return count;
+}
+
+int64_t bench_read_frames(Sequence *seq, bool recursive, int *max_depth) {
+    enum AVMediaType type;
+    AVFrame *frame = av_frame_alloc();
+    int64_t count = 0;
+    sequence_seek(seq, 0);
+    while((recursive ? recursive_sequence_read_frame(seq, frame, &type, 0, max_depth)
+                     : sequence_read_frame(seq, frame, &type, false)) >= 0) {
+        ++count;
+    }
+    av_frame_free(&frame);
+    return count;
+}
+
+int64_t bench_encode_packets(Sequence *seq, OutputParameters *op, bool recursive, int *max_depth, bool print_stats) {
+    OutputContext oc;
+    init_video_output(&oc);
+    if(open_video_output(&oc, op, seq) < 0) {
+        fprintf(stderr, "bench_encode_packets() error: Failed to open video output\n");
+        return -1;
+    }
+    AVPacket *pkt = av_packet_alloc();
+    int64_t count = 0;
+    sequence_seek(seq, 0);
+    clear_sequence_render_stats(seq);
+    set_render_stats_enabled(print_stats);
+    while((recursive ? recursive_sequence_encode_frame(&oc, seq, pkt, 0, max_depth)
+                     : sequence_encode_frame(&oc, seq, pkt)) >= 0) {
+        ++count;
+        av_packet_unref(pkt);
+    }
+    set_render_stats_enabled(false);
+    av_packet_free(&pkt);
+    close_video_output(&oc, true);
+
+    // where the encode time went
+    if(print_stats) {
+        RenderStats stats;
+        init_render_stats(&stats);
+        get_sequence_render_stats(seq, &stats);
+        merge_render_stats(&stats, &(oc.stats));
+        for(int i = 0; i < RENDER_STAGE_NB; i++) {
+            StageStats s = get_render_stage_total(&stats, i);
+            printf("  %-10s %10ld items %12.3fms\n", get_render_stage_name(i), s.count, s.time_ns / 1000000.0);
+        }
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 4) {
+        printf("usage: %s output_file clip_len_frames file1 [file2 ...]\n", argv[0]);
+        printf("clip_len_frames: each file is cut into clips of this length (short clips stress clip changes)\n");
+        return -1;
+    }
+    int clip_len = atoi(argv[2]);
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+
+    for(int i = 3; i < argc; i++) {
+        Clip *clip = alloc_clip(argv[i]);
+        if(clip == NULL) {
+            fprintf(stderr, "Failed to open clip[%s]\n", argv[i]);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    // cut the sequence into many short clips to stress the clip change path
+    if(clip_len > 0) {
+        int64_t dur = get_sequence_duration(&seq);
+        for(int64_t f = clip_len; f < dur; f += clip_len) {
+            cut_clip(&seq, f);
+        }
+    }
+
+    Clip *first = (Clip *) seq.clips.head->data;
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, first->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, first->vid_ctx->audio_codec_ctx);
+    if(set_output_params(&op, argv[1], vp, ap) < 0) {
+        free_sequence(&seq);
+        return -1;
+    }
+
+    // warm up the file cache, so the first driver timed is not penalized
+    int depth = 0;
+    bench_read_packets(&seq, false, &depth);
+
+    // [0] loop driver, [1] recursive driver
+    BenchResult packets[2], frames[2], encode[2];
+    memset(packets, 0, sizeof(packets));
+    memset(frames, 0, sizeof(frames));
+    memset(encode, 0, sizeof(encode));
+    for(int round = 0; round < BENCH_ROUNDS; round++) {
+        for(int r = 0; r < 2; r++) {
+            int64_t t = now_ns();
+            depth = 0;
+            int64_t count = bench_read_packets(&seq, r, &depth);
+            keep_fastest(&(packets[r]), count, now_ns() - t, depth);
+
+            t = now_ns();
+            depth = 0;
+            count = bench_read_frames(&seq, r, &depth);
+            keep_fastest(&(frames[r]), count, now_ns() - t, depth);
+
+            t = now_ns();
+            depth = 0;
+            count = bench_encode_packets(&seq, &op, r, &depth, false);
+            keep_fastest(&(encode[r]), count, now_ns() - t, depth);
+        }
+    }
+    print_comparison("sequence_read_packet", &(packets[0]), &(packets[1]));
+    print_comparison("sequence_read_frame", &(frames[0]), &(frames[1]));
+    print_comparison("sequence_encode_frame", &(encode[0]), &(encode[1]));
+
+    // stage breakdown of the loop encode driver (separate run, stats cost time)
+    bench_encode_packets(&seq, &op, false, &depth, true);
+
+    free_output_params(&op);
+    free_sequence(&seq);
+    return 0;
+}
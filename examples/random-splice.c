@@ -5,7 +5,7 @@
  */
 int main(int argc, char **argv) {
     if(argc < 8) {
-        printf("usage: %s output_file fps sample_rate source_dir duration cut_len_avg cut_len_var\n", argv[0]);
+        printf("usage: %s output_file fps sample_rate source_dir duration cut_len_avg cut_len_var [draft_height] [snap_dist]\n", argv[0]);
         printf("\nExplanation\n------------\n");
         printf("output_file(string): output filename of encoded edit (ex. out.mov)\n");
         printf("fps(int): frames per second to use in sequence. All frame parameters are based on this (ex. 30 for 30fps)\n");
@@ -14,6 +14,8 @@ int main(int argc, char **argv) {
         printf("duration(int): duration of output file (in frames - fps defined above)\n");
         printf("cut_len_avg(int): average length of cuts (in frames)\n");
         printf("cut_len_var(int): variability of average cuts used by the random number generator for max and min range\n");
+        printf("draft_height(int, optional): write a fast draft preview of this height instead of a full quality render\n");
+        printf("snap_dist(int, optional): detect shot boundaries first, and move cuts to a boundary within this many frames\n");
         return -1;
     }
     RandSpliceParams par;
@@ -25,6 +27,11 @@ int main(int argc, char **argv) {
     par.cut_len_avg = atoi(argv[6]);
     par.cut_len_var = atoi(argv[7]);
     par.pick_frames_recur = 0;
+    par.scenes = NULL;
+    par.snap_dist = argc > 9 ? atoi(argv[9]) : 0;
+    int draft_height = argc > 8 ? atoi(argv[8]) : 0;
+    SceneList scenes;
+    init_scene_list(&scenes);
 
     int num_files, ret = 0;
     char **files = get_filenames_in_dir(par.source_dir, &num_files);
@@ -45,6 +52,16 @@ int main(int argc, char **argv) {
     free(str);
     str = NULL;
 
+    if(par.snap_dist > 0) {
+        ret = detect_sequence_scenes(&orig_seq, NULL, &scenes);
+        if(ret < 0) {
+            fprintf(stderr, "failed to detect shot boundaries\n");
+            goto end;
+        }
+        printf("found %d shot boundaries\n", scenes.nb_cuts);
+        par.scenes = &scenes;
+    }
+
     ret = random_edit(&orig_seq, &new_seq, &par);
     if(ret < 0) {
         fprintf(stderr, "random_edit() error: Failed to finish edit\n");
@@ -56,7 +73,13 @@ int main(int argc, char **argv) {
     free(str);
     str = NULL;
 
-    if(new_seq.clips.head != NULL) {
+    if(new_seq.clips.head != NULL && draft_height > 0) {
+        ret = write_sequence_draft(&new_seq, par.output_file, draft_height, 1);
+        if(ret < 0) {
+            fprintf(stderr, "Failed to write draft of new sequence to output file[%s]\n", par.output_file);
+            goto end;
+        }
+    } else if(new_seq.clips.head != NULL) {
         // output parameters
         OutputParameters op;
         VideoOutParams vp;
@@ -71,7 +94,7 @@ int main(int argc, char **argv) {
             goto end;
         }
 
-        ret = write_sequence(&new_seq, &op);
+        ret = write_sequence(&new_seq, &op, 1);
         free_output_params(&op);
         if(ret < 0) {
             fprintf(stderr, "Failed to write new sequence to output file[%s]\n", op.filename);
@@ -84,6 +107,7 @@ int main(int argc, char **argv) {
     free_str_arr(&files, num_files);
     free_sequence(&orig_seq);
     free_sequence(&new_seq);
+    free_scene_list(&scenes);
 }
 
 /**
@@ -123,7 +147,12 @@ int random_cut(Sequence *os, Sequence *ns, RandSpliceParams *par) {
         fprintf(stderr, "random_cut() error: Failed to pick frames\n");
         return ret;
     }
-    return cut_remove_insert(os, ns, s, e);
+    ret = cut_remove_insert(os, ns, s, e);
+    // shot boundaries after the cut move back with the rest of the original sequence
+    if(ret >= 0 && par->scenes != NULL) {
+        scene_list_ripple_delete(par->scenes, s, e);
+    }
+    return ret;
 }
 
 /**
@@ -207,6 +236,15 @@ int pick_frames(Sequence *seq, RandSpliceParams *par, int *start_index, int *end
     if(e > seq_dur) {
         e = seq_dur;
     }
+    if(par->scenes != NULL) {
+        int snap_s = snap_to_scene_cut(par->scenes, s, par->snap_dist);
+        int snap_e = snap_to_scene_cut(par->scenes, e, par->snap_dist);
+        // keep the snapped cut only if it is still a cut
+        if(snap_e > snap_s) {
+            s = snap_s;
+            e = snap_e;
+        }
+    }
     Clip *sc = NULL, *se = NULL;
     find_clip_at_index(seq, s, &sc);
     find_clip_at_index(seq, e, &se);
@@ -0,0 +1,67 @@
+/**
+ * @file test-frame-cache.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the FrameCache API: scrubs back and forth over the start of a clip
+ * (as an editor does over a cut) with and without a frame cache, and prints the time,
+ * hits and misses of each run
+ * usage: bin/examples/test-frame-cache file.mov [nb_frames] [cache_mb]
+ */
+
+#include "FrameCache.h"
+
+/**
+ * Scrub forward then backward over the first nb_frames of a clip, three times
+ * @param  clip      Clip
+ * @param  nb_frames number of frames scrubbed
+ * @param  max_bytes bytes of cache (0 to disable the cache)
+ * @param  prefetch  frames prefetched around each request
+ * @return           >= 0 on success
+ */
+int scrub(Clip *clip, int nb_frames, int64_t max_bytes, int prefetch) {
+    FrameCache fc;
+    int ret = init_frame_cache(&fc, max_bytes, prefetch);
+    if(ret < 0) {
+        return ret;
+    }
+    AVFrame *frame = av_frame_alloc();
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int pass = 0; pass < 3 && ret >= 0; pass++) {
+        for(int i = 0; i < nb_frames && ret >= 0; i++) {
+            ret = get_cached_clip_frame(&fc, clip, i, frame);
+            av_frame_unref(frame);
+        }
+        for(int i = nb_frames - 1; i >= 0 && ret >= 0; i--) {
+            ret = get_cached_clip_frame(&fc, clip, i, frame);
+            av_frame_unref(frame);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("cache[%ldMB] prefetch[%d]: %.1fms, %d hits, %d misses, %d frames (%ldMB) cached\n",
+        max_bytes >> 20, prefetch, ms, fc.hits, fc.misses, fc.nb_frames, fc.bytes >> 20);
+    av_frame_free(&frame);
+    free_frame_cache(&fc);
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s file [nb_frames] [cache_mb]\n", argv[0]);
+        return -1;
+    }
+    int nb_frames = argc > 2 ? atoi(argv[2]) : 60;
+    int64_t max_bytes = (argc > 3 ? atoi(argv[3]) : 512) * (int64_t) (1 << 20);
+    Clip *clip = alloc_clip(argv[1]);
+    if(clip == NULL) {
+        fprintf(stderr, "Failed to open clip[%s]\n", argv[1]);
+        return -1;
+    }
+    int ret = scrub(clip, nb_frames, 0, 0);
+    if(ret >= 0) {
+        ret = scrub(clip, nb_frames, max_bytes, 15);
+    }
+    free_clip(&clip);
+    return ret < 0 ? -1 : 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test-multitrack.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing tracks of a sequence: a picture in picture over the clips of the
+ * sequence (a quarter of the frame in the bottom right, at 80% opacity) and a music track
+ * mixed at half volume. The sequence is read without and with tracks to time the cost
+ * of compositing, then written with tracks. Both reads must output one video frame per
+ * sequence frame. Missing inputs are replaced by a synthetic source generated next to the output
+ * usage: bin/examples/test-multitrack output.mp4 [input.mov [overlay.mov [music.mp3]]]
+ */
+
+#include "OutputContext.h"
+#include "SyntheticMedia.h"
+
+/**
+ * Read every frame of a sequence
+ * @param  seq Sequence
+ * @param  ms  output time taken in milliseconds
+ * @return     number of video frames read
+ */
+int read_sequence_frames(Sequence *seq, double *ms) {
+    AVFrame *frame = av_frame_alloc();
+    enum AVMediaType type;
+    int nb = 0;
+    struct timespec start, end;
+    sequence_seek(seq, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while(sequence_read_frame(seq, frame, &type, false) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            ++nb;
+        }
+        av_frame_unref(frame);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    av_frame_free(&frame);
+    return nb;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s output [input [overlay [music]]]\n", argv[0]);
+        return -1;
+    }
+    char synth_url[1024];
+    if(argc < 4) {
+        // long enough for both clips (frames 0 to 180 at 30fps)
+        SyntheticParams p;
+        set_synthetic_params_default(&p);
+        p.width = 320;
+        p.height = 180;
+        p.duration = 6;
+        snprintf(synth_url, sizeof(synth_url), "%s-source.mov", argv[1]);
+        if(generate_synthetic_media(synth_url, &p) < 0) {
+            return -1;
+        }
+    }
+    char *input = argc > 2 ? argv[2] : synth_url;
+    char *overlay_url = argc > 3 ? argv[3] : synth_url;
+    char *music = argc > 4 ? argv[4] : overlay_url;
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+
+    Clip *clip1 = alloc_clip(input);
+    if(clip1 == NULL) {
+        fprintf(stderr, "Failed to open [%s]\n", input);
+        return -1;
+    }
+    Clip *clip2 = copy_clip_vc(clip1);
+    if(clip2 == NULL) {
+        fprintf(stderr, "Failed to open clips\n");
+        return -1;
+    }
+    set_clip_bounds(clip1, 0, 90);
+    set_clip_bounds(clip2, 90, 180);
+    sequence_append_clip(&seq, clip1);
+    sequence_append_clip(&seq, clip2);
+
+    double plain_ms, tracks_ms;
+    int failed = 0;
+    int nb = read_sequence_frames(&seq, &plain_ms);
+    printf("clips: %d frames in %.1fms (%ld sequence frames)\n", nb, plain_ms, get_sequence_duration(&seq));
+    if(nb != get_sequence_duration(&seq)) {
+        printf("clips: wrong number of video frames FAIL\n");
+        ++failed;
+    }
+
+    // picture in picture from frame 30 to 120
+    SequenceTrack *pip = sequence_add_track(&seq, true, false);
+    Clip *overlay = alloc_clip(overlay_url);
+    if(pip == NULL || overlay == NULL) {
+        fprintf(stderr, "Failed to open [%s]\n", overlay_url);
+        free_sequence(&seq);
+        return -1;
+    }
+    set_clip_bounds(overlay, 0, 90);
+    sequence_add_clip(&(pip->seq), overlay, 30);
+    int width = clip1->vid_ctx->video_codec_ctx->width, height = clip1->vid_ctx->video_codec_ctx->height;
+    set_track_layout(pip, width - width / 4 - width / 16, height - height / 4 - height / 16,
+                        width / 4, height / 4, 0.8);
+
+    // music under the whole sequence
+    SequenceTrack *bgm = sequence_add_track(&seq, false, true);
+    Clip *song = alloc_clip(music);
+    if(bgm == NULL || song == NULL) {
+        fprintf(stderr, "Failed to open [%s]\n", music);
+        free_sequence(&seq);
+        return -1;
+    }
+    sequence_append_clip(&(bgm->seq), song);
+    set_track_volume(bgm, 0.5);
+
+    nb = read_sequence_frames(&seq, &tracks_ms);
+    printf("tracks: %d frames in %.1fms (%ld sequence frames, %+.1f%%)\n", nb, tracks_ms,
+            get_sequence_duration(&seq), plain_ms > 0 ? (tracks_ms - plain_ms) * 100 / plain_ms : 0);
+    if(nb != get_sequence_duration(&seq)) {
+        printf("tracks: wrong number of video frames FAIL\n");
+        ++failed;
+    }
+
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    if(set_output_params(&op, argv[1], vp, ap) < 0) {
+        free_sequence(&seq);
+        return -1;
+    }
+    sequence_seek(&seq, 0);
+    int ret = write_sequence(&seq, &op, 1);
+    printf("write_sequence(): %d\n", ret);
+
+    free_output_params(&op);
+    free_sequence(&seq);
+    return ret < 0 || failed > 0 ? -1 : 0;
+}
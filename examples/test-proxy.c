@@ -0,0 +1,120 @@
+/**
+ * @file test-proxy.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the Proxy API: proxies are created in the background,
+ * the sequence is previewed (decoded) from proxies, then rendered from originals.
+ * The first file is added twice with separate VideoContexts, and every clip must read
+ * its proxy (same frame count as the originals). When no file is given a synthetic source
+ * is generated next to the output
+ * usage: bin/examples/test-proxy out.mov [file1.mov file2.mov ...]
+ */
+
+#include "OutputContext.h"
+#include "Proxy.h"
+#include "SyntheticMedia.h"
+
+/**
+ * Decode every frame of the sequence (preview/analysis stand in)
+ * @param  seq Sequence
+ * @return     number of video frames decoded
+ */
+int64_t preview_sequence(Sequence *seq) {
+    enum AVMediaType type;
+    AVFrame *frame = av_frame_alloc();
+    int64_t count = 0;
+    sequence_seek(seq, 0);
+    while(sequence_read_frame(seq, frame, &type, false) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            ++count;
+        }
+    }
+    av_frame_free(&frame);
+    return count;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s output_file [file1 file2 ...]\n", argv[0]);
+        return -1;
+    }
+    char synth_url[1024];
+    char *first_url = argv[2];
+    if(argc < 3) {
+        SyntheticParams p;
+        set_synthetic_params_default(&p);
+        p.width = 320;
+        p.height = 180;
+        snprintf(synth_url, sizeof(synth_url), "%s-source.mov", argv[1]);
+        if(generate_synthetic_media(synth_url, &p) < 0) {
+            return -1;
+        }
+        first_url = synth_url;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+    // the first file twice, each clip with its own VideoContext
+    for(int i = 1; i < argc || i <= 2; i++) {
+        char *url = i <= 2 ? first_url : argv[i];
+        Clip *clip = i <= 2 ? alloc_clip(url) : seq_alloc_clip(&seq, url);
+        if(clip == NULL || open_clip(clip) < 0) {
+            fprintf(stderr, "Failed to open clip[%s]\n", url);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+
+    ProxyParams params;
+    ProxyManager pm;
+    set_proxy_params_default(&params);
+    init_proxy_manager(&pm, &params);
+
+    clock_t t = clock();
+    sequence_create_proxies(&pm, &seq);
+    wait_proxies(&pm);
+    printf("Proxies ready in %fms.\n", ((double)(clock() - t))/(CLOCKS_PER_SEC/1000));
+
+    int failed = 0;
+    for(Node *curr = seq.clips.head; curr != NULL; curr = curr->next) {
+        VideoContext *vc = ((Clip *) curr->data)->vid_ctx;
+        if(vc->proxy_url == NULL) {
+            printf("clip[%s]: no proxy FAIL\n", vc->url);
+            ++failed;
+        }
+    }
+
+    sequence_use_proxies(&seq, true);
+    t = clock();
+    int64_t proxy_frames = preview_sequence(&seq);
+    printf("Preview from proxies: %ld frames in %fms.\n", proxy_frames, ((double)(clock() - t))/(CLOCKS_PER_SEC/1000));
+
+    sequence_use_proxies(&seq, false);
+    t = clock();
+    int64_t frames = preview_sequence(&seq);
+    printf("Preview from originals: %ld frames in %fms.\n", frames, ((double)(clock() - t))/(CLOCKS_PER_SEC/1000));
+    if(proxy_frames != frames) {
+        printf("proxies and originals have a different frame count FAIL\n");
+        ++failed;
+    }
+
+    // final render always reads originals
+    Clip *clip1 = (Clip *) seq.clips.head->data;
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    int ret = set_output_params(&op, argv[1], vp, ap);
+    if(ret >= 0) {
+        sequence_seek(&seq, 0);
+        ret = write_sequence(&seq, &op, 1);
+        free_output_params(&op);
+    }
+
+    free_proxy_manager(&pm);
+    free_sequence(&seq);
+    return ret < 0 || failed > 0 ? -1 : 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test-render-cache.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the RenderCache API: the sequence is rendered once (every clip
+ * is encoded into the cache), the last clip is trimmed, and the sequence is rendered again
+ * (only the trimmed clip is encoded, every other segment is stream copied).
+ * The first file is cut into several clips sharing one VideoContext, and the frame count
+ * of every cached segment is compared to the length of its clip after each render.
+ * When no file is given a synthetic source is generated into cache_dir
+ * usage: bin/examples/test-render-cache out.mov cache_dir [file1.mov file2.mov ...]
+ */
+
+#include "OutputContext.h"
+#include "RenderCache.h"
+#include "SyntheticMedia.h"
+
+/* frames between the cuts made in the first clip */
+#define TEST_CUT_FRAMES 30
+
+/**
+ * Count the video packets of a cached segment
+ * @param  url filename of segment
+ * @return     number of video frames, < 0 on fail
+ */
+int64_t count_segment_frames(char *url) {
+    AVFormatContext *fmt_ctx = NULL;
+    int ret = avformat_open_input(&fmt_ctx, url, NULL, NULL);
+    if(ret < 0) {
+        fprintf(stderr, "Failed to open segment[%s]\n", url);
+        return ret;
+    }
+    int stream_index = -1;
+    if((ret = avformat_find_stream_info(fmt_ctx, NULL)) >= 0) {
+        ret = stream_index = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    }
+    int64_t nb_frames = 0;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    while(ret >= 0 && (ret = av_read_frame(fmt_ctx, &pkt)) >= 0) {
+        if(pkt.stream_index == stream_index) {
+            ++nb_frames;
+        }
+        av_packet_unref(&pkt);
+    }
+    avformat_close_input(&fmt_ctx);
+    return ret == AVERROR_EOF ? nb_frames : ret;
+}
+
+/**
+ * Compare the frame count of every cached segment to the length of its clip
+ * @param  seq Sequence rendered with write_sequence_cached()
+ * @param  op  OutputParameters of the render
+ * @param  rc  RenderCache
+ * @return     number of segments with the wrong length, < 0 on fail
+ */
+int check_segment_frames(Sequence *seq, OutputParameters *op, RenderCache *rc) {
+    OutputParameters seg_op = *op;
+    int ret = resolve_render_cache_codecs(&seg_op);
+    if(ret < 0) {
+        return ret;
+    }
+    set_render_cache_segment_audio(&(seg_op.audio));
+    int64_t frame_pts = seq_frame_index_to_pts(seq, 1);
+    int failed = 0;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next) {
+        Clip *clip = (Clip *) curr->data;
+        char *url = get_render_cache_url(rc, get_clip_cache_key(seq, clip, &seg_op));
+        if(url == NULL) {
+            return AVERROR(ENOMEM);
+        }
+        int64_t expected = (clip->end_pts - clip->start_pts) / frame_pts;
+        int64_t nb_frames = count_segment_frames(url);
+        printf("segment[%s]: %ld frames, expected %ld %s\n", url, nb_frames, expected,
+                nb_frames == expected ? "OK" : "FAIL");
+        if(nb_frames != expected) {
+            ++failed;
+        }
+        free(url);
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 3) {
+        printf("usage: %s output_file cache_dir [file1 file2 ...]\n", argv[0]);
+        return -1;
+    }
+    RenderCache rc;
+    if(init_render_cache(&rc, argv[2]) < 0) {
+        return -1;
+    }
+    char synth_url[1024];
+    char *first_url = argv[3];
+    if(argc < 4) {
+        SyntheticParams p;
+        set_synthetic_params_default(&p);
+        p.width = 320;
+        p.height = 180;
+        snprintf(synth_url, sizeof(synth_url), "%s/synthetic.mov", argv[2]);
+        if(generate_synthetic_media(synth_url, &p) < 0) {
+            free_render_cache(&rc);
+            return -1;
+        }
+        first_url = synth_url;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+    for(int i = 3; i < argc || i == 3; i++) {
+        char *url = i == 3 ? first_url : argv[i];
+        Clip *clip = seq_alloc_clip(&seq, url);
+        if(clip == NULL || open_clip(clip) < 0) {
+            fprintf(stderr, "Failed to open clip[%s]\n", url);
+            free_sequence(&seq);
+            free_render_cache(&rc);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    // several clips of the first file (one shared VideoContext)
+    Clip *clip1 = (Clip *) seq.clips.head->data;
+    int64_t clip1_frames = (clip1->end_pts - clip1->start_pts) / seq_frame_index_to_pts(&seq, 1);
+    for(int64_t i = TEST_CUT_FRAMES; i < clip1_frames; i += TEST_CUT_FRAMES) {
+        if(cut_clip(&seq, i) < 0) {
+            fprintf(stderr, "Failed to cut clip at frame[%ld]\n", i);
+            free_sequence(&seq);
+            free_render_cache(&rc);
+            return -1;
+        }
+    }
+
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    if(set_output_params(&op, argv[1], vp, ap) < 0) {
+        free_sequence(&seq);
+        free_render_cache(&rc);
+        return -1;
+    }
+
+    clock_t t = clock();
+    int ret = write_sequence_cached(&seq, &op, &rc);
+    printf("First render: %fms.\n", ((double)(clock() - t))/(CLOCKS_PER_SEC/1000));
+    int failed = 0;
+    if(ret >= 0 && (ret = check_segment_frames(&seq, &op, &rc)) >= 0) {
+        failed += ret;
+    }
+
+    // small edit: trim the last frame of the last clip (no clips follow it)
+    if(ret >= 0) {
+        Clip *last = (Clip *) seq.clips.tail->data;
+        int64_t frame_pts = get_video_frame_pts(last->vid_ctx, 1);
+        if(last->orig_end_pts - frame_pts > last->orig_start_pts) {
+            set_clip_end(last, last->orig_end_pts - frame_pts);
+            move_clip_pts(&seq, last, last->start_pts);
+        }
+        t = clock();
+        ret = write_sequence_cached(&seq, &op, &rc);
+        printf("Render after edit: %fms.\n", ((double)(clock() - t))/(CLOCKS_PER_SEC/1000));
+        if(ret >= 0 && (ret = check_segment_frames(&seq, &op, &rc)) >= 0) {
+            failed += ret;
+        }
+    }
+
+    printf("%d segments with the wrong length\n", failed);
+    free_output_params(&op);
+    free_sequence(&seq);
+    free_render_cache(&rc);
+    return ret < 0 || failed > 0 ? -1 : 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test-reverse-decode.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the ReverseDecode API: a clip is read forward, then backwards with
+ * and without prefetch. Frames read backwards are checked against the forward read
+ * (same pictures, reverse order), and the time of each read is printed
+ * usage: bin/examples/test-reverse-decode file.mov [max_frames]
+ */
+
+#include "ReverseDecode.h"
+
+/**
+ * Get the checksum of the first plane of a video frame
+ * @param  frame video frame
+ * @return       checksum
+ */
+uint64_t frame_checksum(AVFrame *frame) {
+    uint64_t sum = 0;
+    for(int y = 0; y < frame->height; y++) {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        for(int x = 0; x < frame->width; x++) {
+            sum = sum * 31 + row[x];
+        }
+    }
+    return sum;
+}
+
+/**
+ * Read a clip backwards and compare with the frames read forward
+ * @param  clip       Clip
+ * @param  sums       checksums of frames read forward
+ * @param  pts        pts of frames read forward
+ * @param  nb         number of frames read forward
+ * @param  max_frames max frames per segment
+ * @param  prefetch   decode on a worker thread
+ * @return            >= 0 when every frame matches
+ */
+int read_reverse(Clip *clip, uint64_t *sums, int64_t *pts, int nb, int max_frames, bool prefetch) {
+    ReverseReader rr;
+    int ret = init_clip_reverse_reader(&rr, clip, max_frames, prefetch);
+    if(ret < 0) {
+        return ret;
+    }
+    AVFrame *frame = av_frame_alloc();
+    int i = nb - 1, nb_diff = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while((ret = reverse_read_frame(&rr, frame)) >= 0) {
+        if(i < 0 || frame->pts != pts[i] || frame_checksum(frame) != sums[i]) {
+            ++nb_diff;
+        }
+        av_frame_unref(frame);
+        --i;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("reverse (prefetch %s): %d frames in %.1fms, %d differ from forward\n",
+        prefetch ? "on" : "off", nb - 1 - i, ms, nb_diff + (i >= 0 ? i + 1 : 0));
+    av_frame_free(&frame);
+    free_reverse_reader(&rr);
+    seek_clip_pts(clip, 0);
+    return (ret != AVERROR_EOF || nb_diff > 0 || i >= 0) ? -1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s file [max_frames]\n", argv[0]);
+        return -1;
+    }
+    int max_frames = argc > 2 ? atoi(argv[2]) : 0;
+    Clip *clip = alloc_clip(argv[1]);
+    if(clip == NULL || open_clip(clip) < 0) {
+        fprintf(stderr, "Failed to open clip[%s]\n", argv[1]);
+        return -1;
+    }
+    int nb = 0, size = 1024;
+    uint64_t *sums = malloc(size * sizeof(uint64_t));
+    int64_t *pts = malloc(size * sizeof(int64_t));
+    AVFrame *frame = av_frame_alloc();
+    enum AVMediaType type;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while(clip_read_frame(clip, frame, &type) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            if(nb == size) {
+                size *= 2;
+                sums = realloc(sums, size * sizeof(uint64_t));
+                pts = realloc(pts, size * sizeof(int64_t));
+            }
+            sums[nb] = frame_checksum(frame);
+            pts[nb++] = frame->pts;
+        }
+        av_frame_unref(frame);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("forward: %d frames in %.1fms\n", nb, ms);
+    seek_clip_pts(clip, 0);
+
+    int ret = read_reverse(clip, sums, pts, nb, max_frames, false);
+    if(ret >= 0) {
+        ret = read_reverse(clip, sums, pts, nb, max_frames, true);
+    }
+    av_frame_free(&frame);
+    free(sums);
+    free(pts);
+    free_clip(&clip);
+    return ret < 0 ? -1 : 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file test-scene-detect.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the SceneDetect API: shot boundaries of a sequence are printed
+ * with their score, along with the speed of the analysis compared to real time
+ * usage: bin/examples/test-scene-detect file1.mov [file2.mov ...]
+ */
+
+#include "SceneDetect.h"
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s file1 [file2 ...]\n", argv[0]);
+        return -1;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+    for(int i = 1; i < argc; i++) {
+        Clip *clip = seq_alloc_clip(&seq, argv[i]);
+        if(clip == NULL) {
+            fprintf(stderr, "Failed to open clip[%s]\n", argv[i]);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    SceneList scenes;
+    init_scene_list(&scenes);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ret = detect_sequence_scenes(&seq, NULL, &scenes);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if(ret < 0) {
+        fprintf(stderr, "Failed to detect shot boundaries\n");
+        free_scene_list(&scenes);
+        free_sequence(&seq);
+        return -1;
+    }
+    for(int i = 0; i < scenes.nb_cuts; i++) {
+        int64_t cut = scenes.cuts[i];
+        printf("shot boundary at frame[%ld] (%.2fs) score[%.3f]\n", cut, cut / seq.fps, scenes.scores[cut]);
+    }
+    double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    double duration = get_sequence_duration(&seq) / seq.fps;
+    printf("%d shot boundaries in %ld frames, analysed in %.2fs (%.1fx real time)\n",
+        scenes.nb_cuts, scenes.nb_scores, secs, secs > 0 ? duration / secs : 0);
+
+    free_scene_list(&scenes);
+    free_sequence(&seq);
+    return 0;
+}
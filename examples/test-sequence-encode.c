@@ -50,13 +50,20 @@ int main(int argc, char **argv) {
     if(set_output_params(&op, argv[1], vp, ap) < 0) {
         return -1;
     }
+    // any other arguments are additional containers muxed from the same packets
+    for(int i = 2; i < argc; i++) {
+        if(add_output_mux_target(&op, argv[i]) < 0) {
+            free_output_params(&op);
+            return -1;
+        }
+    }
 
     printf("\nREAD #1\n");
     printf("Start timing..\n");
     clock_t t;
     t = clock();
 
-    write_sequence(&seq, &op);
+    write_sequence(&seq, &op, 1);
 
     t = clock() - t;
     double time_taken = ((double)t)/(CLOCKS_PER_SEC/1000);
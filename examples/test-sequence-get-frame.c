@@ -0,0 +1,94 @@
+/**
+ * @file test-sequence-get-frame.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing sequence_get_frame(): frames of a sequence are fetched in random order
+ * (as a timeline preview does) and compared with the same frames read sequentially
+ * with sequence_read_frame(), with the time of each run
+ * usage: bin/examples/test-sequence-get-frame file1.mov [file2.mov ...]
+ */
+
+#include "SequenceDecode.h"
+
+/**
+ * Get the checksum of the first plane of a video frame
+ * @param  frame video frame
+ * @return       checksum
+ */
+uint64_t frame_checksum(AVFrame *frame) {
+    uint64_t sum = 0;
+    for(int y = 0; y < frame->height; y++) {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        for(int x = 0; x < frame->width; x++) {
+            sum = sum * 31 + row[x];
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s file1 [file2 ...]\n", argv[0]);
+        return -1;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+    for(int i = 1; i < argc; i++) {
+        Clip *clip = seq_alloc_clip(&seq, argv[i]);
+        if(clip == NULL) {
+            fprintf(stderr, "Failed to open clip[%s]\n", argv[i]);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    int nb_frames = get_sequence_duration(&seq);
+    uint64_t *sums = calloc(nb_frames, sizeof(uint64_t));
+    AVFrame *frame = av_frame_alloc();
+    enum AVMediaType type;
+    int ret = 0, nb_read = 0;
+
+    // sequential reference
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sequence_seek(&seq, 0);
+    while(sequence_read_frame(&seq, frame, &type, false) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            int index = seq_pts_to_frame_index(&seq, frame->pts);
+            if(index >= 0 && index < nb_frames) {
+                sums[index] = frame_checksum(frame);
+                ++nb_read;
+            }
+        }
+        av_frame_unref(frame);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("sequential: %d frames in %.1fms\n", nb_read, ms);
+
+    // random order, through a frame cache
+    FrameCache fc;
+    init_frame_cache(&fc, 256 << 20, 8);
+    int nb_diff = 0;
+    srand(1);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < nb_frames && ret >= 0; i++) {
+        int index = rand() % nb_frames;
+        if((ret = sequence_get_frame(&seq, &fc, index, frame)) >= 0) {
+            if(sums[index] != 0 && sums[index] != frame_checksum(frame)) {
+                ++nb_diff;
+            }
+            av_frame_unref(frame);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("random: %d frames in %.1fms, %d hits, %d misses, %d frames differ from sequential\n",
+        nb_frames, ms, fc.hits, fc.misses, nb_diff);
+
+    free_frame_cache(&fc);
+    av_frame_free(&frame);
+    free(sums);
+    free_sequence(&seq);
+    return (ret < 0 || nb_diff > 0) ? -1 : 0;
+}
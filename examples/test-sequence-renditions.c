@@ -0,0 +1,123 @@
+/**
+ * @file test-sequence-renditions.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing multiple renditions (1080p, 720p, 480p) written from a single decode pass.
+ * Every rendition must hold as many video frames as the sequence. When no file is given
+ * a synthetic source is generated next to the outputs
+ * usage: bin/examples/test-sequence-renditions out_prefix [file1.mov file2.mov ...]
+ */
+
+#include "OutputContext.h"
+#include "SyntheticMedia.h"
+
+#define NB_RENDITIONS 3
+
+/**
+ * Count the video packets of a file
+ * @param  url filename
+ * @return     number of video frames, < 0 on fail
+ */
+int64_t count_video_frames(char *url) {
+    AVFormatContext *fmt_ctx = NULL;
+    int ret = avformat_open_input(&fmt_ctx, url, NULL, NULL);
+    if(ret < 0) {
+        fprintf(stderr, "Failed to open rendition[%s]\n", url);
+        return ret;
+    }
+    int stream_index = -1;
+    if((ret = avformat_find_stream_info(fmt_ctx, NULL)) >= 0) {
+        ret = stream_index = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    }
+    int64_t nb_frames = 0;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    while(ret >= 0 && (ret = av_read_frame(fmt_ctx, &pkt)) >= 0) {
+        if(pkt.stream_index == stream_index) {
+            ++nb_frames;
+        }
+        av_packet_unref(&pkt);
+    }
+    avformat_close_input(&fmt_ctx);
+    return ret == AVERROR_EOF ? nb_frames : ret;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s out_prefix [file1 file2 ...]\n", argv[0]);
+        return -1;
+    }
+    int heights[NB_RENDITIONS] = {1080, 720, 480};
+    char filename[1024];
+    char *first_url = argv[2];
+    if(argc < 3) {
+        SyntheticParams p;
+        set_synthetic_params_default(&p);
+        snprintf(filename, sizeof(filename), "%s-source.mov", argv[1]);
+        if(generate_synthetic_media(filename, &p) < 0) {
+            return -1;
+        }
+        first_url = filename;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+
+    for(int i = 2; i < argc || i == 2; i++) {
+        char *url = i == 2 ? first_url : argv[i];
+        Clip *clip = alloc_clip(url);
+        if(clip == NULL || open_clip(clip) < 0) {
+            fprintf(stderr, "Failed to open clip[%s]\n", url);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    Clip *clip1 = (Clip *) seq.clips.head->data;
+
+    OutputParameters op_list[NB_RENDITIONS];
+    for(int i = 0; i < NB_RENDITIONS; i++) {
+        VideoOutParams vp;
+        AudioOutParams ap;
+        set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+        vp.codec_id = AV_CODEC_ID_NONE;
+        vp.bit_rate = -1;
+        // keep aspect ratio of the first clip (even width for chroma subsampling)
+        vp.width = (int) av_rescale(heights[i], vp.width, vp.height) & ~1;
+        vp.height = heights[i];
+        set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+        snprintf(filename, sizeof(filename), "%s-%dp.mov", argv[1], heights[i]);
+        if(set_output_params(&(op_list[i]), filename, vp, ap) < 0) {
+            for(int j = 0; j < i; j++) {
+                free_output_params(&(op_list[j]));
+            }
+            free_sequence(&seq);
+            return -1;
+        }
+    }
+
+    printf("Start timing..\n");
+    clock_t t;
+    t = clock();
+
+    int ret = write_sequence(&seq, op_list, NB_RENDITIONS);
+
+    t = clock() - t;
+    double time_taken = ((double)t)/(CLOCKS_PER_SEC/1000);
+    printf("Completed %d renditions in %fms.\n", NB_RENDITIONS, time_taken);
+
+    int failed = 0;
+    int64_t duration = get_sequence_duration(&seq);
+    for(int i = 0; i < NB_RENDITIONS && ret >= 0; i++) {
+        int64_t nb_frames = count_video_frames(op_list[i].filename);
+        printf("rendition[%s]: %ld frames, expected %ld %s\n", op_list[i].filename, nb_frames, duration,
+                nb_frames == duration ? "OK" : "FAIL");
+        if(nb_frames != duration) {
+            ++failed;
+        }
+    }
+    for(int i = 0; i < NB_RENDITIONS; i++) {
+        free_output_params(&(op_list[i]));
+    }
+    free_sequence(&seq);
+    return ret < 0 || failed > 0 ? -1 : 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file test-silence.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the Silence API: silences of the input files are trimmed into a
+ * new sequence, which is written as a draft preview
+ * usage: bin/examples/test-silence out.mov file1.mov [file2.mov ...]
+ */
+
+#include "Silence.h"
+#include "OutputContext.h"
+
+int main(int argc, char **argv) {
+    if(argc < 3) {
+        printf("usage: %s output_file file1 [file2 ...]\n", argv[0]);
+        return -1;
+    }
+    Sequence seq, trimmed;
+    init_sequence(&seq, 30, 48000);
+    init_sequence(&trimmed, 30, 48000);
+    for(int i = 2; i < argc; i++) {
+        Clip *clip = seq_alloc_clip(&seq, argv[i]);
+        if(clip == NULL) {
+            fprintf(stderr, "Failed to open clip[%s]\n", argv[i]);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int nb = trim_sequence_silence(&seq, NULL, &trimmed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    int ret = nb;
+    if(nb < 0) {
+        fprintf(stderr, "Failed to trim silence\n");
+        goto end;
+    }
+    double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    double before = get_sequence_duration(&seq) / seq.fps;
+    double after = get_sequence_duration(&trimmed) / trimmed.fps;
+    printf("removed %d silences: %.1fs -> %.1fs, analysed in %.2fs (%.0fx real time)\n",
+        nb, before, after, secs, secs > 0 ? before / secs : 0);
+
+    if(trimmed.clips.head != NULL) {
+        ret = write_sequence_draft(&trimmed, argv[1], 360, 1);
+        if(ret < 0) {
+            fprintf(stderr, "Failed to write trimmed sequence to output file[%s]\n", argv[1]);
+        }
+    }
+
+    end:
+    // trimmed clips share the VideoContexts of seq (freed with the last clip using them)
+    free_sequence(&trimmed);
+    free_sequence(&seq);
+    return ret < 0 ? -1 : 0;
+}
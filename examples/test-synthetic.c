@@ -0,0 +1,55 @@
+/**
+ * @file test-synthetic.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the SyntheticMedia API: a source with B frames and a long GOP is
+ * generated, then the sequence is seeked to several frames and the frame number embedded
+ * in the first decoded video frame is compared to the seeked frame (frame accurate seeking).
+ * usage: bin/examples/test-synthetic out.mov
+ */
+
+#include "OutputContext.h"
+#include "SyntheticMedia.h"
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s output_file\n", argv[0]);
+        return -1;
+    }
+    SyntheticParams p;
+    set_synthetic_params_default(&p);
+    p.width = 320;
+    p.height = 180;
+    p.gop_size = 30;
+    p.max_b_frames = 2;
+    if(generate_synthetic_media(argv[1], &p) < 0) {
+        return -1;
+    }
+    Sequence seq;
+    init_sequence(&seq, av_q2d(p.fps), p.sample_rate);
+    Clip *clip = seq_alloc_clip(&seq, argv[1]);
+    if(clip == NULL) {
+        fprintf(stderr, "Failed to open clip[%s]\n", argv[1]);
+        free_sequence(&seq);
+        return -1;
+    }
+    sequence_append_clip(&seq, clip);
+
+    int seeks[] = {0, 1, 29, 30, 31, 47, 90, 13, 100};
+    int failed = 0;
+    AVFrame *frame = av_frame_alloc();
+    for(int i = 0; i < (int) (sizeof(seeks) / sizeof(seeks[0])); i++) {
+        enum AVMediaType type = AVMEDIA_TYPE_UNKNOWN;
+        sequence_seek(&seq, seeks[i]);
+        while(sequence_read_frame(&seq, frame, &type, false) >= 0 && type != AVMEDIA_TYPE_VIDEO);
+        int64_t number = type == AVMEDIA_TYPE_VIDEO ? read_frame_number_pattern(frame) : -1;
+        printf("seek %d: frame %ld %s\n", seeks[i], number, number == seeks[i] ? "OK" : "FAIL");
+        if(number != seeks[i]) {
+            ++failed;
+        }
+    }
+    av_frame_free(&frame);
+    free_sequence(&seq);
+    printf("%d seeks failed\n", failed);
+    return failed > 0 ? -1 : 0;
+}
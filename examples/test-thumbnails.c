@@ -0,0 +1,69 @@
+/**
+ * @file test-thumbnails.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the Thumbnail API: a timeline strip of evenly spaced sequence
+ * frames is extracted in parallel and written as JPEG files (out_dir/thumb-0000.jpg, ..)
+ * usage: bin/examples/test-thumbnails out_dir nb_thumbs file1.mov [file2.mov ...]
+ */
+
+#include <sys/stat.h>
+#include <errno.h>
+#include "Thumbnail.h"
+
+int main(int argc, char **argv) {
+    if(argc < 4) {
+        printf("usage: %s out_dir nb_thumbs file1 [file2 ...]\n", argv[0]);
+        return -1;
+    }
+    char *dir = argv[1];
+    int nb = atoi(argv[2]);
+    if(nb <= 0 || (mkdir(dir, 0755) != 0 && errno != EEXIST)) {
+        fprintf(stderr, "Invalid nb_thumbs or failed to create directory[%s]\n", dir);
+        return -1;
+    }
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+    for(int i = 3; i < argc; i++) {
+        Clip *clip = seq_alloc_clip(&seq, argv[i]);
+        if(clip == NULL) {
+            fprintf(stderr, "Failed to open clip[%s]\n", argv[i]);
+            free_sequence(&seq);
+            return -1;
+        }
+        sequence_append_clip(&seq, clip);
+    }
+    int64_t duration = get_sequence_duration(&seq);
+    Thumbnail *thumbs = malloc(sizeof(struct Thumbnail) * nb);
+    if(thumbs == NULL || duration <= 0) {
+        free(thumbs);
+        free_sequence(&seq);
+        return -1;
+    }
+    for(int i = 0; i < nb; i++) {
+        init_thumbnail(&(thumbs[i]));
+        set_sequence_thumbnail(&(thumbs[i]), &seq, (int) (duration * i / nb));
+    }
+    ThumbnailParams params;
+    set_thumbnail_params_default(&params);
+    params.format = THUMBNAIL_JPEG;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int failed = extract_thumbnails(thumbs, nb, &params);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    printf("%d thumbnails in %.1fms (%d failed)\n", nb, ms, failed);
+
+    char filename[1024];
+    for(int i = 0; i < nb; i++) {
+        if(thumbs[i].ret >= 0) {
+            snprintf(filename, sizeof(filename), "%s/thumb-%04d.jpg", dir, i);
+            write_thumbnail_jpeg(&(thumbs[i]), filename);
+        }
+        free_thumbnail(&(thumbs[i]));
+    }
+    free(thumbs);
+    free_sequence(&seq);
+    return failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test-transitions.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing transitions between clips of a sequence: a dissolve and a dip to black.
+ * The sequence is read with cuts and then with transitions to time the cost of mixing,
+ * then written with transitions. With a single input file all clips read the same file
+ * (the incoming side of each transition reads through a clone). Both reads must output
+ * one video frame per sequence frame. When no input is given a synthetic source is
+ * generated next to the output
+ * usage: bin/examples/test-transitions output.mp4 [input.mov [input2.mov]]
+ */
+
+#include "OutputContext.h"
+#include "SyntheticMedia.h"
+
+/**
+ * Read every frame of a sequence
+ * @param  seq Sequence
+ * @param  ms  output time taken in milliseconds
+ * @return     number of video frames read
+ */
+int read_sequence_frames(Sequence *seq, double *ms) {
+    AVFrame *frame = av_frame_alloc();
+    enum AVMediaType type;
+    int nb = 0;
+    struct timespec start, end;
+    sequence_seek(seq, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while(sequence_read_frame(seq, frame, &type, false) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            ++nb;
+        }
+        av_frame_unref(frame);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    av_frame_free(&frame);
+    return nb;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s output [input [input2]]\n", argv[0]);
+        return -1;
+    }
+    char synth_url[1024];
+    char *first = argv[2];
+    if(argc < 3) {
+        // long enough for the last clip (frames 60 to 150 at 30fps)
+        SyntheticParams p;
+        set_synthetic_params_default(&p);
+        p.width = 320;
+        p.height = 180;
+        p.duration = 6;
+        snprintf(synth_url, sizeof(synth_url), "%s-source.mov", argv[1]);
+        if(generate_synthetic_media(synth_url, &p) < 0) {
+            return -1;
+        }
+        first = synth_url;
+    }
+    char *second = argc > 3 ? argv[3] : first;
+    Sequence seq;
+    init_sequence(&seq, 30, 48000);
+
+    Clip *clip1 = alloc_clip(first);
+    if(clip1 == NULL) {
+        fprintf(stderr, "Failed to open [%s]\n", first);
+        return -1;
+    }
+    Clip *clip2 = (second == first) ? copy_clip_vc(clip1) : alloc_clip(second);
+    Clip *clip3 = copy_clip_vc(clip1);
+    if(clip2 == NULL || clip3 == NULL) {
+        fprintf(stderr, "Failed to open clips\n");
+        return -1;
+    }
+    set_clip_bounds(clip1, 0, 90);
+    set_clip_bounds(clip2, 30, 120);
+    set_clip_bounds(clip3, 60, 150);
+    sequence_append_clip(&seq, clip1);
+    sequence_append_clip(&seq, clip2);
+    sequence_append_clip(&seq, clip3);
+
+    double cut_ms, mix_ms;
+    int failed = 0;
+    int nb = read_sequence_frames(&seq, &cut_ms);
+    printf("cuts: %d frames in %.1fms (%ld sequence frames)\n", nb, cut_ms, get_sequence_duration(&seq));
+    if(nb != get_sequence_duration(&seq)) {
+        printf("cuts: wrong number of video frames FAIL\n");
+        ++failed;
+    }
+
+    Transition dissolve = { .type = TRANSITION_DISSOLVE };
+    Transition dip = { .type = TRANSITION_DIP_TO_COLOR, .color = {0, 0, 0} };
+    if(sequence_add_transition(&seq, clip2, &dissolve, 15) < 0 ||
+        sequence_add_transition(&seq, clip3, &dip, 20) < 0) {
+        fprintf(stderr, "Failed to add transitions\n");
+        free_sequence(&seq);
+        return -1;
+    }
+    nb = read_sequence_frames(&seq, &mix_ms);
+    printf("transitions: %d frames in %.1fms (%ld sequence frames, %+.1f%%)\n", nb, mix_ms,
+            get_sequence_duration(&seq), cut_ms > 0 ? (mix_ms - cut_ms) * 100 / cut_ms : 0);
+    if(nb != get_sequence_duration(&seq)) {
+        printf("transitions: wrong number of video frames FAIL\n");
+        ++failed;
+    }
+
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    if(set_output_params(&op, argv[1], vp, ap) < 0) {
+        free_sequence(&seq);
+        return -1;
+    }
+    sequence_seek(&seq, 0);
+    int ret = write_sequence(&seq, &op, 1);
+    printf("write_sequence(): %d\n", ret);
+
+    free_output_params(&op);
+    free_sequence(&seq);
+    return ret < 0 || failed > 0 ? -1 : 0;
+}
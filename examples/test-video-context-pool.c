@@ -0,0 +1,134 @@
+/**
+ * @file test-video-context-pool.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File testing the VideoContextPool API: a clip is split into one range per thread,
+ * and every range is decoded at the same time through a clone of the file. The time is
+ * compared with decoding the whole clip on one thread, along with the cost of opening
+ * a clone compared to opening (and probing) the file
+ * usage: bin/examples/test-video-context-pool file.mov [nb_threads]
+ */
+
+#include "VideoContextPool.h"
+#include "ClipDecode.h"
+#include "ThreadPool.h"
+
+typedef struct RangeJobs {
+    VideoContextPool *pool;
+    Clip *clip;
+    int nb_ranges;
+    int *nb_frames;
+} RangeJobs;
+
+/**
+ * Get elapsed milliseconds since start
+ * @param  start start time
+ * @return       milliseconds
+ */
+double elapsed_ms(struct timespec *start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start->tv_sec) * 1000.0 + (end.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * Count the video frames decoded from a clip
+ * @param  clip Clip seeked to its start
+ * @return      number of video frames
+ */
+int decode_clip_frames(Clip *clip) {
+    AVFrame *frame = av_frame_alloc();
+    enum AVMediaType type;
+    int nb = 0;
+    while(clip_read_frame(clip, frame, &type) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            ++nb;
+        }
+        av_frame_unref(frame);
+    }
+    av_frame_free(&frame);
+    return nb;
+}
+
+/**
+ * ThreadPoolJob decoding one range of the clip through the clone of the thread
+ * @param arg        RangeJobs
+ * @param job_idx    index of range
+ * @param thread_idx index of thread
+ */
+void decode_range(void *arg, int job_idx, int thread_idx) {
+    RangeJobs *jobs = (RangeJobs *) arg;
+    Clip *clip = jobs->clip;
+    int64_t len = clip->orig_end_pts - clip->orig_start_pts;
+    Clip *range = copy_clip_pooled_vc(jobs->pool, clip, thread_idx);
+    if(range == NULL) {
+        jobs->nb_frames[job_idx] = -1;
+        return;
+    }
+    int64_t start = clip->orig_start_pts + len * job_idx / jobs->nb_ranges;
+    int64_t end = clip->orig_start_pts + len * (job_idx + 1) / jobs->nb_ranges;
+    if(set_clip_bounds_pts(range, start, end) < 0 || seek_clip_pts(range, 0) < 0) {
+        jobs->nb_frames[job_idx] = -1;
+    } else {
+        jobs->nb_frames[job_idx] = decode_clip_frames(range);
+    }
+    free_clip(&range);
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("usage: %s file [nb_threads]\n", argv[0]);
+        return -1;
+    }
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Clip *clip = alloc_clip(argv[1]);
+    if(clip == NULL) {
+        fprintf(stderr, "Failed to open clip[%s]\n", argv[1]);
+        return -1;
+    }
+    printf("open: %.2fms\n", elapsed_ms(&start));
+    VideoContext *clone;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(clone_video_context(clip->vid_ctx, &clone) < 0) {
+        fprintf(stderr, "Failed to clone [%s]\n", argv[1]);
+        free_clip(&clip);
+        return -1;
+    }
+    printf("clone: %.2fms\n", elapsed_ms(&start));
+    free_video_context(&clone);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int nb = decode_clip_frames(clip);
+    double serial_ms = elapsed_ms(&start);
+    printf("1 thread: %d frames in %.1fms\n", nb, serial_ms);
+
+    ThreadPool tp;
+    if(init_thread_pool(&tp, argc > 2 ? atoi(argv[2]) : 0) < 0) {
+        free_clip(&clip);
+        return -1;
+    }
+    VideoContextPool pool;
+    init_video_context_pool(&pool, get_thread_pool_size(&tp));
+    RangeJobs jobs = { .pool = &pool, .clip = clip, .nb_ranges = get_thread_pool_size(&tp) };
+    jobs.nb_frames = calloc(jobs.nb_ranges, sizeof(int));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    thread_pool_execute(&tp, &decode_range, &jobs, jobs.nb_ranges);
+    double ms = elapsed_ms(&start);
+    int total = 0, ret = 0;
+    for(int i = 0; i < jobs.nb_ranges; i++) {
+        if(jobs.nb_frames[i] < 0) {
+            fprintf(stderr, "Failed to decode range[%d]\n", i);
+            ret = -1;
+        }
+        total += jobs.nb_frames[i];
+    }
+    printf("%d threads: %d frames in %.1fms (%.2fx)\n", jobs.nb_ranges, total, ms, ms > 0 ? serial_ms / ms : 0);
+
+    free(jobs.nb_frames);
+    free_video_context_pool(&pool);
+    free_thread_pool(&tp);
+    free_clip(&clip);
+    return ret;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file AudioConvert.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for AudioConvert API:
+ * Resampling of decoded audio frames into the output (encoder) format, and
+ * re-chunking of samples into frames of the encoder frame_size.
+ * One SwrContext is cached per source format, and frames that already match
+ * the output format (and frame size) are passed through untouched.
+ */
+
+#ifndef _AUDIO_CONVERT_API_
+#define _AUDIO_CONVERT_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+#include "LinkedListAPI.h"
+#include "Log.h"
+
+/*
+    Cached conversion from one source format into the output format
+ */
+typedef struct AudioConvertCache {
+    /*
+        source format (the cache key)
+     */
+    int sample_rate;
+    enum AVSampleFormat sample_fmt;
+    uint64_t channel_layout;
+    /*
+        true when the source already matches the output format (no resampling)
+     */
+    bool bypass;
+    struct SwrContext *swr_ctx;
+} AudioConvertCache;
+
+typedef struct AudioConverter {
+    /*
+        output format
+     */
+    int sample_rate;
+    enum AVSampleFormat sample_fmt;
+    uint64_t channel_layout;
+    int channels;
+    /*
+        number of samples in each output frame (0 when the encoder accepts any size)
+     */
+    int frame_size;
+    /*
+        time_base of output frame pts (encoder time_base)
+     */
+    AVRational time_base;
+    /*
+        List of AudioConvertCache (one per source format seen)
+     */
+    List cache;
+    /*
+        cache entry used by the last frame. Consecutive frames of a clip skip the list search
+     */
+    AudioConvertCache *last;
+    /*
+        converted samples waiting to be chunked into output frames
+     */
+    AVAudioFifo *fifo;
+    /*
+        buffer holding the output of swr_convert() before it is written into fifo
+     */
+    uint8_t **samples;
+    int samples_size;
+    /*
+        frame passed through untouched (already in output format and frame size)
+     */
+    AVFrame *pass_frame;
+    /*
+        pts of the first output sample, and number of samples output since.
+        Sequence audio is contiguous, so output pts are counted from the first frame
+     */
+    int64_t start_pts, nb_samples_out;
+    /*
+        true when no more frames will be sent, and the remaining samples must be output
+     */
+    bool flushing;
+    bool open;
+} AudioConverter;
+
+/**
+ * Initialize AudioConverter with default values (does not allocate)
+ * @param ac AudioConverter
+ */
+void init_audio_converter(AudioConverter *ac);
+
+/**
+ * Open an AudioConverter for the format of an audio encoder
+ * @param  ac AudioConverter initialized with init_audio_converter()
+ * @param  c  opened audio encoder
+ * @return    >= 0 on success
+ */
+int open_audio_converter(AudioConverter *ac, AVCodecContext *c);
+
+/**
+ * Send a decoded audio frame to the converter.
+ * The frame data is consumed (frame is unreferenced)
+ * @param  ac    AudioConverter
+ * @param  frame decoded audio frame
+ * @return       >= 0 on success
+ */
+int send_audio_convert_frame(AudioConverter *ac, AVFrame *frame);
+
+/**
+ * Receive an audio frame in the output format and frame size
+ * @param  ac    AudioConverter
+ * @param  frame output frame (unreferenced before being filled)
+ * @return       0 when a frame was received,
+ *               AVERROR(EAGAIN) when more frames must be sent,
+ *               AVERROR_EOF when the converter has been fully flushed,
+ *               other < 0 on error
+ */
+int receive_audio_convert_frame(AudioConverter *ac, AVFrame *frame);
+
+/**
+ * Signal that no more frames will be sent. The remaining samples (including
+ * the samples delayed within the resampler) are output by receive_audio_convert_frame()
+ * @param  ac AudioConverter
+ * @return    >= 0 on success
+ */
+int flush_audio_converter(AudioConverter *ac);
+
+/**
+ * Check if a frame needs resampling to match the output format
+ * @param  ac    AudioConverter
+ * @param  frame audio frame
+ * @return       true if frame already matches output format
+ */
+bool audio_frame_matches(AudioConverter *ac, AVFrame *frame);
+
+/**
+ * Free all cached SwrContexts and buffered samples
+ * @param ac AudioConverter
+ */
+void close_audio_converter(AudioConverter *ac);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Get the channel layout of a frame (default layout when the decoder did not set it)
+ * @param  frame audio frame
+ * @return       channel layout
+ */
+uint64_t get_frame_channel_layout(AVFrame *frame);
+
+/**
+ * Find the cache entry for the source format of a frame (allocating it if needed)
+ * @param  ac    AudioConverter
+ * @param  frame source frame
+ * @return       NULL on fail, not NULL on success
+ */
+AudioConvertCache *get_audio_convert_cache(AudioConverter *ac, AVFrame *frame);
+
+/**
+ * Allocate a cache entry and its SwrContext for a source format
+ * @param  ac             AudioConverter
+ * @param  sample_rate    source sample rate
+ * @param  sample_fmt     source sample format
+ * @param  channel_layout source channel layout
+ * @return                NULL on fail, not NULL on success
+ */
+AudioConvertCache *alloc_audio_convert_cache(AudioConverter *ac, int sample_rate,
+                    enum AVSampleFormat sample_fmt, uint64_t channel_layout);
+
+/**
+ * Resample source samples into the fifo
+ * @param  ac         AudioConverter
+ * @param  acc        cache entry of source format
+ * @param  data       source samples (NULL to drain the samples delayed within the resampler)
+ * @param  nb_samples number of source samples
+ * @return            >= 0 on success
+ */
+int write_audio_convert_fifo(AudioConverter *ac, AudioConvertCache *acc,
+                    const uint8_t **data, int nb_samples);
+
+/**
+ * Read samples from the fifo into a new output frame
+ * @param  ac         AudioConverter
+ * @param  frame      output frame
+ * @param  nb_samples number of samples to read
+ * @return            >= 0 on success
+ */
+int read_audio_convert_fifo(AudioConverter *ac, AVFrame *frame, int nb_samples);
+
+/**
+ * Set the pts of an output frame and count its samples
+ * @param ac    AudioConverter
+ * @param frame output frame
+ */
+void set_audio_convert_pts(AudioConverter *ac, AVFrame *frame);
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a cache entry in a string
+ * @param  toBePrinted AudioConvertCache
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_audio_convert_cache(void *toBePrinted);
+
+/**
+ * Free cache entry and its SwrContext
+ * @param toBeDeleted AudioConvertCache allocated on heap
+ */
+void list_delete_audio_convert_cache(void *toBeDeleted);
+
+/**
+ * Compare two cache entries by source format
+ * @param  first  first AudioConvertCache
+ * @param  second second AudioConvertCache
+ * @return        0 if source formats are equal, non zero otherwise
+ */
+int list_compare_audio_convert_cache(const void *first, const void *second);
+
+#endif
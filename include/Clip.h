@@ -10,10 +10,16 @@
 
 #include "VideoContext.h"
 #include "Timebase.h"
+#include "RenderStats.h"
+#include "Transition.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
 
+/* max frames read through between two clips of the same file instead of seeking
+   (see resume_clip_read()) */
+#define CLIP_MAX_READ_FORWARD 30
+
 /**
     Clip stores a reference to a video file and its data within an editing sequence.
     This way, we can access the AVPackets whenever needed, and further decode or
@@ -51,14 +57,33 @@ typedef struct Clip {
     */
     int64_t start_pts, end_pts;
 
+    /*
+        Transition from the clip before this one in the sequence (TRANSITION_NONE for a cut).
+        Set with sequence_add_transition(): the clip then starts before the previous one ends
+    */
+    Transition transition;
+
     /********** INTERNAL ONLY **********/
     // DO NOT USE, YOU WILL BREAK SOME INTERNAL FUNCTIONS (clip_read_packet)
     bool done_reading_video, done_reading_audio;
 
+    /*
+        read_cycle_done: the last read cycle reached the clip end. The seek back to the
+        start is deferred to the next read, so the next clip of the same file can read on.
+        read_ahead_lost: packets past the clip end were dropped in this read cycle
+     */
+    bool read_cycle_done, read_ahead_lost;
+
     /*
         counted by clip_read_frame()
      */
     int64_t frame_index;
+
+    /*
+        time spent demuxing, decoding and seeking this clip
+        (only collected while render stats are enabled, see RenderStats.h)
+     */
+    RenderStats stats;
 } Clip;
 
 /**
@@ -212,12 +237,32 @@ int64_t get_clip_end_frame_idx(Clip* clip);
  */
 bool is_vc_out_bounds(Clip *clip);
 
+/**
+ * Start a read cycle of a clip whose VideoContext was used by another clip.
+ * When the last read cycle on the file ended before this clip, within a cheap distance
+ * (see can_resume_clip_read()), the file is read on without seeking. Otherwise seek_clip_pts(clip, 0)
+ * @param  clip Clip
+ * @return      >= 0 on success
+ */
+int resume_clip_read(Clip *clip);
+
+/**
+ * Check if a clip can be read by reading on from where the last read cycle on its
+ * VideoContext ended: nothing was dropped, the clip starts at or after that point and no key
+ * frame lies in between (a seek would land on it). The clip must start
+ * within CLIP_MAX_READ_FORWARD frames
+ * @param  clip Clip
+ * @return      true to read on, false to seek
+ */
+bool can_resume_clip_read(Clip *clip);
+
 /**
  * Detects if we are done reading the current packet stream..
  * if true.. then the packet in parameter should be skipped over!
  * @param  clip clip
  * @param  pkt  AVPacket currently read
- * @return      true, if our clip has read the entire stream associated with this packet.
+ * @return      true, if our clip has read the entire stream associated with this packet
+ *              (or the packet is not from the clip video or audio stream).
  *              false, otherwise
  */
 bool done_curr_pkt_stream(Clip *clip, AVPacket *pkt);
@@ -243,11 +288,21 @@ int clip_read_packet(Clip *clip, AVPacket *pkt);
 int reset_packet_counter(Clip *clip);
 
 /**
- * Set internal vars used in reading stream data
+ * Set internal vars used in reading stream data and re-enable demuxing
+ * of the clip video and audio streams
  * @param clip Clip
  */
 void init_internal_vars(Clip *clip);
 
+/**
+ * Keep a packet read past the end of a clip for the next clip of the same file.
+ * When too many are kept (streams far apart in the file), they are all dropped and
+ * demuxing of the finished streams stops, as reading on is no longer possible
+ * @param clip Clip
+ * @param pkt  packet past the clip end (moved or unreferenced)
+ */
+void keep_clip_read_ahead(Clip *clip, AVPacket *pkt);
+
 /**
  * Compare two clips based on pts
  * @param  first  First clip to compare
@@ -0,0 +1,125 @@
+/**
+ * @file Composite.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Composite API:
+ * Layering of video frames (alpha over, with the opacity of the layer and its own
+ * alpha channel) and summing of planar float audio. Layers are composited a band of
+ * rows at a time, so the bands of a frame can be split across threads. Row kernels
+ * use SSE2 when available (scalar fallback otherwise). The sequence side (reading the
+ * tracks of a sequence together) is in SequenceDecode.
+ */
+
+#ifndef _COMPOSITE_API_
+#define _COMPOSITE_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/imgutils.h>
+#include "Transition.h"
+
+/* minimum number of rows in a band composited by one thread (smaller frames use fewer bands) */
+#define COMPOSITE_MIN_TILE_H 32
+
+/**
+ * Check if frames of a pixel format can be composited
+ * (same formats as transitions, see transition_pix_fmt_supported())
+ * @param  pix_fmt pixel format
+ * @return         true if supported by composite_layer_rows()
+ */
+bool composite_pix_fmt_supported(enum AVPixelFormat pix_fmt);
+
+/**
+ * Get the pixel format with the same planes as a format plus an alpha plane
+ * (ex: AV_PIX_FMT_YUVA420P for AV_PIX_FMT_YUV420P). Layers with their own alpha
+ * are scaled into it
+ * @param  pix_fmt supported pixel format with one component per plane and no alpha
+ * @return         pixel format with alpha, AV_PIX_FMT_NONE when there is none
+ */
+enum AVPixelFormat get_composite_alpha_format(enum AVPixelFormat pix_fmt);
+
+/**
+ * Make sure a frame has a writable buffer of a format and size
+ * @param  frame   frame to allocate (allocated itself when NULL)
+ * @param  width   width wanted
+ * @param  height  height wanted
+ * @param  pix_fmt pixel format wanted
+ * @return         0 when the buffer was kept, 1 when a new buffer was allocated, < 0 on error
+ */
+int get_composite_buffer(AVFrame **frame, int width, int height, enum AVPixelFormat pix_fmt);
+
+/**
+ * Copy a band of rows from one frame into another (same format and size)
+ * @param dst output frame
+ * @param src source frame
+ * @param y0  first row of band (multiple of the chroma height)
+ * @param y1  end of band (exclusive)
+ */
+void copy_frame_rows(AVFrame *dst, const AVFrame *src, int y0, int y1);
+
+/**
+ * Composite a layer over a band of rows of a frame. The layer has the format of dst,
+ * or the format of dst with an alpha plane (see get_composite_alpha_format()) to be
+ * blended by its own alpha. Parts of the layer outside of dst are ignored
+ * @param dst     frame composited in place (supported pixel format)
+ * @param layer   layer frame
+ * @param x       left of layer in dst (multiple of the chroma width, can be negative)
+ * @param y       top of layer in dst (multiple of the chroma height, can be negative)
+ * @param opacity opacity of the layer (0 to 1)
+ * @param y0      first row of band (multiple of the chroma height)
+ * @param y1      end of band (exclusive)
+ */
+void composite_layer_rows(AVFrame *dst, const AVFrame *layer, int x, int y, double opacity, int y0, int y1);
+
+/**
+ * Sum samples into a frame: dst[dst_offset + i] += src[src_offset + i] * volume (planar float)
+ * @param dst        frame mixed in place (AV_SAMPLE_FMT_FLTP, writable)
+ * @param dst_offset first sample of dst
+ * @param src        samples (AV_SAMPLE_FMT_FLTP, same channels)
+ * @param src_offset first sample of src
+ * @param nb_samples number of samples (within both frames)
+ * @param volume     gain of src
+ */
+void mix_audio_samples(AVFrame *dst, int dst_offset, const AVFrame *src, int src_offset, int nb_samples,
+                        float volume);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Alpha over a row of bytes: dst = dst + (src - dst) * w / 32768,
+ * where w = ((alpha[i * alpha_step] << 8) * k) >> 16
+ * @param dst        row composited in place
+ * @param src        layer row
+ * @param alpha      alpha row of the layer (8 bit, at the resolution of the first plane)
+ * @param n          number of bytes
+ * @param alpha_step alpha values per byte of dst (1 << horizontal chroma shift)
+ * @param k          opacity scale of alpha (see get_composite_alpha_scale())
+ */
+void alpha_over_row_8(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int n, int alpha_step, int k);
+
+/**
+ * Alpha over a row of 16 bit words holding at most 14 bits: dst = dst + (src - dst) * w / 32768,
+ * where w = ((alpha[i * alpha_step] << (16 - depth)) * k) >> 16
+ * @param dst        row composited in place
+ * @param src        layer row
+ * @param alpha      alpha row of the layer (depth bits, at the resolution of the first plane)
+ * @param n          number of words
+ * @param alpha_step alpha values per word of dst (1 << horizontal chroma shift)
+ * @param k          opacity scale of alpha (see get_composite_alpha_scale())
+ * @param depth      bits of alpha
+ */
+void alpha_over_row_16(uint16_t *dst, const uint16_t *src, const uint16_t *alpha, int n, int alpha_step,
+                        int k, int depth);
+
+/**
+ * Get the scale turning alpha values (shifted up to 16 bits) into blend weights in 1/32768,
+ * so an opaque pixel of a layer at full opacity gets the largest weight (32767)
+ * @param  opacity opacity of the layer (0 to 1)
+ * @param  depth   bits of alpha
+ * @return         scale k (0 to 65535)
+ */
+int get_composite_alpha_scale(double opacity, int depth);
+
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file FrameCache.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for FrameCache API:
+ * Memory bounded LRU cache of decoded video frames keyed by (source, pts), with
+ * random access decoding behind it. A request is looked up before any seek or decode.
+ * On a miss, frames are decoded (forward from the decoder position when that is cheaper
+ * than seeking) and every decoded frame is cached. Frames around the last request are
+ * prefetched in the direction of travel, so scrubbing and repeated reads stop re-decoding.
+ * A FrameCache is not thread safe (use one per thread).
+ */
+
+#ifndef _FRAME_CACHE_API_
+#define _FRAME_CACHE_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include "Clip.h"
+
+/* number of hash buckets (power of 2) */
+#define FRAME_CACHE_BUCKETS 4096
+
+/* max frames decoded forward instead of seeking */
+#define FRAME_CACHE_MAX_FORWARD 60
+
+/*
+    Decoded frame in the cache
+ */
+typedef struct FrameCacheEntry {
+    /*
+        key: source file, decoding resolution (VideoContext.lowres) and pts
+     */
+    char *url;
+    int lowres;
+    int64_t pts;
+    uint64_t hash;
+    AVFrame *frame;
+    /*
+        bytes of frame data
+     */
+    int64_t size;
+    /*
+        next entry of the same hash bucket
+     */
+    struct FrameCacheEntry *bucket_next;
+    /*
+        least recently used order (head is the most recently used)
+     */
+    struct FrameCacheEntry *lru_prev, *lru_next;
+} FrameCacheEntry;
+
+typedef struct FrameCache {
+    FrameCacheEntry **buckets;
+    FrameCacheEntry *lru_head, *lru_tail;
+    /*
+        bytes of frame data held, and the limit (least recently used frames are evicted)
+     */
+    int64_t bytes, max_bytes;
+    int nb_frames;
+    /*
+        number of frames cached ahead of (or behind, when moving backwards) each request
+     */
+    int prefetch;
+    /*
+        last request, giving the direction of travel
+     */
+    char *last_url;
+    int64_t last_pts;
+    /*
+        requests found in the cache / decoded
+     */
+    int hits, misses;
+    /*
+        internal use only. decoded frame
+     */
+    AVFrame *decoded;
+} FrameCache;
+
+/**
+ * Initialize a frame cache
+ * @param  fc        FrameCache
+ * @param  max_bytes max bytes of decoded frames held
+ * @param  prefetch  frames cached around each request (0 to disable prefetch)
+ * @return           >= 0 on success
+ */
+int init_frame_cache(FrameCache *fc, int64_t max_bytes, int prefetch);
+
+/**
+ * Get the video frame at pts of a file (the first frame at or after pts),
+ * from the cache or by decoding it
+ * @param  fc    FrameCache
+ * @param  vc    opened VideoContext of the file (its read position is invalidated:
+ *               clips reading it sequentially will seek again)
+ * @param  pts   pts in video time base
+ * @param  frame output frame (reference to the cached frame: do not write into its data)
+ * @return       >= 0 on success
+ */
+int get_cached_video_frame(FrameCache *fc, VideoContext *vc, int64_t pts, AVFrame *frame);
+
+/**
+ * Get a frame of a clip, from the cache or by decoding it
+ * @param  fc          FrameCache
+ * @param  clip        Clip (opened if needed)
+ * @param  frame_index index of frame relative to the start of the clip
+ * @param  frame       output frame (reference to the cached frame: do not write into its data)
+ * @return             >= 0 on success
+ */
+int get_cached_clip_frame(FrameCache *fc, Clip *clip, int64_t frame_index, AVFrame *frame);
+
+/**
+ * Find a frame in the cache (and mark it as most recently used)
+ * @param  fc    FrameCache
+ * @param  vc    VideoContext of the file
+ * @param  pts   pts of frame
+ * @return       cached frame, NULL when missing
+ */
+AVFrame *find_cached_frame(FrameCache *fc, VideoContext *vc, int64_t pts);
+
+/**
+ * Add a decoded frame to the cache (a reference is kept). Least recently used
+ * frames are evicted to stay within max_bytes
+ * @param  fc    FrameCache
+ * @param  vc    VideoContext that decoded the frame
+ * @param  frame decoded frame (frame->pts is the key)
+ * @return       >= 0 on success
+ */
+int add_cached_frame(FrameCache *fc, VideoContext *vc, AVFrame *frame);
+
+/**
+ * Remove every frame from the cache
+ * @param fc FrameCache
+ */
+void clear_frame_cache(FrameCache *fc);
+
+/**
+ * Free the frames and data of a frame cache
+ * @param fc FrameCache
+ */
+void free_frame_cache(FrameCache *fc);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Hash of a cache key
+ * @param  url    source file
+ * @param  lowres decoding resolution
+ * @param  pts    pts of frame
+ * @return        hash
+ */
+uint64_t hash_frame_cache_key(char *url, int lowres, int64_t pts);
+
+/**
+ * Find an entry without changing the LRU order
+ * @param  fc     FrameCache
+ * @param  url    source file
+ * @param  lowres decoding resolution
+ * @param  pts    pts of frame
+ * @return        entry, NULL when missing
+ */
+FrameCacheEntry *find_frame_cache_entry(FrameCache *fc, char *url, int lowres, int64_t pts);
+
+/**
+ * Move an entry to the head of the LRU order
+ * @param fc    FrameCache
+ * @param entry entry in the cache
+ */
+void touch_frame_cache_entry(FrameCache *fc, FrameCacheEntry *entry);
+
+/**
+ * Remove an entry from the cache and free it
+ * @param fc    FrameCache
+ * @param entry entry in the cache
+ */
+void remove_frame_cache_entry(FrameCache *fc, FrameCacheEntry *entry);
+
+/**
+ * Get bytes of data held by a frame
+ * @param  frame AVFrame
+ * @return       size of all buffers of the frame
+ */
+int64_t get_frame_data_size(AVFrame *frame);
+
+/**
+ * Decode video frames from pts up to end_pts (inclusive) into the cache. Decodes forward
+ * from the decoder position when that is cheaper than seeking
+ * @param  fc      FrameCache
+ * @param  vc      opened VideoContext
+ * @param  pts     first frame wanted
+ * @param  end_pts last frame wanted
+ * @param  frame   output: first frame at or after pts (NULL when not wanted)
+ * @return         >= 0 on success
+ */
+int decode_cached_frames(FrameCache *fc, VideoContext *vc, int64_t pts, int64_t end_pts, AVFrame *frame);
+
+/**
+ * Cache the frames around a request in the direction of travel
+ * @param  fc  FrameCache
+ * @param  vc  opened VideoContext
+ * @param  pts pts of the request
+ * @return     >= 0 on success
+ */
+int prefetch_cached_frames(FrameCache *fc, VideoContext *vc, int64_t pts);
+
+/**
+ * Get duration of one video frame
+ * @param  vc opened VideoContext
+ * @return    frame duration in video time base (> 0)
+ */
+int64_t get_cached_frame_duration(VideoContext *vc);
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file Log.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Log API:
+ * Leveled logging with a runtime threshold, a compile time minimum level and an
+ * optional callback sink. Messages below LOG_MIN_LEVEL are removed at compile time
+ * (arguments are never evaluated), so trace logging costs nothing in release builds.
+ * Build with -DLOG_MIN_LEVEL=LOG_LEVEL_INFO (make LOG_MIN_LEVEL=LOG_LEVEL_INFO) to remove
+ * trace and debug messages.
+ */
+
+#ifndef _LOG_API_
+#define _LOG_API_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+enum LogLevel {
+    LOG_LEVEL_TRACE = 0,    // every packet or frame (hot paths)
+    LOG_LEVEL_DEBUG,        // opening/closing files, clip changes, converter setup
+    LOG_LEVEL_INFO,         // progress of a render
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_QUIET         // threshold that disables every message
+};
+
+/* messages below this level are compiled out */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#endif
+
+/* runtime threshold used until set_log_level() is called */
+#define LOG_DEFAULT_LEVEL LOG_LEVEL_INFO
+
+/* maximum length of a message passed to a log callback (longer messages are truncated) */
+#define LOG_MAX_MESSAGE 1024
+
+/*
+    true if messages of level are compiled in and above the runtime threshold.
+    Use this to skip work only needed by a log message
+ */
+#define log_enabled(level) ((level) >= LOG_MIN_LEVEL && log_level_enabled(level))
+
+#define LOG_AT(level, ...) do {                 \
+        if(log_enabled(level)) {                \
+            log_message(level, __VA_ARGS__);    \
+        }                                       \
+    } while(0)
+
+#define log_trace(...)      LOG_AT(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define log_debug(...)      LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define log_info(...)       LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define log_warning(...)    LOG_AT(LOG_LEVEL_WARNING, __VA_ARGS__)
+#define log_error(...)      LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+/*
+    Log callback (sink). Receives every formatted message at or above the runtime
+    threshold (including its trailing newline). May be called from several threads
+ */
+typedef void (*LogCallback)(enum LogLevel level, const char *message, void *opaque);
+
+/**
+ * Set the runtime threshold: messages below level are ignored
+ * @param level LogLevel (LOG_LEVEL_QUIET to disable logging)
+ */
+void set_log_level(enum LogLevel level);
+
+/**
+ * Get the runtime threshold
+ * @return LogLevel
+ */
+enum LogLevel get_log_level();
+
+/**
+ * Check if messages of a level pass the runtime threshold
+ * @param  level LogLevel
+ * @return       true if messages of level are written
+ */
+bool log_level_enabled(enum LogLevel level);
+
+/**
+ * Route log messages into a callback instead of stdout/stderr
+ * @param callback  LogCallback (NULL to restore stdout/stderr)
+ * @param opaque    user data passed to every call of callback
+ */
+void set_log_callback(LogCallback callback, void *opaque);
+
+/**
+ * Write a log message (use the log_*() macros so disabled levels are never formatted).
+ * Without a callback, warnings and errors go to stderr and everything else to stdout
+ * @param level   LogLevel of message
+ * @param format  printf format
+ * @param VARARGS printf arguments
+ */
+void log_message(enum LogLevel level, const char *format, ...);
+
+/**
+ * Get the name of a log level
+ * @param  level LogLevel
+ * @return       name of level
+ */
+const char *get_log_level_name(enum LogLevel level);
+
+#endif
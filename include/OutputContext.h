@@ -66,6 +66,14 @@ int set_audio_codec_params(OutputContext *oc, AudioOutParams *op);
  */
 int set_muxer_params(OutputContext *oc, OutputStream *os, AVCodecContext *c);
 
+/**
+ * Open the encoder of an OutputStream and copy its parameters to the muxer
+ * @param  oc OutputContext
+ * @param  os OutputStream (video or audio) within OutputContext
+ * @return    >= 0 on success
+ */
+int open_codec(OutputContext *oc, OutputStream *os);
+
 /**
  * Open format and file for video output
  * @param  oc           OutputContext
@@ -76,13 +84,120 @@ int set_muxer_params(OutputContext *oc, OutputStream *os, AVCodecContext *c);
 int open_video_output(OutputContext *oc, OutputParameters *op, Sequence *seq);
 
 /**
- * Open output file, write sequence frames and close the output file!
+ * Get the muxer name of a segmented output
+ * @param  op   OutputParameters
+ * @return      name of muxer, NULL to deduce muxer from filename
+ */
+char *get_segment_format_name(OutputParameters *op);
+
+/**
+ * Get the muxer options of a segmented output
+ * @param  op   OutputParameters
+ * @return      options to be freed with av_dict_free() (NULL when not segmented)
+ */
+AVDictionary *get_segment_muxer_options(OutputParameters *op);
+
+/**
+ * Allocate the format context of each additional muxer target
+ * @param  oc   OutputContext
+ * @param  op   OutputParameters containing mux_filenames
+ * @return      >= 0 on success
+ */
+int alloc_output_muxers(OutputContext *oc, OutputParameters *op);
+
+/**
+ * Check if every muxer target of the output wants stream headers to be separate.
+ * When only some targets do, encoders keep their headers in the bitstream:
+ * containers without global headers (mpegts, hls..) need them in band to be decodable
+ * @param  oc   OutputContext
+ * @return      true if encoders must use AV_CODEC_FLAG_GLOBAL_HEADER
+ */
+bool output_needs_global_header(OutputContext *oc);
+
+/**
+ * Create the streams of each additional muxer from the opened encoders,
+ * open the files and write headers
+ * @param  oc   OutputContext with opened codecs
+ * @return      >= 0 on success
+ */
+int open_output_muxers(OutputContext *oc);
+
+/**
+ * Add a stream to a muxer with the parameters of an opened encoder
+ * @param  fmt_ctx  muxer
+ * @param  c        opened encoder
+ * @return          NULL on fail, not NULL on success
+ */
+AVStream *add_muxer_stream(AVFormatContext *fmt_ctx, AVCodecContext *c);
+
+/**
+ * Write an encoded packet to the output file and every additional muxer target
+ * @param  oc   OutputContext
+ * @param  pkt  encoded packet with timestamps in the time_base of its oc->fmt_ctx stream
+ *              (packet is unreferenced)
+ * @return      >= 0 on success
+ */
+int output_write_packet(OutputContext *oc, AVPacket *pkt);
+
+/**
+ * Open output files, write sequence frames and close the output files!
  * (this is an end to end solution)
- * @param  seq      Sequence containing clips to write to file
- * @param  op       OutputParameters for video and audio codec/muxers (and filename)
- * @return          >= 0 on success
+ * When more than one output is given, the sequence is decoded once and every
+ * decoded frame is encoded into all outputs (ex: 1080p, 720p and 480p renditions)
+ * @param  seq          Sequence containing clips to write to file
+ * @param  op_list      array of OutputParameters for video and audio codec/muxers (and filename)
+ * @param  nb_outputs   number of OutputParameters in op_list
+ * @return              >= 0 on success
  */
-int write_sequence(Sequence *seq, OutputParameters *op);
+int write_sequence(Sequence *seq, OutputParameters *op_list, int nb_outputs);
+
+/**
+ * Write a draft preview of a sequence (end to end solution tuned for time to preview).
+ * Video is decoded at reduced resolution where the codec supports it, and encoded
+ * with the fastest preset at low resolution. Audio keeps the format of the first
+ * clip, so matching clips skip resampling. The decoding options of every clip are restored after
+ * @param  seq          Sequence containing clips to write to file
+ * @param  filename     name of output file
+ * @param  height       height of preview (width keeps aspect ratio of first clip)
+ * @param  frame_step   encode every frame_step'th video frame (1 to keep every frame)
+ * @return              >= 0 on success
+ */
+int write_sequence_draft(Sequence *seq, char *filename, int height, int frame_step);
+
+/**
+ * Start collecting render stats if requested by output parameters (set_output_stats()).
+ * Clears the stats of every clip and enables render stats
+ * @param  seq  Sequence about to be written
+ * @param  op   OutputParameters of (first) output
+ * @return      start time of render, 0 when stats were not requested
+ */
+int64_t start_render_stats(Sequence *seq, OutputParameters *op);
+
+/**
+ * Finish a render started with start_render_stats(): fill op->stats with the totals
+ * of all clips and outputs, and write the JSON report to op->stats_filename
+ * @param  seq          Sequence that was written
+ * @param  oc_list      array of OutputContexts written (closed, stats are still valid)
+ * @param  op_list      array of OutputParameters (stats requested in first output)
+ * @param  nb_outputs   number of outputs
+ * @param  start_ns     return from start_render_stats()
+ * @return              >= 0 on success
+ */
+int finish_render_stats(Sequence *seq, OutputContext *oc_list, OutputParameters *op_list, int nb_outputs, int64_t start_ns);
+
+/**
+ * Write a JSON report of a render: wall time, totals, stats of every clip and every output
+ * @param  filename     name of report file
+ * @param  seq          Sequence that was written
+ * @param  oc_list      array of OutputContexts written
+ * @param  op_list      array of OutputParameters
+ * @param  nb_outputs   number of outputs
+ * @param  total        totals of all clips and outputs
+ * @param  wall_ns      wall time of the render in nanoseconds
+ * @return              >= 0 on success
+ */
+int write_render_report(char *filename, Sequence *seq, OutputContext *oc_list, OutputParameters *op_list,
+                        int nb_outputs, RenderStats *total, int64_t wall_ns);
 
 /**
  * Write entire sequence to an output file
@@ -92,6 +207,95 @@ int write_sequence(Sequence *seq, OutputParameters *op);
  */
 int write_sequence_frames(OutputContext *oc, Sequence *seq);
 
+/**
+ * Open every output, write sequence frames into all of them from a single
+ * decode pass and close the outputs
+ * @param  seq          Sequence containing clips to write to file
+ * @param  op_list      array of OutputParameters (one per rendition)
+ * @param  nb_outputs   number of OutputParameters in op_list
+ * @return              >= 0 on success
+ */
+int write_sequence_renditions(Sequence *seq, OutputParameters *op_list, int nb_outputs);
+
+/**
+ * Decode entire sequence once and encode every frame into each output.
+ * Outputs are encoded from largest to smallest, and each video frame is scaled
+ * from the nearest larger rendition instead of the decoded frame
+ * @param  oc_list      array of opened OutputContexts
+ * @param  nb_outputs   number of OutputContexts in oc_list
+ * @param  seq          Sequence containing clips
+ * @return              >= 0 on success
+ */
+int write_sequence_frames_renditions(OutputContext *oc_list, int nb_outputs, Sequence *seq);
+
+/**
+ * Get the order in which outputs are encoded (largest video size first)
+ * @param  oc_list      array of opened OutputContexts
+ * @param  nb_outputs   number of OutputContexts in oc_list
+ * @return              array of indexes into oc_list (to be freed by caller), NULL on fail
+ */
+int *get_rendition_order(OutputContext *oc_list, int nb_outputs);
+
+/**
+ * Get number of pixels in the video frames of an output
+ * @param  oc   OutputContext
+ * @return      width * height of output video frames
+ */
+int64_t get_rendition_area(OutputContext *oc);
+
+/**
+ * Get the frame a rendition is scaled from: the frame of the nearest larger
+ * rendition that was already encoded, or the decoded frame if there is none
+ * @param  oc_list  array of OutputContexts
+ * @param  order    encoding order from get_rendition_order()
+ * @param  i        index into order of rendition
+ * @param  decoded  decoded video frame
+ * @return          source video frame
+ */
+AVFrame *get_rendition_source(OutputContext *oc_list, int *order, int i, AVFrame *decoded);
+
+/**
+ * Convert a decoded frame into the output format, encode it and write
+ * all packets available from the encoder
+ * @param  oc       OutputContext
+ * @param  frame    decoded frame (not modified, the output keeps its own reference)
+ * @param  type     type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return          >= 0 on success
+ */
+int output_encode_frame(OutputContext *oc, AVFrame *frame, enum AVMediaType type);
+
+/**
+ * Encode every audio frame ready in the audio converter
+ * @param  oc   OutputContext
+ * @return      >= 0 on success
+ */
+int output_send_audio_frames(OutputContext *oc);
+
+/**
+ * Send a frame to an encoder and write all packets available from it
+ * @param  oc       OutputContext
+ * @param  os       OutputStream (video or audio) within OutputContext
+ * @param  frame    frame in encoder format, NULL to flush the encoder
+ * @return          >= 0 on success
+ */
+int output_send_frame(OutputContext *oc, OutputStream *os, AVFrame *frame);
+
+/**
+ * Write all packets available from an encoder into the output file
+ * @param  oc       OutputContext
+ * @param  os       OutputStream (video or audio) within OutputContext
+ * @return          >= 0 on success
+ */
+int output_write_packets(OutputContext *oc, OutputStream *os);
+
+/**
+ * Encode the remaining audio samples, flush both encoders and write
+ * the remaining packets
+ * @param  oc   OutputContext
+ * @return      >= 0 on success
+ */
+int output_flush_encoders(OutputContext *oc);
+
  /**
   * Set OutputParameters given Video and Audio OutputParameters
   * @param op        OutputParameters to set filename, video and audio params
@@ -102,6 +306,44 @@ int write_sequence_frames(OutputContext *oc, Sequence *seq);
   */
  int set_output_params(OutputParameters *op, char *filename, VideoOutParams vp, AudioOutParams ap);
 
+ /**
+  * Add a file written with the same encoded packets as the main output file
+  * (encode once, mux to multiple containers. ex: out.mp4, out.mov and out.ts)
+  * @param  op       OutputParameters already set with set_output_params()
+  * @param  filename name of additional output file (container deduced from extension)
+  * @return          >= 0 on success
+  */
+ int add_output_mux_target(OutputParameters *op, char *filename);
+
+ /**
+  * Tune output for time to preview: fastest encoder preset and
+  * optionally a lower frame rate
+  * @param  op           OutputParameters already set with set_output_params()
+  * @param  frame_step   encode every frame_step'th video frame (1 to keep every frame)
+  * @return              >= 0 on success
+  */
+ int set_output_draft(OutputParameters *op, int frame_step);
+
+ /**
+  * Collect render stats (time and count of demux, decode, seek, encode and mux) during write_sequence()
+  * @param  op               OutputParameters already set with set_output_params()
+  * @param  stats            filled with the totals of the render (can be NULL)
+  * @param  report_filename  JSON report written after the render (can be NULL)
+  * @return                  >= 0 on success
+  */
+ int set_output_stats(OutputParameters *op, RenderStats *stats, char *report_filename);
+
+ /**
+  * Write output as segments (HLS or fragmented MP4) instead of one monolithic file,
+  * so segments can be consumed while the sequence is still rendering
+  * @param  op       OutputParameters already set with set_output_params()
+  *                  (filename is the playlist .m3u8 for HLS)
+  * @param  type     segmented output mode
+  * @param  duration duration of each segment in seconds
+  * @return          >= 0 on success
+  */
+ int set_output_segments(OutputParameters *op, enum OutputSegmentType type, double duration);
+
  /**
   * Copy relevant codec context params (from decoder) into VideoOutParams struct (for encoding)
   * This can copy clip decoder settings to the encoder context
@@ -137,4 +379,11 @@ int write_sequence_frames(OutputContext *oc, Sequence *seq);
   */
  int close_video_output(OutputContext *out_ctx, bool trailer_flag);
 
+ /**
+  * Write trailers, close files and free every additional muxer target
+  * @param oc            OutputContext
+  * @param trailer_flag  when true, trailers will attempt to be written
+  */
+ void close_output_muxers(OutputContext *oc, bool trailer_flag);
+
 #endif
\ No newline at end of file
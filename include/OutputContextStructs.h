@@ -13,6 +13,9 @@
 #include <libavformat/avformat.h>
 #include <libavutil/timestamp.h>
 #include <libavcodec/avcodec.h>
+#include "VideoConvert.h"
+#include "AudioConvert.h"
+#include "RenderStats.h"
 
 #include <libavutil/opt.h>
 
@@ -43,6 +46,12 @@ typedef struct VideoOutParams {
         used to get time_base of 1/fps.
      */
     int fps;
+
+    /*
+        number of threads used to scale/convert decoded frames into the
+        encoder format (0 for one thread per cpu core)
+     */
+    int scale_threads;
 } VideoOutParams;
 
 typedef struct AudioOutParams {
@@ -83,10 +92,46 @@ typedef struct AudioOutParams {
     uint64_t channel_layout;
 } AudioOutParams;
 
+/*
+    Segmented output modes (set with set_output_segments())
+ */
+enum OutputSegmentType {
+    OUTPUT_SEGMENT_NONE = 0,        // one monolithic file
+    OUTPUT_SEGMENT_HLS,             // HLS playlist (.m3u8) with MPEG-TS segments
+    OUTPUT_SEGMENT_HLS_FMP4,        // HLS playlist (.m3u8) with fragmented MP4 (CMAF) segments
+    OUTPUT_SEGMENT_FRAGMENTED_MP4   // single fragmented MP4, one fragment per segment
+};
+
 typedef struct OutputParameters {
     VideoOutParams video;
     AudioOutParams audio;
     char *filename;
+    /*
+        additional files written with the same encoded packets as filename
+        (ex: out.mov, out.ts). Added with add_output_mux_target()
+     */
+    char **mux_filenames;
+    int nb_mux_filenames;
+    /*
+        segmented output mode, and duration of each segment in seconds.
+        Segments start on a key frame, and the playlist (or fragment index)
+        is written as each segment finishes
+     */
+    enum OutputSegmentType segment_type;
+    double segment_duration;
+    /*
+        draft preview: fastest encoder preset, and only every draft_frame_step'th
+        video frame is encoded (1 to keep every frame). Set with set_output_draft()
+     */
+    bool draft;
+    int draft_frame_step;
+    /*
+        render stats: when stats is not NULL it is filled with the totals of the render,
+        and when stats_filename is not NULL a JSON report is written to it after the render.
+        Set with set_output_stats()
+     */
+    RenderStats *stats;
+    char *stats_filename;
 } OutputParameters;
 
 
@@ -99,11 +144,55 @@ typedef struct OutputStream {
     bool flushing, done_flush;
 } OutputStream;
 
+/*
+    Additional muxer target sharing the encoders of an OutputContext
+ */
+typedef struct OutputMuxer {
+    AVFormatContext *fmt_ctx;
+    AVStream *video_stream, *audio_stream;
+} OutputMuxer;
+
 typedef struct OutputContext {
     AVFormatContext *fmt_ctx;
     OutputStream video, audio;
     AVFrame *buffer_frame;
     enum AVMediaType last_encoder_frame_type;
+    /*
+        true when buffer_frame was refused by the encoder (EAGAIN)
+        and must be sent again after the encoder is drained
+     */
+    bool frame_pending;
+    /*
+        converts decoded video frames into the encoder size and pixel format
+        (frames already in that format pass through untouched)
+     */
+    VideoConverter video_convert;
+    /*
+        resamples decoded audio frames into the encoder format and frame_size
+        (frames already in that format and size pass through untouched)
+     */
+    AudioConverter audio_convert;
+    /*
+        additional muxer targets. Every packet written to fmt_ctx is also
+        written to each of these (rescaled to their stream time_base)
+     */
+    OutputMuxer *muxers;
+    int nb_muxers;
+    /*
+        duration of segments and pts of the next segment boundary
+        (video codec time_base). segment_duration_pts is 0 when output is not segmented
+     */
+    int64_t segment_duration_pts, next_segment_pts;
+    /*
+        only every frame_step'th video frame is encoded (draft preview).
+        frame_count counts video frames read from the sequence
+     */
+    int frame_step;
+    int64_t frame_count;
+    /*
+        time spent encoding and muxing (only collected while render stats are enabled)
+     */
+    RenderStats stats;
 } OutputContext;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,283 @@
+/**
+ * @file Proxy.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Proxy API:
+ * Proxies are low resolution, intra-only (or short GOP) copies of source files
+ * with timestamps identical to the original. They are transcoded in the background,
+ * mapped to the VideoContext of the original, and a Sequence can switch between
+ * proxies (previews, analysis) and originals (final render) at any time.
+ */
+
+#ifndef _PROXY_API_
+#define _PROXY_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/dict.h>
+#include "Sequence.h"
+#include "VideoConvert.h"
+
+/* extension appended to proxy filenames */
+#define PROXY_EXTENSION ".proxy.mov"
+
+/* metadata key of the ProxyParams a proxy was made with */
+#define PROXY_PARAMS_TAG "comment"
+
+/* size of the string written by get_proxy_params_tag() */
+#define PROXY_PARAMS_TAG_SIZE 128
+
+typedef struct ProxyParams {
+    /*
+        height of proxy video (width keeps aspect ratio).
+        Sources smaller than this keep their size
+     */
+    int height;
+    /*
+        video codec of proxies (audio is copied as it is)
+     */
+    enum AVCodecID codec_id;
+    /*
+        distance between key frames. 1 for intra-only proxies (fastest seeking)
+     */
+    int gop_size;
+    int64_t bit_rate;
+    /*
+        directory where proxies are written (NULL for the directory of the original)
+     */
+    char *dir;
+} ProxyParams;
+
+/*
+    Mapping from an original file to its proxy
+ */
+typedef struct Proxy {
+    /*
+        every VideoContext reading the original file (separate allocations and clones),
+        all mapped to the proxy when it is ready. Not used by the thread
+     */
+    VideoContext **vid_ctxs;
+    int nb_vid_ctxs;
+    /*
+        filename of original and proxy
+     */
+    char *orig_url, *url;
+    ProxyParams params;
+    /*
+        background transcode
+     */
+    pthread_t thread;
+    bool running;
+    /*
+        result of transcode (>= 0 when proxy is ready)
+     */
+    int ret;
+} Proxy;
+
+typedef struct ProxyManager {
+    /*
+        List of Proxy (one per original file)
+     */
+    List proxies;
+    ProxyParams params;
+} ProxyManager;
+
+/*
+    Output of a proxy transcode (internal use only)
+ */
+typedef struct ProxyOutput {
+    AVFormatContext *fmt_ctx;
+    AVCodecContext *codec_ctx;
+    AVStream *video_stream, *audio_stream;
+    VideoConverter convert;
+    AVFrame *frame;
+} ProxyOutput;
+
+/**
+ * Set default proxy parameters (360p, intra-only MJPEG next to the original)
+ * @param params ProxyParams
+ */
+void set_proxy_params_default(ProxyParams *params);
+
+/**
+ * Initialize ProxyManager
+ * @param  pm     ProxyManager
+ * @param  params parameters of all proxies (copied, dir is not)
+ * @return        >= 0 on success
+ */
+int init_proxy_manager(ProxyManager *pm, ProxyParams *params);
+
+/**
+ * Start creating proxies in the background for every file used in a sequence and its tracks
+ * (files which already have a proxy are not transcoded again, their clips are added to it)
+ * @param  pm  ProxyManager
+ * @param  seq Sequence
+ * @return     >= 0 on success
+ */
+int sequence_create_proxies(ProxyManager *pm, Sequence *seq);
+
+/**
+ * Start creating a proxy in the background for the file of a VideoContext.
+ * A proxy on disk newer than the original, made with the same parameters, is reused
+ * @param  pm      ProxyManager
+ * @param  vid_ctx VideoContext of original file
+ * @return         >= 0 on success
+ */
+int create_proxy(ProxyManager *pm, VideoContext *vid_ctx);
+
+/**
+ * Wait for all background proxies to finish, and map each finished proxy
+ * to every VideoContext of its original
+ * @param  pm ProxyManager
+ * @return    >= 0 when all proxies are ready (files without proxy keep using originals)
+ */
+int wait_proxies(ProxyManager *pm);
+
+/**
+ * Find the proxy of an original file
+ * @param  pm       ProxyManager
+ * @param  orig_url filename of original
+ * @return          NULL if not found
+ */
+Proxy *find_proxy(ProxyManager *pm, char *orig_url);
+
+/**
+ * Switch every clip of a sequence (and its tracks) between proxies and originals.
+ * Clips without a proxy keep reading originals.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq       Sequence
+ * @param  use_proxy true to read proxies, false to read originals
+ * @return           >= 0 on success
+ */
+int sequence_use_proxies(Sequence *seq, bool use_proxy);
+
+/**
+ * Wait for proxies and free ProxyManager (proxy files are kept on disk)
+ * @param pm ProxyManager
+ */
+void free_proxy_manager(ProxyManager *pm);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Add a VideoContext of the original file to a proxy (each context is added once).
+ * The context is mapped to the proxy right away when it is already ready
+ * @param  p       Proxy
+ * @param  vid_ctx VideoContext of original file
+ * @return         >= 0 on success
+ */
+int add_proxy_video_context(Proxy *p, VideoContext *vid_ctx);
+
+/**
+ * Get the filename of the proxy of a file
+ * @param  orig_url filename of original
+ * @param  dir      directory of proxy (NULL for directory of original)
+ * @return          filename allocated on heap, to be freed by caller
+ */
+char *get_proxy_url(char *orig_url, char *dir);
+
+/**
+ * Check if a proxy on disk is newer than its original and was made with the
+ * parameters of the Proxy (size, codec, gop size and bit rate)
+ * @param  p Proxy
+ * @return   true if proxy can be reused
+ */
+bool proxy_up_to_date(Proxy *p);
+
+/**
+ * Get the string identifying the parameters of a proxy (stored in the proxy metadata)
+ * @param params ProxyParams
+ * @param buf    output string of PROXY_PARAMS_TAG_SIZE bytes
+ */
+void get_proxy_params_tag(ProxyParams *params, char *buf);
+
+/**
+ * Check if the metadata of a proxy file matches the parameters of a Proxy
+ * @param  p Proxy
+ * @return   true if the proxy file was made with the same parameters
+ */
+bool proxy_params_match(Proxy *p);
+
+/**
+ * Thread creating a proxy
+ * @param  arg Proxy
+ * @return     NULL
+ */
+void *proxy_thread(void *arg);
+
+/**
+ * Transcode the original file into its proxy (video is scaled and re-encoded,
+ * audio is copied). Timestamps and time bases are identical to the original
+ * @param  p Proxy
+ * @return   >= 0 on success
+ */
+int transcode_proxy(Proxy *p);
+
+/**
+ * Open proxy file, video encoder and muxer with the time bases of the original
+ * @param  p   Proxy
+ * @param  in  opened VideoContext of original
+ * @param  out ProxyOutput to open
+ * @return     >= 0 on success
+ */
+int open_proxy_output(Proxy *p, VideoContext *in, ProxyOutput *out);
+
+/**
+ * Allocate and open the proxy video encoder
+ * @param  p   Proxy
+ * @param  in  opened VideoContext of original
+ * @param  out ProxyOutput with allocated format context
+ * @return     >= 0 on success
+ */
+int open_proxy_encoder(Proxy *p, VideoContext *in, ProxyOutput *out);
+
+/**
+ * Decode a video packet of the original, then scale and encode every frame it gives
+ * @param  in  VideoContext of original
+ * @param  out ProxyOutput
+ * @param  pkt video packet (NULL to flush decoder)
+ * @return     >= 0 on success
+ */
+int proxy_decode_packet(VideoContext *in, ProxyOutput *out, AVPacket *pkt);
+
+/**
+ * Send a frame to the proxy encoder and write every packet available
+ * @param  out   ProxyOutput
+ * @param  frame frame in encoder format (NULL to flush encoder)
+ * @return       >= 0 on success
+ */
+int proxy_encode_frame(ProxyOutput *out, AVFrame *frame);
+
+/**
+ * Close proxy file and free ProxyOutput
+ * @param out ProxyOutput
+ */
+void close_proxy_output(ProxyOutput *out);
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a proxy in a string
+ * @param  toBePrinted Proxy
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_proxy(void *toBePrinted);
+
+/**
+ * Wait for proxy thread and free Proxy
+ * @param toBeDeleted Proxy allocated on heap
+ */
+void list_delete_proxy(void *toBeDeleted);
+
+/**
+ * Compare two proxies by original filename
+ * @param  first  first Proxy
+ * @param  second second Proxy
+ * @return        0 if original filenames are equal
+ */
+int list_compare_proxy(const void *first, const void *second);
+
+#endif
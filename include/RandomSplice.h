@@ -8,6 +8,7 @@
 #include <stdlib.h>
 
 #include "OutputContext.h"
+#include "SceneDetect.h"
 
 #define PICK_FRAMES_RECUR_LIMIT 50
 
@@ -44,6 +45,12 @@ typedef struct RandSpliceParams {
         variability of average cuts
      */
     int cut_len_var;
+    /*
+        shot boundaries of the original sequence (NULL to cut anywhere).
+        Cut points move to a shot boundary within snap_dist frames
+     */
+    SceneList *scenes;
+    int snap_dist;
 
     /*************** INTERNAL ONLY ***************/
     int pick_frames_recur;
@@ -0,0 +1,186 @@
+/**
+ * @file RenderCache.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for RenderCache API:
+ * Incremental rendering. Each clip of a sequence is encoded into its own independently
+ * decodable segment (starting on a key frame), saved in a cache directory under a key
+ * hashed from the source file, clip bounds and output parameters. A re-render only
+ * encodes clips whose key changed, and stream copies every other segment into the output.
+ * Segment audio is stored as PCM and encoded once over the whole output.
+ */
+
+#ifndef _RENDER_CACHE_API_
+#define _RENDER_CACHE_API_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/stat.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include "OutputContext.h"
+
+/* extension of cached segments (nut keeps the time base of the encoder) */
+#define RENDER_CACHE_EXTENSION ".nut"
+
+typedef struct RenderCache {
+    /*
+        directory where segments are stored
+     */
+    char *dir;
+    /*
+        segments reused / encoded by the last write_sequence_cached()
+     */
+    int hits, misses;
+} RenderCache;
+
+/**
+ * Initialize a render cache (the directory must already exist)
+ * @param  rc  RenderCache
+ * @param  dir directory where encoded segments are stored
+ * @return     >= 0 on success
+ */
+int init_render_cache(RenderCache *rc, char *dir);
+
+/**
+ * Write a sequence to file, reusing the cached segment of every clip that has not changed
+ * since the last render. Changed (or new) clips are encoded into the cache first, then
+ * the video of all segments is stream copied into the output at the position of their clip,
+ * and their audio is encoded once (a single encoder delay for the whole output).
+ * Segmented output, draft mode, additional mux targets, transitions and tracks are not supported here
+ * @param  seq Sequence containing clips to write to file
+ * @param  op  OutputParameters of output file
+ * @param  rc  RenderCache
+ * @return     >= 0 on success
+ */
+int write_sequence_cached(Sequence *seq, OutputParameters *op, RenderCache *rc);
+
+/**
+ * Free data within render cache (files on disk are kept)
+ * @param rc RenderCache
+ */
+void free_render_cache(RenderCache *rc);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Hash bytes into a 64 bit FNV-1a hash
+ * @param  hash previous hash (RENDER_CACHE_HASH_INIT to start a new hash)
+ * @param  data bytes to hash
+ * @param  size number of bytes
+ * @return      new hash
+ */
+uint64_t render_cache_hash(uint64_t hash, const void *data, size_t size);
+
+/* FNV-1a 64 bit offset basis */
+#define RENDER_CACHE_HASH_INIT 0xcbf29ce484222325ULL
+
+/**
+ * Resolve codecs left as AV_CODEC_ID_NONE to the default codecs of the output format,
+ * so the cached segments are encoded with the codecs the final output expects
+ * @param  op OutputParameters (codec ids are updated)
+ * @return    >= 0 on success
+ */
+int resolve_render_cache_codecs(OutputParameters *op);
+
+/**
+ * Get the cache key of a clip: source identity (url, size, modification time),
+ * clip bounds (orig_start_pts, orig_end_pts), sequence time bases and output parameters
+ * @param  seq Sequence containing clip
+ * @param  clip Clip
+ * @param  op  OutputParameters with resolved codecs
+ * @return     cache key
+ */
+uint64_t get_clip_cache_key(Sequence *seq, Clip *clip, OutputParameters *op);
+
+/**
+ * Get the filename of a cached segment
+ * @param  rc  RenderCache
+ * @param  key cache key
+ * @return     allocated filename (free after use) or NULL on fail
+ */
+char *get_render_cache_url(RenderCache *rc, uint64_t key);
+
+/**
+ * Encode a single clip into a cached segment. The segment starts at pts 0 and is written
+ * to a temporary file first, so an interrupted render never leaves a partial segment
+ * @param  seq  Sequence containing clip (fps and sample rate are copied)
+ * @param  clip Clip to encode
+ * @param  op   OutputParameters with resolved codecs
+ * @param  url  filename of segment
+ * @return      >= 0 on success
+ */
+int render_clip_segment(Sequence *seq, Clip *clip, OutputParameters *op, char *url);
+
+/**
+ * Get the audio parameters of cached segments: the output sample format, rate and layout
+ * stored as PCM. Audio is encoded once over the whole render (from these samples),
+ * so the priming and padding of lossy encoders never lands at a segment boundary
+ * @param ap AudioOutParams of output (updated to the segment parameters)
+ */
+void set_render_cache_segment_audio(AudioOutParams *ap);
+
+/**
+ * Open the output file: the video stream is copied from the parameters of the first
+ * segment, the audio stream is encoded with the audio parameters of the output
+ * @param  oc      OutputContext to open
+ * @param  op      OutputParameters with resolved codecs
+ * @param  seq     Sequence (audio time base of the encoder)
+ * @param  seg_url filename of the first segment
+ * @return         >= 0 on success
+ */
+int open_render_cache_output(OutputContext *oc, OutputParameters *op, Sequence *seq, char *seg_url);
+
+/**
+ * Write a cached segment into the output at the start of its clip in the sequence.
+ * Video packets are stream copied with one constant offset per segment (the first
+ * packet lands on the start of the clip), so presentation order and the decode delay of
+ * the encoder are kept. Audio is decoded and sent to the output audio encoder
+ * @param  oc             opened OutputContext (open_render_cache_output())
+ * @param  seq            Sequence containing clip
+ * @param  clip           Clip of segment
+ * @param  seg_url        filename of segment
+ * @param  last_video_dts last video dts written to output (updated)
+ * @return                >= 0 on success
+ */
+int copy_clip_segment(OutputContext *oc, Sequence *seq, Clip *clip, char *seg_url, int64_t *last_video_dts);
+
+/**
+ * Get the constant timestamp offset of a segment stream: the first packet is moved to
+ * the start of its clip, then later if needed so its dts follows the last dts written
+ * @param  pkt      first packet of the stream in segment
+ * @param  start    start of the clip in the time base of pkt
+ * @param  last_dts last dts written to the output stream (AV_NOPTS_VALUE if none)
+ * @return          offset to add to every timestamp of the stream in segment
+ */
+int64_t get_segment_offset(AVPacket *pkt, int64_t start, int64_t last_dts);
+
+/**
+ * Open a decoder for the audio stream of a segment
+ * @param  stream    audio stream of segment
+ * @param  time_base time base of the packets sent to the decoder
+ * @param  dec       output decoder context
+ * @return           >= 0 on success
+ */
+int open_segment_audio_decoder(AVStream *stream, AVRational time_base, AVCodecContext **dec);
+
+/**
+ * Decode a packet of segment audio and send the samples to the output audio encoder
+ * @param  oc     OutputContext with opened audio encoder
+ * @param  dec    segment audio decoder
+ * @param  pkt    packet with timestamps in the time base of the encoder (NULL to flush decoder)
+ * @param  frame  frame to receive decoded samples
+ * @param  offset offset of segment audio in sequence
+ * @return        >= 0 on success
+ */
+int encode_segment_audio(OutputContext *oc, AVCodecContext *dec, AVPacket *pkt, AVFrame *frame, int64_t offset);
+
+/**
+ * Encode the samples remaining in the output audio converter and flush the audio encoder
+ * @param  oc OutputContext opened with open_render_cache_output()
+ * @return    >= 0 on success
+ */
+int flush_render_cache_audio(OutputContext *oc);
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file RenderStats.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for RenderStats API:
+ * Low overhead timers and counters around each stage of a render (demux, decode,
+ * seek, encode, mux), aggregated per stream. Clips and OutputContexts each own
+ * a RenderStats, and timing is only taken while render stats are enabled.
+ */
+
+#ifndef _RENDER_STATS_API_
+#define _RENDER_STATS_API_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <libavutil/avutil.h>
+
+/*
+    Stages of a render
+ */
+enum RenderStage {
+    RENDER_STAGE_DEMUX = 0,     // clip_read_packet() (count = packets)
+    RENDER_STAGE_DECODE,        // decoder send/receive (count = frames)
+    RENDER_STAGE_PREROLL,       // frames decoded before the seek position and skipped (count = frames)
+    RENDER_STAGE_SEEK,          // open_clip() and seek_clip_pts() (count = seeks)
+    RENDER_STAGE_ENCODE,        // encoder send/receive (count = packets)
+    RENDER_STAGE_MUX,           // av_interleaved_write_frame() (count = packets)
+    RENDER_STAGE_NB
+};
+
+/*
+    Streams of a render (RENDER_STATS_OTHER is used by stages without a stream, like seeking)
+ */
+enum RenderStatsStream {
+    RENDER_STATS_VIDEO = 0,
+    RENDER_STATS_AUDIO,
+    RENDER_STATS_OTHER,
+    RENDER_STATS_NB_STREAMS
+};
+
+typedef struct StageStats {
+    int64_t count;
+    int64_t time_ns;
+} StageStats;
+
+typedef struct RenderStats {
+    StageStats stages[RENDER_STATS_NB_STREAMS][RENDER_STAGE_NB];
+} RenderStats;
+
+/**
+ * Initialize (clear) render stats
+ * @param rs RenderStats
+ */
+void init_render_stats(RenderStats *rs);
+
+/**
+ * Enable or disable timing of all render stages (disabled by default)
+ * @param enabled true to collect render stats
+ */
+void set_render_stats_enabled(bool enabled);
+
+/**
+ * Get whether render stats are collected
+ * @return true if enabled
+ */
+bool get_render_stats_enabled();
+
+/**
+ * Get monotonic time in nanoseconds
+ * @return nanoseconds
+ */
+int64_t render_stats_now();
+
+/**
+ * Start timing a stage
+ * @return start time to pass to render_stats_add(), 0 when render stats are disabled
+ */
+int64_t render_stats_start();
+
+/**
+ * Stop timing a stage and add it to render stats
+ * @param rs        RenderStats
+ * @param type      AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO (anything else is RENDER_STATS_OTHER)
+ * @param stage     RenderStage
+ * @param start_ns  return from render_stats_start() (nothing is added when 0)
+ * @param count     items completed by this call (packets, frames or seeks)
+ */
+void render_stats_add(RenderStats *rs, enum AVMediaType type, enum RenderStage stage, int64_t start_ns, int count);
+
+/**
+ * Add all stages of src into dst
+ * @param dst RenderStats
+ * @param src RenderStats
+ */
+void merge_render_stats(RenderStats *dst, RenderStats *src);
+
+/**
+ * Get stats of a stage summed over all streams
+ * @param  rs    RenderStats
+ * @param  stage RenderStage
+ * @return       StageStats of stage
+ */
+StageStats get_render_stage_total(RenderStats *rs, enum RenderStage stage);
+
+/**
+ * Get the name of a stage (used in reports)
+ * @param  stage RenderStage
+ * @return       name of stage
+ */
+const char *get_render_stage_name(enum RenderStage stage);
+
+/**
+ * Write render stats as a JSON object: {"video": {"demux": {"count": n, "ms": t}, ..}, ..}
+ * @param f  file to write
+ * @param rs RenderStats
+ */
+void write_render_stats_json(FILE *f, RenderStats *rs);
+
+/**
+ * Write a string as a quoted JSON string
+ * @param f   file to write
+ * @param str string to escape
+ */
+void write_json_string(FILE *f, const char *str);
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file ReverseDecode.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for ReverseDecode API:
+ * Reading the video frames of a clip or sequence backwards. Frames are decoded in segments
+ * (one GOP, from its key frame to the next key frame) forward once, buffered in a bounded
+ * pool and output in reverse. While a segment is output, the previous one is decoded on a
+ * worker thread into a second pool, so reverse reading runs at close to forward decode speed
+ * instead of decoding from the key frame again for every frame.
+ */
+
+#ifndef _REVERSE_DECODE_API_
+#define _REVERSE_DECODE_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include "SequenceDecode.h"
+
+/* frames buffered per segment when no limit is given (GOPs longer than this are split) */
+#define REVERSE_DEFAULT_MAX_FRAMES 120
+
+/*
+    Frames of one segment, in decode (forward) order
+ */
+typedef struct ReverseSegment {
+    /*
+        pool of max_frames frames (allocated once and reused), nb of them hold data
+     */
+    AVFrame **frames;
+    int nb;
+    /*
+        clip the segment was read from, and its range of pts in video time base
+        of the clip's file (end exclusive)
+     */
+    Clip *clip;
+    int64_t start_pts, end_pts;
+    /*
+        result of decoding the segment (AVERROR_EOF when no segments were left)
+     */
+    int ret;
+} ReverseSegment;
+
+typedef struct ReverseReader {
+    /*
+        sequence read backwards (NULL when reading a single clip)
+     */
+    Sequence *seq;
+    bool close_clips;
+    /*
+        max frames held by each segment
+     */
+    int max_frames;
+    /*
+        segment being output (segs[cur]) and the next frame output from it (counting down).
+        The other segment is decoded while this one is output
+     */
+    ReverseSegment segs[2];
+    int cur, pos;
+    bool eof;
+    /*
+        next segment to decode: its clip (NULL when the start is reached), the list node
+        of that clip (sequences only), and the end of the segment (exclusive).
+        Only used by the thread decoding
+     */
+    Clip *next_clip;
+    Node *next_node;
+    int64_t next_end_pts;
+    /*
+        decoded frame (only used by the thread decoding)
+     */
+    AVFrame *decoded;
+    /*
+        worker thread decoding the previous segment (prefetch)
+     */
+    bool threaded;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    /*
+        segment given to the worker (NULL when it has none), and when it must stop
+     */
+    ReverseSegment *job;
+    bool exit;
+} ReverseReader;
+
+/**
+ * Initialize a reader of the video frames of a clip, from its last frame to its first
+ * @param  rr         ReverseReader
+ * @param  clip       Clip (opened if needed). It must not be read by anything else until the
+ *                    reader is freed, then seek_clip_pts() before reading it forward again
+ * @param  max_frames max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES).
+ *                    Two segments are held at once
+ * @param  prefetch   decode the previous segment on a worker thread
+ * @return            >= 0 on success
+ */
+int init_clip_reverse_reader(ReverseReader *rr, Clip *clip, int max_frames, bool prefetch);
+
+/**
+ * Initialize a reader of the video frames of a sequence, from its last frame to its first
+ * @param  rr          ReverseReader
+ * @param  seq         Sequence. It must not be read by anything else until the reader is freed,
+ *                     then sequence_seek() before reading it forward again
+ * @param  max_frames  max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES)
+ * @param  prefetch    decode the previous segment on a worker thread
+ * @param  close_clips if true, close each clip when done reading it (as sequence_read_frame())
+ * @return             >= 0 on success
+ */
+int init_sequence_reverse_reader(ReverseReader *rr, Sequence *seq, int max_frames, bool prefetch, bool close_clips);
+
+/**
+ * Read the previous video frame
+ * @param  rr    ReverseReader
+ * @param  frame output frame, with the pts it has when read forward (file pts for clips,
+ *               sequence pts for sequences)
+ * @return       >= 0 on success, AVERROR_EOF after the first frame, < 0 on error
+ */
+int reverse_read_frame(ReverseReader *rr, AVFrame *frame);
+
+/**
+ * Stop the worker thread and free the frames of a reader
+ * @param rr ReverseReader
+ */
+void free_reverse_reader(ReverseReader *rr);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Allocate segment pools and start the worker thread (the first segment is given to it)
+ * @param  rr         ReverseReader with seq, close_clips, next_clip, next_node and next_end_pts set
+ * @param  max_frames max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES)
+ * @param  prefetch   start the worker thread
+ * @return            >= 0 on success
+ */
+int init_reverse_reader(ReverseReader *rr, int max_frames, bool prefetch);
+
+/**
+ * Decode the segment before the last one decoded (moving on to the previous clip
+ * of the sequence when the start of a clip is reached)
+ * @param  rr  ReverseReader
+ * @param  seg output segment (its frames are unreferenced first)
+ * @return     >= 0 on success, AVERROR_EOF when there are no segments left
+ */
+int decode_next_reverse_segment(ReverseReader *rr, ReverseSegment *seg);
+
+/**
+ * Decode the frames of seg->clip within [seg->start_pts, seg->end_pts) into the segment.
+ * When more than max_frames are found, the earliest are dropped and start_pts is raised
+ * @param  rr  ReverseReader
+ * @param  seg segment with clip and range set
+ * @return     >= 0 on success
+ */
+int decode_reverse_segment(ReverseReader *rr, ReverseSegment *seg);
+
+/**
+ * Give a segment to the worker thread to decode
+ * @param rr  ReverseReader
+ * @param seg segment to decode (not in use)
+ */
+void start_reverse_job(ReverseReader *rr, ReverseSegment *seg);
+
+/**
+ * Wait for the worker thread to finish its segment
+ * @param  rr ReverseReader
+ * @return    result of decoding the segment
+ */
+int wait_reverse_job(ReverseReader *rr);
+
+/**
+ * Worker thread main loop. Decodes each segment it is given
+ * @param  arg ReverseReader
+ * @return     NULL
+ */
+void *reverse_reader_thread(void *arg);
+
+#endif
@@ -0,0 +1,262 @@
+/**
+ * @file SceneDetect.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for SceneDetect API:
+ * Analysis pass over a clip or sequence finding shot boundaries (cut candidates).
+ * Every frame is reduced to a downscaled luma plane (8x8 block averages) and a luma
+ * histogram, then compared with the previous frame (mean absolute difference and
+ * histogram difference). The kernels use SSE2 when available, with a scalar fallback.
+ * Edit generators can snap their cuts to the detected shot boundaries.
+ */
+
+#ifndef _SCENE_DETECT_API_
+#define _SCENE_DETECT_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include "Sequence.h"
+#include "ClipDecode.h"
+#include "VideoConvert.h"
+
+/* width and height of the blocks averaged into one pixel of the downscaled luma plane */
+#define SCENE_BLOCK_SIZE 8
+
+/* number of bins in luma histograms (and bits dropped from a luma value to find its bin) */
+#define SCENE_HIST_BINS 64
+#define SCENE_HIST_SHIFT 2
+
+/* max number of previous scores averaged by the adaptive threshold */
+#define SCENE_MAX_WINDOW 64
+
+typedef struct SceneParams {
+    /*
+        minimum score (0 to 1) of a shot boundary
+     */
+    double threshold;
+    /*
+        a shot boundary must also score this many times the average of the previous
+        window frames (camera motion raises every score, a cut raises a single one)
+     */
+    double adaptive_ratio;
+    int window;
+    /*
+        minimum number of frames in a shot
+     */
+    int min_scene_len;
+    /*
+        decoding speed options of each VideoContext (see set_video_decode_options())
+     */
+    int lowres;
+    bool fast_decode;
+} SceneParams;
+
+typedef struct SceneList {
+    /*
+        frame indices of shot boundaries (first frame of each new shot), in increasing order
+     */
+    int64_t *cuts;
+    int nb_cuts, cuts_size;
+    /*
+        score (0 to 1) of every frame against the frame before it (0 for frames not analysed)
+     */
+    float *scores;
+    int64_t nb_scores, scores_size;
+} SceneList;
+
+/*
+    Analysis state carried from frame to frame (internal use only)
+ */
+typedef struct SceneDetector {
+    SceneParams params;
+    /*
+        downscaled luma planes and histograms of the current and previous frames
+     */
+    uint8_t *planes[2];
+    uint32_t hist[2][SCENE_HIST_BINS];
+    int width, height;
+    int curr;
+    bool has_prev;
+    /*
+        scores of the last frames (ring buffer used by the adaptive threshold)
+     */
+    float window[SCENE_MAX_WINDOW];
+    int window_nb, window_pos;
+    int64_t last_cut;
+    /*
+        converts frames without an 8 bit luma plane into downscaled GRAY8
+     */
+    VideoConverter convert;
+} SceneDetector;
+
+/**
+ * Set default scene detection parameters
+ * @param params SceneParams
+ */
+void set_scene_params_default(SceneParams *params);
+
+/**
+ * Initialize an empty scene list
+ * @param list SceneList
+ */
+void init_scene_list(SceneList *list);
+
+/**
+ * Find the shot boundaries of a clip. Frame indices are relative to the start of the clip
+ * @param  clip   Clip to analyse (the clip is seeked back to its start when done)
+ * @param  params SceneParams (NULL for defaults)
+ * @param  list   SceneList initialized with init_scene_list() (results are added)
+ * @return        >= 0 on success
+ */
+int detect_clip_scenes(Clip *clip, SceneParams *params, SceneList *list);
+
+/**
+ * Find the shot boundaries of a sequence. Frame indices are sequence frame indices
+ * @param  seq    Sequence to analyse (sequence is seeked back to its start when done)
+ * @param  params SceneParams (NULL for defaults)
+ * @param  list   SceneList initialized with init_scene_list() (results are added)
+ * @return        >= 0 on success
+ */
+int detect_sequence_scenes(Sequence *seq, SceneParams *params, SceneList *list);
+
+/**
+ * Snap a frame index to the closest shot boundary
+ * @param  list        SceneList
+ * @param  frame_index frame index to snap
+ * @param  max_dist    max distance (in frames) of the shot boundary
+ * @return             closest shot boundary within max_dist, else frame_index
+ */
+int64_t snap_to_scene_cut(SceneList *list, int64_t frame_index, int max_dist);
+
+/**
+ * Remove a range of frames from a scene list (shot boundaries and scores after
+ * the range move back). Keeps the list in sync with sequence_ripple_delete_clip()
+ * @param list  SceneList
+ * @param start first frame removed
+ * @param end   end of removed frames (exclusive)
+ */
+void scene_list_ripple_delete(SceneList *list, int64_t start, int64_t end);
+
+/**
+ * Free the cuts and scores of a scene list
+ * @param list SceneList
+ */
+void free_scene_list(SceneList *list);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Initialize the analysis state
+ * @param sd     SceneDetector
+ * @param params SceneParams (NULL for defaults)
+ */
+void init_scene_detector(SceneDetector *sd, SceneParams *params);
+
+/**
+ * Free the planes and converter of the analysis state
+ * @param sd SceneDetector
+ */
+void free_scene_detector(SceneDetector *sd);
+
+/**
+ * Decode every video frame of a clip and analyse it. The decoding options of
+ * the analysis are set by the caller, once for the whole pass (set_scene_decode_options())
+ * @param  sd   SceneDetector
+ * @param  clip Clip
+ * @param  seq  Sequence of the clip (frames get sequence indices), NULL for clip indices
+ * @param  list SceneList to add results
+ * @return      >= 0 on success
+ */
+int detect_scenes_internal(SceneDetector *sd, Clip *clip, Sequence *seq, SceneList *list);
+
+/**
+ * Change the decoding options of a clip VideoContext (reopened when it was open)
+ * @param  clip        Clip
+ * @param  lowres      decode at 1/(2^lowres) resolution
+ * @param  fast_decode non spec compliant speedups
+ * @return             >= 0 on success
+ */
+int set_scene_decode_options(Clip *clip, int lowres, bool fast_decode);
+
+/**
+ * Score a decoded frame against the previous frame, and add a shot boundary when
+ * the score passes both thresholds
+ * @param  sd          SceneDetector
+ * @param  frame       decoded video frame (may be replaced by a converted frame)
+ * @param  frame_index index of the frame
+ * @param  list        SceneList to add results
+ * @return             >= 0 on success
+ */
+int analyse_scene_frame(SceneDetector *sd, AVFrame *frame, int64_t frame_index, SceneList *list);
+
+/**
+ * Downscale the luma of a frame into the current plane of the detector
+ * (reallocates the planes when the size changes)
+ * @param  sd    SceneDetector
+ * @param  frame decoded video frame
+ * @return       >= 0 on success
+ */
+int load_scene_plane(SceneDetector *sd, AVFrame *frame);
+
+/**
+ * Check if the first plane of a pixel format holds 8 bit luma, one byte per pixel
+ * @param  pix_fmt pixel format
+ * @return         true when the luma plane can be read directly
+ */
+bool scene_luma_plane(enum AVPixelFormat pix_fmt);
+
+/**
+ * Average SCENE_BLOCK_SIZE x SCENE_BLOCK_SIZE blocks of a luma plane
+ * @param src      luma plane
+ * @param linesize bytes per row of src
+ * @param width    width of dst (blocks per row)
+ * @param height   height of dst (rows of blocks)
+ * @param dst      downscaled plane (width * height bytes)
+ */
+void scene_downscale(const uint8_t *src, int linesize, int width, int height, uint8_t *dst);
+
+/**
+ * Sum of absolute differences between two planes
+ * @param  a first plane
+ * @param  b second plane
+ * @param  n number of pixels
+ * @return   sum of |a[i] - b[i]|
+ */
+uint64_t scene_sad(const uint8_t *a, const uint8_t *b, int n);
+
+/**
+ * Luma histogram of a plane (SCENE_HIST_BINS bins)
+ * @param plane downscaled plane
+ * @param n     number of pixels
+ * @param hist  output histogram
+ */
+void scene_histogram(const uint8_t *plane, int n, uint32_t *hist);
+
+/**
+ * Sum of absolute differences between two histograms
+ * @param  a first histogram
+ * @param  b second histogram
+ * @return   sum of |a[i] - b[i]|
+ */
+uint64_t scene_histogram_diff(const uint32_t *a, const uint32_t *b);
+
+/**
+ * Set the score of a frame (grows the scores array)
+ * @param  list        SceneList
+ * @param  frame_index index of frame
+ * @param  score       score of frame
+ * @return             >= 0 on success
+ */
+int set_scene_score(SceneList *list, int64_t frame_index, float score);
+
+/**
+ * Add a shot boundary at the end of the list
+ * @param  list        SceneList
+ * @param  frame_index first frame of the new shot
+ * @return             >= 0 on success
+ */
+int add_scene_cut(SceneList *list, int64_t frame_index);
+
+#endif
@@ -11,10 +11,142 @@
 
 #define SEQ_VIDEO_FRAME_DURATION 1000
 
+/* max video frames of the incoming clip of a transition decoded ahead of the outgoing clip */
+#define SEQ_TRANSITION_MAX_FRAMES 32
+
+/* max video frames of a track decoded ahead of the sequence */
+#define SEQ_TRACK_MAX_FRAMES 32
+
+/* max audio frames of a track decoded ahead of the sequence */
+#define SEQ_TRACK_MAX_AUDIO_FRAMES 256
+
+#include <libavutil/audio_fifo.h>
+#include <libswscale/swscale.h>
+#include <libswresample/swresample.h>
 #include "Clip.h"
 #include "LinkedListAPI.h"
+#include "ThreadPool.h"
 #include "Util.h"
 
+/*
+    Position of a clip in the sequence, as held by the clip index (see build_sequence_index())
+ */
+typedef struct SequenceIndexEntry {
+    int64_t start_pts, end_pts;
+    Node *node;
+} SequenceIndexEntry;
+
+/*
+    Transition being read by sequence_read_frame(): while the outgoing clip is read, the
+    incoming clip is decoded alongside it, and its frames are mixed into the outgoing frames
+ */
+typedef struct SequenceTransition {
+    /*
+        list node of the incoming clip (NULL when no transition is being read)
+     */
+    Node *node;
+    /*
+        clip decoding the incoming side: the incoming clip itself, or a copy reading through
+        a clone of the file when both clips read the same file (own_clip)
+     */
+    Clip *clip;
+    bool own_clip;
+    /*
+        overlap of the two clips in sequence video and audio time base (end exclusive)
+     */
+    int64_t start_pts, end_pts;
+    int64_t audio_start_pts, audio_end_pts;
+    /*
+        the incoming clip has no more frames
+     */
+    bool eof;
+    /*
+        video frames of the incoming clip decoded ahead, in pts order
+     */
+    AVFrame *frames[SEQ_TRANSITION_MAX_FRAMES];
+    int nb_frames;
+    /*
+        audio samples of the incoming clip decoded ahead (in the format it was decoded),
+        and the pts of the first one in sequence audio time base
+     */
+    AVAudioFifo *fifo;
+    enum AVSampleFormat sample_fmt;
+    int sample_rate, channels;
+    uint64_t channel_layout;
+    int64_t fifo_pts;
+    /*
+        pts of the last video frame and end of the last audio frame output during the
+        transition (frames of the incoming clip before them are not output after it)
+     */
+    int64_t video_out_pts, audio_out_pts;
+    /*
+        frame read from the incoming clip, blended output frame (reused when not referenced),
+        frame of the dip color, incoming frame scaled into the outgoing format and incoming
+        samples taken from fifo
+     */
+    AVFrame *decoded, *mix, *color, *scaled, *samples;
+    struct SwsContext *sws_ctx;
+} SequenceTransition;
+
+/*
+    Compositing of the tracks of a sequence by sequence_read_frame(): for each frame of the
+    sequence clips, the tracks are decoded up to it in parallel, then their video is layered
+    over the frame (bands of rows in parallel) and their audio is summed into it
+ */
+typedef struct SequenceCompositor {
+    /*
+        threads decoding tracks and compositing bands of rows (started with the first read)
+     */
+    ThreadPool pool;
+    bool pool_open;
+    /*
+        tracks were seeked to the position of the sequence (cleared by sequence_seek())
+     */
+    bool started;
+    /*
+        format audio is mixed in: planar float at the sequence sample rate,
+        with the channel layout of the clip read when the tracks started
+     */
+    uint64_t channel_layout;
+    int channels;
+    /*
+        the clip of the sequence being read has audio the tracks can be mixed into
+        (audio of the tracks is not queued otherwise)
+     */
+    bool mix_audio;
+    /*
+        tracks of the current job (one job per track, or the layers of the composite job)
+     */
+    struct SequenceTrack **job_tracks;
+    int nb_job_tracks;
+    /*
+        position tracks are decoded up to: video pts, and audio frame (sequence time base)
+     */
+    int64_t job_pts, job_audio_pts, job_audio_end;
+    /*
+        format and size frames are composited in (the format of the sequence frame when supported)
+     */
+    int job_width, job_height;
+    enum AVPixelFormat job_format;
+    /*
+        source and output frames and height of the bands of the composite job
+     */
+    AVFrame *job_src, *job_dst;
+    int job_tile_h;
+    /*
+        composited frame (reused when not referenced), frame of the sequence converted into
+        a format that can be composited, audio of the sequence converted into the mix format
+     */
+    AVFrame *mix, *base, *audio;
+    struct SwsContext *sws_ctx;
+    /*
+        converts audio of the sequence into the mix format (source format it was opened for)
+     */
+    struct SwrContext *swr_ctx;
+    enum AVSampleFormat swr_fmt;
+    uint64_t swr_layout;
+} SequenceCompositor;
+
 /**
  * Define the Sequence structure.
  * A Sequence is a list of clips in a realtime video editor
@@ -53,8 +185,104 @@ typedef struct Sequence {
         Current clip index
      */
     int current_clip_idx;
+
+    /*
+        Clips sorted by start_pts, for binary search of the clip at a frame.
+        Rebuilt on the next lookup after the clips of the sequence change
+     */
+    SequenceIndexEntry *index;
+    int index_nb, index_size;
+    bool index_dirty;
+
+    /*
+        Transition being read (see sequence_read_frame())
+     */
+    SequenceTransition transition;
+
+    /*
+        Tracks layered over the clips of the sequence, bottom to top (see sequence_add_track())
+     */
+    struct SequenceTrack **tracks;
+    int nb_tracks;
+
+    /*
+        Compositing of the tracks (see sequence_read_frame())
+     */
+    SequenceCompositor compositor;
 } Sequence;
 
+/*
+    Track layered over the clips of a sequence (see sequence_add_track()).
+    Clips are added to the sequence of the track with the Sequence API
+    (ex: sequence_add_clip_pts(&(track->seq), clip, pts)), and can overlap any clip of
+    another track. The clips of the sequence set its duration: tracks are read
+    while there is a clip of the sequence (parts of tracks over gaps are not output).
+    Clips reading a file also read by the sequence or a track below (ex: copy_clip_vc())
+    are switched onto a clone of it when the tracks start
+ */
+typedef struct SequenceTrack {
+    /*
+        clips of the track (same fps and sample rate as the sequence)
+     */
+    Sequence seq;
+    /*
+        video of the track is layered over the sequence, audio is mixed into the sequence
+     */
+    bool video, audio;
+    /*
+        position and size of the video within frames of the sequence in pixels
+        (width and height of 0 fill the frame), and its opacity (0 to 1)
+     */
+    int x, y, width, height;
+    double opacity;
+    /*
+        gain of the audio
+     */
+    double volume;
+    /*
+        the track has no more frames
+     */
+    bool eof;
+    /*
+        video frames decoded ahead in pts order, and the end of the clip
+        that decoded each (sequence pts, where a frame stops being shown)
+     */
+    AVFrame *frames[SEQ_TRACK_MAX_FRAMES];
+    int64_t frames_end_pts[SEQ_TRACK_MAX_FRAMES];
+    int nb_frames;
+    /*
+        audio frames decoded ahead in pts order, converted into the mix format
+     */
+    AVFrame **audio_frames;
+    int nb_audio_frames, audio_frames_size;
+    /*
+        pts of the last video frame read from the track (sequence pts), bounds reading
+        ahead for audio over clips without audio
+     */
+    int64_t read_pts;
+    /*
+        frame read from the track, and its video scaled to the size of the layer in the format
+        composited (with an alpha plane when the track has alpha), with its position.
+        layer_pts is the pts of the frame the layer was scaled from
+     */
+    AVFrame *decoded, *layer;
+    bool layer_ready;
+    int64_t layer_pts;
+    int layer_x, layer_y;
+    struct SwsContext *sws_ctx;
+    /*
+        converts audio of the track into the mix format (format it was opened for)
+     */
+    struct SwrContext *swr_ctx;
+    enum AVSampleFormat swr_fmt;
+    uint64_t swr_layout, swr_out_layout;
+    int swr_rate;
+    /*
+        return of the last job run on the track
+     */
+    int ret;
+} SequenceTrack;
+
 /**
  * Initialize new sequence and list of clips
  * @param  sequence     Sequence is assumed to already be allocated memory
@@ -157,6 +385,74 @@ int shift_clips_after(Sequence *seq, Node *curr_node);
  */
 int sequence_ripple_delete_clip(Sequence *seq, Clip *clip);
 
+/**
+ * Add a transition from the previous clip into a clip. The clip and all following clips
+ * move back by the duration of the transition, so the two clips overlap for that long
+ * (the sequence gets shorter). Any transition already on the clip is replaced
+ * @param  seq        Sequence
+ * @param  clip       Clip within sequence (not the first)
+ * @param  transition type (and color) of transition
+ * @param  nb_frames  duration of transition in sequence frames (shorter than both clips)
+ * @return            >= 0 on success
+ */
+int sequence_add_transition(Sequence *seq, Clip *clip, Transition *transition, int nb_frames);
+
+/**
+ * Remove the transition into a clip. The clip and all following clips move forward
+ * so the clip starts where the previous one ends (a cut)
+ * @param  seq  Sequence
+ * @param  clip Clip within sequence
+ * @return      >= 0 on success
+ */
+int sequence_remove_transition(Sequence *seq, Clip *clip);
+
+/**
+ * Get the overlap of a clip with the previous clip (its transition)
+ * @param  node      list node of clip within sequence
+ * @param  start_pts output start of overlap (sequence pts)
+ * @param  end_pts   output end of overlap (sequence pts, exclusive)
+ * @return           true if the clip has a transition
+ */
+bool get_clip_transition_pts(Node *node, int64_t *start_pts, int64_t *end_pts);
+
+/**
+ * Add a track on top of the tracks of a sequence. Clips are added to track->seq
+ * @param  seq   Sequence
+ * @param  video layer the video of the track over the sequence
+ * @param  audio mix the audio of the track into the sequence
+ * @return       SequenceTrack (freed with the sequence), NULL on error
+ */
+SequenceTrack *sequence_add_track(Sequence *seq, bool video, bool audio);
+
+/**
+ * Remove a track from a sequence and free it (along with its clips)
+ * @param  seq   Sequence
+ * @param  track SequenceTrack within sequence
+ * @return       >= 0 on success
+ */
+int sequence_remove_track(Sequence *seq, SequenceTrack *track);
+
+/**
+ * Set the position, size and opacity of the video of a track
+ * (aligned down to the chroma subsampling of the sequence frames when composited)
+ * @param  track   SequenceTrack
+ * @param  x       left of video in frames of the sequence (can be negative)
+ * @param  y       top of video in frames of the sequence (can be negative)
+ * @param  width   width of video (0 for the width of the frames)
+ * @param  height  height of video (0 for the height of the frames)
+ * @param  opacity opacity of video (0 to 1)
+ * @return         >= 0 on success
+ */
+int set_track_layout(SequenceTrack *track, int x, int y, int width, int height, double opacity);
+
+/**
+ * Set the gain of the audio of a track
+ * @param  track  SequenceTrack
+ * @param  volume gain (1 to keep the level of the track)
+ * @return        >= 0 on success
+ */
+int set_track_volume(SequenceTrack *track, double volume);
+
 /**
  * Convert sequence frame index to pts (presentation time stamp)
  * @param  seq         Sequence
@@ -192,6 +488,34 @@ int cut_clip(Sequence *seq, int frame_index);
  */
 int64_t find_clip_at_index(Sequence *seq, int frame_index, Clip **found_clip);
 
+/**
+ * Find the list node of the clip that contains this frame_index in sequence
+ * (the clip lookup of sequence_seek(), without seeking the clip)
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @param  clip_pts    output pts relative to the clip, and clip timebase
+ *                     (where zero represents clip->orig_start_pts)
+ * @return             Node of clip, NULL if no clip contains frame_index
+ */
+Node *find_clip_node_at_index(Sequence *seq, int frame_index, int64_t *clip_pts);
+
+/**
+ * Build the clip index of a sequence (clips sorted by start_pts)
+ * @param  seq Sequence
+ * @return     >= 0 on success
+ */
+int build_sequence_index(Sequence *seq);
+
+/**
+ * Binary search the clip index for the clip that contains this frame_index.
+ * The entry found is checked against the clip (so clips changed outside of the
+ * Sequence API only cost a rebuild)
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @return             Node of clip, NULL if no clip contains frame_index (or on error)
+ */
+Node *find_sequence_index_node(Sequence *seq, int frame_index);
+
 /**
  * Determine if sequence frame lies within a clip (assuming clip is within sequence)
  * Example:
@@ -273,6 +597,65 @@ int64_t video_pkt_to_seq_ts(Sequence *seq, Clip *clip, int64_t orig_pkt_ts);
  */
 int64_t audio_pkt_to_seq_ts(Sequence *seq, Clip *clip, int64_t orig_pkt_ts);
 
+/**
+ * Set the video decoding options of every clip in a sequence and its tracks (draft or full quality).
+ * Open clips are reopened with the new options.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq          Sequence
+ * @param  lowres       decode at 1/(2^lowres) resolution where the codec supports it (0 for full)
+ * @param  fast_decode  skip the loop filter and allow non spec compliant speedups
+ * @return              >= 0 on success
+ */
+int sequence_set_decode_options(Sequence *seq, int lowres, bool fast_decode);
+
+/**
+ * Save the video decoding options of every clip in a sequence and its tracks,
+ * to be restored with restore_sequence_decode_options()
+ * @param  seq          Sequence
+ * @param  lowres       output: lowres of every clip (allocated, to be freed by caller)
+ * @param  fast_decode  output: fast_decode of every clip (allocated, to be freed by caller)
+ * @return              >= 0 on success
+ */
+int save_sequence_decode_options(Sequence *seq, int **lowres, bool **fast_decode);
+
+/**
+ * Restore the video decoding options saved by save_sequence_decode_options()
+ * (clips must not be added or removed in between). Open clips are reopened with their options.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq          Sequence
+ * @param  lowres       lowres of every clip
+ * @param  fast_decode  fast_decode of every clip
+ * @return              >= 0 on success
+ */
+int restore_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode);
+
+/**
+ * Clear the render stats of every clip in a sequence (and its tracks)
+ * @param seq Sequence
+ */
+void clear_sequence_render_stats(Sequence *seq);
+
+/**
+ * Sum the render stats (demux, decode, preroll, seek) of every clip in a sequence (and its tracks)
+ * @param seq   Sequence
+ * @param total RenderStats to add the stats of every clip into
+ */
+void get_sequence_render_stats(Sequence *seq, RenderStats *total);
+
+/**
+ * Stop reading the current transition (frames decoded ahead are dropped,
+ * buffers are kept for the next transition)
+ * @param st SequenceTransition
+ */
+void reset_sequence_transition(SequenceTransition *st);
+
+/**
+ * Stop reading the tracks of a sequence (frames decoded ahead are dropped). The tracks
+ * are seeked to the position of the sequence on the next sequence_read_frame()
+ * @param seq Sequence
+ */
+void reset_sequence_tracks(Sequence *seq);
+
 /**
  * Free entire sequence and all clips within
  * @param seq Sequence containing clips and clip data to be freed
@@ -293,4 +676,84 @@ char *print_sequence(Sequence *seq);
  */
 void example_sequence_read_packets(Sequence *seq, bool close_clips_flag);
 
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Count the clips of a sequence and its tracks
+ * @param  seq Sequence
+ * @return     number of clips
+ */
+int count_sequence_clips(Sequence *seq);
+
+/**
+ * Copy the video decoding options of every clip in a sequence and its tracks
+ * @param  seq          Sequence
+ * @param  lowres       output: lowres of every clip (count_sequence_clips() entries)
+ * @param  fast_decode  output: fast_decode of every clip (count_sequence_clips() entries)
+ * @return              number of clips copied
+ */
+int get_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode);
+
+/**
+ * Set the video decoding options of every clip in a sequence and its tracks, one entry per clip
+ * @param  seq          Sequence
+ * @param  lowres       lowres of every clip
+ * @param  fast_decode  fast_decode of every clip
+ * @return              number of clips set, < 0 on error
+ */
+int set_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode);
+
+/**
+ * Change the video decoding options of a clip VideoContext (reopened when it was open).
+ * Clips sharing the VideoContext are changed together
+ * @param  clip        Clip
+ * @param  lowres      decode at 1/(2^lowres) resolution
+ * @param  fast_decode non spec compliant speedups
+ * @return             >= 0 on success
+ */
+int set_clip_decode_options(Clip *clip, int lowres, bool fast_decode);
+
+/**
+ * Initialize the transition state of a sequence (does not allocate)
+ * @param st SequenceTransition
+ */
+void init_sequence_transition(SequenceTransition *st);
+
+/**
+ * Free the transition state of a sequence
+ * @param st SequenceTransition
+ */
+void free_sequence_transition(SequenceTransition *st);
+
+/**
+ * Shift clips sequence pts starting at a node
+ * @param seq   Sequence
+ * @param node  first node to shift
+ * @param shift pts added to start_pts and end_pts of each clip
+ */
+void shift_clips_from(Sequence *seq, Node *node, int64_t shift);
+
+/**
+ * Initialize the compositing state of a sequence (does not allocate)
+ * @param sc SequenceCompositor
+ */
+void init_sequence_compositor(SequenceCompositor *sc);
+
+/**
+ * Free the compositing state of a sequence (threads and buffers)
+ * @param sc SequenceCompositor
+ */
+void free_sequence_compositor(SequenceCompositor *sc);
+
+/**
+ * Stop reading a track (frames decoded ahead are dropped, buffers are kept)
+ * @param track SequenceTrack
+ */
+void reset_sequence_track(SequenceTrack *track);
+
+/**
+ * Free a track, its clips and buffers
+ * @param track SequenceTrack allocated on heap
+ */
+void free_sequence_track(SequenceTrack *track);
+
 #endif
\ No newline at end of file
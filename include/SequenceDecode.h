@@ -12,18 +12,48 @@
 
 #include "Sequence.h"
 #include "ClipDecode.h"
+#include "FrameCache.h"
+#include "Composite.h"
 
 /**
- * Read decoded frames from our editing sequence
+ * Read decoded frames from our editing sequence.
+ * Where a clip has a transition (see sequence_add_transition()), both clips of the overlap
+ * are decoded together and their frames are mixed (sequence_read_packet() only cuts).
+ * The tracks of the sequence (see sequence_add_track()) are decoded along with the clips:
+ * their video is layered over each video frame and their audio summed into each audio frame
  * @param  seq              Sequence with clips to be read
  * @param  frame            decoded output frame
  * @param  frame_type       type of output frame
- * @param  close_clips_flag if true, close clips after read
- * @return                  >= 0 on success (returned a frame)
- *                          < 0 when reached end of sequence or error
+ * @param  close_clips_flag if true, close clips after read (clips of tracks are always closed)
+ * @return                  >= 0 on success (returned a frame),
+ *                          AVERROR_EOF when reached end of sequence, other < 0 on error
  */
 int sequence_read_frame(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool close_clips_flag);
 
+/**
+ * Get a video frame of the sequence by index, in any order. Stateless: the clip is found
+ * through the clip index, and the iterator of sequence_read_frame() is not moved (clips
+ * reading a VideoContext used here seek again on their next read). The decoder keeps going
+ * forward when the frame is just ahead of its last position, and only seeks when that is cheaper
+ * @param  seq         Sequence
+ * @param  fc          FrameCache consulted before decoding (NULL to decode without caching)
+ * @param  frame_index index of frame in sequence
+ * @param  frame       output frame with sequence pts (its data may be shared with the
+ *                     cache: do not write into it)
+ * @return             >= 0 on success
+ */
+int sequence_get_frame(Sequence *seq, FrameCache *fc, int frame_index, AVFrame *frame);
+
+/**
+ * Convert a decoded clip frame into a sequence frame
+ * (sequence timestamps, and an I frame at the start of each clip)
+ * @param seq   Sequence containing clip
+ * @param clip  Clip that decoded the frame
+ * @param frame decoded frame from clip_read_frame()
+ * @param type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ */
+void seq_frame_to_seq_ts(Sequence *seq, Clip *clip, AVFrame *frame, enum AVMediaType type);
+
 /**
  * Clear fields on AVFrame from decoding
  * @param f AVFrame to initialize
@@ -37,4 +67,333 @@ void clear_frame_decoding_garbage(AVFrame *f);
  */
  int example_sequence_read_frames(Sequence *seq, bool close_clips_flag);
 
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Read the next frame of the clips of a sequence (sequence_read_frame() without the tracks)
+ * @param  seq              Sequence with clips to be read
+ * @param  frame            decoded output frame
+ * @param  frame_type       type of output frame
+ * @param  close_clips_flag if true, close clips after read
+ * @param  seek_start       if true, seek back to the first clip at the end of the sequence
+ *                          (tracks are seeked when they start again instead)
+ * @return                  >= 0 on success (returned a frame),
+ *                          AVERROR_EOF when reached end of sequence, other < 0 on error
+ */
+int read_sequence_clips_frame(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool close_clips_flag,
+                                bool seek_start);
+
+/**
+ * Mix a frame of the outgoing clip of a transition with the incoming clip
+ * (frames outside of a transition are left untouched)
+ * @param  seq   Sequence
+ * @param  node  list node of the clip that decoded the frame
+ * @param  frame frame with sequence pts (replaced by the mixed frame)
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int mix_transition_frame(Sequence *seq, Node *node, AVFrame *frame, enum AVMediaType type);
+
+/**
+ * Start reading a transition: the incoming clip is seeked to a position of the overlap.
+ * When both clips read the same file, the incoming side reads a copy of the clip
+ * through a clone of the file (see clone_video_context())
+ * @param  seq  Sequence
+ * @param  node list node of the incoming clip
+ * @param  pts  position to start from (sequence video pts)
+ * @return      >= 0 on success
+ */
+int start_sequence_transition(Sequence *seq, Node *node, int64_t pts);
+
+/**
+ * Finish the transition into the next clip, once the outgoing clip is done.
+ * The incoming clip continues from where the transition decoded it (a copy reading through
+ * a clone is dropped, and the clip itself seeks to the end of the overlap)
+ * @param  seq  Sequence
+ * @param  next list node of the clip read next
+ * @return      >= 0 on success
+ */
+int end_sequence_transition(Sequence *seq, Node *next);
+
+/**
+ * Get the next frame of the incoming clip decoded ahead by a transition and not output yet
+ * @param  seq        Sequence
+ * @param  frame      output frame
+ * @param  frame_type output type of frame
+ * @param  clip_done  set to true when the incoming clip was read to the end
+ * @return            0 when a frame was output, AVERROR_EOF when there are none left
+ *                    (the transition is then reset), other < 0 on error
+ */
+int read_transition_leftover(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool *clip_done);
+
+/**
+ * Decode the next frame of the incoming clip of a transition. Video frames are queued
+ * and audio samples are written into the transition fifo
+ * @param  seq Sequence
+ * @return     >= 0 on success, AVERROR_EOF when the incoming clip has no more frames
+ */
+int read_transition_frame(Sequence *seq);
+
+/**
+ * Blend a video frame of the outgoing clip with the incoming frame shown at the same time
+ * @param  seq   Sequence
+ * @param  frame outgoing frame with sequence pts (replaced by the blended frame)
+ * @return       >= 0 on success
+ */
+int mix_transition_video(Sequence *seq, AVFrame *frame);
+
+/**
+ * Mix an audio frame of the outgoing clip with the incoming samples at the same time
+ * (planar float at the same sample rate and channels only: otherwise the outgoing audio
+ * is kept until the end of the transition)
+ * @param  seq   Sequence
+ * @param  frame outgoing frame with sequence pts (mixed in place)
+ * @return       >= 0 on success
+ */
+int mix_transition_audio_frame(Sequence *seq, AVFrame *frame);
+
+/**
+ * Write decoded samples of the incoming clip into the transition fifo
+ * @param  seq   Sequence
+ * @param  frame audio frame with sequence pts
+ * @return       >= 0 on success
+ */
+int write_transition_audio(Sequence *seq, AVFrame *frame);
+
+/**
+ * Drop the samples of the transition fifo before a pts
+ * @param seq Sequence
+ * @param pts sequence audio pts
+ */
+void drop_transition_samples(Sequence *seq, int64_t pts);
+
+/**
+ * Drop the oldest queued video frame of the incoming clip
+ * @param st SequenceTransition
+ */
+void pop_transition_frame(SequenceTransition *st);
+
+/**
+ * Make sure a frame has a writable buffer of the same format and size as another frame
+ * @param  frame frame to allocate (allocated itself when NULL)
+ * @param  like  frame with the format and size wanted
+ * @return       0 when the buffer was kept, 1 when a new buffer was allocated, < 0 on error
+ */
+int get_transition_buffer(AVFrame **frame, const AVFrame *like);
+
+/**
+ * Scale an incoming frame into the format and size of the outgoing frame (into st->scaled)
+ * @param  st   SequenceTransition
+ * @param  src  incoming frame
+ * @param  like outgoing frame
+ * @return      >= 0 on success
+ */
+int scale_transition_frame(SequenceTransition *st, const AVFrame *src, const AVFrame *like);
+
+/**
+ * Layer the tracks of a sequence over a frame of its clips (video),
+ * or sum them into it (audio). Tracks are seeked to the frame on the first call
+ * @param  seq   Sequence with tracks
+ * @param  frame frame of the clips with sequence pts (replaced by the composited frame)
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int composite_sequence_tracks(Sequence *seq, AVFrame *frame, enum AVMediaType type);
+
+/**
+ * Start reading the tracks of a sequence from the position of a frame: every track is
+ * seeked (in parallel), and the audio mix format is set from the clip being read
+ * @param  seq   Sequence with tracks
+ * @param  frame first frame read from the clips since the last seek
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int start_sequence_tracks(Sequence *seq, AVFrame *frame, enum AVMediaType type);
+
+/**
+ * Set if the audio of the tracks is mixed into the clip of the sequence being read.
+ * When it is not, the audio queued by the tracks is dropped and no more is queued
+ * @param seq       Sequence with tracks
+ * @param mix_audio the clip has audio at the sequence sample rate
+ */
+void set_track_audio_mixing(Sequence *seq, bool mix_audio);
+
+/**
+ * Give the clips of a track their own clone of every VideoContext also read by the clips
+ * of the sequence or of a track below it (see clone_video_context()), so each track reads
+ * its files at its own position, from its own thread. Clips of one track share the clone
+ * (a sequence reads its clips one after the other). The clips keep the clone until freed
+ * @param  seq Sequence with tracks
+ * @return     >= 0 on success
+ */
+int isolate_track_video_contexts(Sequence *seq);
+
+/**
+ * Check if a VideoContext is read by a clip of a sequence or of its tracks below a track
+ * @param  seq       Sequence with tracks
+ * @param  track_idx index of the track
+ * @param  vc        VideoContext
+ * @return           true when the VideoContext is read below the track
+ */
+bool video_context_read_below(Sequence *seq, int track_idx, VideoContext *vc);
+
+/**
+ * Switch every clip of a track reading the VideoContext of a clip onto one clone of it
+ * @param  ts   Sequence of the track
+ * @param  clip Clip of the track
+ * @return      >= 0 on success
+ */
+int clone_track_video_context(Sequence *ts, Clip *clip);
+
+/**
+ * Set the tracks of the next job, bottom to top
+ * @param seq  Sequence with tracks
+ * @param type AVMEDIA_TYPE_VIDEO for tracks with video, AVMEDIA_TYPE_AUDIO for tracks with audio,
+ *             AVMEDIA_TYPE_UNKNOWN for every track
+ */
+void set_job_tracks(Sequence *seq, enum AVMediaType type);
+
+/**
+ * Run a job on each track of the current job, in parallel
+ * @param  seq Sequence with tracks
+ * @param  job function run with seq as arg, and the index of the track in sc->job_tracks
+ * @return     >= 0 on success, the first error of a track otherwise
+ */
+int run_track_jobs(Sequence *seq, ThreadPoolJob job);
+
+/**
+ * ThreadPoolJob seeking a track to sc->job_pts
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void seek_track_job(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Seek a track to a position of the sequence. Over a gap of the track,
+ * it is seeked to the start of the next clip
+ * @param  track SequenceTrack
+ * @param  pts   sequence pts
+ * @return       >= 0 on success
+ */
+int seek_sequence_track(SequenceTrack *track, int64_t pts);
+
+/**
+ * Read the next frame of a track. Video frames are queued (when the track has video)
+ * and audio frames are converted into the mix format and queued (when the track has audio)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @return       >= 0 on success, AVERROR_EOF when the track has no more frames
+ */
+int read_track_frame(Sequence *seq, SequenceTrack *track);
+
+/**
+ * Drop the oldest queued video frame of a track
+ * @param track SequenceTrack
+ */
+void pop_track_frame(SequenceTrack *track);
+
+/**
+ * Drop the oldest queued audio frame of a track
+ * @param track SequenceTrack
+ */
+void pop_track_audio(SequenceTrack *track);
+
+/**
+ * ThreadPoolJob decoding a track up to sc->job_pts and scaling its frame into a layer
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void read_track_video_job(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Decode a track up to a pts, keeping the last video frame at or before it
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  pts   sequence pts
+ * @return       >= 0 on success
+ */
+int advance_track_video(Sequence *seq, SequenceTrack *track, int64_t pts);
+
+/**
+ * Scale the video frame of a track shown at sc->job_pts into its layer
+ * (track->layer_ready is false when the track shows nothing there)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @return       >= 0 on success
+ */
+int get_track_layer(Sequence *seq, SequenceTrack *track);
+
+/**
+ * Layer the video of the tracks over a frame of the clips. Tracks are decoded in parallel,
+ * then bands of rows are composited in parallel. Frames in a pixel format that cannot be
+ * composited are converted into yuv420p
+ * @param  seq   Sequence with tracks
+ * @param  frame video frame of the clips with sequence pts (replaced by the composited frame)
+ * @return       >= 0 on success
+ */
+int composite_tracks_video(Sequence *seq, AVFrame *frame);
+
+/**
+ * ThreadPoolJob compositing the layers of the current job over a band of rows
+ * @param arg        Sequence
+ * @param job_idx    index of the band (of sc->job_tile_h rows)
+ * @param thread_idx index of the thread
+ */
+void composite_tile_job(void *arg, int job_idx, int thread_idx);
+
+/**
+ * ThreadPoolJob decoding the audio of a track over sc->job_audio_pts to sc->job_audio_end
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void read_track_audio_job(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Decode a track until its queued audio covers a range of the sequence
+ * (audio ending before the range is dropped)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  start start of range (sequence audio pts)
+ * @param  end   end of range (exclusive)
+ * @return       >= 0 on success
+ */
+int advance_track_audio(Sequence *seq, SequenceTrack *track, int64_t start, int64_t end);
+
+/**
+ * Sum the audio of the tracks into an audio frame of the clips. Tracks are decoded in parallel.
+ * The frame is converted into the mix format (planar float) when it has another format
+ * @param  seq   Sequence with tracks
+ * @param  frame audio frame of the clips with sequence pts (mixed in place, or replaced)
+ * @return       >= 0 on success
+ */
+int mix_tracks_audio(Sequence *seq, AVFrame *frame);
+
+/**
+ * Convert an audio frame of the clips into the mix format (same sample rate)
+ * @param  seq    Sequence with tracks
+ * @param  frame  audio frame (replaced by the converted frame)
+ * @param  layout channel layout of frame
+ * @return        >= 0 on success
+ */
+int convert_sequence_audio(Sequence *seq, AVFrame *frame, uint64_t layout);
+
+/**
+ * Convert an audio frame of a track into the mix format (resampled to the sequence rate)
+ * and queue it (dropped while the sequence has no audio to mix it into)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  frame audio frame with sequence pts
+ * @return       >= 0 on success
+ */
+int write_track_audio(Sequence *seq, SequenceTrack *track, AVFrame *frame);
+
+/**
+ * Sum the queued audio of a track into the samples of a frame it overlaps
+ * @param track SequenceTrack
+ * @param frame audio frame in the mix format with sequence pts (writable)
+ */
+void mix_track_audio(SequenceTrack *track, AVFrame *frame);
+
 #endif
\ No newline at end of file
@@ -19,7 +19,7 @@
  * @param  oc           OutputContext already allocated with codecs
  * @param  seq_ts       Sequence containing clips to encode
  * @param  pkt          output encoded packet
- * @return      >= 0 on success, < 0 when reach EOF, end of clip boundary or error.
+ * @return      >= 0 on success, AVERROR_EOF when the sequence is fully encoded, other < 0 on error.
  */
 int sequence_encode_frame(OutputContext *oc, Sequence *seq, AVPacket *pkt);
 
@@ -32,34 +32,80 @@ int sequence_encode_frame(OutputContext *oc, Sequence *seq, AVPacket *pkt);
 
 /*************** INTERNAL FUNCTIONS ***************/
 /**
- * Receive an encoded packet given an output stream, and handle the return value
- * @param  oc   OutputContext
+ * Get the output stream which must be drained of packets before more frames are sent.
+ * This is the stream of the last frame sent, or the stream currently being flushed
+ * @param  oc OutputContext
+ * @return    OutputStream to receive packets from, NULL if a new frame must be sent
+ */
+OutputStream *seq_get_drain_stream(OutputContext *oc);
+
+/**
+ * Receive an encoded packet given an output stream
  * @param  os   OutputStream within OutputContext (video or audio)
- * @param  seq  Sequence being encoded
  * @param  pkt  output encoded packet
- * @return      >= 0 on success
+ * @return      0 when a packet was received,
+ *              AVERROR(EAGAIN) when the encoder needs more input,
+ *              AVERROR_EOF when the encoder has been fully flushed,
+ *              other < 0 on error
  */
-int seq_receive_enc_packet(OutputContext *oc, OutputStream *os, Sequence *seq, AVPacket *pkt);
+int seq_receive_enc_packet(OutputStream *os, AVPacket *pkt);
 
 /**
  * Send a frame to encoder. This function builds ontop of seq_read_frame().
+ * If the last frame was refused by the encoder, it is sent again instead of reading a new one.
+ * When the sequence has no more frames, both encoders are put into flushing mode
+ * (after the remaining audio samples are sent).
  * @param  oc   OutputContext already allocated
  * @param  seq  Sequence to encode
- * @param  pkt  packet output
  * @return      >= 0 on success
  */
-int seq_send_frame_to_encoder(OutputContext *oc, Sequence *seq, AVPacket *pkt);
+int seq_send_frame_to_encoder(OutputContext *oc, Sequence *seq);
+
+/**
+ * Get the next frame to be sent to an encoder into oc->buffer_frame.
+ * Video frames are converted into the encoder format. Audio frames are resampled
+ * and re-chunked into the encoder frame_size, so a decoded audio frame can give
+ * zero, one or more encoder frames.
+ * @param  oc   OutputContext already allocated
+ * @param  seq  Sequence to encode
+ * @param  type output type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return      0 when oc->buffer_frame is ready to be sent,
+ *              AVERROR(EAGAIN) when there is no frame ready yet,
+ *              AVERROR_EOF when the sequence and audio samples are all sent,
+ *              other < 0 on error
+ */
+int seq_get_encoder_frame(OutputContext *oc, Sequence *seq, enum AVMediaType *type);
+
+/**
+ * Force a key frame on the first video frame of each segment
+ * @param oc    OutputContext
+ * @param frame video frame about to be sent to the encoder
+ */
+void set_segment_key_frame(OutputContext *oc, AVFrame *frame);
+
+/**
+ * Check if a video frame is dropped by a lower output frame rate (draft preview).
+ * Must be called once for every video frame read
+ * @param  oc   OutputContext
+ * @return      true if the frame must not be encoded
+ */
+bool drop_video_frame(OutputContext *oc);
 
 /**
  * Handle the return from avcodec_send_frame().
  * This function is to be used inside of seq_send_frame_to_encoder()
  * @param  oc   OutputContext already allocated
- * @param  seq  Sequence to encode
  * @param  type AVMediaType of frame that was sent
  * @param  ret  return from avcodec_send_frame()
- * @param  pkt  output packet
  * @return      >= 0 on success
  */
-int seq_handle_send_frame(OutputContext *oc, Sequence *seq, enum AVMediaType type, int ret, AVPacket *pkt);
+int seq_handle_send_frame(OutputContext *oc, enum AVMediaType type, int ret);
+
+/**
+ * Send NULL frames to the video and audio encoders to enter flushing mode
+ * @param  oc OutputContext already allocated
+ * @return    >= 0 on success
+ */
+int seq_flush_encoders(OutputContext *oc);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,194 @@
+/**
+ * @file Silence.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Silence API:
+ * Silence detection and auto-trim. Only the audio stream of each clip is demuxed and
+ * decoded (video packets are discarded by the demuxer). Samples are reduced to an
+ * RMS/peak envelope with SSE kernels (scalar fallback), silent ranges longer than a
+ * threshold are found, and a trimmed sequence is built in a single pass of batched cuts.
+ */
+
+#ifndef _SILENCE_API_
+#define _SILENCE_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+#include "Sequence.h"
+#include "ClipDecode.h"
+
+typedef struct SilenceParams {
+    /*
+        windows with an RMS level below threshold_db (dBFS) are silent
+     */
+    double threshold_db;
+    /*
+        length of envelope windows (seconds)
+     */
+    double window;
+    /*
+        only silences at least this long are trimmed (seconds)
+     */
+    double min_silence;
+    /*
+        silence kept on each side of a trimmed range, so speech is not clipped (seconds)
+     */
+    double padding;
+    /*
+        audio left between two trimmed ranges shorter than this is trimmed with them (seconds)
+     */
+    double min_keep;
+} SilenceParams;
+
+/*
+    Range of a clip, in video pts relative to the start of the clip (end exclusive)
+ */
+typedef struct SilenceRange {
+    int64_t start_pts, end_pts;
+} SilenceRange;
+
+/*
+    RMS and peak level (0 to 1) of consecutive windows of a clip (all channels together)
+ */
+typedef struct SilenceEnvelope {
+    float *rms, *peak;
+    int nb, size;
+    int sample_rate;
+    int window_samples;
+    /*
+        sample of the first window, relative to the start of the clip
+     */
+    int64_t start_sample;
+    /*
+        internal use only. window being filled: sum of squares, peak, and number of
+        samples (per channel) and values (all channels)
+     */
+    double acc_sq;
+    float acc_peak;
+    int acc_samples;
+    int64_t acc_values;
+} SilenceEnvelope;
+
+/**
+ * Set default silence parameters (-45 dBFS for 0.75 seconds, with 0.15 seconds of padding)
+ * @param params SilenceParams
+ */
+void set_silence_params_default(SilenceParams *params);
+
+/**
+ * Initialize an empty envelope
+ * @param env SilenceEnvelope
+ */
+void init_silence_envelope(SilenceEnvelope *env);
+
+/**
+ * Decode the audio of a clip (without decoding video) into an RMS/peak envelope
+ * @param  clip   Clip (seeked back to its start when done)
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  env    SilenceEnvelope initialized with init_silence_envelope()
+ * @return        >= 0 on success
+ */
+int get_clip_silence_envelope(Clip *clip, SilenceParams *params, SilenceEnvelope *env);
+
+/**
+ * Find the silent ranges of a clip that should be trimmed
+ * @param  clip   Clip with an audio stream
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  ranges output array of ranges (free() when done), NULL when there are none
+ * @return        number of ranges, < 0 on error
+ */
+int detect_clip_silence(Clip *clip, SilenceParams *params, SilenceRange **ranges);
+
+/**
+ * Build a sequence without the silences of another. The clips of seq are split around
+ * their silent ranges and appended to out in one pass (out shares the VideoContexts of seq)
+ * @param  seq    Sequence to trim (not changed, apart from being seeked to its start)
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  out    empty Sequence (initialized with the fps and sample rate of seq)
+ * @return        number of silent ranges removed, < 0 on error
+ */
+int trim_sequence_silence(Sequence *seq, SilenceParams *params, Sequence *out);
+
+/**
+ * Free the windows of an envelope
+ * @param env SilenceEnvelope
+ */
+void free_silence_envelope(SilenceEnvelope *env);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Add the samples of a decoded audio frame to the envelope
+ * @param  env   SilenceEnvelope
+ * @param  frame decoded audio frame
+ * @return       >= 0 on success
+ */
+int add_silence_frame(SilenceEnvelope *env, AVFrame *frame);
+
+/**
+ * Add sum of squares and peak of samples [offset, offset+n) of every channel of a frame
+ * @param env    SilenceEnvelope
+ * @param frame  decoded audio frame
+ * @param offset first sample
+ * @param n      number of samples per channel
+ */
+void add_silence_samples(SilenceEnvelope *env, AVFrame *frame, int offset, int n);
+
+/**
+ * Output the window being filled (when it has samples)
+ * @param  env SilenceEnvelope
+ * @return     >= 0 on success
+ */
+int flush_silence_window(SilenceEnvelope *env);
+
+/**
+ * Find the trimmed ranges of an envelope
+ * @param  env    SilenceEnvelope
+ * @param  params SilenceParams
+ * @param  ranges output array of ranges in samples from the start of the clip
+ * @return        number of ranges, < 0 on error
+ */
+int find_silence_ranges(SilenceEnvelope *env, SilenceParams *params, SilenceRange **ranges);
+
+/**
+ * Sum of squares and peak of float samples
+ * @param s      samples
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_float_stats(const float *s, int n, double *sum_sq, float *peak);
+
+/**
+ * Sum of squares and peak of signed 16 bit samples (scaled into -1 to 1)
+ * @param s      samples
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_s16_stats(const int16_t *s, int n, double *sum_sq, float *peak);
+
+/**
+ * Sum of squares and peak of samples in any other packed format (scaled into -1 to 1)
+ * @param data   samples
+ * @param fmt    packed sample format
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_sample_stats(const uint8_t *data, enum AVSampleFormat fmt, int n, double *sum_sq, float *peak);
+
+/**
+ * Append a copy of part of a clip to a sequence
+ * @param  out   Sequence
+ * @param  clip  source clip
+ * @param  start start of part, in video pts relative to the clip
+ * @param  end   end of part (exclusive)
+ * @return       >= 0 on success
+ */
+int append_silence_trimmed_clip(Sequence *out, Clip *clip, int64_t start, int64_t end);
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @file SyntheticMedia.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for SyntheticMedia API:
+ * Generates test sources (video and audio) with a controlled codec, resolution,
+ * frame rate (constant or variable), GOP structure, duration and audio format.
+ * Every video frame can embed its frame number as a block pattern, so decoded frames
+ * can be identified after seeking and cutting (frame accuracy checks with no external footage).
+ */
+
+#ifndef _SYNTHETIC_MEDIA_API_
+#define _SYNTHETIC_MEDIA_API_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/samplefmt.h>
+#include <libavutil/channel_layout.h>
+#include "Log.h"
+
+/* number of bits in the frame number pattern (top row of blocks in the luma plane) */
+#define SYNTH_PATTERN_BITS 24
+/* luma of pattern blocks (limited range black and white) */
+#define SYNTH_PATTERN_BLACK 16
+#define SYNTH_PATTERN_WHITE 235
+/* time base ticks per nominal frame for variable frame rate sources */
+#define SYNTH_VFR_TICKS 4
+
+typedef struct SyntheticParams {
+    /*
+        video encoder, AV_CODEC_ID_NONE for no video
+     */
+    enum AVCodecID video_codec_id;
+    enum AVPixelFormat pix_fmt;
+    int width, height;
+    /*
+        nominal frame rate. When vfr is true, frame durations vary between
+        1/2 and 3/2 of the nominal duration (deterministic, same for every run)
+     */
+    AVRational fps;
+    bool vfr;
+    /*
+        distance between key frames and maximum consecutive B frames
+     */
+    int gop_size;
+    int max_b_frames;
+    /*
+        video bit rate (0 for the codec default)
+     */
+    int64_t bit_rate;
+    /*
+        embed the frame number as a pattern (see read_frame_number_pattern())
+     */
+    bool frame_number_pattern;
+    /*
+        duration in seconds
+     */
+    double duration;
+    /*
+        audio encoder (440Hz tone), AV_CODEC_ID_NONE for no audio
+     */
+    enum AVCodecID audio_codec_id;
+    int sample_rate;
+    uint64_t channel_layout;
+    int64_t audio_bit_rate;
+} SyntheticParams;
+
+/**
+ * Set default synthetic params: 640x360 MPEG-4 at 30fps, GOP 12 without B frames,
+ * 4 seconds, frame number pattern, 48kHz stereo AAC
+ * @param p SyntheticParams
+ */
+void set_synthetic_params_default(SyntheticParams *p);
+
+/**
+ * Generate a synthetic media file (container deduced from the filename extension)
+ * @param  filename output filename
+ * @param  p        SyntheticParams
+ * @return          >= 0 on success
+ */
+int generate_synthetic_media(char *filename, SyntheticParams *p);
+
+/**
+ * Read the frame number embedded in a decoded video frame by generate_synthetic_media().
+ * The frame must keep the aspect ratio of the source and have a planar YUV format
+ * (the pattern survives scaling and lossy compression)
+ * @param  frame decoded video frame
+ * @return       frame number, < 0 if the frame has no readable pattern
+ */
+int64_t read_frame_number_pattern(AVFrame *frame);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Allocate a stream and open its encoder
+ * @param  fmt_ctx  output format context
+ * @param  p        SyntheticParams
+ * @param  codec_id codec of stream (video or audio)
+ * @param  stream   output stream allocated
+ * @return          opened encoder or NULL on fail
+ */
+AVCodecContext *open_synthetic_encoder(AVFormatContext *fmt_ctx, SyntheticParams *p,
+                                        enum AVCodecID codec_id, AVStream **stream);
+
+/**
+ * Get the duration of a video frame in time base ticks (SYNTH_VFR_TICKS per nominal frame)
+ * @param  p           SyntheticParams
+ * @param  frame_index index of frame
+ * @return             duration of frame
+ */
+int get_synthetic_frame_duration(SyntheticParams *p, int64_t frame_index);
+
+/**
+ * Draw a moving gradient and the frame number pattern into a video frame
+ * @param  frame        writable video frame
+ * @param  frame_index  index of frame
+ * @param  pattern      true to draw the frame number pattern
+ * @return              >= 0 on success
+ */
+int fill_synthetic_video_frame(AVFrame *frame, int64_t frame_index, bool pattern);
+
+/**
+ * Fill an audio frame with a 440Hz tone (float and signed 16 bit, planar or packed)
+ * @param  frame        writable audio frame
+ * @param  sample_index index of first sample in frame
+ * @return              >= 0 on success
+ */
+int fill_synthetic_audio_frame(AVFrame *frame, int64_t sample_index);
+
+/**
+ * Send a frame (NULL to flush) to an encoder and write every packet it returns
+ * @param  fmt_ctx  output format context
+ * @param  c        encoder
+ * @param  stream   output stream of encoder
+ * @param  frame    frame to encode, NULL to flush
+ * @return          >= 0 on success
+ */
+int write_synthetic_frame(AVFormatContext *fmt_ctx, AVCodecContext *c, AVStream *stream, AVFrame *frame);
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file ThreadPool.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for ThreadPool API:
+ * A fixed set of worker threads used to split work (such as frame slices)
+ * across cpu cores. The calling thread takes part in the work.
+ */
+
+#ifndef _THREAD_POOL_API_
+#define _THREAD_POOL_API_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "Log.h"
+
+/*
+    job function run by thread_pool_execute()
+    @param arg        user data passed to thread_pool_execute()
+    @param job_idx    index of this job (0 to nb_jobs - 1)
+    @param thread_idx index of the thread running the job (0 to nb_threads)
+ */
+typedef void (*ThreadPoolJob)(void *arg, int job_idx, int thread_idx);
+
+typedef struct ThreadPool {
+    /*
+        worker threads (the calling thread is not included)
+     */
+    pthread_t *threads;
+    int nb_threads;
+
+    /*
+        protects all fields below
+     */
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond, done_cond;
+
+    /*
+        current batch of jobs
+     */
+    ThreadPoolJob job;
+    void *arg;
+    int nb_jobs, next_job, jobs_done;
+
+    /*
+        set when the pool is freed, to stop the workers
+     */
+    bool exit;
+} ThreadPool;
+
+/*
+    argument given to each worker thread
+ */
+typedef struct ThreadPoolWorker {
+    ThreadPool *tp;
+    int thread_idx;
+} ThreadPoolWorker;
+
+/**
+ * Initialize a thread pool and start the worker threads
+ * @param  tp          ThreadPool
+ * @param  nb_threads  total number of threads to use, including the calling thread.
+ *                     <= 0 will use one thread per cpu core
+ * @return             >= 0 on success
+ */
+int init_thread_pool(ThreadPool *tp, int nb_threads);
+
+/**
+ * Run nb_jobs jobs across all threads of the pool (and the calling thread).
+ * Blocks until every job is complete
+ * @param  tp      ThreadPool
+ * @param  job     function to run once per job index
+ * @param  arg     user data passed to job
+ * @param  nb_jobs number of jobs
+ * @return         >= 0 on success
+ */
+int thread_pool_execute(ThreadPool *tp, ThreadPoolJob job, void *arg, int nb_jobs);
+
+/**
+ * Get the total number of threads used by the pool (including the calling thread)
+ * @param  tp ThreadPool
+ * @return    number of threads
+ */
+int get_thread_pool_size(ThreadPool *tp);
+
+/**
+ * Stop and join the worker threads and free thread pool data
+ * @param tp ThreadPool
+ */
+void free_thread_pool(ThreadPool *tp);
+
+/**
+ * Get the number of online cpu cores
+ * @return number of cores (>= 1)
+ */
+int get_cpu_count();
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Take and run jobs from the current batch until there are none left.
+ * Must be called with tp->lock held, returns with tp->lock held
+ * @param tp         ThreadPool
+ * @param thread_idx index of the thread running the jobs
+ */
+void thread_pool_run_jobs(ThreadPool *tp, int thread_idx);
+
+/**
+ * Worker thread main loop. Waits for a batch of jobs and helps run it
+ * @param  arg ThreadPoolWorker allocated on heap (freed by this function)
+ * @return     NULL
+ */
+void *thread_pool_worker(void *arg);
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * @file Thumbnail.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Thumbnail API:
+ * Frame accurate thumbnails of many sequence or source frames at once.
+ * Requests are grouped by file and GOP (so each GOP is decoded once) and the groups
+ * are decoded in parallel, each thread with its own VideoContext.
+ * Thumbnails are scaled RGB frames or JPEG images (contact sheets, timeline strips).
+ */
+
+#ifndef _THUMBNAIL_API_
+#define _THUMBNAIL_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include "Sequence.h"
+#include "VideoConvert.h"
+#include "ThreadPool.h"
+
+/* Thumbnail.ret of a request found in its file, waiting to be decoded (internal) */
+#define THUMBNAIL_PENDING 1
+
+enum ThumbnailFormat { THUMBNAIL_RGB24, THUMBNAIL_JPEG };
+
+typedef struct ThumbnailParams {
+    /*
+        size of thumbnails. When height <= 0, height keeps the aspect ratio of the source
+     */
+    int width, height;
+    enum ThumbnailFormat format;
+    /*
+        JPEG quality scale, 2 (best) to 31 (smallest)
+     */
+    int jpeg_quality;
+    /*
+        decoding speed options of each VideoContext (see set_video_decode_options())
+     */
+    int lowres;
+    bool fast_decode;
+    /*
+        number of threads (<= 0 for one per cpu core)
+     */
+    int nb_threads;
+} ThumbnailParams;
+
+typedef struct Thumbnail {
+    /*
+        request: file and frame (set with set_source_thumbnail() or set_sequence_thumbnail()).
+        When pts < 0, frame_index is converted into pts with the frame rate of the file
+     */
+    char *url;
+    int64_t frame_index;
+    int64_t pts;
+    /*
+        result: RGB24 frame (THUMBNAIL_RGB24) or JPEG image (THUMBNAIL_JPEG)
+     */
+    AVFrame *frame;
+    AVPacket *jpeg;
+    /*
+        >= 0 when the thumbnail was extracted
+     */
+    int ret;
+    /*
+        internal use only. pts of key frame before pts (thumbnails of a GOP are decoded together)
+     */
+    int64_t key_pts;
+} Thumbnail;
+
+/*
+    Decoder, scaler and encoder of a thread (internal use only)
+ */
+typedef struct ThumbnailWorker {
+    VideoContext vid_ctx;
+    /*
+        url of the file open in vid_ctx (points to the url of a Thumbnail)
+     */
+    char *url;
+    VideoConverter convert;
+    AVCodecContext *jpeg_ctx;
+    AVFrame *frame;
+} ThumbnailWorker;
+
+/*
+    Range of requests decoded by a single job (internal use only)
+ */
+typedef struct ThumbnailGroup {
+    int start, nb;
+} ThumbnailGroup;
+
+/*
+    State shared by all jobs of extract_thumbnails() (internal use only)
+ */
+typedef struct ThumbnailJobs {
+    ThumbnailParams *params;
+    /*
+        requests sorted by file, key frame and pts
+     */
+    Thumbnail **order;
+    ThumbnailGroup *groups;
+    int nb_groups;
+    /*
+        one per thread of the pool
+     */
+    ThumbnailWorker *workers;
+} ThumbnailJobs;
+
+/**
+ * Set default thumbnail parameters (160 pixels wide RGB24, one thread per cpu core)
+ * @param params ThumbnailParams
+ */
+void set_thumbnail_params_default(ThumbnailParams *params);
+
+/**
+ * Initialize an empty thumbnail request
+ * @param t Thumbnail
+ */
+void init_thumbnail(Thumbnail *t);
+
+/**
+ * Request a thumbnail of a source file frame
+ * @param  t           Thumbnail initialized with init_thumbnail()
+ * @param  url         filename
+ * @param  frame_index index of frame in the file
+ * @return             >= 0 on success
+ */
+int set_source_thumbnail(Thumbnail *t, char *url, int64_t frame_index);
+
+/**
+ * Request a thumbnail of a sequence frame (the frame of the clip at this index).
+ * Uses the proxy of the clip when the sequence is using proxies
+ * @param  t           Thumbnail initialized with init_thumbnail()
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @return             >= 0 on success
+ */
+int set_sequence_thumbnail(Thumbnail *t, Sequence *seq, int frame_index);
+
+/**
+ * Extract thumbnails. Requests are grouped by file and GOP, and groups are decoded
+ * across threads (each with its own VideoContext)
+ * @param  thumbs array of requests
+ * @param  nb     number of requests
+ * @param  params ThumbnailParams
+ * @return        number of thumbnails that failed (see Thumbnail.ret), < 0 on error
+ */
+int extract_thumbnails(Thumbnail *thumbs, int nb, ThumbnailParams *params);
+
+/**
+ * Write a JPEG thumbnail to a file
+ * @param  t        Thumbnail extracted as THUMBNAIL_JPEG
+ * @param  filename output filename
+ * @return          >= 0 on success
+ */
+int write_thumbnail_jpeg(Thumbnail *t, char *filename);
+
+/**
+ * Free thumbnail request and result
+ * @param t Thumbnail
+ */
+void free_thumbnail(Thumbnail *t);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Compare two requests by url, key_pts and pts (qsort of Thumbnail pointers)
+ * @param  first  Thumbnail **
+ * @param  second Thumbnail **
+ * @return        < 0, 0 or > 0 as strcmp
+ */
+int compare_thumbnails(const void *first, const void *second);
+
+/**
+ * Split the sorted requests into groups of the same file (and the same GOP)
+ * @param jobs   ThumbnailJobs with sorted requests
+ * @param nb     number of requests
+ * @param by_gop true to split files into GOPs
+ */
+void group_thumbnails(ThumbnailJobs *jobs, int nb, bool by_gop);
+
+/**
+ * Open a file in a worker (nothing is done if the file is already open)
+ * @param  w      ThumbnailWorker
+ * @param  url    filename
+ * @param  params ThumbnailParams
+ * @return        >= 0 on success
+ */
+int open_thumbnail_worker(ThumbnailWorker *w, char *url, ThumbnailParams *params);
+
+/**
+ * Close the file, converter and encoder of a worker
+ * @param w ThumbnailWorker
+ */
+void close_thumbnail_worker(ThumbnailWorker *w);
+
+/**
+ * ThreadPoolJob finding the pts and key frame of every request of a file
+ * @param arg        ThumbnailJobs
+ * @param job_idx    index of file group
+ * @param thread_idx index of worker
+ */
+void resolve_thumbnail_file(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Get pts of the key frame at or before pts (from the index of the demuxer)
+ * @param  vid_ctx opened VideoContext
+ * @param  pts     pts in video time base
+ * @return         pts of key frame, pts itself when the file has no index
+ */
+int64_t get_thumbnail_key_pts(VideoContext *vid_ctx, int64_t pts);
+
+/**
+ * ThreadPoolJob decoding a GOP once and extracting every thumbnail requested in it
+ * @param arg        ThumbnailJobs
+ * @param job_idx    index of GOP group
+ * @param thread_idx index of worker
+ */
+void decode_thumbnail_group(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Seek to the first request, then decode until every request has its frame
+ * (the first frame at or after the pts of the request)
+ * @param  w      ThumbnailWorker with the file open
+ * @param  params ThumbnailParams
+ * @param  thumbs requests sorted by pts
+ * @param  nb     number of requests
+ * @return        >= 0 on success
+ */
+int decode_thumbnails(ThumbnailWorker *w, ThumbnailParams *params, Thumbnail **thumbs, int nb);
+
+/**
+ * Scale a decoded frame into a thumbnail (and encode it in JPEG format)
+ * @param  w      ThumbnailWorker
+ * @param  params ThumbnailParams
+ * @param  frame  decoded frame (replaced by the scaled frame)
+ * @param  t      Thumbnail to set
+ * @return        >= 0 on success
+ */
+int output_thumbnail(ThumbnailWorker *w, ThumbnailParams *params, AVFrame *frame, Thumbnail *t);
+
+/**
+ * Open (or reopen at a new size) the JPEG encoder of a worker
+ * @param  w      ThumbnailWorker
+ * @param  params ThumbnailParams
+ * @param  width  width of thumbnails
+ * @param  height height of thumbnails
+ * @return        >= 0 on success
+ */
+int open_thumbnail_encoder(ThumbnailWorker *w, ThumbnailParams *params, int width, int height);
+
+#endif
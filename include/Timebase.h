@@ -42,6 +42,40 @@ int seek_video(VideoContext *vid_ctx, int frameIndex);
 */
 int seek_video_pts(VideoContext *vid_ctx, int pts);
 
+/**
+ * Get pts of the key frame at or before pts (from the index of the demuxer)
+ * @param  vid_ctx opened VideoContext
+ * @param  pts     pts in video time base
+ * @return         pts of key frame, -1 when the file has no index
+ */
+int64_t get_video_key_frame_pts(VideoContext *vid_ctx, int64_t pts);
+
+/**
+ * Check if reading and decoding on from pos reaches pts more cheaply than seeking.
+ * Reading on is cheaper until a key frame lies after pos, at or before pts
+ * (a seek lands on that key frame). The index of the demuxer can be incomplete (mpegts,
+ * mkv without cues: it only holds key frames read so far), so reading on is only chosen
+ * within max_dist
+ * @param  vid_ctx  opened VideoContext
+ * @param  pos      pts the demuxer and decoder are at (video time base)
+ * @param  pts      pts of the frame wanted (>= pos)
+ * @param  max_dist max distance to read on
+ * @return          true to read on, false to seek
+ */
+bool video_read_forward_cheaper(VideoContext *vid_ctx, int64_t pos, int64_t pts, int64_t max_dist);
+
+/**
+ * Check if the video decoder can reach pts by decoding forward from the last random access
+ * frame (vid_ctx->last_decoded_pts) more cheaply than seeking. Decoding forward is cheaper
+ * until a key frame lies between the decoder and pts (a seek lands on that key frame),
+ * and is only chosen within max_dist
+ * @param  vid_ctx  opened VideoContext
+ * @param  pts      pts of the frame wanted (video time base)
+ * @param  max_dist max distance to decode forward
+ * @return          true to decode forward, false to seek
+ */
+bool video_decode_forward_cheaper(VideoContext *vid_ctx, int64_t pts, int64_t max_dist);
+
 int64_t get_audio_frame_pts(VideoContext *vid_ctx, int frameIndex);
 
 int64_t cov_video_to_audio_pts(VideoContext *vid_ctx, int videoFramePts);
@@ -0,0 +1,147 @@
+/**
+ * @file Transition.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for Transition API:
+ * Transitions between two clips (video dissolve and dip to color, audio crossfade).
+ * Frames are mixed plane by plane with SSE2 kernels (scalar fallback) for 8 bit and
+ * 9 to 14 bit video, and planar float audio. The sequence side (reading both clips of a
+ * transition together) is in SequenceDecode.
+ */
+
+#ifndef _TRANSITION_API_
+#define _TRANSITION_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/samplefmt.h>
+#include "Log.h"
+
+typedef enum TransitionType {
+    TRANSITION_NONE = 0,
+    /*
+        outgoing clip fades into the incoming clip (video and audio)
+     */
+    TRANSITION_DISSOLVE,
+    /*
+        outgoing clip fades to a color (and silence) for the first half,
+        then the color fades into the incoming clip
+     */
+    TRANSITION_DIP_TO_COLOR
+} TransitionType;
+
+/*
+    Transition into a clip from the clip before it in a sequence.
+    It lasts as long as the two clips overlap (see sequence_add_transition())
+ */
+typedef struct Transition {
+    TransitionType type;
+    /*
+        color of TRANSITION_DIP_TO_COLOR (RGB)
+     */
+    uint8_t color[3];
+} Transition;
+
+/**
+ * Check if frames of a pixel format can be blended (every component is a whole 8 bit byte,
+ * or a native 16 bit word holding 9 to 14 bits)
+ * @param  pix_fmt pixel format
+ * @return         true if supported by blend_video_frames()
+ */
+bool transition_pix_fmt_supported(enum AVPixelFormat pix_fmt);
+
+/**
+ * Fill a frame with a color
+ * @param  frame frame with format, width, height and buffers set (supported pixel format)
+ * @param  rgb   color (converted into YUV for YUV formats, using the color range of the frame)
+ * @return       >= 0 on success
+ */
+int fill_video_frame_color(AVFrame *frame, const uint8_t rgb[3]);
+
+/**
+ * Blend two frames: dst = a * (1 - t) + b * t.
+ * All frames have the same supported pixel format and size (dst can be a or b)
+ * @param dst output frame with buffers
+ * @param a   first frame
+ * @param b   second frame
+ * @param t   weight of b (0 to 1)
+ */
+void blend_video_frames(AVFrame *dst, const AVFrame *a, const AVFrame *b, double t);
+
+/**
+ * Blend a video frame of a transition
+ * @param tr    Transition
+ * @param dst   output frame with buffers
+ * @param a     frame of the outgoing clip
+ * @param b     frame of the incoming clip (same format and size)
+ * @param color frame filled with the dip color (TRANSITION_DIP_TO_COLOR only)
+ * @param t     progress of the transition (0 to 1)
+ */
+void blend_transition_frame(Transition *tr, AVFrame *dst, const AVFrame *a, const AVFrame *b,
+                                const AVFrame *color, double t);
+
+/**
+ * Mix the samples of the incoming clip into the samples of the outgoing clip (planar float).
+ * Gains follow the progress of the transition sample by sample
+ * @param tr         Transition
+ * @param dst        outgoing frame (AV_SAMPLE_FMT_FLTP, writable), mixed in place
+ * @param src        incoming samples (AV_SAMPLE_FMT_FLTP, same channels), at least nb_samples of dst
+ * @param t0         progress at the first sample of dst
+ * @param dt         progress between two samples
+ */
+void mix_transition_audio(Transition *tr, AVFrame *dst, const AVFrame *src, double t0, double dt);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Get the gains of the outgoing and incoming clips at a point of a transition,
+ * and how fast they change. Gains are piecewise linear in t (constant outside 0 to 1)
+ * @param type  TransitionType
+ * @param t     progress of the transition
+ * @param ga    output gain of the outgoing clip
+ * @param gb    output gain of the incoming clip
+ * @param da    output change of ga per unit of t
+ * @param db    output change of gb per unit of t
+ * @return      next value of t where the gains change slope (> t), or INFINITY
+ */
+double get_transition_gains(TransitionType type, double t, float *ga, float *gb, float *da, float *db);
+
+/**
+ * Blend a row of bytes: dst = a + (b - a) * w / 32768
+ * @param dst output row (can be a or b)
+ * @param a   first row
+ * @param b   second row
+ * @param n   number of bytes
+ * @param w   weight of b (0 to 32767)
+ */
+void blend_row_8(uint8_t *dst, const uint8_t *a, const uint8_t *b, int n, int w);
+
+/**
+ * Blend a row of 16 bit words holding at most 14 bits: dst = a + (b - a) * w / 32768
+ * @param dst output row (can be a or b)
+ * @param a   first row
+ * @param b   second row
+ * @param n   number of words
+ * @param w   weight of b (0 to 32767)
+ */
+void blend_row_16(uint16_t *dst, const uint16_t *a, const uint16_t *b, int n, int w);
+
+/**
+ * Mix two rows of float samples with linear gain ramps:
+ * dst[i] = a[i] * (ga + i * da) + b[i] * (gb + i * db)
+ * @param dst output samples (can be a)
+ * @param a   first samples
+ * @param b   second samples
+ * @param n   number of samples
+ * @param ga  gain of a at the first sample
+ * @param da  change of the gain of a per sample
+ * @param gb  gain of b at the first sample
+ * @param db  change of the gain of b per sample
+ */
+void mix_row_float(float *dst, const float *a, const float *b, int n, float ga, float da, float gb, float db);
+
+#endif
@@ -16,6 +16,10 @@
 #include <libavutil/pixdesc.h>
 #include <stdbool.h>
 #include <sys/stat.h>
+#include "Log.h"
+
+/* max packets kept past the end of a clip for the next clip of the same file (see Clip API) */
+#define VIDEO_READ_AHEAD_MAX_PACKETS 256
 
 enum PacketStreamType { DEC_STREAM_NONE = -1, DEC_STREAM_VIDEO, DEC_STREAM_AUDIO };
 
@@ -60,6 +64,23 @@ typedef struct VideoContext {
     */
     char *url;
 
+    /*
+        filename of proxy media (low resolution copy of url with identical timestamps).
+        NULL when there is no proxy. When use_proxy is true, the proxy is opened
+        instead of url (see Proxy API)
+     */
+    char *proxy_url;
+    bool use_proxy;
+
+    /*
+        Video decoding speed/quality options, applied when the file is opened.
+        lowres: decode at 1/(2^lowres) resolution (clamped to what the codec supports)
+        fast_decode: allow non spec compliant speedups and skip the loop filter
+        (see set_video_decode_options())
+     */
+    int lowres;
+    bool fast_decode;
+
     /*
         Timebases fetched when the file is first opened.
         After the file is open, get timebase from here to avoid opening the file again
@@ -85,6 +106,28 @@ typedef struct VideoContext {
      */
     int64_t curr_pts;
 
+    /*
+        pts of the last video frame output by random access decoding (see FrameCache API),
+        -1 when the decoder was not left there by random access.
+        Every seek flushes the video decoder and resets this
+     */
+    int64_t last_decoded_pts;
+
+    /*
+        packets read past the end of a clip (read_ahead_nb of them from read_ahead_start),
+        returned by read_video_context_packet() before the file is read again.
+        Every seek drops them
+     */
+    AVPacket **read_ahead;
+    int read_ahead_start, read_ahead_nb, read_ahead_size;
+
+    /*
+        orig_end_pts of the clip whose read cycle left the file at its end with nothing
+        dropped, so the next clip of this file can read on without seeking.
+        -1 when the read position is unknown. Every seek resets this
+     */
+    int64_t read_end_pts;
+
     /*
         number of clips associated with this VideoContext.
         We must only free a VideoContext when the last clip using it is freed
@@ -115,6 +158,35 @@ int open_format_context(VideoContext *vid_ctx, char *filename);
 */
 int open_codec_context(VideoContext *vid_ctx, enum AVMediaType type);
 
+/**
+ * Open the decoder of a stream and attach it to the VideoContext
+ * @param  vid_ctx      VideoContext with open format context
+ * @param  type         AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO
+ * @param  stream_index index of stream in fmt_ctx->streams
+ * @param  codec        decoder of the stream
+ * @return              >= 0 on success
+ */
+int open_stream_decoder(VideoContext *vid_ctx, enum AVMediaType type, int stream_index, AVCodec *codec);
+
+/**
+ * Open a clone of an opened VideoContext: the same file and streams, with its own demuxer,
+ * decoders and read position, so another thread can read it at the same time.
+ * The probe of the source is reused (input format, stream info, codec parameters, file stats):
+ * only the container header is read again. The source must not be read while it is cloned
+ * @param  src   opened VideoContext
+ * @param  clone output VideoContext allocated on heap (free with free_video_context())
+ * @return       >= 0 on success
+ */
+int clone_video_context(VideoContext *src, VideoContext **clone);
+
+/**
+ * Open the format context and decoders of a clone (see clone_video_context())
+ * @param  vid_ctx VideoContext initialized with the options of src
+ * @param  src     opened VideoContext
+ * @return         >= 0 on success
+ */
+int open_cloned_video_context(VideoContext *vid_ctx, VideoContext *src);
+
 
 void init_video_context(VideoContext *vid_ctx);
 
@@ -127,6 +199,78 @@ void close_video_context(VideoContext *vid_ctx);
  */
 void free_video_context(VideoContext **vc);
 
+/**
+ * Get the filename opened by a VideoContext (proxy when in use, url otherwise)
+ * @param  vid_ctx VideoContext
+ * @return         filename to open
+ */
+char *get_video_context_url(VideoContext *vid_ctx);
+
+/**
+ * Map a VideoContext to its proxy media
+ * @param  vid_ctx   VideoContext of original file
+ * @param  proxy_url filename of proxy (copied)
+ * @return           >= 0 on success
+ */
+int set_video_context_proxy(VideoContext *vid_ctx, char *proxy_url);
+
+/**
+ * Apply the decoding speed/quality options of a VideoContext to a video decoder
+ * (before the decoder is opened)
+ * @param vid_ctx   VideoContext
+ * @param codec     video decoder
+ * @param codec_ctx video decoder context
+ */
+void set_video_decode_options(VideoContext *vid_ctx, AVCodec *codec, AVCodecContext *codec_ctx);
+
+/**
+ * Tell the demuxer to skip every stream except the selected video and audio streams.
+ * Packets from discarded streams (data, timecode, extra audio tracks..) are never
+ * returned by av_read_frame(), so we don't pay to copy and unref them.
+ * Call this function after open_codec_context() has selected the streams
+ * @param vid_ctx VideoContext with open format context
+ */
+void discard_unused_streams(VideoContext *vid_ctx);
+
+/**
+ * Enable or disable demuxing of a single stream
+ * @param vid_ctx    VideoContext with open format context
+ * @param stream_idx index of stream in fmt_ctx->streams (ignored if -1)
+ * @param discard    when true, the demuxer will skip all packets of this stream
+ */
+void set_stream_discard(VideoContext *vid_ctx, int stream_idx, bool discard);
+
+/**
+ * Read the next packet of a file: packets kept by keep_read_ahead_packet() first,
+ * then av_read_frame()
+ * @param  vid_ctx opened VideoContext
+ * @param  pkt     output packet
+ * @return         >= 0 on success, < 0 on EOF or error (as av_read_frame())
+ */
+int read_video_context_packet(VideoContext *vid_ctx, AVPacket *pkt);
+
+/**
+ * Keep a packet to be returned by read_video_context_packet()
+ * @param  vid_ctx opened VideoContext
+ * @param  pkt     packet (the reference is moved, or unreferenced on failure)
+ * @return         >= 0 on success, < 0 when VIDEO_READ_AHEAD_MAX_PACKETS are already kept
+ */
+int keep_read_ahead_packet(VideoContext *vid_ctx, AVPacket *pkt);
+
+/**
+ * Drop the packets kept by keep_read_ahead_packet()
+ * @param vid_ctx VideoContext
+ */
+void clear_read_ahead_packets(VideoContext *vid_ctx);
+
+/**
+ * Check if a stream is discarded by the demuxer
+ * @param  vid_ctx    VideoContext with open format context
+ * @param  stream_idx index of stream in fmt_ctx->streams (-1 is never discarded)
+ * @return            true if the demuxer skips all packets of this stream
+ */
+bool is_stream_discarded(VideoContext *vid_ctx, int stream_idx);
+
 /**
  * Check if AVRational is valid
  * @param  r AVRational to check
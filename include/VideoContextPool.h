@@ -0,0 +1,91 @@
+/**
+ * @file VideoContextPool.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for VideoContextPool API:
+ * Clips of a file share one VideoContext (one demuxer, decoder and read position), so only
+ * one thread can read a file at a time. A pool hands out one clone of each source
+ * VideoContext per worker thread (see clone_video_context()), opened on first use and
+ * kept for the life of the pool, so threads read different ranges of the same file at once.
+ */
+
+#ifndef _VIDEO_CONTEXT_POOL_API_
+#define _VIDEO_CONTEXT_POOL_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "Clip.h"
+
+/*
+    Clones of one source VideoContext
+ */
+typedef struct VideoContextClones {
+    VideoContext *src;
+    /*
+        one per thread (NULL until the thread first asks for it)
+     */
+    VideoContext **clones;
+} VideoContextClones;
+
+typedef struct VideoContextPool {
+    /*
+        sources with clones (pointers stay valid while the array grows)
+     */
+    VideoContextClones **sources;
+    int nb_sources, sources_size;
+    /*
+        number of threads (thread_idx is 0 to nb_threads - 1)
+     */
+    int nb_threads;
+    /*
+        protects the list of sources. Each clone is only used by its own thread
+     */
+    pthread_mutex_t lock;
+} VideoContextPool;
+
+/**
+ * Initialize an empty pool
+ * @param  pool       VideoContextPool
+ * @param  nb_threads number of threads taking clones (ex: get_thread_pool_size())
+ * @return            >= 0 on success
+ */
+int init_video_context_pool(VideoContextPool *pool, int nb_threads);
+
+/**
+ * Get the clone of a source VideoContext owned by a thread, opening it on first use.
+ * The source must not be read while clones are opened
+ * @param  pool       VideoContextPool
+ * @param  src        opened source VideoContext
+ * @param  thread_idx index of the calling thread
+ * @return            clone, NULL on error
+ */
+VideoContext *get_pooled_video_context(VideoContextPool *pool, VideoContext *src, int thread_idx);
+
+/**
+ * Copy a clip (same file and bounds) reading through the clone of a thread.
+ * The copy is opened and seeked to its start
+ * @param  pool       VideoContextPool
+ * @param  src        opened Clip
+ * @param  thread_idx index of the calling thread
+ * @return            Clip allocated on heap (free_clip() when done), NULL on error
+ */
+Clip *copy_clip_pooled_vc(VideoContextPool *pool, Clip *src, int thread_idx);
+
+/**
+ * Close and free every clone of the pool (clones still used by clips are freed
+ * with their last clip)
+ * @param pool VideoContextPool
+ */
+void free_video_context_pool(VideoContextPool *pool);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Find the clones of a source, adding them when missing
+ * @param  pool VideoContextPool
+ * @param  src  source VideoContext
+ * @return      clones of the source, NULL on error
+ */
+VideoContextClones *find_video_context_clones(VideoContextPool *pool, VideoContext *src);
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ * @file VideoConvert.h
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the definition and usage for VideoConvert API:
+ * Scaling and pixel format conversion of decoded video frames into the
+ * output (encoder) format. One set of SwsContexts is cached per source format,
+ * and frames that already match the output format are passed through untouched.
+ */
+
+#ifndef _VIDEO_CONVERT_API_
+#define _VIDEO_CONVERT_API_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+#include "LinkedListAPI.h"
+#include "ThreadPool.h"
+
+/* scaling algorithm used by all SwsContexts */
+#define VIDEO_CONVERT_SWS_FLAGS SWS_BICUBIC
+
+/* minimum number of output rows in a slice (smaller frames use fewer slices) */
+#define VIDEO_CONVERT_MIN_SLICE_H 32
+
+/*
+    Horizontal band of a frame converted by a single thread
+ */
+typedef struct VideoConvertSlice {
+    struct SwsContext *sws_ctx;
+    /*
+        first row and number of rows of the band in the source and output frames
+     */
+    int src_y, src_h;
+    int dst_y, dst_h;
+} VideoConvertSlice;
+
+/*
+    Cached conversion from one source format into the output format
+ */
+typedef struct VideoConvertCache {
+    /*
+        source format (the cache key)
+     */
+    int width, height;
+    enum AVPixelFormat pix_fmt;
+    VideoConvertSlice *slices;
+    int nb_slices;
+} VideoConvertCache;
+
+typedef struct VideoConverter {
+    /*
+        output format
+     */
+    int width, height;
+    enum AVPixelFormat pix_fmt;
+    /*
+        List of VideoConvertCache (one per source format seen)
+     */
+    List cache;
+    /*
+        cache entry used by the last frame. Consecutive frames of a clip skip the list search
+     */
+    VideoConvertCache *last;
+    /*
+        threads used to convert slices in parallel
+     */
+    ThreadPool pool;
+    /*
+        output frame (reused when the encoder holds no reference to it)
+     */
+    AVFrame *frame;
+    /*
+        internal use only. source frame and cache of the current convert_video_frame() call
+     */
+    AVFrame *job_src;
+    VideoConvertCache *job_cache;
+    bool open;
+} VideoConverter;
+
+/**
+ * Initialize VideoConverter with default values (does not allocate)
+ * @param vc VideoConverter
+ */
+void init_video_converter(VideoConverter *vc);
+
+/**
+ * Open a VideoConverter for an output format
+ * @param  vc         VideoConverter initialized with init_video_converter()
+ * @param  width      output width
+ * @param  height     output height
+ * @param  pix_fmt    output pixel format
+ * @param  nb_threads number of threads used to convert slices of a frame (<= 0 for one per cpu core)
+ * @return            >= 0 on success
+ */
+int open_video_converter(VideoConverter *vc, int width, int height, enum AVPixelFormat pix_fmt, int nb_threads);
+
+/**
+ * Convert a decoded frame into the output format.
+ * If the frame already matches the output format, it is left untouched.
+ * Otherwise the frame is replaced with a reference to the converted frame
+ * (all frame properties such as pts are kept)
+ * @param  vc    VideoConverter
+ * @param  frame decoded video frame (input and output)
+ * @return       >= 0 on success
+ */
+int convert_video_frame(VideoConverter *vc, AVFrame *frame);
+
+/**
+ * Check if a frame needs conversion to match the output format
+ * @param  vc    VideoConverter
+ * @param  frame video frame
+ * @return       true if frame already matches output format
+ */
+bool video_frame_matches(VideoConverter *vc, AVFrame *frame);
+
+/**
+ * Free all cached SwsContexts, threads and the output frame
+ * @param vc VideoConverter
+ */
+void close_video_converter(VideoConverter *vc);
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Find the cache entry for the source format of a frame (allocating it if needed)
+ * @param  vc    VideoConverter
+ * @param  frame source frame
+ * @return       NULL on fail, not NULL on success
+ */
+VideoConvertCache *get_video_convert_cache(VideoConverter *vc, AVFrame *frame);
+
+/**
+ * Allocate a cache entry and its SwsContexts for a source format
+ * @param  vc      VideoConverter
+ * @param  width   source width
+ * @param  height  source height
+ * @param  pix_fmt source pixel format
+ * @return         NULL on fail, not NULL on success
+ */
+VideoConvertCache *alloc_video_convert_cache(VideoConverter *vc, int width, int height, enum AVPixelFormat pix_fmt);
+
+/**
+ * Split the output frame into horizontal bands, one per thread.
+ * Only frames converted without any vertical scaling are split (same height and vertical
+ * chroma subsampling): a band scaled on its own has no filter taps across its edges.
+ * Band edges are aligned to chroma rows
+ * @param  vcc        cache entry with source format set
+ * @param  vc         VideoConverter with output format
+ * @param  nb_slices  number of bands wanted
+ * @return            number of bands created (1 when the frame cannot be split)
+ */
+int set_video_convert_slices(VideoConvertCache *vcc, VideoConverter *vc, int nb_slices);
+
+/**
+ * Make sure the output frame has a buffer we can write into
+ * @param  vc VideoConverter
+ * @return    >= 0 on success
+ */
+int get_video_convert_buffer(VideoConverter *vc);
+
+/**
+ * ThreadPoolJob converting a single slice of the current frame
+ * @param arg        VideoConverter
+ * @param job_idx    index of slice
+ * @param thread_idx unused
+ */
+void convert_video_slice(void *arg, int job_idx, int thread_idx);
+
+/**
+ * Get the plane pointers of a frame starting at a row
+ * @param frame  AVFrame
+ * @param y      row (in luma rows)
+ * @param data   output plane pointers
+ */
+void get_frame_rows(AVFrame *frame, int y, uint8_t *data[AV_NUM_DATA_POINTERS]);
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a cache entry in a string
+ * @param  toBePrinted VideoConvertCache
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_video_convert_cache(void *toBePrinted);
+
+/**
+ * Free cache entry and all its SwsContexts
+ * @param toBeDeleted VideoConvertCache allocated on heap
+ */
+void list_delete_video_convert_cache(void *toBeDeleted);
+
+/**
+ * Compare two cache entries by source format
+ * @param  first  first VideoConvertCache
+ * @param  second second VideoConvertCache
+ * @return        0 if source formats are equal, non zero otherwise
+ */
+int list_compare_video_convert_cache(const void *first, const void *second);
+
+#endif
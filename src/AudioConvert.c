@@ -0,0 +1,417 @@
+/**
+ * @file AudioConvert.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the source for AudioConvert API:
+ * Resampling of decoded audio frames into the output (encoder) format, and
+ * re-chunking of samples into frames of the encoder frame_size.
+ * One SwrContext is cached per source format, and frames that already match
+ * the output format (and frame size) are passed through untouched.
+ */
+
+#include "AudioConvert.h"
+
+/**
+ * Initialize AudioConverter with default values (does not allocate)
+ * @param ac AudioConverter
+ */
+void init_audio_converter(AudioConverter *ac) {
+    ac->sample_rate = 0;
+    ac->sample_fmt = AV_SAMPLE_FMT_NONE;
+    ac->channel_layout = 0;
+    ac->channels = 0;
+    ac->frame_size = 0;
+    ac->time_base = (AVRational){0, 1};
+    ac->cache = initializeList(&list_print_audio_convert_cache,
+                &list_delete_audio_convert_cache, &list_compare_audio_convert_cache);
+    ac->last = NULL;
+    ac->fifo = NULL;
+    ac->samples = NULL;
+    ac->samples_size = 0;
+    ac->pass_frame = NULL;
+    ac->start_pts = AV_NOPTS_VALUE;
+    ac->nb_samples_out = 0;
+    ac->flushing = false;
+    ac->open = false;
+}
+
+/**
+ * Open an AudioConverter for the format of an audio encoder
+ * @param  ac AudioConverter initialized with init_audio_converter()
+ * @param  c  opened audio encoder
+ * @return    >= 0 on success
+ */
+int open_audio_converter(AudioConverter *ac, AVCodecContext *c) {
+    if(ac == NULL || ac->open || c == NULL) {
+        log_error("open_audio_converter() error: Invalid params\n");
+        return -1;
+    }
+    ac->sample_rate = c->sample_rate;
+    ac->sample_fmt = c->sample_fmt;
+    ac->channels = c->channels;
+    ac->channel_layout = c->channel_layout;
+    if(ac->channel_layout == 0) {
+        ac->channel_layout = av_get_default_channel_layout(c->channels);
+    }
+    // encoders with a variable frame size accept frames of any size
+    ac->frame_size = c->frame_size;
+    if(c->codec != NULL && (c->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)) {
+        ac->frame_size = 0;
+    }
+    ac->time_base = c->time_base;
+    ac->fifo = av_audio_fifo_alloc(ac->sample_fmt, ac->channels, FFMAX(ac->frame_size, 1));
+    ac->pass_frame = av_frame_alloc();
+    if(ac->fifo == NULL || ac->pass_frame == NULL) {
+        log_error("open_audio_converter() error: Failed to allocate fifo\n");
+        av_audio_fifo_free(ac->fifo);
+        ac->fifo = NULL;
+        av_frame_free(&(ac->pass_frame));
+        return AVERROR(ENOMEM);
+    }
+    ac->open = true;
+    return 0;
+}
+
+/**
+ * Send a decoded audio frame to the converter.
+ * The frame data is consumed (frame is unreferenced)
+ * @param  ac    AudioConverter
+ * @param  frame decoded audio frame
+ * @return       >= 0 on success
+ */
+int send_audio_convert_frame(AudioConverter *ac, AVFrame *frame) {
+    if(!ac->open || ac->flushing) {
+        log_error("send_audio_convert_frame() error: converter is not accepting frames\n");
+        return -1;
+    }
+    AudioConvertCache *prev = ac->last;
+    AudioConvertCache *acc = get_audio_convert_cache(ac, frame);
+    if(acc == NULL) {
+        return -1;
+    }
+    int ret;
+    if(prev != NULL && prev != acc && !prev->bypass) {
+        // source format changed: samples delayed in the last resampler come first
+        ret = write_audio_convert_fifo(ac, prev, NULL, 0);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    if(ac->start_pts == AV_NOPTS_VALUE) {
+        ac->start_pts = frame->pts;
+    }
+    // fast path: frame can be sent to the encoder as it is
+    if(acc->bypass && ac->pass_frame->buf[0] == NULL && av_audio_fifo_size(ac->fifo) == 0
+        && (ac->frame_size == 0 || frame->nb_samples == ac->frame_size)) {
+        av_frame_move_ref(ac->pass_frame, frame);
+        return 0;
+    }
+    ret = write_audio_convert_fifo(ac, acc, (const uint8_t **)frame->extended_data, frame->nb_samples);
+    av_frame_unref(frame);
+    return ret;
+}
+
+/**
+ * Receive an audio frame in the output format and frame size
+ * @param  ac    AudioConverter
+ * @param  frame output frame (unreferenced before being filled)
+ * @return       0 when a frame was received,
+ *               AVERROR(EAGAIN) when more frames must be sent,
+ *               AVERROR_EOF when the converter has been fully flushed,
+ *               other < 0 on error
+ */
+int receive_audio_convert_frame(AudioConverter *ac, AVFrame *frame) {
+    if(!ac->open) {
+        return ac->flushing ? AVERROR_EOF : AVERROR(EAGAIN);
+    }
+    if(ac->pass_frame->buf[0] != NULL) {
+        av_frame_unref(frame);
+        av_frame_move_ref(frame, ac->pass_frame);
+        set_audio_convert_pts(ac, frame);
+        return 0;
+    }
+    int size = av_audio_fifo_size(ac->fifo);
+    int nb_samples = ac->frame_size > 0 ? ac->frame_size : size;
+    if(size > 0 && (size >= nb_samples || ac->flushing)) {
+        // the last frame may be shorter than frame_size
+        return read_audio_convert_fifo(ac, frame, FFMIN(size, nb_samples));
+    }
+    return ac->flushing ? AVERROR_EOF : AVERROR(EAGAIN);
+}
+
+/**
+ * Signal that no more frames will be sent. The remaining samples (including
+ * the samples delayed within the resampler) are output by receive_audio_convert_frame()
+ * @param  ac AudioConverter
+ * @return    >= 0 on success
+ */
+int flush_audio_converter(AudioConverter *ac) {
+    int ret = 0;
+    if(ac->open && !ac->flushing && ac->last != NULL && !ac->last->bypass) {
+        ret = write_audio_convert_fifo(ac, ac->last, NULL, 0);
+    }
+    ac->flushing = true;
+    return ret;
+}
+
+/**
+ * Check if a frame needs resampling to match the output format
+ * @param  ac    AudioConverter
+ * @param  frame audio frame
+ * @return       true if frame already matches output format
+ */
+bool audio_frame_matches(AudioConverter *ac, AVFrame *frame) {
+    return frame->sample_rate == ac->sample_rate && frame->format == ac->sample_fmt
+            && get_frame_channel_layout(frame) == ac->channel_layout;
+}
+
+/**
+ * Free all cached SwrContexts and buffered samples
+ * @param ac AudioConverter
+ */
+void close_audio_converter(AudioConverter *ac) {
+    if(ac->open) {
+        clearList(&(ac->cache));
+        ac->cache.length = 0;
+        ac->last = NULL;
+        av_audio_fifo_free(ac->fifo);
+        ac->fifo = NULL;
+        if(ac->samples != NULL) {
+            av_freep(&(ac->samples[0]));
+        }
+        av_freep(&(ac->samples));
+        ac->samples_size = 0;
+        av_frame_free(&(ac->pass_frame));
+        ac->open = false;
+    }
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Get the channel layout of a frame (default layout when the decoder did not set it)
+ * @param  frame audio frame
+ * @return       channel layout
+ */
+uint64_t get_frame_channel_layout(AVFrame *frame) {
+    if(frame->channel_layout != 0) {
+        return frame->channel_layout;
+    }
+    return av_get_default_channel_layout(frame->channels);
+}
+
+/**
+ * Find the cache entry for the source format of a frame (allocating it if needed)
+ * @param  ac    AudioConverter
+ * @param  frame source frame
+ * @return       NULL on fail, not NULL on success
+ */
+AudioConvertCache *get_audio_convert_cache(AudioConverter *ac, AVFrame *frame) {
+    AudioConvertCache key;
+    key.sample_rate = frame->sample_rate;
+    key.sample_fmt = frame->format;
+    key.channel_layout = get_frame_channel_layout(frame);
+    // most frames come from the same clip as the last frame
+    if(ac->last != NULL && list_compare_audio_convert_cache(ac->last, &key) == 0) {
+        return ac->last;
+    }
+    Node *curr = ac->cache.head;
+    while(curr != NULL) {
+        if(list_compare_audio_convert_cache(curr->data, &key) == 0) {
+            ac->last = (AudioConvertCache *) curr->data;
+            return ac->last;
+        }
+        curr = curr->next;
+    }
+    AudioConvertCache *acc = alloc_audio_convert_cache(ac, key.sample_rate,
+                                key.sample_fmt, key.channel_layout);
+    if(acc == NULL) {
+        return NULL;
+    }
+    insertBack(&(ac->cache), acc);
+    ac->last = acc;
+    return acc;
+}
+
+/**
+ * Allocate a cache entry and its SwrContext for a source format
+ * @param  ac             AudioConverter
+ * @param  sample_rate    source sample rate
+ * @param  sample_fmt     source sample format
+ * @param  channel_layout source channel layout
+ * @return                NULL on fail, not NULL on success
+ */
+AudioConvertCache *alloc_audio_convert_cache(AudioConverter *ac, int sample_rate,
+                    enum AVSampleFormat sample_fmt, uint64_t channel_layout) {
+    AudioConvertCache *acc = malloc(sizeof(struct AudioConvertCache));
+    if(acc == NULL) {
+        log_error("alloc_audio_convert_cache() error: Failed to allocate cache\n");
+        return NULL;
+    }
+    acc->sample_rate = sample_rate;
+    acc->sample_fmt = sample_fmt;
+    acc->channel_layout = channel_layout;
+    acc->bypass = (sample_rate == ac->sample_rate && sample_fmt == ac->sample_fmt
+                    && channel_layout == ac->channel_layout);
+    acc->swr_ctx = NULL;
+    if(acc->bypass) {
+        return acc;
+    }
+    acc->swr_ctx = swr_alloc_set_opts(NULL, ac->channel_layout, ac->sample_fmt, ac->sample_rate,
+                                      channel_layout, sample_fmt, sample_rate, 0, NULL);
+    int ret = acc->swr_ctx == NULL ? AVERROR(ENOMEM) : swr_init(acc->swr_ctx);
+    if(ret < 0) {
+        log_error("alloc_audio_convert_cache() error: Cannot convert %dHz %s into %dHz %s (%s)\n",
+                sample_rate, av_get_sample_fmt_name(sample_fmt), ac->sample_rate,
+                av_get_sample_fmt_name(ac->sample_fmt), av_err2str(ret));
+        list_delete_audio_convert_cache(acc);
+        return NULL;
+    }
+    log_debug("AudioConvert: %dHz %s %d channels -> %dHz %s %d channels\n", sample_rate,
+            av_get_sample_fmt_name(sample_fmt), av_get_channel_layout_nb_channels(channel_layout),
+            ac->sample_rate, av_get_sample_fmt_name(ac->sample_fmt), ac->channels);
+    return acc;
+}
+
+/**
+ * Resample source samples into the fifo
+ * @param  ac         AudioConverter
+ * @param  acc        cache entry of source format
+ * @param  data       source samples (NULL to drain the samples delayed within the resampler)
+ * @param  nb_samples number of source samples
+ * @return            >= 0 on success
+ */
+int write_audio_convert_fifo(AudioConverter *ac, AudioConvertCache *acc,
+                    const uint8_t **data, int nb_samples) {
+    int ret;
+    if(acc->bypass) {
+        ret = av_audio_fifo_write(ac->fifo, (void **)data, nb_samples);
+        if(ret < nb_samples) {
+            log_error("write_audio_convert_fifo() error: Failed to write samples into fifo\n");
+            return ret < 0 ? ret : AVERROR(ENOMEM);
+        }
+        return 0;
+    }
+    // grow the resampler output buffer when needed (it is reused between frames)
+    int out_samples = swr_get_out_samples(acc->swr_ctx, nb_samples);
+    if(out_samples <= 0) {
+        return 0;
+    }
+    if(out_samples > ac->samples_size) {
+        if(ac->samples != NULL) {
+            av_freep(&(ac->samples[0]));
+        }
+        av_freep(&(ac->samples));
+        ret = av_samples_alloc_array_and_samples(&(ac->samples), NULL, ac->channels,
+                                                 out_samples, ac->sample_fmt, 0);
+        if(ret < 0) {
+            log_error("write_audio_convert_fifo() error: Failed to allocate samples\n");
+            ac->samples_size = 0;
+            return ret;
+        }
+        ac->samples_size = out_samples;
+    }
+    ret = swr_convert(acc->swr_ctx, ac->samples, ac->samples_size, data, nb_samples);
+    if(ret < 0) {
+        log_error("write_audio_convert_fifo() error: Failed to resample [%s]\n", av_err2str(ret));
+        return ret;
+    }
+    out_samples = ret;
+    ret = av_audio_fifo_write(ac->fifo, (void **)ac->samples, out_samples);
+    if(ret < out_samples) {
+        log_error("write_audio_convert_fifo() error: Failed to write samples into fifo\n");
+        return ret < 0 ? ret : AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
+/**
+ * Read samples from the fifo into a new output frame
+ * @param  ac         AudioConverter
+ * @param  frame      output frame
+ * @param  nb_samples number of samples to read
+ * @return            >= 0 on success
+ */
+int read_audio_convert_fifo(AudioConverter *ac, AVFrame *frame, int nb_samples) {
+    av_frame_unref(frame);
+    frame->nb_samples = nb_samples;
+    frame->format = ac->sample_fmt;
+    frame->sample_rate = ac->sample_rate;
+    frame->channel_layout = ac->channel_layout;
+    frame->channels = ac->channels;
+    int ret = av_frame_get_buffer(frame, 0);
+    if(ret < 0) {
+        log_error("read_audio_convert_fifo() error: Failed to allocate frame buffer\n");
+        return ret;
+    }
+    ret = av_audio_fifo_read(ac->fifo, (void **)frame->extended_data, nb_samples);
+    if(ret < nb_samples) {
+        log_error("read_audio_convert_fifo() error: Failed to read samples from fifo\n");
+        av_frame_unref(frame);
+        return ret < 0 ? ret : -1;
+    }
+    set_audio_convert_pts(ac, frame);
+    return 0;
+}
+
+/**
+ * Set the pts of an output frame and count its samples
+ * @param ac    AudioConverter
+ * @param frame output frame
+ */
+void set_audio_convert_pts(AudioConverter *ac, AVFrame *frame) {
+    frame->pts = ac->start_pts + av_rescale_q(ac->nb_samples_out,
+                    (AVRational){1, ac->sample_rate}, ac->time_base);
+    ac->nb_samples_out += frame->nb_samples;
+}
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a cache entry in a string
+ * @param  toBePrinted AudioConvertCache
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_audio_convert_cache(void *toBePrinted) {
+    char buf[256];
+    buf[0] = 0;
+    if(toBePrinted != NULL) {
+        AudioConvertCache *acc = (AudioConvertCache *) toBePrinted;
+        sprintf(buf, "%dHz %s %d channels (bypass: %d)", acc->sample_rate,
+                av_get_sample_fmt_name(acc->sample_fmt),
+                av_get_channel_layout_nb_channels(acc->channel_layout), acc->bypass);
+    }
+    char *str = malloc(sizeof(char) * (strlen(buf) + 1));
+    strcpy(str, buf);
+    return str;
+}
+
+/**
+ * Free cache entry and its SwrContext
+ * @param toBeDeleted AudioConvertCache allocated on heap
+ */
+void list_delete_audio_convert_cache(void *toBeDeleted) {
+    if(toBeDeleted == NULL) {
+        return;
+    }
+    AudioConvertCache *acc = (AudioConvertCache *) toBeDeleted;
+    swr_free(&(acc->swr_ctx));
+    free(acc);
+}
+
+/**
+ * Compare two cache entries by source format
+ * @param  first  first AudioConvertCache
+ * @param  second second AudioConvertCache
+ * @return        0 if source formats are equal, non zero otherwise
+ */
+int list_compare_audio_convert_cache(const void *first, const void *second) {
+    AudioConvertCache *f = (AudioConvertCache *) first;
+    AudioConvertCache *s = (AudioConvertCache *) second;
+    if(f->sample_rate != s->sample_rate) {
+        return f->sample_rate - s->sample_rate;
+    } else if(f->sample_fmt != s->sample_fmt) {
+        return f->sample_fmt - s->sample_fmt;
+    } else if(f->channel_layout != s->channel_layout) {
+        return f->channel_layout < s->channel_layout ? -1 : 1;
+    }
+    return 0;
+}
@@ -17,12 +17,12 @@
  */
 Clip *copy_clip_vc(Clip *src) {
     if(src == NULL || src->vid_ctx == NULL) {
-        fprintf(stderr, "copy_clip_vc() error: Invalid params\n");
+        log_error("copy_clip_vc() error: Invalid params\n");
         return NULL;
     }
     Clip *copy = alloc_clip_internal();
     if(copy == NULL) {
-        fprintf(stderr, "copy_clip_vc() error: Failed to allocate new clip\n");
+        log_error("copy_clip_vc() error: Failed to allocate new clip\n");
         return NULL;
     }
     copy->vid_ctx = src->vid_ctx;
@@ -65,7 +65,7 @@ Clip *alloc_clip(char *url) {
  */
 int init_clip_internal(Clip *clip) {
     if(clip == NULL) {
-        fprintf(stderr, "init_clip_internal() error: Invalid params\n");
+        log_error("init_clip_internal() error: Invalid params\n");
         return -1;
     }
     clip->vid_ctx = NULL;
@@ -73,9 +73,14 @@ int init_clip_internal(Clip *clip) {
     clip->orig_end_pts = -1;
     clip->start_pts = -1;
     clip->end_pts = -1;
+    clip->transition.type = TRANSITION_NONE;
+    memset(clip->transition.color, 0, sizeof(clip->transition.color));
     clip->done_reading_video = false;
     clip->done_reading_audio = false;
+    clip->read_cycle_done = false;
+    clip->read_ahead_lost = false;
     clip->frame_index = 0;
+    init_render_stats(&(clip->stats));
     return 0;
 }
 
@@ -92,14 +97,14 @@ int init_clip(Clip *clip, char *url) {
     }
     clip->vid_ctx = (VideoContext *)malloc(sizeof(struct VideoContext));
     if(clip->vid_ctx == NULL) {
-        fprintf(stderr, "init_clip() error: Failed to allocate vid_ctx\n");
+        log_error("init_clip() error: Failed to allocate vid_ctx\n");
         return -1;
     }
     init_video_context(clip->vid_ctx);
     clip->vid_ctx->clip_count = 1;
     clip->vid_ctx->url = malloc(strlen(url) + 1);
     if(clip->vid_ctx->url == NULL) {
-        fprintf(stderr, "init_clip() error: Failed to allocate video_context filename[%s]\n", url);
+        log_error("init_clip() error: Failed to allocate video_context filename[%s]\n", url);
         return -1;
     }
     strcpy(clip->vid_ctx->url, url);
@@ -113,13 +118,16 @@ int init_clip(Clip *clip, char *url) {
  */
 int open_clip(Clip *clip) {
     if(clip == NULL) {
-        fprintf(stderr, "open_clip() error: NULL param\n");
+        log_error("open_clip() error: NULL param\n");
         return -1;
     }
     if(!(clip->vid_ctx->open)) {
         int ret;
-        if((ret = open_video_context(clip->vid_ctx, clip->vid_ctx->url)) < 0) {
-            fprintf(stderr, "open_clip() error: Failed to open VideoContext for clip[%s]\n", clip->vid_ctx->url);
+        int64_t start_ns = render_stats_start();
+        ret = open_video_context(clip->vid_ctx, get_video_context_url(clip->vid_ctx));
+        render_stats_add(&(clip->stats), AVMEDIA_TYPE_UNKNOWN, RENDER_STAGE_SEEK, start_ns, 0);
+        if(ret < 0) {
+            log_error("open_clip() error: Failed to open VideoContext for clip[%s]\n", clip->vid_ctx->url);
             // free_video_context(&(clip->vid_ctx));
             return ret;
         }
@@ -207,6 +215,7 @@ int set_clip_start(Clip *clip, int64_t pts) {
         clip->orig_start_pts = pts;
         clip->vid_ctx->seek_pts = pts;
         clip->vid_ctx->curr_pts = pts;
+        init_internal_vars(clip);
     }
     return ret;
 }
@@ -253,20 +262,25 @@ int seek_clip_pts(Clip *clip, int64_t pts) {
     int64_t abs_pts = pts + clip->orig_start_pts;
     if(pts < 0 || abs_pts > clip->orig_end_pts) {
         int64_t endBound = get_clip_end_frame_idx(clip);
-        fprintf(stderr, "seek_clip_pts() error: seek pts[%ld] outside of clip bounds (0 - %ld)\n", pts, endBound);
+        log_error("seek_clip_pts() error: seek pts[%ld] outside of clip bounds (0 - %ld)\n", pts, endBound);
         return -1;
     }
     int ret;
-    if((ret = seek_video_pts(clip->vid_ctx, abs_pts)) < 0) {
-        fprintf(stderr, "seek_clip_pts() error: Failed to seek to pts[%ld] on clip[%s]\n", abs_pts, clip->vid_ctx->url);
+    int64_t start_ns = render_stats_start();
+    ret = seek_video_pts(clip->vid_ctx, abs_pts);
+    render_stats_add(&(clip->stats), AVMEDIA_TYPE_UNKNOWN, RENDER_STAGE_SEEK, start_ns, 1);
+    if(ret < 0) {
+        log_error("seek_clip_pts() error: Failed to seek to pts[%ld] on clip[%s]\n", abs_pts, clip->vid_ctx->url);
         return ret;
     }
     clip->vid_ctx->seek_pts = abs_pts;
     if((ret = cov_video_pts(clip->vid_ctx, abs_pts)) < 0) {
-        fprintf(stderr, "seek_clip_pts error: Failed to convert pts to frame index\n");
+        log_error("seek_clip_pts error: Failed to convert pts to frame index\n");
         return ret;
     }
     clip->vid_ctx->curr_pts = clip->vid_ctx->seek_pts;
+    // seeking starts a new read cycle (streams may have been discarded by the last one)
+    init_internal_vars(clip);
     return 0;
 }
 
@@ -332,17 +346,64 @@ bool is_vc_out_bounds(Clip *clip) {
             clip->vid_ctx->seek_pts >= clip->orig_end_pts;
 }
 
+/**
+ * Start a read cycle of a clip whose VideoContext was used by another clip.
+ * When the last read cycle on the file ended before this clip, within a cheap distance
+ * (see can_resume_clip_read()), the file is read on without seeking. Otherwise seek_clip_pts(clip, 0)
+ * @param  clip Clip
+ * @return      >= 0 on success
+ */
+int resume_clip_read(Clip *clip) {
+    if(!can_resume_clip_read(clip)) {
+        return seek_clip_pts(clip, 0);
+    }
+    VideoContext *vid_ctx = clip->vid_ctx;
+    log_debug("resume_clip_read(): reading on from pts[%ld] to clip start[%ld] in [%s]\n",
+                vid_ctx->read_end_pts, clip->orig_start_pts, vid_ctx->url);
+    // frames before the clip start are decoded and skipped, as after a seek
+    vid_ctx->seek_pts = clip->orig_start_pts;
+    vid_ctx->curr_pts = clip->orig_start_pts;
+    vid_ctx->read_end_pts = -1;
+    init_internal_vars(clip);
+    return 0;
+}
+
+/**
+ * Check if a clip can be read by reading on from where the last read cycle on its
+ * VideoContext ended: nothing was dropped, the clip starts at or after that point and no key
+ * frame lies in between (a seek would land on it). The clip must start
+ * within CLIP_MAX_READ_FORWARD frames
+ * @param  clip Clip
+ * @return      true to read on, false to seek
+ */
+bool can_resume_clip_read(Clip *clip) {
+    VideoContext *vid_ctx = clip->vid_ctx;
+    if(!vid_ctx->open || vid_ctx->read_end_pts < 0) {
+        return false;
+    }
+    int64_t max_dist = get_video_frame_pts(vid_ctx, CLIP_MAX_READ_FORWARD);
+    return video_read_forward_cheaper(vid_ctx, vid_ctx->read_end_pts, clip->orig_start_pts, max_dist);
+}
+
 /**
  * Detects if we are done reading the current packet stream..
  * if true.. then the packet in parameter should be skipped over!
  * @param  clip clip
  * @param  pkt  AVPacket currently read
- * @return      true, if our clip has read the entire stream associated with this packet.
+ * @return      true, if our clip has read the entire stream associated with this packet
+ *              (or the packet is not from the clip video or audio stream).
  *              false, otherwise
  */
 bool done_curr_pkt_stream(Clip *clip, AVPacket *pkt) {
-    return (clip->done_reading_audio && pkt->stream_index == clip->vid_ctx->audio_stream_idx)
-        || (clip->done_reading_video && pkt->stream_index == clip->vid_ctx->video_stream_idx);
+    VideoContext *vid_ctx = clip->vid_ctx;
+    if(pkt->stream_index == vid_ctx->video_stream_idx) {
+        return clip->done_reading_video;
+    } else if(pkt->stream_index == vid_ctx->audio_stream_idx) {
+        return clip->done_reading_audio;
+    }
+    // Not a stream we use. These are normally discarded by the demuxer
+    // (discard_unused_streams()), but not every demuxer honours AVStream.discard
+    return true;
 }
 
 /**
@@ -361,58 +422,60 @@ bool done_curr_pkt_stream(Clip *clip, AVPacket *pkt) {
 int clip_read_packet(Clip *clip, AVPacket *pkt) {
     AVPacket tmpPkt;
     VideoContext *vid_ctx = clip->vid_ctx;
-    int ret, readPackets = 0;
-    do {
-        if(readPackets++ > 0) {
-            av_packet_unref(&tmpPkt);
-        }
+    int64_t video_end_pts = clip->orig_end_pts;
+    int64_t audio_end_pts = cov_video_to_audio_pts(vid_ctx, video_end_pts);
+    int ret;
+    // the last read cycle ended at the clip end: start again from the clip start
+    if(clip->read_cycle_done && (ret = reset_packet_counter(clip)) < 0) {
+        return ret;
+    }
+    int64_t start_ns = render_stats_start();
+    // Keep reading until we get a packet within clip bounds, or both streams are complete
+    while(!(clip->done_reading_video && clip->done_reading_audio)) {
         // If EOF (or error)
-        if((ret = av_read_frame(vid_ctx->fmt_ctx, &tmpPkt)) < 0) {
+        if((ret = read_video_context_packet(vid_ctx, &tmpPkt)) < 0) {
             *pkt = tmpPkt;
             reset_packet_counter(clip);
+            render_stats_add(&(clip->stats), AVMEDIA_TYPE_UNKNOWN, RENDER_STAGE_DEMUX, start_ns, 0);
             return ret;
         }
-    } while(done_curr_pkt_stream(clip, &tmpPkt));   // Skip by packets from finished stream
-
-    int64_t video_end_pts = clip->orig_end_pts;
-    int64_t audio_end_pts = cov_video_to_audio_pts(vid_ctx, video_end_pts);
-    if(tmpPkt.stream_index == vid_ctx->video_stream_idx) {
-        // If packet is past, or equal to the end_frame_pts (outside of clip)
-        // This performs exclusive end_pts
-        if(tmpPkt.pts >= video_end_pts) {
-            clip->done_reading_video = true;
-
-            // Recursion to read the rest of audio frames
-            if(!clip->done_reading_audio) {
-                av_packet_unref(&tmpPkt);
-                return clip_read_packet(clip, pkt);
-            }
-        } else {
-            *pkt = tmpPkt;
-            clip->vid_ctx->curr_pts = pkt->pts;
+        // Skip by packets from finished stream (kept for the next clip of this file)
+        if(done_curr_pkt_stream(clip, &tmpPkt)) {
+            keep_clip_read_ahead(clip, &tmpPkt);
+            continue;
         }
-    } else if(tmpPkt.stream_index == vid_ctx->audio_stream_idx) {
-        if(tmpPkt.pts >= audio_end_pts) {
-            clip->done_reading_audio = true;
-
-            // Recursion to read the rest of video frames
-            if(!clip->done_reading_video) {
-                av_packet_unref(&tmpPkt);
-                return clip_read_packet(clip, pkt);
+        if(tmpPkt.stream_index == vid_ctx->video_stream_idx) {
+            // If packet is past, or equal to the end_frame_pts (outside of clip)
+            // This performs exclusive end_pts
+            if(tmpPkt.pts >= video_end_pts) {
+                clip->done_reading_video = true;
+                // continue to read the rest of audio packets
+                keep_clip_read_ahead(clip, &tmpPkt);
+                continue;
             }
-        } else {
-            *pkt = tmpPkt;
+            vid_ctx->curr_pts = tmpPkt.pts;
+        } else if(tmpPkt.pts >= audio_end_pts) {
+            clip->done_reading_audio = true;
+            // continue to read the rest of video packets
+            keep_clip_read_ahead(clip, &tmpPkt);
+            continue;
         }
-    } else {
-        printf("Unknown packet type (not video or audio).. ignoring\n");
-    }
-    // If both audio and video streams have completed read cycle of the entire clip
-    if(clip->done_reading_video && clip->done_reading_audio) {
-        av_packet_unref(&tmpPkt);
-        reset_packet_counter(clip);
-        return -1;
+        *pkt = tmpPkt;
+        render_stats_add(&(clip->stats), tmpPkt.stream_index == vid_ctx->video_stream_idx ?
+                AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO, RENDER_STAGE_DEMUX, start_ns, 1);
+        return 0;
     }
-    return 0;
+    // Both audio and video streams have completed read cycle of the entire clip.
+    // The file is left at the clip end (the seek back to the start happens on the next read):
+    // when no packet was dropped, the next clip of this file may read on from here
+    bool dropped = clip->read_ahead_lost || is_stream_discarded(vid_ctx, vid_ctx->video_stream_idx) ||
+                    is_stream_discarded(vid_ctx, vid_ctx->audio_stream_idx);
+    vid_ctx->read_end_pts = dropped ? -1 : clip->orig_end_pts;
+    // any clip reading this VideoContext next must seek or read on (see resume_clip_read())
+    vid_ctx->seek_pts = -1;
+    clip->read_cycle_done = true;
+    render_stats_add(&(clip->stats), AVMEDIA_TYPE_UNKNOWN, RENDER_STAGE_DEMUX, start_ns, 0);
+    return -1;
 }
 
 /**
@@ -430,12 +493,42 @@ int reset_packet_counter(Clip *clip) {
 }
 
 /**
- * Set internal vars used in reading stream data
+ * Set internal vars used in reading stream data and re-enable demuxing
+ * of the clip video and audio streams
  * @param clip Clip
  */
 void init_internal_vars(Clip *clip) {
-    clip->done_reading_video = (clip->vid_ctx->video_stream_idx == -1);
-    clip->done_reading_audio = (clip->vid_ctx->audio_stream_idx == -1);
+    VideoContext *vid_ctx = clip->vid_ctx;
+    clip->done_reading_video = (vid_ctx->video_stream_idx == -1);
+    clip->done_reading_audio = (vid_ctx->audio_stream_idx == -1);
+    clip->read_cycle_done = false;
+    clip->read_ahead_lost = false;
+    // demux both streams again (they may have been discarded by the last read cycle)
+    set_stream_discard(vid_ctx, vid_ctx->video_stream_idx, false);
+    set_stream_discard(vid_ctx, vid_ctx->audio_stream_idx, false);
+}
+
+/**
+ * Keep a packet read past the end of a clip for the next clip of the same file.
+ * When too many are kept (streams far apart in the file), they are all dropped and
+ * demuxing of the finished streams stops, as reading on is no longer possible
+ * @param clip Clip
+ * @param pkt  packet past the clip end (moved or unreferenced)
+ */
+void keep_clip_read_ahead(Clip *clip, AVPacket *pkt) {
+    VideoContext *vid_ctx = clip->vid_ctx;
+    bool used = pkt->stream_index == vid_ctx->video_stream_idx || pkt->stream_index == vid_ctx->audio_stream_idx;
+    if(!used || clip->read_ahead_lost) {
+        av_packet_unref(pkt);
+        return;
+    }
+    if(keep_read_ahead_packet(vid_ctx, pkt) < 0) {
+        clip->read_ahead_lost = true;
+        clear_read_ahead_packets(vid_ctx);
+        // stop demuxing finished streams until the next read cycle
+        set_stream_discard(vid_ctx, vid_ctx->video_stream_idx, clip->done_reading_video);
+        set_stream_discard(vid_ctx, vid_ctx->audio_stream_idx, clip->done_reading_audio);
+    }
 }
 
 /**
@@ -448,7 +541,7 @@ void init_internal_vars(Clip *clip) {
  */
 int64_t compare_clips(Clip *first, Clip *second) {
     if(first == NULL || second == NULL) {
-        fprintf(stderr, "compare_clips() error: params cannot be NULL\n");
+        log_error("compare_clips() error: params cannot be NULL\n");
         return -2;
     }
     return first->start_pts - second->start_pts;
@@ -464,7 +557,7 @@ int64_t compare_clips(Clip *first, Clip *second) {
  */
 int64_t compare_clips_sequential(Clip *f, Clip *s) {
     if(f == NULL || s == NULL) {
-        fprintf(stderr, "compare_clips_sequential() error: params cannot be NULL\n");
+        log_error("compare_clips_sequential() error: params cannot be NULL\n");
         return -2;
     }
     double diff = difftime(f->vid_ctx->file_stats.st_mtime, s->vid_ctx->file_stats.st_mtime);
@@ -477,7 +570,7 @@ int64_t compare_clips_sequential(Clip *f, Clip *s) {
     } else if(diff < 0) {
         return -1;
     }
-    fprintf(stderr, "compare_clips_sequential() error: We should never get down here..\n");
+    log_error("compare_clips_sequential() error: We should never get down here..\n");
     return -2;
 }
 
@@ -488,7 +581,7 @@ int64_t compare_clips_sequential(Clip *f, Clip *s) {
  */
 AVRational get_clip_video_time_base(Clip *clip) {
     if(!clip->vid_ctx->open) {
-        fprintf(stderr, "Failed to get video time_base: clip[%s] is not open\n", clip->vid_ctx->url);
+        log_error("Failed to get video time_base: clip[%s] is not open\n", clip->vid_ctx->url);
         return (AVRational){-1, -1};
     }
     return get_video_time_base(clip->vid_ctx);
@@ -501,7 +594,7 @@ AVRational get_clip_video_time_base(Clip *clip) {
  */
 AVRational get_clip_audio_time_base(Clip *clip) {
     if(!clip->vid_ctx->open) {
-        fprintf(stderr, "Failed to get audio time_base: clip[%s] is not open\n", clip->vid_ctx->url);
+        log_error("Failed to get audio time_base: clip[%s] is not open\n", clip->vid_ctx->url);
         return (AVRational){-1, -1};
     }
     return get_audio_time_base(clip->vid_ctx);
@@ -514,7 +607,7 @@ AVRational get_clip_audio_time_base(Clip *clip) {
  */
 AVStream *get_clip_video_stream(Clip *clip) {
     if(!clip->vid_ctx->open) {
-        fprintf(stderr, "Failed to get video stream: clip[%s] is not open\n", clip->vid_ctx->url);
+        log_error("Failed to get video stream: clip[%s] is not open\n", clip->vid_ctx->url);
         return NULL;
     }
     return get_video_stream(clip->vid_ctx);
@@ -527,7 +620,7 @@ AVStream *get_clip_video_stream(Clip *clip) {
  */
 AVStream *get_clip_audio_stream(Clip *clip) {
     if(!clip->vid_ctx->open) {
-        fprintf(stderr, "Failed to get audio stream: clip[%s] is not open\n", clip->vid_ctx->url);
+        log_error("Failed to get audio stream: clip[%s] is not open\n", clip->vid_ctx->url);
         return NULL;
     }
     return get_audio_stream(clip->vid_ctx);
@@ -544,7 +637,7 @@ AVCodecParameters *get_clip_video_params(Clip *clip) {
     if(ret < 0) {
         avcodec_parameters_free(&par);
         par = NULL;
-        fprintf(stderr, "Failed to get clip[%s] video params\n", clip->vid_ctx->url);
+        log_error("Failed to get clip[%s] video params\n", clip->vid_ctx->url);
     } else {
         if(par->extradata) {
             free(par->extradata);
@@ -566,7 +659,7 @@ AVCodecParameters *get_clip_audio_params(Clip *clip) {
     if(ret < 0) {
         avcodec_parameters_free(&par);
         par = NULL;
-        fprintf(stderr, "Failed to get clip[%s] audio params\n", clip->vid_ctx->url);
+        log_error("Failed to get clip[%s] audio params\n", clip->vid_ctx->url);
     } else{
         if(par->extradata) {
             free(par->extradata);
@@ -590,14 +683,14 @@ AVCodecParameters *get_clip_audio_params(Clip *clip) {
 int cut_clip_internal(Clip *oc, int64_t pts, Clip **sc) {
     *sc = NULL;
     if(oc == NULL || oc->vid_ctx == NULL) {
-        fprintf(stderr, "cut_clip_internal() error: Invalid params\n");
+        log_error("cut_clip_internal() error: Invalid params\n");
         return -1;
     }
     AVStream *vid_stream = get_clip_video_stream(oc);
     int64_t frame_duration = vid_stream->duration / vid_stream->nb_frames;
     if((pts < frame_duration) || (pts >= (oc->orig_end_pts - oc->orig_start_pts))) {
-        printf("cut_clip_internal(): pts out of range/cannot cut less than one frame.. ");
-        printf("pts: %ld, frame_duration: %ld\n", pts, frame_duration);
+        log_warning("cut_clip_internal(): pts out of range/cannot cut less than one frame.. "
+                    "pts: %ld, frame_duration: %ld\n", pts, frame_duration);
         return -1;
     }
     // set orig_end_pts of original clip
@@ -608,13 +701,13 @@ int cut_clip_internal(Clip *oc, int64_t pts, Clip **sc) {
     }
     *sc = copy_clip_vc(oc);
     if(*sc == NULL) {
-        fprintf(stderr, "cut_clip_internal() error: failed to allocate new clip\n");
+        log_error("cut_clip_internal() error: failed to allocate new clip\n");
         return -1;
     }
     ret = set_clip_bounds_pts(*sc, oc->orig_start_pts + pts, sc_orig_end_pts);
     if(ret < 0) {
         free_clip(sc);
-        fprintf(stderr, "cut_clip_internal() error: Failed to set bounds on new clip\n");
+        log_error("cut_clip_internal() error: Failed to set bounds on new clip\n");
         return ret;
     }
     return 0;
@@ -681,7 +774,7 @@ void list_delete_clip(void *toBeDeleted) {
  */
 int list_compare_clips(const void *first, const void *second) {
     if(first == NULL || second == NULL) {
-        fprintf(stderr, "ERROR: compare clips param cannot be NULL\n");
+        log_error("ERROR: compare clips param cannot be NULL\n");
         return -2;
     }
     Clip *clip1 = (Clip *) first;
@@ -708,7 +801,7 @@ int list_compare_clips(const void *first, const void *second) {
  */
 int list_compare_clips_sequential(const void *first, const void *second) {
     if(first == NULL || second == NULL) {
-        fprintf(stderr, "list_compare_clips_sequential() error: params cannot be NULL\n");
+        log_error("list_compare_clips_sequential() error: params cannot be NULL\n");
         return -2;
     }
     Clip *f = (Clip *) first;
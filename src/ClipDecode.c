@@ -21,21 +21,26 @@
 int clip_read_frame(Clip *clip, AVFrame *frame, enum AVMediaType *frame_type) {
     VideoContext *vid_ctx = clip->vid_ctx;
     int ret, handle_ret = 0;
+    int64_t start_ns;
     do {
         // try to receive frame from decoder (from clip_send_packet())
         if(vid_ctx->last_decoder_packet_stream == DEC_STREAM_VIDEO) {
             *frame_type = AVMEDIA_TYPE_VIDEO;
+            start_ns = render_stats_start();
             ret = avcodec_receive_frame(vid_ctx->video_codec_ctx, frame);
             if(ret == 0) {
                 // success, frame was returned from decoder
                 if(frame->pts < clip->vid_ctx->seek_pts) {
-                    printf("skip video frame[%ld] before seek[%ld]\n", frame->pts, clip->vid_ctx->seek_pts);
+                    log_trace("skip video frame[%ld] before seek[%ld]\n", frame->pts, clip->vid_ctx->seek_pts);
+                    render_stats_add(&(clip->stats), AVMEDIA_TYPE_VIDEO, RENDER_STAGE_PREROLL, start_ns, 1);
                     handle_ret = 1;
                 } else {
                     ++(clip->frame_index);
+                    render_stats_add(&(clip->stats), AVMEDIA_TYPE_VIDEO, RENDER_STAGE_DECODE, start_ns, 1);
                     handle_ret = 0;
                 }
             } else if(ret == AVERROR(EAGAIN)) {
+                render_stats_add(&(clip->stats), *frame_type, RENDER_STAGE_DECODE, start_ns, 0);
                 // output is not available in this state - user must try to send new input
                 ret = clip_send_packet(clip);   // if no more packets or error
                 if(ret < 0) {
@@ -45,23 +50,27 @@ int clip_read_frame(Clip *clip, AVFrame *frame, enum AVMediaType *frame_type) {
                 handle_ret = 1;
             } else {
                 // legitimate decoding error
-                fprintf(stderr, "Error decoding frame (%s)\n", av_err2str(ret));
+                log_error("Error decoding frame (%s)\n", av_err2str(ret));
                 clip->frame_index = 0;
                 return -1;
             }
         } else if(vid_ctx->last_decoder_packet_stream == DEC_STREAM_AUDIO) {
             *frame_type = AVMEDIA_TYPE_AUDIO;
+            start_ns = render_stats_start();
             ret = avcodec_receive_frame(vid_ctx->audio_codec_ctx, frame);
             if(ret == 0) {
                 // success, frame was returned from decoder
                 int64_t seek_pts = cov_video_to_audio_pts(clip->vid_ctx, clip->vid_ctx->seek_pts);
                 if(frame->pts < seek_pts) {
-                    printf("skip audio frame[%ld] before seek[%ld]\n", frame->pts, seek_pts);
+                    log_trace("skip audio frame[%ld] before seek[%ld]\n", frame->pts, seek_pts);
+                    render_stats_add(&(clip->stats), AVMEDIA_TYPE_AUDIO, RENDER_STAGE_PREROLL, start_ns, 1);
                     handle_ret = 1;
                 } else {
+                    render_stats_add(&(clip->stats), AVMEDIA_TYPE_AUDIO, RENDER_STAGE_DECODE, start_ns, 1);
                     handle_ret = 0;
                 }
             } else if(ret == AVERROR(EAGAIN)) {
+                render_stats_add(&(clip->stats), *frame_type, RENDER_STAGE_DECODE, start_ns, 0);
                 // output is not available in this state - user must try to send new input
                 ret = clip_send_packet(clip);   // if no more packets or error
                 if(ret < 0) {
@@ -71,7 +80,7 @@ int clip_read_frame(Clip *clip, AVFrame *frame, enum AVMediaType *frame_type) {
                 handle_ret = 1;
             } else {
                 // legitimate decoding error
-                fprintf(stderr, "Error decoding frame (%s)\n", av_err2str(ret));
+                log_error("Error decoding frame (%s)\n", av_err2str(ret));
                 clip->frame_index = 0;
                 return -1;
             }
@@ -97,7 +106,7 @@ int example_clip_read_frames(Clip *clip) {
     enum AVMediaType type;
     AVFrame *frame = av_frame_alloc();
     if(!frame) {
-        fprintf(stderr, "Could not allocate frame\n");
+        log_error("Could not allocate frame\n");
         return AVERROR(ENOMEM);
     }
     while(clip_read_frame(clip, frame, &type) >= 0) {
@@ -145,24 +154,27 @@ int clip_send_packet(Clip *clip) {
         return ret;
     }
     // Send raw packet to decoder
+    int64_t start_ns = render_stats_start();
     if(pkt.stream_index == vid_ctx->video_stream_idx) {
         ret = avcodec_send_packet(vid_ctx->video_codec_ctx, &pkt);
+        render_stats_add(&(clip->stats), AVMEDIA_TYPE_VIDEO, RENDER_STAGE_DECODE, start_ns, 0);
         if(ret < 0) {
-            fprintf(stderr, "Failed to send video packet to decoder (%s)\n", av_err2str(ret));
+            log_error("Failed to send video packet to decoder (%s)\n", av_err2str(ret));
         } else {
             vid_ctx->last_decoder_packet_stream = DEC_STREAM_VIDEO;
         }
     }
     else if(pkt.stream_index == vid_ctx->audio_stream_idx) {
         ret = avcodec_send_packet(vid_ctx->audio_codec_ctx, &pkt);
+        render_stats_add(&(clip->stats), AVMEDIA_TYPE_AUDIO, RENDER_STAGE_DECODE, start_ns, 0);
         if(ret < 0) {
-            fprintf(stderr, "Failed to send audio packet[%ld] to decoder (%s)\n",
+            log_error("Failed to send audio packet[%ld] to decoder (%s)\n",
                                 pkt.pts, av_err2str(ret));
         } else {
             vid_ctx->last_decoder_packet_stream = DEC_STREAM_AUDIO;
         }
     } else {
-        printf("packet is not video or audio stream. (we should never get down here, this should be handled internally by clip_read_packet())\n");
+        log_error("packet is not video or audio stream. (we should never get down here, this should be handled internally by clip_read_packet())\n");
         ret = -1;
     }
     av_packet_unref(&pkt);
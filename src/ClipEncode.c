@@ -77,7 +77,7 @@ int clip_receive_enc_packet(OutputContext *oc, OutputStream *os, Clip *clip, AVP
         return clip_encode_frame(oc, clip, pkt);
     } else {
         // legitimate encoding errors
-        fprintf(stderr, "Legitmate encoding error when handling receive frame[%s]\n",
+        log_error("Legitmate encoding error when handling receive frame[%s]\n",
                             av_err2str(ret));
         return ret;
     }
@@ -101,7 +101,7 @@ int clip_send_frame_to_encoder(OutputContext *oc, Clip *clip, AVPacket *pkt) {
         // flush the video stream
         ret = avcodec_send_frame(oc->video.codec_ctx, NULL);
         if(ret < 0) {
-            fprintf(stderr, "Failed to flush the video stream (%s)\n", av_err2str(ret));
+            log_error("Failed to flush the video stream (%s)\n", av_err2str(ret));
             return ret;
         }
         oc->video.flushing = true;
@@ -109,7 +109,7 @@ int clip_send_frame_to_encoder(OutputContext *oc, Clip *clip, AVPacket *pkt) {
         // flush the audio stream
         ret = avcodec_send_frame(oc->audio.codec_ctx, NULL);
         if(ret < 0) {
-            fprintf(stderr, "Failed to flush the audio stream (%s)\n", av_err2str(ret));
+            log_error("Failed to flush the audio stream (%s)\n", av_err2str(ret));
             return ret;
         }
         oc->audio.flushing = true;
@@ -128,7 +128,7 @@ int clip_send_frame_to_encoder(OutputContext *oc, Clip *clip, AVPacket *pkt) {
         return handle_send_frame(oc, clip, type, ret, pkt);
     } else {
         // this should never happen
-        fprintf(stderr, "AVFrame type is invalid (must be AVMEDIA_TYPE_VIDEO or AVMEDIA_TYPE_AUDIO)\n");
+        log_error("AVFrame type is invalid (must be AVMEDIA_TYPE_VIDEO or AVMEDIA_TYPE_AUDIO)\n");
         return -1;
     }
 }
@@ -153,7 +153,7 @@ int handle_send_frame(OutputContext *oc, Clip *clip, enum AVMediaType type, int
         return clip_encode_frame(oc, clip, pkt);
     } else {
         // legitimate encoding error
-        fprintf(stderr, "Legitmate encoding error when handling send frame[%s]\n",
+        log_error("Legitmate encoding error when handling send frame[%s]\n",
                             av_err2str(ret));
         return ret;
     }
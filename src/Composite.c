@@ -0,0 +1,310 @@
+/**
+ * @file Composite.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for Composite API:
+ * Alpha over of video layers and summing of audio tracks.
+ * Row kernels use SSE2 when available (scalar fallback otherwise).
+ */
+
+#include "Composite.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Check if frames of a pixel format can be composited
+ * (same formats as transitions, see transition_pix_fmt_supported())
+ * @param  pix_fmt pixel format
+ * @return         true if supported by composite_layer_rows()
+ */
+bool composite_pix_fmt_supported(enum AVPixelFormat pix_fmt) {
+    return transition_pix_fmt_supported(pix_fmt);
+}
+
+/**
+ * Get the pixel format with the same planes as a format plus an alpha plane
+ * (ex: AV_PIX_FMT_YUVA420P for AV_PIX_FMT_YUV420P). Layers with their own alpha
+ * are scaled into it
+ * @param  pix_fmt supported pixel format with one component per plane and no alpha
+ * @return         pixel format with alpha, AV_PIX_FMT_NONE when there is none
+ */
+enum AVPixelFormat get_composite_alpha_format(enum AVPixelFormat pix_fmt) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
+    if(!composite_pix_fmt_supported(pix_fmt) || (desc->flags & AV_PIX_FMT_FLAG_ALPHA) ||
+        av_pix_fmt_count_planes(pix_fmt) != desc->nb_components) {
+        return AV_PIX_FMT_NONE;
+    }
+    int nb = desc->nb_components;
+    const AVPixFmtDescriptor *d = NULL;
+    while((d = av_pix_fmt_desc_next(d)) != NULL) {
+        if(d->nb_components != nb + 1 || d->flags != (desc->flags | AV_PIX_FMT_FLAG_ALPHA) ||
+            d->log2_chroma_w != desc->log2_chroma_w || d->log2_chroma_h != desc->log2_chroma_h) {
+            continue;
+        }
+        // same components in the same planes, and alpha alone in the next plane
+        bool same = true;
+        for(int c = 0; c <= nb && same; c++) {
+            const AVComponentDescriptor *a = &(d->comp[c]);
+            const AVComponentDescriptor *b = &(desc->comp[c < nb ? c : 0]);
+            same = a->plane == (c < nb ? b->plane : nb) && a->step == b->step &&
+                    a->offset == b->offset && a->shift == b->shift && a->depth == b->depth;
+        }
+        if(same) {
+            return av_pix_fmt_desc_get_id(d);
+        }
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+/**
+ * Make sure a frame has a writable buffer of a format and size
+ * @param  frame   frame to allocate (allocated itself when NULL)
+ * @param  width   width wanted
+ * @param  height  height wanted
+ * @param  pix_fmt pixel format wanted
+ * @return         0 when the buffer was kept, 1 when a new buffer was allocated, < 0 on error
+ */
+int get_composite_buffer(AVFrame **frame, int width, int height, enum AVPixelFormat pix_fmt) {
+    if(*frame == NULL && (*frame = av_frame_alloc()) == NULL) {
+        log_error("get_composite_buffer() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    AVFrame *f = *frame;
+    if(f->buf[0] != NULL && av_frame_is_writable(f) && f->width == width &&
+        f->height == height && f->format == pix_fmt) {
+        return 0;
+    }
+    // still referenced by the encoder (or there is none yet): get a new one
+    av_frame_unref(f);
+    f->width = width;
+    f->height = height;
+    f->format = pix_fmt;
+    int ret = av_frame_get_buffer(f, 32);
+    if(ret < 0) {
+        log_error("get_composite_buffer() error: Failed to allocate frame buffer (%s)\n", av_err2str(ret));
+        return ret;
+    }
+    return 1;
+}
+
+/**
+ * Copy a band of rows from one frame into another (same format and size)
+ * @param dst output frame
+ * @param src source frame
+ * @param y0  first row of band (multiple of the chroma height)
+ * @param y1  end of band (exclusive)
+ */
+void copy_frame_rows(AVFrame *dst, const AVFrame *src, int y0, int y1) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    int bytes[4];
+    if(desc == NULL || av_image_fill_linesizes(bytes, src->format, src->width) < 0) {
+        return;
+    }
+    int nb_planes = av_pix_fmt_count_planes(src->format);
+    for(int p = 0; p < nb_planes; p++) {
+        int sh = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+        int r0 = y0 >> sh, r1 = AV_CEIL_RSHIFT(y1, sh);
+        av_image_copy_plane(dst->data[p] + (ptrdiff_t) r0 * dst->linesize[p], dst->linesize[p],
+                            src->data[p] + (ptrdiff_t) r0 * src->linesize[p], src->linesize[p],
+                            bytes[p], r1 - r0);
+    }
+}
+
+/**
+ * Composite a layer over a band of rows of a frame. The layer has the format of dst,
+ * or the format of dst with an alpha plane (see get_composite_alpha_format()) to be
+ * blended by its own alpha. Parts of the layer outside of dst are ignored
+ * @param dst     frame composited in place (supported pixel format)
+ * @param layer   layer frame
+ * @param x       left of layer in dst (multiple of the chroma width, can be negative)
+ * @param y       top of layer in dst (multiple of the chroma height, can be negative)
+ * @param opacity opacity of the layer (0 to 1)
+ * @param y0      first row of band (multiple of the chroma height)
+ * @param y1      end of band (exclusive)
+ */
+void composite_layer_rows(AVFrame *dst, const AVFrame *layer, int x, int y, double opacity, int y0, int y1) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst->format);
+    int top = FFMAX(y0, y), bottom = FFMIN3(y1, y + layer->height, dst->height);
+    int left = FFMAX(x, 0), right = FFMIN(x + layer->width, dst->width);
+    if(desc == NULL || top >= bottom || left >= right || opacity <= 0) {
+        return;
+    }
+    bool words = desc->comp[0].depth > 8;
+    int nb_planes = av_pix_fmt_count_planes(dst->format);
+    if(layer->format != dst->format) {
+        // blended by the alpha plane of the layer (one component per plane)
+        int k = get_composite_alpha_scale(opacity, desc->comp[0].depth);
+        int size = words ? 2 : 1;
+        const uint8_t *alpha_plane = layer->data[nb_planes];
+        int alpha_linesize = layer->linesize[nb_planes];
+        for(int p = 0; p < nb_planes; p++) {
+            int sw = (p == 1 || p == 2) ? desc->log2_chroma_w : 0;
+            int sh = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+            int c0 = left >> sw, n = AV_CEIL_RSHIFT(right, sw) - c0;
+            int lc0 = c0 - (x >> sw);
+            for(int r = top >> sh; r < AV_CEIL_RSHIFT(bottom, sh); r++) {
+                int lr = r - (y >> sh);
+                uint8_t *d = dst->data[p] + (ptrdiff_t) r * dst->linesize[p] + c0 * size;
+                const uint8_t *s = layer->data[p] + (ptrdiff_t) lr * layer->linesize[p] + lc0 * size;
+                const uint8_t *a = alpha_plane + (ptrdiff_t) (lr << sh) * alpha_linesize + (lc0 << sw) * size;
+                if(words) {
+                    alpha_over_row_16((uint16_t *) d, (const uint16_t *) s, (const uint16_t *) a, n, 1 << sw,
+                                        k, desc->comp[0].depth);
+                } else {
+                    alpha_over_row_8(d, s, a, n, 1 << sw, k);
+                }
+            }
+        }
+        return;
+    }
+    // byte offsets of the visible columns in each plane
+    int off[4], end[4], layer_off[4];
+    if(av_image_fill_linesizes(off, dst->format, left) < 0 || av_image_fill_linesizes(end, dst->format, right) < 0 ||
+        av_image_fill_linesizes(layer_off, dst->format, left - x) < 0) {
+        return;
+    }
+    // weight in 1/32768 (an opaque layer is copied)
+    int w = (int) lrint(av_clipd(opacity, 0, 1) * 32768);
+    for(int p = 0; p < nb_planes; p++) {
+        int sh = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+        int n = end[p] - off[p];
+        for(int r = top >> sh; r < AV_CEIL_RSHIFT(bottom, sh); r++) {
+            int lr = r - (y >> sh);
+            uint8_t *d = dst->data[p] + (ptrdiff_t) r * dst->linesize[p] + off[p];
+            const uint8_t *s = layer->data[p] + (ptrdiff_t) lr * layer->linesize[p] + layer_off[p];
+            if(w >= 32768) {
+                memcpy(d, s, n);
+            } else if(words) {
+                blend_row_16((uint16_t *) d, (const uint16_t *) d, (const uint16_t *) s, n / 2, w);
+            } else {
+                blend_row_8(d, d, s, n, w);
+            }
+        }
+    }
+}
+
+/**
+ * Sum samples into a frame: dst[dst_offset + i] += src[src_offset + i] * volume (planar float)
+ * @param dst        frame mixed in place (AV_SAMPLE_FMT_FLTP, writable)
+ * @param dst_offset first sample of dst
+ * @param src        samples (AV_SAMPLE_FMT_FLTP, same channels)
+ * @param src_offset first sample of src
+ * @param nb_samples number of samples (within both frames)
+ * @param volume     gain of src
+ */
+void mix_audio_samples(AVFrame *dst, int dst_offset, const AVFrame *src, int src_offset, int nb_samples,
+                        float volume) {
+    for(int c = 0; c < dst->channels; c++) {
+        float *d = (float *) dst->extended_data[c] + dst_offset;
+        mix_row_float(d, d, (const float *) src->extended_data[c] + src_offset, nb_samples, 1, 0, volume, 0);
+    }
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Alpha over a row of bytes: dst = dst + (src - dst) * w / 32768,
+ * where w = ((alpha[i * alpha_step] << 8) * k) >> 16
+ * @param dst        row composited in place
+ * @param src        layer row
+ * @param alpha      alpha row of the layer (8 bit, at the resolution of the first plane)
+ * @param n          number of bytes
+ * @param alpha_step alpha values per byte of dst (1 << horizontal chroma shift)
+ * @param k          opacity scale of alpha (see get_composite_alpha_scale())
+ */
+void alpha_over_row_8(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int n, int alpha_step, int k) {
+    int i = 0;
+#ifdef __SSE2__
+    if(alpha_step <= 2) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i vk = _mm_set1_epi16((int16_t) k);
+        for(; i + 16 <= n; i += 16) {
+            __m128i alo, ahi;
+            if(alpha_step == 1) {
+                __m128i va = _mm_loadu_si128((const __m128i *) (alpha + i));
+                alo = _mm_unpacklo_epi8(zero, va);
+                ahi = _mm_unpackhi_epi8(zero, va);
+            } else {
+                // even alpha bytes (one per chroma sample) shifted into the high byte
+                alo = _mm_slli_epi16(_mm_loadu_si128((const __m128i *) (alpha + 2 * i)), 8);
+                ahi = _mm_slli_epi16(_mm_loadu_si128((const __m128i *) (alpha + 2 * i + 16)), 8);
+            }
+            __m128i wlo = _mm_mulhi_epu16(alo, vk);
+            __m128i whi = _mm_mulhi_epu16(ahi, vk);
+            __m128i vd = _mm_loadu_si128((const __m128i *) (dst + i));
+            __m128i vs = _mm_loadu_si128((const __m128i *) (src + i));
+            __m128i dlo = _mm_unpacklo_epi8(vd, zero);
+            __m128i dhi = _mm_unpackhi_epi8(vd, zero);
+            __m128i slo = _mm_sub_epi16(_mm_unpacklo_epi8(vs, zero), dlo);
+            __m128i shi = _mm_sub_epi16(_mm_unpackhi_epi8(vs, zero), dhi);
+            // (2 * d * w) >> 16 = d * w / 32768
+            dlo = _mm_add_epi16(dlo, _mm_mulhi_epi16(_mm_add_epi16(slo, slo), wlo));
+            dhi = _mm_add_epi16(dhi, _mm_mulhi_epi16(_mm_add_epi16(shi, shi), whi));
+            _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(dlo, dhi));
+        }
+    }
+#endif
+    for(; i < n; i++) {
+        int w = (int) ((((uint32_t) alpha[i * alpha_step] << 8) * (uint32_t) k) >> 16);
+        dst[i] = dst[i] + ((2 * (src[i] - dst[i]) * w) >> 16);
+    }
+}
+
+/**
+ * Alpha over a row of 16 bit words holding at most 14 bits: dst = dst + (src - dst) * w / 32768,
+ * where w = ((alpha[i * alpha_step] << (16 - depth)) * k) >> 16
+ * @param dst        row composited in place
+ * @param src        layer row
+ * @param alpha      alpha row of the layer (depth bits, at the resolution of the first plane)
+ * @param n          number of words
+ * @param alpha_step alpha values per word of dst (1 << horizontal chroma shift)
+ * @param k          opacity scale of alpha (see get_composite_alpha_scale())
+ * @param depth      bits of alpha
+ */
+void alpha_over_row_16(uint16_t *dst, const uint16_t *src, const uint16_t *alpha, int n, int alpha_step,
+                        int k, int depth) {
+    int i = 0;
+#ifdef __SSE2__
+    if(alpha_step <= 2) {
+        const __m128i vk = _mm_set1_epi16((int16_t) k);
+        const __m128i shift = _mm_cvtsi32_si128(16 - depth);
+        for(; i + 8 <= n; i += 8) {
+            __m128i va;
+            if(alpha_step == 1) {
+                va = _mm_loadu_si128((const __m128i *) (alpha + i));
+            } else {
+                // even alpha words (one per chroma sample), alpha fits a signed word
+                __m128i a0 = _mm_loadu_si128((const __m128i *) (alpha + 2 * i));
+                __m128i a1 = _mm_loadu_si128((const __m128i *) (alpha + 2 * i + 8));
+                a0 = _mm_srai_epi32(_mm_slli_epi32(a0, 16), 16);
+                a1 = _mm_srai_epi32(_mm_slli_epi32(a1, 16), 16);
+                va = _mm_packs_epi32(a0, a1);
+            }
+            __m128i w = _mm_mulhi_epu16(_mm_sll_epi16(va, shift), vk);
+            __m128i vd = _mm_loadu_si128((const __m128i *) (dst + i));
+            __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *) (src + i)), vd);
+            vd = _mm_add_epi16(vd, _mm_mulhi_epi16(_mm_add_epi16(d, d), w));
+            _mm_storeu_si128((__m128i *) (dst + i), vd);
+        }
+    }
+#endif
+    for(; i < n; i++) {
+        int w = (int) ((((uint32_t) alpha[i * alpha_step] << (16 - depth)) * (uint32_t) k) >> 16);
+        dst[i] = dst[i] + ((2 * (src[i] - dst[i]) * w) >> 16);
+    }
+}
+
+/**
+ * Get the scale turning alpha values (shifted up to 16 bits) into blend weights in 1/32768,
+ * so an opaque pixel of a layer at full opacity gets the largest weight (32767)
+ * @param  opacity opacity of the layer (0 to 1)
+ * @param  depth   bits of alpha
+ * @return         scale k (0 to 65535)
+ */
+int get_composite_alpha_scale(double opacity, int depth) {
+    double max_alpha = (double) (((1 << depth) - 1) << (16 - depth));
+    return av_clip((int) (av_clipd(opacity, 0, 1) * 32767.0 * 65536.0 / max_alpha), 0, 65535);
+}
@@ -0,0 +1,445 @@
+/**
+ * @file FrameCache.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for FrameCache API:
+ * Memory bounded LRU cache of decoded video frames keyed by (source, pts), with
+ * random access decoding and prefetch around the last request.
+ */
+
+#include "FrameCache.h"
+
+/**
+ * Initialize a frame cache
+ * @param  fc        FrameCache
+ * @param  max_bytes max bytes of decoded frames held
+ * @param  prefetch  frames cached around each request (0 to disable prefetch)
+ * @return           >= 0 on success
+ */
+int init_frame_cache(FrameCache *fc, int64_t max_bytes, int prefetch) {
+    fc->buckets = calloc(FRAME_CACHE_BUCKETS, sizeof(FrameCacheEntry *));
+    fc->decoded = av_frame_alloc();
+    if(fc->buckets == NULL || fc->decoded == NULL) {
+        log_error("init_frame_cache() error: Failed to allocate cache\n");
+        free(fc->buckets);
+        fc->buckets = NULL;
+        av_frame_free(&(fc->decoded));
+        return AVERROR(ENOMEM);
+    }
+    fc->lru_head = NULL;
+    fc->lru_tail = NULL;
+    fc->bytes = 0;
+    fc->max_bytes = max_bytes;
+    fc->nb_frames = 0;
+    fc->prefetch = prefetch;
+    fc->last_url = NULL;
+    fc->last_pts = -1;
+    fc->hits = 0;
+    fc->misses = 0;
+    return 0;
+}
+
+/**
+ * Get the video frame at pts of a file (the first frame at or after pts),
+ * from the cache or by decoding it
+ * @param  fc    FrameCache
+ * @param  vc    opened VideoContext of the file (its read position is invalidated:
+ *               clips reading it sequentially will seek again)
+ * @param  pts   pts in video time base
+ * @param  frame output frame (reference to the cached frame: do not write into its data)
+ * @return       >= 0 on success
+ */
+int get_cached_video_frame(FrameCache *fc, VideoContext *vc, int64_t pts, AVFrame *frame) {
+    if(!vc->open || pts < 0) {
+        log_error("get_cached_video_frame() error: Invalid params\n");
+        return -1;
+    }
+    int ret;
+    AVFrame *cached = find_cached_frame(fc, vc, pts);
+    if(cached == NULL) {
+        // pts between two frames (converted from another frame rate): the next frame
+        int64_t dur = get_cached_frame_duration(vc);
+        cached = find_cached_frame(fc, vc, (pts + dur - 1) / dur * dur);
+    }
+    if(cached != NULL) {
+        ++(fc->hits);
+        ret = av_frame_ref(frame, cached);
+    } else {
+        ++(fc->misses);
+        ret = decode_cached_frames(fc, vc, pts, pts, frame);
+    }
+    if(ret < 0) {
+        log_error("get_cached_video_frame() error: Failed to get frame[%ld] of [%s]\n", pts, vc->url);
+        return ret;
+    }
+    // a failed prefetch does not fail the request
+    if(prefetch_cached_frames(fc, vc, pts) < 0) {
+        log_warning("get_cached_video_frame(): Failed to prefetch around frame[%ld]\n", pts);
+    }
+    char *url = get_video_context_url(vc);
+    if(fc->last_url == NULL || strcmp(fc->last_url, url) != 0) {
+        free(fc->last_url);
+        fc->last_url = strdup(url);
+    }
+    fc->last_pts = pts;
+    return 0;
+}
+
+/**
+ * Get a frame of a clip, from the cache or by decoding it
+ * @param  fc          FrameCache
+ * @param  clip        Clip (opened if needed)
+ * @param  frame_index index of frame relative to the start of the clip
+ * @param  frame       output frame (reference to the cached frame: do not write into its data)
+ * @return             >= 0 on success
+ */
+int get_cached_clip_frame(FrameCache *fc, Clip *clip, int64_t frame_index, AVFrame *frame) {
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    int64_t pts = get_video_frame_pts(clip->vid_ctx, frame_index);
+    if(pts < 0 || clip->orig_start_pts + pts >= clip->orig_end_pts) {
+        log_error("get_cached_clip_frame() error: frame[%ld] outside of clip[%s]\n", frame_index, clip->vid_ctx->url);
+        return -1;
+    }
+    return get_cached_video_frame(fc, clip->vid_ctx, clip->orig_start_pts + pts, frame);
+}
+
+/**
+ * Find a frame in the cache (and mark it as most recently used)
+ * @param  fc    FrameCache
+ * @param  vc    VideoContext of the file
+ * @param  pts   pts of frame
+ * @return       cached frame, NULL when missing
+ */
+AVFrame *find_cached_frame(FrameCache *fc, VideoContext *vc, int64_t pts) {
+    FrameCacheEntry *entry = find_frame_cache_entry(fc, get_video_context_url(vc), vc->lowres, pts);
+    if(entry == NULL) {
+        return NULL;
+    }
+    touch_frame_cache_entry(fc, entry);
+    return entry->frame;
+}
+
+/**
+ * Add a decoded frame to the cache (a reference is kept). Least recently used
+ * frames are evicted to stay within max_bytes
+ * @param  fc    FrameCache
+ * @param  vc    VideoContext that decoded the frame
+ * @param  frame decoded frame (frame->pts is the key)
+ * @return       >= 0 on success
+ */
+int add_cached_frame(FrameCache *fc, VideoContext *vc, AVFrame *frame) {
+    char *url = get_video_context_url(vc);
+    int64_t size = get_frame_data_size(frame);
+    if(size > fc->max_bytes) {
+        return 0;
+    }
+    FrameCacheEntry *entry = find_frame_cache_entry(fc, url, vc->lowres, frame->pts);
+    if(entry != NULL) {
+        touch_frame_cache_entry(fc, entry);
+        return 0;
+    }
+    entry = malloc(sizeof(struct FrameCacheEntry));
+    if(entry == NULL) {
+        log_error("add_cached_frame() error: Failed to allocate entry\n");
+        return AVERROR(ENOMEM);
+    }
+    entry->url = strdup(url);
+    entry->frame = av_frame_clone(frame);
+    if(entry->url == NULL || entry->frame == NULL) {
+        log_error("add_cached_frame() error: Failed to reference frame\n");
+        free(entry->url);
+        av_frame_free(&(entry->frame));
+        free(entry);
+        return AVERROR(ENOMEM);
+    }
+    entry->lowres = vc->lowres;
+    entry->pts = frame->pts;
+    entry->hash = hash_frame_cache_key(url, vc->lowres, frame->pts);
+    entry->size = size;
+    // insert at the head of its bucket and of the LRU order
+    FrameCacheEntry **bucket = &(fc->buckets[entry->hash & (FRAME_CACHE_BUCKETS - 1)]);
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    entry->lru_prev = NULL;
+    entry->lru_next = fc->lru_head;
+    if(fc->lru_head != NULL) {
+        fc->lru_head->lru_prev = entry;
+    } else {
+        fc->lru_tail = entry;
+    }
+    fc->lru_head = entry;
+    fc->bytes += size;
+    ++(fc->nb_frames);
+    while(fc->bytes > fc->max_bytes && fc->lru_tail != NULL) {
+        remove_frame_cache_entry(fc, fc->lru_tail);
+    }
+    return 0;
+}
+
+/**
+ * Remove every frame from the cache
+ * @param fc FrameCache
+ */
+void clear_frame_cache(FrameCache *fc) {
+    while(fc->lru_head != NULL) {
+        remove_frame_cache_entry(fc, fc->lru_head);
+    }
+}
+
+/**
+ * Free the frames and data of a frame cache
+ * @param fc FrameCache
+ */
+void free_frame_cache(FrameCache *fc) {
+    if(fc->buckets != NULL) {
+        clear_frame_cache(fc);
+        free(fc->buckets);
+        fc->buckets = NULL;
+    }
+    av_frame_free(&(fc->decoded));
+    free(fc->last_url);
+    fc->last_url = NULL;
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Hash of a cache key
+ * @param  url    source file
+ * @param  lowres decoding resolution
+ * @param  pts    pts of frame
+ * @return        hash
+ */
+uint64_t hash_frame_cache_key(char *url, int lowres, int64_t pts) {
+    // FNV-1a over the url, then the lowres and pts are mixed in
+    uint64_t hash = 14695981039346656037ULL;
+    for(char *c = url; *c != '\0'; c++) {
+        hash = (hash ^ (uint8_t) *c) * 1099511628211ULL;
+    }
+    hash = (hash ^ (uint64_t) lowres) * 1099511628211ULL;
+    hash = (hash ^ (uint64_t) pts) * 1099511628211ULL;
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * Find an entry without changing the LRU order
+ * @param  fc     FrameCache
+ * @param  url    source file
+ * @param  lowres decoding resolution
+ * @param  pts    pts of frame
+ * @return        entry, NULL when missing
+ */
+FrameCacheEntry *find_frame_cache_entry(FrameCache *fc, char *url, int lowres, int64_t pts) {
+    uint64_t hash = hash_frame_cache_key(url, lowres, pts);
+    FrameCacheEntry *entry = fc->buckets[hash & (FRAME_CACHE_BUCKETS - 1)];
+    while(entry != NULL) {
+        if(entry->hash == hash && entry->pts == pts && entry->lowres == lowres && strcmp(entry->url, url) == 0) {
+            return entry;
+        }
+        entry = entry->bucket_next;
+    }
+    return NULL;
+}
+
+/**
+ * Move an entry to the head of the LRU order
+ * @param fc    FrameCache
+ * @param entry entry in the cache
+ */
+void touch_frame_cache_entry(FrameCache *fc, FrameCacheEntry *entry) {
+    if(fc->lru_head == entry) {
+        return;
+    }
+    // unlink (entry is not the head, so it has a prev)
+    entry->lru_prev->lru_next = entry->lru_next;
+    if(entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        fc->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = fc->lru_head;
+    fc->lru_head->lru_prev = entry;
+    fc->lru_head = entry;
+}
+
+/**
+ * Remove an entry from the cache and free it
+ * @param fc    FrameCache
+ * @param entry entry in the cache
+ */
+void remove_frame_cache_entry(FrameCache *fc, FrameCacheEntry *entry) {
+    FrameCacheEntry **link = &(fc->buckets[entry->hash & (FRAME_CACHE_BUCKETS - 1)]);
+    while(*link != NULL && *link != entry) {
+        link = &((*link)->bucket_next);
+    }
+    if(*link != NULL) {
+        *link = entry->bucket_next;
+    }
+    if(entry->lru_prev != NULL) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        fc->lru_head = entry->lru_next;
+    }
+    if(entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        fc->lru_tail = entry->lru_prev;
+    }
+    fc->bytes -= entry->size;
+    --(fc->nb_frames);
+    av_frame_free(&(entry->frame));
+    free(entry->url);
+    free(entry);
+}
+
+/**
+ * Get bytes of data held by a frame
+ * @param  frame AVFrame
+ * @return       size of all buffers of the frame
+ */
+int64_t get_frame_data_size(AVFrame *frame) {
+    int64_t size = 0;
+    for(int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i] != NULL; i++) {
+        size += frame->buf[i]->size;
+    }
+    return size;
+}
+
+/**
+ * Decode video frames from pts up to end_pts (inclusive) into the cache. Decodes forward
+ * from the decoder position when that is cheaper than seeking
+ * @param  fc      FrameCache
+ * @param  vc      opened VideoContext
+ * @param  pts     first frame wanted
+ * @param  end_pts last frame wanted
+ * @param  frame   output: first frame at or after pts (NULL when not wanted)
+ * @return         >= 0 on success
+ */
+int decode_cached_frames(FrameCache *fc, VideoContext *vc, int64_t pts, int64_t end_pts, AVFrame *frame) {
+    AVCodecContext *dec = vc->video_codec_ctx;
+    int64_t max_forward = FRAME_CACHE_MAX_FORWARD * get_cached_frame_duration(vc);
+    int ret = 0;
+    if(!video_decode_forward_cheaper(vc, pts, max_forward)) {
+        if((ret = seek_video_pts(vc, pts)) < 0) {
+            log_error("decode_cached_frames() error: Failed to seek to pts[%ld] in [%s]\n", pts, vc->url);
+            return ret;
+        }
+        // a sequential reader may have left frames in the decoder
+        avcodec_flush_buffers(dec);
+    }
+    // clips reading this VideoContext sequentially must seek again (see is_vc_out_bounds())
+    vc->seek_pts = -1;
+    vc->last_decoder_packet_stream = DEC_STREAM_NONE;
+    // video only: audio is demuxed again by the next clip seek (init_internal_vars())
+    set_stream_discard(vc, vc->audio_stream_idx, true);
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    bool found = (frame == NULL), done = false, eof = false;
+    while(!done && !(eof && ret == AVERROR_EOF)) {
+        if(!eof) {
+            ret = av_read_frame(vc->fmt_ctx, &pkt);
+            if(ret == AVERROR_EOF) {
+                eof = true;
+                ret = avcodec_send_packet(dec, NULL);
+            } else if(ret < 0) {
+                break;
+            } else if(pkt.stream_index != vc->video_stream_idx) {
+                av_packet_unref(&pkt);
+                continue;
+            } else {
+                ret = avcodec_send_packet(dec, &pkt);
+                av_packet_unref(&pkt);
+            }
+            if(ret < 0) {
+                log_error("decode_cached_frames() error: Failed to send packet (%s)\n", av_err2str(ret));
+                break;
+            }
+        }
+        while(!done && (ret = avcodec_receive_frame(dec, fc->decoded)) >= 0) {
+            int64_t frame_pts = fc->decoded->best_effort_timestamp;
+            if(frame_pts != AV_NOPTS_VALUE) {
+                fc->decoded->pts = frame_pts;
+                vc->last_decoded_pts = frame_pts;
+                // every decoded frame is cached, including the pre-roll from the key frame
+                if((ret = add_cached_frame(fc, vc, fc->decoded)) < 0) {
+                    break;
+                }
+                if(!found && frame_pts >= pts) {
+                    if((ret = av_frame_ref(frame, fc->decoded)) < 0) {
+                        break;
+                    }
+                    found = true;
+                }
+                done = frame_pts >= end_pts;
+            }
+            av_frame_unref(fc->decoded);
+        }
+        if(ret == AVERROR(EAGAIN)) {
+            ret = 0;
+        } else if(ret < 0 && ret != AVERROR_EOF) {
+            log_error("decode_cached_frames() error: Failed to decode frame (%s)\n", av_err2str(ret));
+            break;
+        }
+    }
+    av_frame_unref(fc->decoded);
+    if(eof) {
+        // a drained decoder must be flushed before it is used again
+        avcodec_flush_buffers(dec);
+        vc->last_decoded_pts = -1;
+    }
+    if(ret < 0 && ret != AVERROR_EOF) {
+        vc->last_decoded_pts = -1;
+        return ret;
+    }
+    return found ? 0 : AVERROR_EOF;
+}
+
+/**
+ * Cache the frames around a request in the direction of travel
+ * @param  fc  FrameCache
+ * @param  vc  opened VideoContext
+ * @param  pts pts of the request
+ * @return     >= 0 on success
+ */
+int prefetch_cached_frames(FrameCache *fc, VideoContext *vc, int64_t pts) {
+    if(fc->prefetch <= 0) {
+        return 0;
+    }
+    int64_t dur = get_cached_frame_duration(vc);
+    int64_t dist = fc->prefetch * dur;
+    char *url = get_video_context_url(vc);
+    bool backward = fc->last_url != NULL && strcmp(fc->last_url, url) == 0 && pts < fc->last_pts;
+    if(!backward) {
+        int64_t end = pts + dist;
+        // the decoder already passed the end (prefetched by an earlier request)
+        if(vc->last_decoded_pts >= end || find_frame_cache_entry(fc, url, vc->lowres, end) != NULL) {
+            return 0;
+        }
+        // go on from the frames decoded by the last prefetch (decoding forward, without seeking back)
+        int ret = decode_cached_frames(fc, vc, FFMAX(pts + dur, vc->last_decoded_pts + dur), end, NULL);
+        return ret == AVERROR_EOF ? 0 : ret;
+    }
+    int64_t start = FFMAX(pts - dist, 0);
+    if(start >= pts || find_frame_cache_entry(fc, url, vc->lowres, start) != NULL) {
+        return 0;
+    }
+    // decoded from the key frame before start: the previous GOP is cached on the way
+    int ret = decode_cached_frames(fc, vc, start, pts - dur, NULL);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+/**
+ * Get duration of one video frame
+ * @param  vc opened VideoContext
+ * @return    frame duration in video time base (> 0)
+ */
+int64_t get_cached_frame_duration(VideoContext *vc) {
+    int64_t dur = get_video_frame_pts(vc, 1);
+    return dur > 0 ? dur : 1;
+}
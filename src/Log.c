@@ -0,0 +1,89 @@
+/**
+ * @file Log.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for Log API:
+ * Leveled logging with a runtime threshold, a compile time minimum level and an
+ * optional callback sink.
+ */
+
+#include "Log.h"
+
+/* runtime threshold and sink shared by every module */
+enum LogLevel log_level = LOG_DEFAULT_LEVEL;
+LogCallback log_callback = NULL;
+void *log_callback_opaque = NULL;
+
+/**
+ * Set the runtime threshold: messages below level are ignored
+ * @param level LogLevel (LOG_LEVEL_QUIET to disable logging)
+ */
+void set_log_level(enum LogLevel level) {
+    log_level = level;
+}
+
+/**
+ * Get the runtime threshold
+ * @return LogLevel
+ */
+enum LogLevel get_log_level() {
+    return log_level;
+}
+
+/**
+ * Check if messages of a level pass the runtime threshold
+ * @param  level LogLevel
+ * @return       true if messages of level are written
+ */
+bool log_level_enabled(enum LogLevel level) {
+    return level >= log_level && level < LOG_LEVEL_QUIET;
+}
+
+/**
+ * Route log messages into a callback instead of stdout/stderr
+ * @param callback  LogCallback (NULL to restore stdout/stderr)
+ * @param opaque    user data passed to every call of callback
+ */
+void set_log_callback(LogCallback callback, void *opaque) {
+    log_callback = callback;
+    log_callback_opaque = opaque;
+}
+
+/**
+ * Write a log message (use the log_*() macros so disabled levels are never formatted).
+ * Without a callback, warnings and errors go to stderr and everything else to stdout
+ * @param level   LogLevel of message
+ * @param format  printf format
+ * @param VARARGS printf arguments
+ */
+void log_message(enum LogLevel level, const char *format, ...) {
+    if(!log_level_enabled(level)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    if(log_callback != NULL) {
+        char message[LOG_MAX_MESSAGE];
+        vsnprintf(message, LOG_MAX_MESSAGE, format, args);
+        log_callback(level, message, log_callback_opaque);
+    } else {
+        vfprintf(level >= LOG_LEVEL_WARNING ? stderr : stdout, format, args);
+    }
+    va_end(args);
+}
+
+/**
+ * Get the name of a log level
+ * @param  level LogLevel
+ * @return       name of level
+ */
+const char *get_log_level_name(enum LogLevel level) {
+    switch(level) {
+        case LOG_LEVEL_TRACE:   return "trace";
+        case LOG_LEVEL_DEBUG:   return "debug";
+        case LOG_LEVEL_INFO:    return "info";
+        case LOG_LEVEL_WARNING: return "warning";
+        case LOG_LEVEL_ERROR:   return "error";
+        default:                return "quiet";
+    }
+}
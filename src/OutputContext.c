@@ -31,6 +31,16 @@ void init_video_output(OutputContext *oc) {
     init_output_stream(&(oc->audio));
     oc->buffer_frame = av_frame_alloc();
     oc->last_encoder_frame_type = AVMEDIA_TYPE_NB;
+    oc->frame_pending = false;
+    init_video_converter(&(oc->video_convert));
+    init_audio_converter(&(oc->audio_convert));
+    oc->muxers = NULL;
+    oc->nb_muxers = 0;
+    oc->segment_duration_pts = 0;
+    oc->next_segment_pts = AV_NOPTS_VALUE;
+    oc->frame_step = 1;
+    oc->frame_count = 0;
+    init_render_stats(&(oc->stats));
 }
 
 /**
@@ -44,20 +54,20 @@ int add_stream(OutputContext *oc, OutputStream *os, enum AVCodecID codec_id) {
     // find the encoder
     os->codec = avcodec_find_encoder(codec_id);
     if (!(os->codec)) {
-        fprintf(stderr, "Could not find encoder for '%s'\n",
+        log_error("Could not find encoder for '%s'\n",
                 avcodec_get_name(codec_id));
         return -1;
     }
     // allocate codec context
     os->codec_ctx = avcodec_alloc_context3(os->codec);
     if (!(os->codec_ctx)) {
-        fprintf(stderr, "Could not alloc an encoding context\n");
+        log_error("Could not alloc an encoding context\n");
         return -1;
     }
     // Create stream for muxing
     os->stream = avformat_new_stream(oc->fmt_ctx, NULL);
     if(!(os->stream)) {
-        fprintf(stderr, "Could not allocate stream");
+        log_error("Could not allocate stream");
         return -1;
     }
     os->stream->id = oc->fmt_ctx->nb_streams-1;
@@ -111,7 +121,7 @@ int set_muxer_params(OutputContext *oc, OutputStream *os, AVCodecContext *c) {
     /* Fill the parameters struct based on the values from the supplied codec context */
     int ret = avcodec_parameters_from_context(os->stream->codecpar, c);
     if (ret < 0) {
-        fprintf(stderr, "Could not copy the codec parameters to the output stream (muxer)\n");
+        log_error("Could not copy the codec parameters to the output stream (muxer)\n");
         return ret;
     }
     /* Some formats want stream headers to be separate. */
@@ -121,22 +131,28 @@ int set_muxer_params(OutputContext *oc, OutputStream *os, AVCodecContext *c) {
     return 0;
 }
 
+/**
+ * Open the encoder of an OutputStream and copy its parameters to the muxer
+ * @param  oc OutputContext
+ * @param  os OutputStream (video or audio) within OutputContext
+ * @return    >= 0 on success
+ */
 int open_codec(OutputContext *oc, OutputStream *os) {
     /* Some formats want stream headers to be separate. */
-    if (oc->fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) {
+    if (output_needs_global_header(oc)) {
         os->codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
     }
     // open video codec
     int ret = avcodec_open2(os->codec_ctx, os->codec, NULL);
     if(ret < 0) {
-        fprintf(stderr, "Could not open video codec: %s\n", av_err2str(ret));
+        log_error("Could not open video codec: %s\n", av_err2str(ret));
         return ret;
     }
 
     /* Fill the parameters struct based on the values from the supplied codec context */
     ret = avcodec_parameters_from_context(os->stream->codecpar, os->codec_ctx);
     if (ret < 0) {
-        fprintf(stderr, "Could not copy the codec parameters to the output stream (muxer)\n");
+        log_error("Could not copy the codec parameters to the output stream (muxer)\n");
         return ret;
     }
     return 0;
@@ -153,63 +169,90 @@ int open_video_output(OutputContext *oc, OutputParameters *op, Sequence *seq) {
     enum AVCodecID vid_codec_id, aud_codec_id;
     int ret;
 
-    // Create AVFormatContext from input parameters
-    avformat_alloc_output_context2(&(oc->fmt_ctx), NULL, NULL, op->filename);
+    // Create AVFormatContext from input parameters (segmented outputs force their muxer)
+    avformat_alloc_output_context2(&(oc->fmt_ctx), NULL, get_segment_format_name(op), op->filename);
     if (!(oc->fmt_ctx)) {
-        printf("Could not deduce output format from file extension: using MP4.\n");
+        log_info("Could not deduce output format from file extension: using MP4.\n");
         avformat_alloc_output_context2(&(oc->fmt_ctx), NULL, "mp4", op->filename);
         if (!(oc->fmt_ctx)) {
-            fprintf(stderr, "Failed to allocate output context for file[%s]\n", op->filename);
+            log_error("Failed to allocate output context for file[%s]\n", op->filename);
             return -1;
         }
     }
     // video codec id override from user defined params
 
     if(op->video.codec_id != AV_CODEC_ID_NONE) {
-        printf("OVERRIDE VIDEO CODEC\n");
+        log_debug("OVERRIDE VIDEO CODEC\n");
         oc->fmt_ctx->oformat->video_codec = op->video.codec_id;
     }
     // audio codec id override from user defined params
     if(op->audio.codec_id != AV_CODEC_ID_NONE) {
-        printf("OVERRIDE AUDIO CODEC\n");
+        log_debug("OVERRIDE AUDIO CODEC\n");
         oc->fmt_ctx->oformat->audio_codec = op->audio.codec_id;
     }
     vid_codec_id = oc->fmt_ctx->oformat->video_codec;
     aud_codec_id = oc->fmt_ctx->oformat->audio_codec;
+
+    // additional muxers must exist before codecs are opened (global header flag)
+    ret = alloc_output_muxers(oc, op);
+    if(ret < 0) {
+        log_error("Failed to allocate additional muxers\n");
+        return ret;
+    }
     if(vid_codec_id != AV_CODEC_ID_NONE) {
         // create video stream
         ret = add_stream(oc, &(oc->video), vid_codec_id);
         if(ret < 0) {
-            fprintf(stderr, "Failed to create video stream\n");
+            log_error("Failed to create video stream\n");
             return ret;
         }
         ret = set_video_codec_params(oc, &(op->video));
         if(ret < 0) {
-            fprintf(stderr, "Failed to set video codec parameters\n");
+            log_error("Failed to set video codec parameters\n");
             return ret;
         }
         // codec context timebase is derived from sequence timebase
         oc->video.codec_ctx->time_base = seq->video_time_base;
+        if(op->draft) {
+            // time to preview over quality (preset is ignored by encoders without one)
+            av_opt_set(oc->video.codec_ctx->priv_data, "preset", "ultrafast", 0);
+            oc->video.codec_ctx->thread_count = 0;
+            oc->frame_step = FFMAX(op->draft_frame_step, 1);
+        }
+        if(op->segment_type != OUTPUT_SEGMENT_NONE) {
+            // segments must start on an IDR frame (libx264/libx265), ignored by other encoders
+            av_opt_set(oc->video.codec_ctx->priv_data, "forced-idr", "1", 0);
+            oc->segment_duration_pts = av_rescale_q((int64_t)(op->segment_duration * AV_TIME_BASE),
+                                            AV_TIME_BASE_Q, seq->video_time_base);
+        }
 
         ret = open_codec(oc, &(oc->video));
         if(ret < 0) {
-            fprintf(stderr, "Failed to set open video codec\n");
+            log_error("Failed to set open video codec\n");
+            return ret;
+        }
+        // decoded frames are converted into the encoder format
+        AVCodecContext *c = oc->video.codec_ctx;
+        ret = open_video_converter(&(oc->video_convert), c->width, c->height,
+                                   c->pix_fmt, op->video.scale_threads);
+        if(ret < 0) {
+            log_error("Failed to open video converter\n");
             return ret;
         }
     } else {
-        printf("out_ctx->fmt_ctx->oformat->video_codec == AV_CODEC_ID_NONE");
+        log_warning("out_ctx->fmt_ctx->oformat->video_codec == AV_CODEC_ID_NONE\n");
     }
 
     if(aud_codec_id != AV_CODEC_ID_NONE) {
         // create audio stream
         ret = add_stream(oc, &(oc->audio), aud_codec_id);
         if(ret < 0) {
-            fprintf(stderr, "Failed to create audio stream\n");
+            log_error("Failed to create audio stream\n");
             return ret;
         }
         ret = set_audio_codec_params(oc, &(op->audio));
         if(ret < 0) {
-            fprintf(stderr, "Failed to set audio codec parameters\n");
+            log_error("Failed to set audio codec parameters\n");
             return ret;
         }
         // codec context time base is derived from sequence time base
@@ -218,66 +261,450 @@ int open_video_output(OutputContext *oc, OutputParameters *op, Sequence *seq) {
         // open audio codec
         ret = open_codec(oc, &(oc->audio));
         if(ret < 0) {
-            fprintf(stderr, "Could not open audio codec: %s\n", av_err2str(ret));
+            log_error("Could not open audio codec: %s\n", av_err2str(ret));
+            return ret;
+        }
+        // decoded audio is resampled into the encoder format and frame_size
+        ret = open_audio_converter(&(oc->audio_convert), oc->audio.codec_ctx);
+        if(ret < 0) {
+            log_error("Failed to open audio converter\n");
             return ret;
         }
     } else {
-        printf("out_ctx->fmt_ctx->oformat->audio_codec == AV_CODEC_ID_NONE");
+        log_warning("out_ctx->fmt_ctx->oformat->audio_codec == AV_CODEC_ID_NONE\n");
     }
 
     /* open the output file, if needed */
     if(!(oc->fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
         ret = avio_open(&(oc->fmt_ctx->pb), op->filename, AVIO_FLAG_WRITE);
         if(ret < 0) {
-            fprintf(stderr, "Could not open '%s': %s\n", op->filename,
+            log_error("Could not open '%s': %s\n", op->filename,
                     av_err2str(ret));
             return ret;
         }
     }
 
-    ret = avformat_write_header(oc->fmt_ctx, NULL);
+    AVDictionary *opts = get_segment_muxer_options(op);
+    ret = avformat_write_header(oc->fmt_ctx, &opts);
+    av_dict_free(&opts);
     if(ret < 0) {
-        fprintf(stderr, "open_video_output(): Error occurred when opening output file: %s\n",
+        log_error("open_video_output(): Error occurred when opening output file: %s\n",
                 av_err2str(ret));
         close_video_output(oc, false);
+        return ret;
+    }
+    ret = open_output_muxers(oc);
+    if(ret < 0) {
+        close_video_output(oc, false);
+    }
+    return ret;
+}
+
+/**
+ * Get the muxer name of a segmented output
+ * @param  op   OutputParameters
+ * @return      name of muxer, NULL to deduce muxer from filename
+ */
+char *get_segment_format_name(OutputParameters *op) {
+    switch(op->segment_type) {
+        case OUTPUT_SEGMENT_HLS:
+        case OUTPUT_SEGMENT_HLS_FMP4:
+            return "hls";
+        case OUTPUT_SEGMENT_FRAGMENTED_MP4:
+            return "mp4";
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Get the muxer options of a segmented output
+ * @param  op   OutputParameters
+ * @return      options to be freed with av_dict_free() (NULL when not segmented)
+ */
+AVDictionary *get_segment_muxer_options(OutputParameters *op) {
+    AVDictionary *opts = NULL;
+    char buf[64];
+    if(op->segment_type == OUTPUT_SEGMENT_HLS || op->segment_type == OUTPUT_SEGMENT_HLS_FMP4) {
+        snprintf(buf, sizeof(buf), "%f", op->segment_duration);
+        av_dict_set(&opts, "hls_time", buf, 0);
+        // keep every segment in the playlist, and rewrite it as each segment finishes
+        av_dict_set(&opts, "hls_list_size", "0", 0);
+        av_dict_set(&opts, "hls_playlist_type", "event", 0);
+        av_dict_set(&opts, "hls_flags", "independent_segments", 0);
+        av_dict_set(&opts, "hls_segment_type",
+                    op->segment_type == OUTPUT_SEGMENT_HLS_FMP4 ? "fmp4" : "mpegts", 0);
+    } else if(op->segment_type == OUTPUT_SEGMENT_FRAGMENTED_MP4) {
+        // a fragment is written on the first key frame after each segment duration
+        av_dict_set(&opts, "movflags", "+frag_keyframe+empty_moov+default_base_moof", 0);
+        av_dict_set_int(&opts, "min_frag_duration", (int64_t)(op->segment_duration * AV_TIME_BASE), 0);
+    }
+    return opts;
+}
+
+/**
+ * Allocate the format context of each additional muxer target
+ * @param  oc   OutputContext
+ * @param  op   OutputParameters containing mux_filenames
+ * @return      >= 0 on success
+ */
+int alloc_output_muxers(OutputContext *oc, OutputParameters *op) {
+    if(op->nb_mux_filenames <= 0) {
+        return 0;
+    }
+    oc->muxers = malloc(sizeof(struct OutputMuxer) * op->nb_mux_filenames);
+    if(oc->muxers == NULL) {
+        log_error("alloc_output_muxers() error: Failed to allocate muxers\n");
+        return -1;
+    }
+    for(int i = 0; i < op->nb_mux_filenames; i++) {
+        OutputMuxer *m = &(oc->muxers[i]);
+        m->video_stream = NULL;
+        m->audio_stream = NULL;
+        m->fmt_ctx = NULL;
+        avformat_alloc_output_context2(&(m->fmt_ctx), NULL, NULL, op->mux_filenames[i]);
+        if(m->fmt_ctx == NULL) {
+            log_error("alloc_output_muxers() error: Could not deduce output format of file[%s]\n",
+                                op->mux_filenames[i]);
+            return -1;
+        }
+        ++(oc->nb_muxers);
+    }
+    return 0;
+}
+
+/**
+ * Check if every muxer target of the output wants stream headers to be separate.
+ * When only some targets do, encoders keep their headers in the bitstream:
+ * containers without global headers (mpegts, hls..) need them in band to be decodable
+ * @param  oc   OutputContext
+ * @return      true if encoders must use AV_CODEC_FLAG_GLOBAL_HEADER
+ */
+bool output_needs_global_header(OutputContext *oc) {
+    bool global_header = oc->fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER;
+    for(int i = 0; i < oc->nb_muxers; i++) {
+        if(!!(oc->muxers[i].fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) != global_header) {
+            log_warning("Muxer targets disagree on global headers: keeping stream headers in band\n");
+            return false;
+        }
+    }
+    return global_header;
+}
+
+/**
+ * Create the streams of each additional muxer from the opened encoders,
+ * open the files and write headers
+ * @param  oc   OutputContext with opened codecs
+ * @return      >= 0 on success
+ */
+int open_output_muxers(OutputContext *oc) {
+    int ret;
+    for(int i = 0; i < oc->nb_muxers; i++) {
+        OutputMuxer *m = &(oc->muxers[i]);
+        if(oc->video.codec_ctx != NULL) {
+            m->video_stream = add_muxer_stream(m->fmt_ctx, oc->video.codec_ctx);
+            if(m->video_stream == NULL) {
+                return -1;
+            }
+        }
+        if(oc->audio.codec_ctx != NULL) {
+            m->audio_stream = add_muxer_stream(m->fmt_ctx, oc->audio.codec_ctx);
+            if(m->audio_stream == NULL) {
+                return -1;
+            }
+        }
+        if(!(m->fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+            ret = avio_open(&(m->fmt_ctx->pb), m->fmt_ctx->url, AVIO_FLAG_WRITE);
+            if(ret < 0) {
+                log_error("Could not open '%s': %s\n", m->fmt_ctx->url, av_err2str(ret));
+                return ret;
+            }
+        }
+        ret = avformat_write_header(m->fmt_ctx, NULL);
+        if(ret < 0) {
+            log_error("open_output_muxers(): Error occurred when opening output file[%s]: %s\n",
+                    m->fmt_ctx->url, av_err2str(ret));
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Add a stream to a muxer with the parameters of an opened encoder
+ * @param  fmt_ctx  muxer
+ * @param  c        opened encoder
+ * @return          NULL on fail, not NULL on success
+ */
+AVStream *add_muxer_stream(AVFormatContext *fmt_ctx, AVCodecContext *c) {
+    AVStream *stream = avformat_new_stream(fmt_ctx, NULL);
+    if(stream == NULL) {
+        log_error("add_muxer_stream() error: Could not allocate stream\n");
+        return NULL;
+    }
+    stream->id = fmt_ctx->nb_streams - 1;
+    stream->time_base = c->time_base;
+    int ret = avcodec_parameters_from_context(stream->codecpar, c);
+    if(ret < 0) {
+        log_error("add_muxer_stream() error: Could not copy the codec parameters to the muxer\n");
+        return NULL;
+    }
+    return stream;
+}
+
+/**
+ * Write an encoded packet to the output file and every additional muxer target
+ * @param  oc   OutputContext
+ * @param  pkt  encoded packet with timestamps in the time_base of its oc->fmt_ctx stream
+ *              (packet is unreferenced)
+ * @return      >= 0 on success
+ */
+int output_write_packet(OutputContext *oc, AVPacket *pkt) {
+    AVStream *src_stream = oc->fmt_ctx->streams[pkt->stream_index];
+    enum AVMediaType type = src_stream->codecpar->codec_type;
+    int64_t start_ns = render_stats_start();
+    int ret;
+    for(int i = 0; i < oc->nb_muxers; i++) {
+        OutputMuxer *m = &(oc->muxers[i]);
+        AVStream *dst_stream = src_stream == oc->video.stream ? m->video_stream : m->audio_stream;
+        AVPacket mux_pkt;
+        av_init_packet(&mux_pkt);
+        mux_pkt.data = NULL;
+        mux_pkt.size = 0;
+        // packet data is shared, only timestamps are rescaled to this muxer
+        ret = av_packet_ref(&mux_pkt, pkt);
+        if(ret < 0) {
+            log_error("output_write_packet() error: Failed to reference packet\n");
+            return ret;
+        }
+        mux_pkt.stream_index = dst_stream->index;
+        av_packet_rescale_ts(&mux_pkt, src_stream->time_base, dst_stream->time_base);
+        ret = av_interleaved_write_frame(m->fmt_ctx, &mux_pkt);
+        if(ret < 0) {
+            log_error("Failed to write encoded packet to file[%s]:%s\n",
+                                        m->fmt_ctx->url, av_err2str(ret));
+            return ret;
+        }
+    }
+    ret = av_interleaved_write_frame(oc->fmt_ctx, pkt);
+    render_stats_add(&(oc->stats), type, RENDER_STAGE_MUX, start_ns, 1);
+    if(ret < 0) {
+        log_error("Failed to write encoded packet to file[%s]:%s\n",
+                                    oc->fmt_ctx->url, av_err2str(ret));
     }
     return ret;
 }
 
 /**
- * Open output file, write sequence packets and close the output file!
+ * Open output files, write sequence packets and close the output files!
  * (this is an end to end solution)
- * @param  seq      Sequence containing clips to write to file
- * @param  op       OutputParameters for video and audio codec/muxers (and filename)
- * @return          >= 0 on success
+ * When more than one output is given, the sequence is decoded once and every
+ * decoded frame is encoded into all outputs (ex: 1080p, 720p and 480p renditions)
+ * @param  seq          Sequence containing clips to write to file
+ * @param  op_list      array of OutputParameters for video and audio codec/muxers (and filename)
+ * @param  nb_outputs   number of OutputParameters in op_list
+ * @return              >= 0 on success
  */
-int write_sequence(Sequence *seq, OutputParameters *op) {
+int write_sequence(Sequence *seq, OutputParameters *op_list, int nb_outputs) {
+    if(nb_outputs > 1) {
+        return write_sequence_renditions(seq, op_list, nb_outputs);
+    } else if(nb_outputs < 1) {
+        log_error("write_sequence() error: No output parameters\n");
+        return -1;
+    }
+    OutputParameters *op = op_list;
     OutputContext oc;
     init_video_output(&oc);
+    bool stats_enabled = get_render_stats_enabled();
+    int64_t stats_start_ns = start_render_stats(seq, op);
     int ret = open_video_output(&oc, op, seq);
     if(ret < 0) {
-        fprintf(stderr, "write_sequence(): Failed to open video output[%s]\n", op->filename);
+        log_error("write_sequence(): Failed to open video output[%s]\n", op->filename);
+        set_render_stats_enabled(stats_enabled);
         return ret;
     }
 
     ret = write_sequence_frames(&oc, seq);
     if(ret < 0) {
         close_video_output(&oc, true);
+        set_render_stats_enabled(stats_enabled);
         return ret;
     }
 
     ret = close_video_output(&oc, true);
     if(ret < 0) {
-        fprintf(stderr, "write_sequence(): Failed to close video output[%s]\n", op->filename);
+        log_error("write_sequence(): Failed to close video output[%s]\n", op->filename);
+        set_render_stats_enabled(stats_enabled);
         return ret;
     }
+    ret = finish_render_stats(seq, &oc, op, 1, stats_start_ns);
+    set_render_stats_enabled(stats_enabled);
+    return ret;
+}
+
+/**
+ * Write a draft preview of a sequence (end to end solution tuned for time to preview).
+ * Video is decoded at reduced resolution where the codec supports it, and encoded
+ * with the fastest preset at low resolution. Audio keeps the format of the first
+ * clip, so matching clips skip resampling. The decoding options of every clip are restored after
+ * @param  seq          Sequence containing clips to write to file
+ * @param  filename     name of output file
+ * @param  height       height of preview (width keeps aspect ratio of first clip)
+ * @param  frame_step   encode every frame_step'th video frame (1 to keep every frame)
+ * @return              >= 0 on success
+ */
+int write_sequence_draft(Sequence *seq, char *filename, int height, int frame_step) {
+    if(seq->clips.head == NULL || height <= 0) {
+        log_error("write_sequence_draft() error: Invalid params\n");
+        return -1;
+    }
+    Clip *clip1 = (Clip *) seq->clips.head->data;
+    int ret = open_clip(clip1);
+    if(ret < 0) {
+        return ret;
+    }
+    OutputParameters op;
+    VideoOutParams vp;
+    AudioOutParams ap;
+    set_video_out_params(&vp, clip1->vid_ctx->video_codec_ctx);
+    set_audio_out_params(&ap, clip1->vid_ctx->audio_codec_ctx);
+    vp.codec_id = AV_CODEC_ID_NONE;
+    vp.bit_rate = -1;
+    // never upscale a preview
+    height = FFMIN(height, vp.height);
+    vp.width = (int) av_rescale(height, vp.width, vp.height) & ~1;
+    vp.height = height & ~1;
+    ret = set_output_params(&op, filename, vp, ap);
+    if(ret < 0) {
+        return ret;
+    }
+    set_output_draft(&op, frame_step);
+
+    // decode at the smallest power of 2 reduction still larger than the preview
+    int lowres = 0, src_height = clip1->vid_ctx->video_codec_ctx->height;
+    while(lowres < 3 && (src_height >> (lowres + 1)) >= height) {
+        ++lowres;
+    }
+    int *saved_lowres;
+    bool *saved_fast_decode;
+    ret = save_sequence_decode_options(seq, &saved_lowres, &saved_fast_decode);
+    if(ret < 0) {
+        free_output_params(&op);
+        return ret;
+    }
+    ret = sequence_set_decode_options(seq, lowres, true);
+    if(ret >= 0) {
+        sequence_seek(seq, 0);
+        ret = write_sequence(seq, &op, 1);
+    }
+    free_output_params(&op);
+    // restore the decoding options of the caller
+    int restore_ret = restore_sequence_decode_options(seq, saved_lowres, saved_fast_decode);
+    free(saved_lowres);
+    free(saved_fast_decode);
+    return ret < 0 ? ret : restore_ret;
+}
+
+/**
+ * Start collecting render stats if requested by output parameters (set_output_stats()).
+ * Clears the stats of every clip and enables render stats
+ * @param  seq  Sequence about to be written
+ * @param  op   OutputParameters of (first) output
+ * @return      start time of render, 0 when stats were not requested
+ */
+int64_t start_render_stats(Sequence *seq, OutputParameters *op) {
+    if(op->stats == NULL && op->stats_filename == NULL) {
+        return 0;
+    }
+    clear_sequence_render_stats(seq);
+    set_render_stats_enabled(true);
+    return render_stats_now();
+}
+
+/**
+ * Finish a render started with start_render_stats(): fill op->stats with the totals
+ * of all clips and outputs, and write the JSON report to op->stats_filename
+ * @param  seq          Sequence that was written
+ * @param  oc_list      array of OutputContexts written (closed, stats are still valid)
+ * @param  op_list      array of OutputParameters (stats requested in first output)
+ * @param  nb_outputs   number of outputs
+ * @param  start_ns     return from start_render_stats()
+ * @return              >= 0 on success
+ */
+int finish_render_stats(Sequence *seq, OutputContext *oc_list, OutputParameters *op_list, int nb_outputs, int64_t start_ns) {
+    if(start_ns == 0) {
+        return 0;
+    }
+    int64_t wall_ns = render_stats_now() - start_ns;
+    RenderStats total;
+    init_render_stats(&total);
+    get_sequence_render_stats(seq, &total);
+    for(int i = 0; i < nb_outputs; i++) {
+        merge_render_stats(&total, &(oc_list[i].stats));
+    }
+    if(op_list->stats != NULL) {
+        *(op_list->stats) = total;
+    }
+    if(op_list->stats_filename != NULL) {
+        return write_render_report(op_list->stats_filename, seq, oc_list, op_list, nb_outputs, &total, wall_ns);
+    }
+    return 0;
+}
+
+/**
+ * Write a JSON report of a render: wall time, totals, stats of every clip and every output
+ * @param  filename     name of report file
+ * @param  seq          Sequence that was written
+ * @param  oc_list      array of OutputContexts written
+ * @param  op_list      array of OutputParameters
+ * @param  nb_outputs   number of outputs
+ * @param  total        totals of all clips and outputs
+ * @param  wall_ns      wall time of the render in nanoseconds
+ * @return              >= 0 on success
+ */
+int write_render_report(char *filename, Sequence *seq, OutputContext *oc_list, OutputParameters *op_list,
+                        int nb_outputs, RenderStats *total, int64_t wall_ns) {
+    FILE *f = fopen(filename, "w");
+    if(f == NULL) {
+        log_error("write_render_report() error: Failed to open report[%s]\n", filename);
+        return -1;
+    }
+    fprintf(f, "{\n  \"wall_ms\": %.3f,\n  \"totals\": ", wall_ns / 1000000.0);
+    write_render_stats_json(f, total);
+    fprintf(f, ",\n  \"clips\": [");
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        Clip *clip = (Clip *) curr->data;
+        fprintf(f, "%s\n    {\"url\": ", curr == seq->clips.head ? "" : ",");
+        write_json_string(f, clip->vid_ctx->url);
+        fprintf(f, ", \"start_pts\": %" PRId64 ", \"end_pts\": %" PRId64 ", \"stats\": ",
+                clip->start_pts, clip->end_pts);
+        write_render_stats_json(f, &(clip->stats));
+        fprintf(f, "}");
+        curr = curr->next;
+    }
+    fprintf(f, "\n  ],\n  \"outputs\": [");
+    for(int i = 0; i < nb_outputs; i++) {
+        fprintf(f, "%s\n    {\"filename\": ", i > 0 ? "," : "");
+        write_json_string(f, op_list[i].filename);
+        fprintf(f, ", \"stats\": ");
+        write_render_stats_json(f, &(oc_list[i].stats));
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+    if(fclose(f) != 0) {
+        log_error("write_render_report() error: Failed to write report[%s]\n", filename);
+        return -1;
+    }
     return 0;
 }
 
 void log_packet(const AVFormatContext *fmt_ctx, const AVPacket *pkt)
 {
-    AVRational *time_base = &fmt_ctx->streams[pkt->stream_index]->time_base;
-    printf("pts:%s pts_time:%s dts:%s dts_time:%s duration:%s duration_time:%s stream_index:%d\n",
+    AVStream *stream = fmt_ctx->streams[pkt->stream_index];
+    AVRational *time_base = &stream->time_base;
+    log_trace("%s Packet | pts:%s pts_time:%s dts:%s dts_time:%s duration:%s duration_time:%s stream_index:%d\n",
+           stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO ? "Video" : "Audio",
            av_ts2str(pkt->pts), av_ts2timestr(pkt->pts, time_base),
            av_ts2str(pkt->dts), av_ts2timestr(pkt->dts, time_base),
            av_ts2str(pkt->duration), av_ts2timestr(pkt->duration, time_base),
@@ -294,31 +721,309 @@ int write_sequence_frames(OutputContext *oc, Sequence *seq) {
     int ret;
     AVPacket *pkt = av_packet_alloc();
     if(!pkt) {
-        fprintf(stderr, "Could not allocate reusable packet for write sequence\n");
+        log_error("Could not allocate reusable packet for write sequence\n");
         return -1;
     }
 
-    printf("Writing sequence to file[%s]..\n", oc->fmt_ctx->url);
-    while(sequence_encode_frame(oc, seq, pkt) >= 0) {
-        if(pkt->stream_index == oc->video.stream->index) {
-            printf("Video Packet | ");
-        } else if(pkt->stream_index == oc->audio.stream->index) {
-            printf("Audio Packet | ");
-        }
+    log_info("Writing sequence to file[%s]..\n", oc->fmt_ctx->url);
+    while((ret = sequence_encode_frame(oc, seq, pkt)) >= 0) {
         log_packet(oc->fmt_ctx, pkt);
-        // write the packet!
-        ret = av_interleaved_write_frame(oc->fmt_ctx, pkt);
+        // write the packet! (to every muxer target)
+        ret = output_write_packet(oc, pkt);
         if(ret < 0) {
-            fprintf(stderr, "Failed to write encoded packet to file[%s]:%s\n",
-                                        oc->fmt_ctx->url, av_err2str(ret));
-            return ret;
+            break;
         }
     }
     av_packet_free(&pkt);
-    printf("Successfully wrote sequence to file[%s]\n", oc->fmt_ctx->url);
+    // the sequence ends with AVERROR_EOF, anything else is an error
+    if(ret != AVERROR_EOF) {
+        log_error("write_sequence_frames() error: Failed to write sequence to file[%s]\n", oc->fmt_ctx->url);
+        return ret;
+    }
+    log_info("Successfully wrote sequence to file[%s]\n", oc->fmt_ctx->url);
+    return 0;
+}
+
+/**
+ * Open every output, write sequence frames into all of them from a single
+ * decode pass and close the outputs
+ * @param  seq          Sequence containing clips to write to file
+ * @param  op_list      array of OutputParameters (one per rendition)
+ * @param  nb_outputs   number of OutputParameters in op_list
+ * @return              >= 0 on success
+ */
+int write_sequence_renditions(Sequence *seq, OutputParameters *op_list, int nb_outputs) {
+    OutputContext *oc_list = malloc(sizeof(struct OutputContext) * nb_outputs);
+    if(oc_list == NULL) {
+        log_error("write_sequence_renditions() error: Failed to allocate outputs\n");
+        return -1;
+    }
+    int i, ret = 0;
+    bool stats_enabled = get_render_stats_enabled();
+    int64_t stats_start_ns = start_render_stats(seq, op_list);
+    for(i = 0; i < nb_outputs; i++) {
+        init_video_output(&(oc_list[i]));
+        ret = open_video_output(&(oc_list[i]), &(op_list[i]), seq);
+        if(ret < 0) {
+            log_error("write_sequence_renditions(): Failed to open video output[%s]\n",
+                                op_list[i].filename);
+            // free what was opened of this output
+            close_video_output(&(oc_list[i]), false);
+            break;
+        }
+    }
+    int nb_open = i;
+    if(ret >= 0) {
+        ret = write_sequence_frames_renditions(oc_list, nb_outputs, seq);
+    }
+    for(i = 0; i < nb_open; i++) {
+        int close_ret = close_video_output(&(oc_list[i]), ret >= 0);
+        if(close_ret < 0 && ret >= 0) {
+            log_error("write_sequence_renditions(): Failed to close video output[%s]\n",
+                                op_list[i].filename);
+            ret = close_ret;
+        }
+    }
+    if(ret >= 0) {
+        ret = finish_render_stats(seq, oc_list, op_list, nb_outputs, stats_start_ns);
+    }
+    set_render_stats_enabled(stats_enabled);
+    free(oc_list);
+    return ret < 0 ? ret : 0;
+}
+
+/**
+ * Decode entire sequence once and encode every frame into each output.
+ * Outputs are encoded from largest to smallest, and each video frame is scaled
+ * from the nearest larger rendition instead of the decoded frame
+ * @param  oc_list      array of opened OutputContexts
+ * @param  nb_outputs   number of OutputContexts in oc_list
+ * @param  seq          Sequence containing clips
+ * @return              >= 0 on success
+ */
+int write_sequence_frames_renditions(OutputContext *oc_list, int nb_outputs, Sequence *seq) {
+    int *order = get_rendition_order(oc_list, nb_outputs);
+    AVFrame *frame = av_frame_alloc();
+    if(order == NULL || frame == NULL) {
+        log_error("write_sequence_frames_renditions() error: Failed to allocate\n");
+        free(order);
+        av_frame_free(&frame);
+        return -1;
+    }
+    enum AVMediaType type;
+    int ret;
+    log_info("Writing sequence to %d renditions..\n", nb_outputs);
+    while(true) {
+        if((ret = sequence_read_frame(seq, frame, &type, true)) < 0) {
+            break;
+        }
+        for(int i = 0; i < nb_outputs && ret >= 0; i++) {
+            AVFrame *src = frame;
+            if(type == AVMEDIA_TYPE_VIDEO) {
+                src = get_rendition_source(oc_list, order, i, frame);
+            }
+            ret = output_encode_frame(&(oc_list[order[i]]), src, type);
+        }
+        if(ret < 0) {
+            break;
+        }
+    }
+    // only the end of the sequence is flushed (not a decoding or encoding error)
+    if(ret == AVERROR_EOF) {
+        ret = 0;
+        for(int i = 0; i < nb_outputs && ret >= 0; i++) {
+            ret = output_flush_encoders(&(oc_list[i]));
+        }
+    }
+    free(order);
+    av_frame_free(&frame);
+    if(ret < 0) {
+        log_error("write_sequence_frames_renditions() error: Failed to write renditions\n");
+        return ret;
+    }
+    log_info("Successfully wrote sequence to %d renditions\n", nb_outputs);
     return 0;
 }
 
+/**
+ * Get the order in which outputs are encoded (largest video size first)
+ * @param  oc_list      array of opened OutputContexts
+ * @param  nb_outputs   number of OutputContexts in oc_list
+ * @return              array of indexes into oc_list (to be freed by caller), NULL on fail
+ */
+int *get_rendition_order(OutputContext *oc_list, int nb_outputs) {
+    int *order = malloc(sizeof(int) * nb_outputs);
+    if(order == NULL) {
+        return NULL;
+    }
+    // insertion sort (there are only a few renditions)
+    for(int i = 0; i < nb_outputs; i++) {
+        int64_t area = get_rendition_area(&(oc_list[i]));
+        int j = i;
+        while(j > 0 && get_rendition_area(&(oc_list[order[j - 1]])) < area) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+    return order;
+}
+
+/**
+ * Get number of pixels in the video frames of an output
+ * @param  oc   OutputContext
+ * @return      width * height of output video frames
+ */
+int64_t get_rendition_area(OutputContext *oc) {
+    return (int64_t)oc->video_convert.width * oc->video_convert.height;
+}
+
+/**
+ * Get the frame a rendition is scaled from: the frame of the nearest larger
+ * rendition that was already encoded, or the decoded frame if there is none
+ * @param  oc_list  array of OutputContexts
+ * @param  order    encoding order from get_rendition_order()
+ * @param  i        index into order of rendition
+ * @param  decoded  decoded video frame
+ * @return          source video frame
+ */
+AVFrame *get_rendition_source(OutputContext *oc_list, int *order, int i, AVFrame *decoded) {
+    VideoConverter *vc = &(oc_list[order[i]].video_convert);
+    for(int j = i - 1; j >= 0; j--) {
+        AVFrame *f = oc_list[order[j]].buffer_frame;
+        if(f->buf[0] != NULL && f->width >= vc->width && f->height >= vc->height
+            && f->width <= decoded->width && f->height <= decoded->height) {
+            return f;
+        }
+    }
+    return decoded;
+}
+
+/**
+ * Convert a decoded frame into the output format, encode it and write
+ * all packets available from the encoder
+ * @param  oc       OutputContext
+ * @param  frame    decoded frame (not modified, the output keeps its own reference)
+ * @param  type     type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return          >= 0 on success
+ */
+int output_encode_frame(OutputContext *oc, AVFrame *frame, enum AVMediaType type) {
+    av_frame_unref(oc->buffer_frame);
+    if(type == AVMEDIA_TYPE_VIDEO && drop_video_frame(oc)) {
+        return 0;
+    }
+    int ret = av_frame_ref(oc->buffer_frame, frame);
+    if(ret < 0) {
+        log_error("output_encode_frame() error: Failed to reference frame\n");
+        return ret;
+    }
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        ret = convert_video_frame(&(oc->video_convert), oc->buffer_frame);
+        if(ret < 0) {
+            return ret;
+        }
+        set_segment_key_frame(oc, oc->buffer_frame);
+        return output_send_frame(oc, &(oc->video), oc->buffer_frame);
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        ret = send_audio_convert_frame(&(oc->audio_convert), oc->buffer_frame);
+        if(ret < 0) {
+            return ret;
+        }
+        return output_send_audio_frames(oc);
+    }
+    log_error("output_encode_frame() error: frame type must be AVMEDIA_TYPE_VIDEO or AVMEDIA_TYPE_AUDIO\n");
+    return -1;
+}
+
+/**
+ * Encode every audio frame ready in the audio converter
+ * @param  oc   OutputContext
+ * @return      >= 0 on success
+ */
+int output_send_audio_frames(OutputContext *oc) {
+    int ret;
+    while((ret = receive_audio_convert_frame(&(oc->audio_convert), oc->buffer_frame)) == 0) {
+        ret = output_send_frame(oc, &(oc->audio), oc->buffer_frame);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Send a frame to an encoder and write all packets available from it
+ * @param  oc       OutputContext
+ * @param  os       OutputStream (video or audio) within OutputContext
+ * @param  frame    frame in encoder format, NULL to flush the encoder
+ * @return          >= 0 on success
+ */
+int output_send_frame(OutputContext *oc, OutputStream *os, AVFrame *frame) {
+    int64_t start_ns = render_stats_start();
+    int ret = avcodec_send_frame(os->codec_ctx, frame);
+    render_stats_add(&(oc->stats), os->codec_ctx->codec_type, RENDER_STAGE_ENCODE, start_ns, 0);
+    if(ret < 0) {
+        log_error("output_send_frame() error: Failed to send frame to encoder[%s]\n",
+                            av_err2str(ret));
+        return ret;
+    }
+    if(frame == NULL) {
+        os->flushing = true;
+    }
+    return output_write_packets(oc, os);
+}
+
+/**
+ * Write all packets available from an encoder into the output file
+ * @param  oc       OutputContext
+ * @param  os       OutputStream (video or audio) within OutputContext
+ * @return          >= 0 on success
+ */
+int output_write_packets(OutputContext *oc, OutputStream *os) {
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    int ret;
+    int64_t start_ns = render_stats_start();
+    while((ret = seq_receive_enc_packet(os, &pkt)) == 0) {
+        render_stats_add(&(oc->stats), os->codec_ctx->codec_type, RENDER_STAGE_ENCODE, start_ns, 1);
+        ret = output_write_packet(oc, &pkt);
+        if(ret < 0) {
+            return ret;
+        }
+        start_ns = render_stats_start();
+    }
+    render_stats_add(&(oc->stats), os->codec_ctx->codec_type, RENDER_STAGE_ENCODE, start_ns, 0);
+    if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Encode the remaining audio samples, flush both encoders and write
+ * the remaining packets
+ * @param  oc   OutputContext
+ * @return      >= 0 on success
+ */
+int output_flush_encoders(OutputContext *oc) {
+    int ret = flush_audio_converter(&(oc->audio_convert));
+    if(ret >= 0) {
+        ret = output_send_audio_frames(oc);
+    }
+    if(ret >= 0) {
+        ret = output_send_frame(oc, &(oc->video), NULL);
+    }
+    if(ret >= 0) {
+        ret = output_send_frame(oc, &(oc->audio), NULL);
+    }
+    return ret;
+}
+
 /**
  * Set OutputParameters given Video and Audio OutputParameters
  * @param op        OutputParameters to set filename, video and audio params
@@ -329,13 +1034,110 @@ int write_sequence_frames(OutputContext *oc, Sequence *seq) {
  */
 int set_output_params(OutputParameters *op, char *filename, VideoOutParams vp, AudioOutParams ap) {
     if(op == NULL || filename == NULL) {
-        printf("set_output_params(): parameters cannot be NULL\n");
+        log_error("set_output_params(): parameters cannot be NULL\n");
         return -1;
     }
     op->filename = malloc(sizeof(char) * (strlen(filename) + 1));
     strcpy(op->filename, filename);
     op->video = vp;
     op->audio = ap;
+    op->mux_filenames = NULL;
+    op->nb_mux_filenames = 0;
+    op->segment_type = OUTPUT_SEGMENT_NONE;
+    op->segment_duration = 0;
+    op->draft = false;
+    op->draft_frame_step = 1;
+    op->stats = NULL;
+    op->stats_filename = NULL;
+    return 0;
+}
+
+/**
+ * Tune output for time to preview: fastest encoder preset and
+ * optionally a lower frame rate
+ * @param  op           OutputParameters already set with set_output_params()
+ * @param  frame_step   encode every frame_step'th video frame (1 to keep every frame)
+ * @return              >= 0 on success
+ */
+int set_output_draft(OutputParameters *op, int frame_step) {
+    if(op == NULL || frame_step < 1) {
+        log_error("set_output_draft() error: Invalid params\n");
+        return -1;
+    }
+    op->draft = true;
+    op->draft_frame_step = frame_step;
+    return 0;
+}
+
+/**
+ * Collect render stats (time and count of demux, decode, seek, encode and mux) during write_sequence()
+ * @param  op               OutputParameters already set with set_output_params()
+ * @param  stats            filled with the totals of the render (can be NULL)
+ * @param  report_filename  JSON report written after the render (can be NULL)
+ * @return                  >= 0 on success
+ */
+int set_output_stats(OutputParameters *op, RenderStats *stats, char *report_filename) {
+    if(op == NULL) {
+        log_error("set_output_stats() error: Invalid params\n");
+        return -1;
+    }
+    op->stats = stats;
+    free(op->stats_filename);
+    op->stats_filename = NULL;
+    if(report_filename != NULL) {
+        op->stats_filename = malloc(strlen(report_filename) + 1);
+        if(op->stats_filename == NULL) {
+            log_error("set_output_stats() error: Failed to allocate filename\n");
+            return AVERROR(ENOMEM);
+        }
+        strcpy(op->stats_filename, report_filename);
+    }
+    return 0;
+}
+
+/**
+ * Write output as segments (HLS or fragmented MP4) instead of one monolithic file,
+ * so segments can be consumed while the sequence is still rendering
+ * @param  op       OutputParameters already set with set_output_params()
+ *                  (filename is the playlist .m3u8 for HLS)
+ * @param  type     segmented output mode
+ * @param  duration duration of each segment in seconds
+ * @return          >= 0 on success
+ */
+int set_output_segments(OutputParameters *op, enum OutputSegmentType type, double duration) {
+    if(op == NULL || (type != OUTPUT_SEGMENT_NONE && duration <= 0)) {
+        log_error("set_output_segments() error: Invalid params\n");
+        return -1;
+    }
+    op->segment_type = type;
+    op->segment_duration = duration;
+    return 0;
+}
+
+/**
+ * Add a file written with the same encoded packets as the main output file
+ * (encode once, mux to multiple containers. ex: out.mp4, out.mov and out.ts)
+ * @param  op       OutputParameters already set with set_output_params()
+ * @param  filename name of additional output file (container deduced from extension)
+ * @return          >= 0 on success
+ */
+int add_output_mux_target(OutputParameters *op, char *filename) {
+    if(op == NULL || filename == NULL) {
+        log_error("add_output_mux_target() error: parameters cannot be NULL\n");
+        return -1;
+    }
+    char **list = realloc(op->mux_filenames, sizeof(char *) * (op->nb_mux_filenames + 1));
+    if(list == NULL) {
+        log_error("add_output_mux_target() error: Failed to allocate filename list\n");
+        return -1;
+    }
+    op->mux_filenames = list;
+    list[op->nb_mux_filenames] = malloc(sizeof(char) * (strlen(filename) + 1));
+    if(list[op->nb_mux_filenames] == NULL) {
+        return -1;
+    }
+    strcpy(list[op->nb_mux_filenames], filename);
+    ++(op->nb_mux_filenames);
     return 0;
 }
 
@@ -351,6 +1153,7 @@ void set_video_out_params(VideoOutParams *op, AVCodecContext *c) {
     op->width = c->width;
     op->height = c->height;
     op->bit_rate = c->bit_rate;
+    op->scale_threads = 0;
 }
 
 /**
@@ -375,6 +1178,14 @@ void free_output_params(OutputParameters *op) {
         free(op->filename);
         op->filename = NULL;
     }
+    for(int i = 0; i < op->nb_mux_filenames; i++) {
+        free(op->mux_filenames[i]);
+    }
+    free(op->mux_filenames);
+    op->mux_filenames = NULL;
+    op->nb_mux_filenames = 0;
+    free(op->stats_filename);
+    op->stats_filename = NULL;
 }
 
 /**
@@ -392,26 +1203,56 @@ void close_output_stream(OutputStream *os) {
  * @return         >= 0 on success
  */
 int close_video_output(OutputContext *out_ctx, bool trailer_flag) {
-    int ret;
+    int ret = 0;
+    if(out_ctx->fmt_ctx == NULL) {
+        // never opened, or closed already (open_video_output() failed)
+        av_frame_free(&(out_ctx->buffer_frame));
+        return 0;
+    }
     if(trailer_flag) {
         ret = av_write_trailer(out_ctx->fmt_ctx);
         if(ret < 0) {
-            fprintf(stderr, "Failed to write trailer [%s]\n", out_ctx->fmt_ctx->url);
+            log_error("Failed to write trailer [%s]\n", out_ctx->fmt_ctx->url);
             return ret;
         }
-        printf("wrote trailer successfully!!\n");
+        log_debug("wrote trailer successfully!!\n");
     }
 
     if(!(out_ctx->fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
         /* Close the output file */
         ret = avio_closep(&(out_ctx->fmt_ctx->pb));
         if(ret < 0) {
-            fprintf(stderr, "Failed to close output file [%s]\n", out_ctx->fmt_ctx->url);
+            log_error("Failed to close output file [%s]\n", out_ctx->fmt_ctx->url);
         }
     }
+    close_output_muxers(out_ctx, trailer_flag);
     close_output_stream(&(out_ctx->video));     // close codecs
     close_output_stream(&(out_ctx->audio));
+    close_video_converter(&(out_ctx->video_convert));
+    close_audio_converter(&(out_ctx->audio_convert));
     av_frame_free(&(out_ctx->buffer_frame));    // free the buffer frame
     avformat_free_context(out_ctx->fmt_ctx);    // free the stream
+    out_ctx->fmt_ctx = NULL;
     return ret;
-}
\ No newline at end of file
+}
+
+/**
+ * Write trailers, close files and free every additional muxer target
+ * @param oc            OutputContext
+ * @param trailer_flag  when true, trailers will attempt to be written
+ */
+void close_output_muxers(OutputContext *oc, bool trailer_flag) {
+    for(int i = 0; i < oc->nb_muxers; i++) {
+        AVFormatContext *fmt_ctx = oc->muxers[i].fmt_ctx;
+        if(trailer_flag && av_write_trailer(fmt_ctx) < 0) {
+            log_error("Failed to write trailer [%s]\n", fmt_ctx->url);
+        }
+        if(!(fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&(fmt_ctx->pb));
+        }
+        avformat_free_context(fmt_ctx);
+    }
+    free(oc->muxers);
+    oc->muxers = NULL;
+    oc->nb_muxers = 0;
+}
@@ -0,0 +1,621 @@
+/**
+ * @file Proxy.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the source for Proxy API:
+ * Proxies are low resolution, intra-only (or short GOP) copies of source files
+ * with timestamps identical to the original. They are transcoded in the background,
+ * mapped to the VideoContext of the original, and a Sequence can switch between
+ * proxies (previews, analysis) and originals (final render) at any time.
+ */
+
+#include "Proxy.h"
+
+/**
+ * Set default proxy parameters (360p, intra-only MJPEG next to the original)
+ * @param params ProxyParams
+ */
+void set_proxy_params_default(ProxyParams *params) {
+    params->height = 360;
+    params->codec_id = AV_CODEC_ID_MJPEG;
+    params->gop_size = 1;
+    params->bit_rate = 4000000;
+    params->dir = NULL;
+}
+
+/**
+ * Initialize ProxyManager
+ * @param  pm     ProxyManager
+ * @param  params parameters of all proxies (copied, dir is not)
+ * @return        >= 0 on success
+ */
+int init_proxy_manager(ProxyManager *pm, ProxyParams *params) {
+    if(pm == NULL || params == NULL) {
+        log_error("init_proxy_manager() error: params cannot be NULL\n");
+        return -1;
+    }
+    pm->proxies = initializeList(&list_print_proxy, &list_delete_proxy, &list_compare_proxy);
+    pm->params = *params;
+    return 0;
+}
+
+/**
+ * Start creating proxies in the background for every file used in a sequence and its tracks
+ * (files which already have a proxy are not transcoded again, their clips are added to it)
+ * @param  pm  ProxyManager
+ * @param  seq Sequence
+ * @return     >= 0 on success
+ */
+int sequence_create_proxies(ProxyManager *pm, Sequence *seq) {
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        Clip *clip = (Clip *) curr->data;
+        Proxy *p = find_proxy(pm, clip->vid_ctx->url);
+        int ret = p == NULL ? create_proxy(pm, clip->vid_ctx) : add_proxy_video_context(p, clip->vid_ctx);
+        if(ret < 0) {
+            return ret;
+        }
+        curr = curr->next;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        int ret = sequence_create_proxies(pm, &(seq->tracks[i]->seq));
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Start creating a proxy in the background for the file of a VideoContext.
+ * A proxy on disk newer than the original, made with the same parameters, is reused
+ * @param  pm      ProxyManager
+ * @param  vid_ctx VideoContext of original file
+ * @return         >= 0 on success
+ */
+int create_proxy(ProxyManager *pm, VideoContext *vid_ctx) {
+    Proxy *p = malloc(sizeof(struct Proxy));
+    if(p == NULL) {
+        log_error("create_proxy() error: Failed to allocate proxy\n");
+        return -1;
+    }
+    p->vid_ctxs = NULL;
+    p->nb_vid_ctxs = 0;
+    p->params = pm->params;
+    p->running = false;
+    p->ret = -1;
+    // the thread gets its own copy of the filenames (VideoContext is not thread safe)
+    p->orig_url = malloc(strlen(vid_ctx->url) + 1);
+    p->url = get_proxy_url(vid_ctx->url, pm->params.dir);
+    if(p->orig_url == NULL || p->url == NULL || add_proxy_video_context(p, vid_ctx) < 0) {
+        log_error("create_proxy() error: Failed to allocate filenames\n");
+        list_delete_proxy(p);
+        return -1;
+    }
+    strcpy(p->orig_url, vid_ctx->url);
+    if(pthread_create(&(p->thread), NULL, &proxy_thread, p) != 0) {
+        log_error("create_proxy() error: Failed to start thread for proxy[%s]\n", p->url);
+        list_delete_proxy(p);
+        return -1;
+    }
+    p->running = true;
+    insertBack(&(pm->proxies), p);
+    return 0;
+}
+
+/**
+ * Wait for all background proxies to finish, and map each finished proxy
+ * to every VideoContext of its original
+ * @param  pm ProxyManager
+ * @return    >= 0 when all proxies are ready (files without proxy keep using originals)
+ */
+int wait_proxies(ProxyManager *pm) {
+    int ret = 0;
+    Node *curr = pm->proxies.head;
+    while(curr != NULL) {
+        Proxy *p = (Proxy *) curr->data;
+        if(p->running) {
+            pthread_join(p->thread, NULL);
+            p->running = false;
+            for(int i = 0; i < p->nb_vid_ctxs && p->ret >= 0; i++) {
+                if(set_video_context_proxy(p->vid_ctxs[i], p->url) < 0) {
+                    p->ret = -1;
+                }
+            }
+        }
+        if(p->ret < 0) {
+            log_error("wait_proxies(): No proxy for [%s], original will be used\n", p->orig_url);
+            ret = -1;
+        }
+        curr = curr->next;
+    }
+    return ret;
+}
+
+/**
+ * Find the proxy of an original file
+ * @param  pm       ProxyManager
+ * @param  orig_url filename of original
+ * @return          NULL if not found
+ */
+Proxy *find_proxy(ProxyManager *pm, char *orig_url) {
+    Node *curr = pm->proxies.head;
+    while(curr != NULL) {
+        Proxy *p = (Proxy *) curr->data;
+        if(strcmp(p->orig_url, orig_url) == 0) {
+            return p;
+        }
+        curr = curr->next;
+    }
+    return NULL;
+}
+
+/**
+ * Switch every clip of a sequence (and its tracks) between proxies and originals.
+ * Clips without a proxy keep reading originals.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq       Sequence
+ * @param  use_proxy true to read proxies, false to read originals
+ * @return           >= 0 on success
+ */
+int sequence_use_proxies(Sequence *seq, bool use_proxy) {
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        Clip *clip = (Clip *) curr->data;
+        VideoContext *vc = clip->vid_ctx;
+        // clips sharing a VideoContext are switched together
+        if(vc->proxy_url != NULL && vc->use_proxy != use_proxy) {
+            bool was_open = vc->open;
+            close_video_context(vc);
+            vc->use_proxy = use_proxy;
+            if(was_open) {
+                int ret = open_clip(clip);
+                if(ret < 0) {
+                    log_error("sequence_use_proxies() error: Failed to reopen clip[%s]\n",
+                                        get_video_context_url(vc));
+                    return ret;
+                }
+            }
+        }
+        curr = curr->next;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        int ret = sequence_use_proxies(&(seq->tracks[i]->seq), use_proxy);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Wait for proxies and free ProxyManager (proxy files are kept on disk)
+ * @param pm ProxyManager
+ */
+void free_proxy_manager(ProxyManager *pm) {
+    clearList(&(pm->proxies));
+    pm->proxies.length = 0;
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Add a VideoContext of the original file to a proxy (each context is added once).
+ * The context is mapped to the proxy right away when it is already ready
+ * @param  p       Proxy
+ * @param  vid_ctx VideoContext of original file
+ * @return         >= 0 on success
+ */
+int add_proxy_video_context(Proxy *p, VideoContext *vid_ctx) {
+    for(int i = 0; i < p->nb_vid_ctxs; i++) {
+        if(p->vid_ctxs[i] == vid_ctx) {
+            return 0;
+        }
+    }
+    VideoContext **vid_ctxs = realloc(p->vid_ctxs, (p->nb_vid_ctxs + 1) * sizeof(VideoContext *));
+    if(vid_ctxs == NULL) {
+        log_error("add_proxy_video_context() error: Failed to allocate VideoContext list\n");
+        return AVERROR(ENOMEM);
+    }
+    p->vid_ctxs = vid_ctxs;
+    p->vid_ctxs[(p->nb_vid_ctxs)++] = vid_ctx;
+    // wait_proxies() already mapped the other contexts
+    if(!p->running && p->ret >= 0) {
+        return set_video_context_proxy(vid_ctx, p->url);
+    }
+    return 0;
+}
+
+/**
+ * Get the filename of the proxy of a file
+ * @param  orig_url filename of original
+ * @param  dir      directory of proxy (NULL for directory of original)
+ * @return          filename allocated on heap, to be freed by caller
+ */
+char *get_proxy_url(char *orig_url, char *dir) {
+    char *name = orig_url;
+    size_t len = strlen(orig_url) + strlen(PROXY_EXTENSION) + 1;
+    if(dir != NULL) {
+        char *slash = strrchr(orig_url, '/');
+        if(slash != NULL) {
+            name = slash + 1;
+        }
+        len = strlen(dir) + 1 + strlen(name) + strlen(PROXY_EXTENSION) + 1;
+    }
+    char *url = malloc(len);
+    if(url == NULL) {
+        return NULL;
+    }
+    if(dir != NULL) {
+        sprintf(url, "%s/%s%s", dir, name, PROXY_EXTENSION);
+    } else {
+        sprintf(url, "%s%s", orig_url, PROXY_EXTENSION);
+    }
+    return url;
+}
+
+/**
+ * Check if a proxy on disk is newer than its original and was made with the
+ * parameters of the Proxy (size, codec, gop size and bit rate)
+ * @param  p Proxy
+ * @return   true if proxy can be reused
+ */
+bool proxy_up_to_date(Proxy *p) {
+    struct stat orig_stats, proxy_stats;
+    if(stat(p->orig_url, &orig_stats) != 0 || stat(p->url, &proxy_stats) != 0) {
+        return false;
+    }
+    if(proxy_stats.st_mtime < orig_stats.st_mtime || proxy_stats.st_size <= 0) {
+        return false;
+    }
+    return proxy_params_match(p);
+}
+
+/**
+ * Get the string identifying the parameters of a proxy (stored in the proxy metadata)
+ * @param params ProxyParams
+ * @param buf    output string of PROXY_PARAMS_TAG_SIZE bytes
+ */
+void get_proxy_params_tag(ProxyParams *params, char *buf) {
+    snprintf(buf, PROXY_PARAMS_TAG_SIZE, "proxy height=%d codec=%s gop=%d bit_rate=%" PRId64,
+                params->height, avcodec_get_name(params->codec_id), params->gop_size, params->bit_rate);
+}
+
+/**
+ * Check if the metadata of a proxy file matches the parameters of a Proxy
+ * @param  p Proxy
+ * @return   true if the proxy file was made with the same parameters
+ */
+bool proxy_params_match(Proxy *p) {
+    AVFormatContext *fmt_ctx = NULL;
+    if(avformat_open_input(&fmt_ctx, p->url, NULL, NULL) < 0) {
+        return false;
+    }
+    char tag[PROXY_PARAMS_TAG_SIZE];
+    get_proxy_params_tag(&(p->params), tag);
+    AVDictionaryEntry *entry = av_dict_get(fmt_ctx->metadata, PROXY_PARAMS_TAG, NULL, 0);
+    bool match = entry != NULL && strcmp(entry->value, tag) == 0;
+    avformat_close_input(&fmt_ctx);
+    return match;
+}
+
+/**
+ * Thread creating a proxy
+ * @param  arg Proxy
+ * @return     NULL
+ */
+void *proxy_thread(void *arg) {
+    Proxy *p = (Proxy *) arg;
+    if(proxy_up_to_date(p)) {
+        log_info("Reusing proxy[%s]\n", p->url);
+        p->ret = 0;
+        return NULL;
+    }
+    p->ret = transcode_proxy(p);
+    if(p->ret < 0) {
+        // never leave a partial proxy behind (it would be reused next time)
+        remove(p->url);
+    }
+    return NULL;
+}
+
+/**
+ * Transcode the original file into its proxy (video is scaled and re-encoded,
+ * audio is copied). Timestamps and time bases are identical to the original
+ * @param  p Proxy
+ * @return   >= 0 on success
+ */
+int transcode_proxy(Proxy *p) {
+    VideoContext in;
+    ProxyOutput out;
+    AVPacket pkt;
+    init_video_context(&in);
+    out.fmt_ctx = NULL;
+    out.codec_ctx = NULL;
+    out.frame = NULL;
+    init_video_converter(&(out.convert));
+
+    int ret = open_video_context(&in, p->orig_url);
+    if(ret < 0) {
+        log_error("transcode_proxy() error: Failed to open original[%s]\n", p->orig_url);
+        goto end;
+    }
+    ret = open_proxy_output(p, &in, &out);
+    if(ret < 0) {
+        goto end;
+    }
+    log_info("Creating proxy[%s]..\n", p->url);
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while((ret = av_read_frame(in.fmt_ctx, &pkt)) >= 0) {
+        if(pkt.stream_index == in.video_stream_idx) {
+            ret = proxy_decode_packet(&in, &out, &pkt);
+            av_packet_unref(&pkt);
+        } else if(pkt.stream_index == in.audio_stream_idx && out.audio_stream != NULL) {
+            // audio is copied, timestamps stay identical
+            AVStream *in_stream = get_audio_stream(&in);
+            pkt.stream_index = out.audio_stream->index;
+            av_packet_rescale_ts(&pkt, in_stream->time_base, out.audio_stream->time_base);
+            ret = av_interleaved_write_frame(out.fmt_ctx, &pkt);
+        } else {
+            av_packet_unref(&pkt);
+        }
+        if(ret < 0) {
+            goto end;
+        }
+    }
+    // flush decoder, then encoder
+    ret = proxy_decode_packet(&in, &out, NULL);
+    if(ret >= 0) {
+        ret = proxy_encode_frame(&out, NULL);
+    }
+    if(ret >= 0) {
+        ret = av_write_trailer(out.fmt_ctx);
+    }
+    if(ret >= 0) {
+        log_info("Created proxy[%s]\n", p->url);
+    }
+end:
+    close_proxy_output(&out);
+    close_video_context(&in);
+    return ret;
+}
+
+/**
+ * Open proxy file, video encoder and muxer with the time bases of the original
+ * @param  p   Proxy
+ * @param  in  opened VideoContext of original
+ * @param  out ProxyOutput to open
+ * @return     >= 0 on success
+ */
+int open_proxy_output(Proxy *p, VideoContext *in, ProxyOutput *out) {
+    AVRational video_tb = get_video_time_base(in);
+    if(video_tb.num != 1) {
+        log_error("open_proxy_output() error: Cannot keep video time base %d/%d of [%s]\n",
+                video_tb.num, video_tb.den, p->orig_url);
+        return -1;
+    }
+    int ret = avformat_alloc_output_context2(&(out->fmt_ctx), NULL, "mov", p->url);
+    if(out->fmt_ctx == NULL) {
+        log_error("open_proxy_output() error: Failed to allocate proxy[%s]\n", p->url);
+        return ret < 0 ? ret : -1;
+    }
+    out->video_stream = avformat_new_stream(out->fmt_ctx, NULL);
+    out->audio_stream = NULL;
+    if(out->video_stream == NULL) {
+        return -1;
+    }
+    ret = open_proxy_encoder(p, in, out);
+    if(ret < 0) {
+        return ret;
+    }
+    AVStream *in_audio = get_audio_stream(in);
+    if(in_audio != NULL) {
+        out->audio_stream = avformat_new_stream(out->fmt_ctx, NULL);
+        if(out->audio_stream == NULL) {
+            return -1;
+        }
+        ret = avcodec_parameters_copy(out->audio_stream->codecpar, in_audio->codecpar);
+        if(ret < 0) {
+            return ret;
+        }
+        out->audio_stream->codecpar->codec_tag = 0;
+        out->audio_stream->time_base = in_audio->time_base;
+    }
+    ret = avio_open(&(out->fmt_ctx->pb), p->url, AVIO_FLAG_WRITE);
+    if(ret < 0) {
+        log_error("Could not open '%s': %s\n", p->url, av_err2str(ret));
+        return ret;
+    }
+    // parameters are compared when the proxy is reused (proxy_up_to_date())
+    char tag[PROXY_PARAMS_TAG_SIZE];
+    get_proxy_params_tag(&(p->params), tag);
+    av_dict_set(&(out->fmt_ctx->metadata), PROXY_PARAMS_TAG, tag, 0);
+    // force the video track time base of the original (identical timestamps)
+    AVDictionary *opts = NULL;
+    av_dict_set_int(&opts, "video_track_timescale", video_tb.den, 0);
+    ret = avformat_write_header(out->fmt_ctx, &opts);
+    av_dict_free(&opts);
+    if(ret < 0) {
+        log_error("open_proxy_output() error: Failed to write header[%s]\n", p->url);
+        return ret;
+    }
+    if(av_cmp_q(out->video_stream->time_base, video_tb) != 0
+        || (in_audio != NULL && av_cmp_q(out->audio_stream->time_base, in_audio->time_base) != 0)) {
+        log_error("open_proxy_output() error: Proxy time bases differ from original[%s]\n", p->orig_url);
+        return -1;
+    }
+    return open_video_converter(&(out->convert), out->codec_ctx->width, out->codec_ctx->height,
+                                out->codec_ctx->pix_fmt, 1);
+}
+
+/**
+ * Allocate and open the proxy video encoder
+ * @param  p   Proxy
+ * @param  in  opened VideoContext of original
+ * @param  out ProxyOutput with allocated format context
+ * @return     >= 0 on success
+ */
+int open_proxy_encoder(Proxy *p, VideoContext *in, ProxyOutput *out) {
+    AVCodec *codec = avcodec_find_encoder(p->params.codec_id);
+    if(codec == NULL) {
+        log_error("open_proxy_encoder() error: Could not find encoder for '%s'\n",
+                avcodec_get_name(p->params.codec_id));
+        return -1;
+    }
+    out->codec_ctx = avcodec_alloc_context3(codec);
+    out->frame = av_frame_alloc();
+    if(out->codec_ctx == NULL || out->frame == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    AVCodecContext *dec = in->video_codec_ctx;
+    AVCodecContext *c = out->codec_ctx;
+    c->height = FFMIN(p->params.height, dec->height);
+    c->width = (int) av_rescale(c->height, dec->width, dec->height) & ~1;
+    c->height &= ~1;
+    c->pix_fmt = codec->pix_fmts != NULL ? codec->pix_fmts[0] : AV_PIX_FMT_YUV420P;
+    c->sample_aspect_ratio = dec->sample_aspect_ratio;
+    c->time_base = get_video_time_base(in);
+    c->framerate = get_video_stream(in)->avg_frame_rate;
+    c->gop_size = p->params.gop_size;
+    c->max_b_frames = 0;
+    c->bit_rate = p->params.bit_rate;
+    if(out->fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) {
+        c->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    int ret = avcodec_open2(c, codec, NULL);
+    if(ret < 0) {
+        log_error("open_proxy_encoder() error: Could not open codec: %s\n", av_err2str(ret));
+        return ret;
+    }
+    out->video_stream->time_base = c->time_base;
+    return avcodec_parameters_from_context(out->video_stream->codecpar, c);
+}
+
+/**
+ * Decode a video packet of the original, then scale and encode every frame it gives
+ * @param  in  VideoContext of original
+ * @param  out ProxyOutput
+ * @param  pkt video packet (NULL to flush decoder)
+ * @return     >= 0 on success
+ */
+int proxy_decode_packet(VideoContext *in, ProxyOutput *out, AVPacket *pkt) {
+    int ret = avcodec_send_packet(in->video_codec_ctx, pkt);
+    if(ret < 0) {
+        log_error("proxy_decode_packet() error: Failed to decode packet[%s]\n", av_err2str(ret));
+        return ret;
+    }
+    while((ret = avcodec_receive_frame(in->video_codec_ctx, out->frame)) >= 0) {
+        out->frame->pts = out->frame->best_effort_timestamp;
+        out->frame->pict_type = AV_PICTURE_TYPE_NONE;
+        ret = convert_video_frame(&(out->convert), out->frame);
+        if(ret >= 0) {
+            ret = proxy_encode_frame(out, out->frame);
+        }
+        av_frame_unref(out->frame);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Send a frame to the proxy encoder and write every packet available
+ * @param  out   ProxyOutput
+ * @param  frame frame in encoder format (NULL to flush encoder)
+ * @return       >= 0 on success
+ */
+int proxy_encode_frame(ProxyOutput *out, AVFrame *frame) {
+    int ret = avcodec_send_frame(out->codec_ctx, frame);
+    if(ret < 0) {
+        log_error("proxy_encode_frame() error: Failed to encode frame[%s]\n", av_err2str(ret));
+        return ret;
+    }
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while((ret = avcodec_receive_packet(out->codec_ctx, &pkt)) >= 0) {
+        pkt.stream_index = out->video_stream->index;
+        av_packet_rescale_ts(&pkt, out->codec_ctx->time_base, out->video_stream->time_base);
+        ret = av_interleaved_write_frame(out->fmt_ctx, &pkt);
+        if(ret < 0) {
+            log_error("proxy_encode_frame() error: Failed to write packet[%s]\n", av_err2str(ret));
+            return ret;
+        }
+    }
+    if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Close proxy file and free ProxyOutput
+ * @param out ProxyOutput
+ */
+void close_proxy_output(ProxyOutput *out) {
+    close_video_converter(&(out->convert));
+    avcodec_free_context(&(out->codec_ctx));
+    av_frame_free(&(out->frame));
+    if(out->fmt_ctx != NULL) {
+        avio_closep(&(out->fmt_ctx->pb));
+        avformat_free_context(out->fmt_ctx);
+        out->fmt_ctx = NULL;
+    }
+}
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a proxy in a string
+ * @param  toBePrinted Proxy
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_proxy(void *toBePrinted) {
+    if(toBePrinted == NULL) {
+        return NULL;
+    }
+    Proxy *p = (Proxy *) toBePrinted;
+    size_t len = strlen(p->orig_url) + strlen(p->url) + 64;
+    char *str = malloc(len);
+    if(str == NULL) {
+        return NULL;
+    }
+    snprintf(str, len, "%s -> %s (%s)", p->orig_url, p->url,
+             p->running ? "running" : (p->ret >= 0 ? "ready" : "failed"));
+    return str;
+}
+
+/**
+ * Wait for proxy thread and free Proxy
+ * @param toBeDeleted Proxy allocated on heap
+ */
+void list_delete_proxy(void *toBeDeleted) {
+    if(toBeDeleted == NULL) {
+        return;
+    }
+    Proxy *p = (Proxy *) toBeDeleted;
+    if(p->running) {
+        pthread_join(p->thread, NULL);
+    }
+    free(p->orig_url);
+    free(p->url);
+    free(p->vid_ctxs);
+    free(p);
+}
+
+/**
+ * Compare two proxies by original filename
+ * @param  first  first Proxy
+ * @param  second second Proxy
+ * @return        0 if original filenames are equal
+ */
+int list_compare_proxy(const void *first, const void *second) {
+    Proxy *f = (Proxy *) first;
+    Proxy *s = (Proxy *) second;
+    return strcmp(f->orig_url, s->orig_url);
+}
@@ -0,0 +1,583 @@
+/**
+ * @file RenderCache.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for RenderCache API:
+ * Incremental rendering. Each clip of a sequence is encoded into its own independently
+ * decodable segment (starting on a key frame), saved in a cache directory under a key
+ * hashed from the source file, clip bounds and output parameters. A re-render only
+ * encodes clips whose key changed, and stream copies every other segment into the output.
+ * Segment audio is stored as PCM and encoded once over the whole output.
+ */
+
+#include "RenderCache.h"
+
+/**
+ * Initialize a render cache (the directory must already exist)
+ * @param  rc  RenderCache
+ * @param  dir directory where encoded segments are stored
+ * @return     >= 0 on success
+ */
+int init_render_cache(RenderCache *rc, char *dir) {
+    struct stat dir_stats;
+    if(rc == NULL || dir == NULL || stat(dir, &dir_stats) != 0 || !S_ISDIR(dir_stats.st_mode)) {
+        log_error("init_render_cache() error: Invalid cache directory[%s]\n", dir);
+        return -1;
+    }
+    rc->dir = malloc(strlen(dir) + 1);
+    if(rc->dir == NULL) {
+        log_error("init_render_cache() error: Failed to allocate directory name\n");
+        return AVERROR(ENOMEM);
+    }
+    strcpy(rc->dir, dir);
+    rc->hits = rc->misses = 0;
+    return 0;
+}
+
+/**
+ * Write a sequence to file, reusing the cached segment of every clip that has not changed
+ * since the last render. Changed (or new) clips are encoded into the cache first, then
+ * the video of all segments is stream copied into the output at the position of their clip,
+ * and their audio is encoded once (a single encoder delay for the whole output).
+ * Segmented output, draft mode, additional mux targets, transitions and tracks are not supported here
+ * @param  seq Sequence containing clips to write to file
+ * @param  op  OutputParameters of output file
+ * @param  rc  RenderCache
+ * @return     >= 0 on success
+ */
+int write_sequence_cached(Sequence *seq, OutputParameters *op, RenderCache *rc) {
+    if(seq == NULL || op == NULL || rc == NULL || seq->clips.head == NULL) {
+        log_error("write_sequence_cached() error: Invalid params\n");
+        return -1;
+    }
+    if(op->segment_type != OUTPUT_SEGMENT_NONE || op->draft || op->nb_mux_filenames > 0) {
+        log_error("write_sequence_cached() error: segmented, draft and multi mux outputs are not supported\n");
+        return -1;
+    }
+    if(seq->nb_tracks > 0) {
+        log_error("write_sequence_cached() error: sequences with tracks are not supported\n");
+        return -1;
+    }
+    // a segment holds one clip: the overlap of a transition would be cut from both segments
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next) {
+        if(((Clip *) curr->data)->transition.type != TRANSITION_NONE) {
+            log_error("write_sequence_cached() error: sequences with transitions are not supported\n");
+            return -1;
+        }
+    }
+    // cached segments are encoded with the codecs of the final output (audio as PCM)
+    OutputParameters out_op = *op;
+    int ret = resolve_render_cache_codecs(&out_op);
+    if(ret < 0) {
+        return ret;
+    }
+    OutputParameters seg_op = out_op;
+    set_render_cache_segment_audio(&(seg_op.audio));
+    int nb_clips = getLength(seq->clips);
+    char **seg_urls = calloc(nb_clips, sizeof(char *));
+    if(seg_urls == NULL) {
+        log_error("write_sequence_cached() error: Failed to allocate segment list\n");
+        return AVERROR(ENOMEM);
+    }
+    rc->hits = rc->misses = 0;
+
+    // encode every clip missing from the cache
+    int i = 0;
+    struct stat seg_stats;
+    Node *curr = seq->clips.head;
+    while(curr != NULL && ret >= 0) {
+        Clip *clip = (Clip *) curr->data;
+        seg_urls[i] = get_render_cache_url(rc, get_clip_cache_key(seq, clip, &seg_op));
+        if(seg_urls[i] == NULL) {
+            log_error("write_sequence_cached() error: Failed to allocate segment filename\n");
+            ret = AVERROR(ENOMEM);
+        } else if(stat(seg_urls[i], &seg_stats) == 0 && seg_stats.st_size > 0) {
+            ++(rc->hits);
+        } else {
+            ++(rc->misses);
+            ret = render_clip_segment(seq, clip, &seg_op, seg_urls[i]);
+        }
+        curr = curr->next;
+        ++i;
+    }
+
+    // copy video of all segments into output, and encode their audio once
+    if(ret >= 0) {
+        OutputContext oc;
+        ret = open_render_cache_output(&oc, &out_op, seq, seg_urls[0]);
+        if(ret >= 0) {
+            int64_t last_video_dts = AV_NOPTS_VALUE;
+            i = 0;
+            curr = seq->clips.head;
+            while(curr != NULL && ret >= 0) {
+                ret = copy_clip_segment(&oc, seq, (Clip *) curr->data, seg_urls[i], &last_video_dts);
+                curr = curr->next;
+                ++i;
+            }
+            if(ret >= 0) {
+                ret = flush_render_cache_audio(&oc);
+            }
+            int close_ret = close_video_output(&oc, ret >= 0);
+            if(ret >= 0 && close_ret < 0) {
+                log_error("write_sequence_cached() error: Failed to write trailer of[%s]\n", op->filename);
+                ret = close_ret;
+            }
+        }
+    }
+    if(ret >= 0) {
+        log_info("Render cache: %d segments reused, %d encoded\n", rc->hits, rc->misses);
+    }
+    for(i = 0; i < nb_clips; i++) {
+        free(seg_urls[i]);
+    }
+    free(seg_urls);
+    return ret;
+}
+
+/**
+ * Free data within render cache (files on disk are kept)
+ * @param rc RenderCache
+ */
+void free_render_cache(RenderCache *rc) {
+    if(rc != NULL) {
+        free(rc->dir);
+        rc->dir = NULL;
+    }
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Hash bytes into a 64 bit FNV-1a hash
+ * @param  hash previous hash (RENDER_CACHE_HASH_INIT to start a new hash)
+ * @param  data bytes to hash
+ * @param  size number of bytes
+ * @return      new hash
+ */
+uint64_t render_cache_hash(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Resolve codecs left as AV_CODEC_ID_NONE to the default codecs of the output format,
+ * so the cached segments are encoded with the codecs the final output expects
+ * @param  op OutputParameters (codec ids are updated)
+ * @return    >= 0 on success
+ */
+int resolve_render_cache_codecs(OutputParameters *op) {
+    AVOutputFormat *fmt = av_guess_format(NULL, op->filename, NULL);
+    if(fmt == NULL) {
+        fmt = av_guess_format("mp4", NULL, NULL);
+    }
+    if(fmt == NULL) {
+        log_error("resolve_render_cache_codecs() error: Could not find output format of[%s]\n", op->filename);
+        return -1;
+    }
+    if(op->video.codec_id == AV_CODEC_ID_NONE) {
+        op->video.codec_id = fmt->video_codec;
+    }
+    if(op->audio.codec_id == AV_CODEC_ID_NONE) {
+        op->audio.codec_id = fmt->audio_codec;
+    }
+    return 0;
+}
+
+/**
+ * Get the cache key of a clip: source identity (url, size, modification time),
+ * clip bounds (orig_start_pts, orig_end_pts), sequence time bases and output parameters
+ * @param  seq Sequence containing clip
+ * @param  clip Clip
+ * @param  op  OutputParameters with resolved codecs
+ * @return     cache key
+ */
+uint64_t get_clip_cache_key(Sequence *seq, Clip *clip, OutputParameters *op) {
+    uint64_t h = RENDER_CACHE_HASH_INIT;
+    // source identity (the proxy when the clip currently reads one)
+    char *url = get_video_context_url(clip->vid_ctx);
+    struct stat file_stats;
+    int64_t size = 0, mtime = 0;
+    if(stat(url, &file_stats) == 0) {
+        size = file_stats.st_size;
+        mtime = file_stats.st_mtime;
+    }
+    h = render_cache_hash(h, url, strlen(url));
+    h = render_cache_hash(h, &size, sizeof(size));
+    h = render_cache_hash(h, &mtime, sizeof(mtime));
+    h = render_cache_hash(h, &(clip->vid_ctx->lowres), sizeof(clip->vid_ctx->lowres));
+    h = render_cache_hash(h, &(clip->vid_ctx->fast_decode), sizeof(clip->vid_ctx->fast_decode));
+    // clip bounds
+    h = render_cache_hash(h, &(clip->orig_start_pts), sizeof(clip->orig_start_pts));
+    h = render_cache_hash(h, &(clip->orig_end_pts), sizeof(clip->orig_end_pts));
+    // sequence time bases
+    h = render_cache_hash(h, &(seq->video_time_base), sizeof(seq->video_time_base));
+    h = render_cache_hash(h, &(seq->audio_time_base), sizeof(seq->audio_time_base));
+    // output params (hashed by field, struct padding is undefined)
+    VideoOutParams *vp = &(op->video);
+    AudioOutParams *ap = &(op->audio);
+    h = render_cache_hash(h, &(vp->codec_id), sizeof(vp->codec_id));
+    h = render_cache_hash(h, &(vp->pix_fmt), sizeof(vp->pix_fmt));
+    h = render_cache_hash(h, &(vp->width), sizeof(vp->width));
+    h = render_cache_hash(h, &(vp->height), sizeof(vp->height));
+    h = render_cache_hash(h, &(vp->bit_rate), sizeof(vp->bit_rate));
+    h = render_cache_hash(h, &(vp->fps), sizeof(vp->fps));
+    h = render_cache_hash(h, &(ap->codec_id), sizeof(ap->codec_id));
+    h = render_cache_hash(h, &(ap->sample_fmt), sizeof(ap->sample_fmt));
+    h = render_cache_hash(h, &(ap->bit_rate), sizeof(ap->bit_rate));
+    h = render_cache_hash(h, &(ap->sample_rate), sizeof(ap->sample_rate));
+    h = render_cache_hash(h, &(ap->channel_layout), sizeof(ap->channel_layout));
+    return h;
+}
+
+/**
+ * Get the filename of a cached segment
+ * @param  rc  RenderCache
+ * @param  key cache key
+ * @return     allocated filename (free after use) or NULL on fail
+ */
+char *get_render_cache_url(RenderCache *rc, uint64_t key) {
+    size_t len = strlen(rc->dir) + 1 + 16 + strlen(RENDER_CACHE_EXTENSION) + 1;
+    char *url = malloc(len);
+    if(url == NULL) {
+        return NULL;
+    }
+    snprintf(url, len, "%s/%016" PRIx64 "%s", rc->dir, key, RENDER_CACHE_EXTENSION);
+    return url;
+}
+
+/**
+ * Encode a single clip into a cached segment. The segment starts at pts 0 and is written
+ * to a temporary file first, so an interrupted render never leaves a partial segment
+ * @param  seq  Sequence containing clip (fps and sample rate are copied)
+ * @param  clip Clip to encode
+ * @param  op   OutputParameters with resolved codecs
+ * @param  url  filename of segment
+ * @return      >= 0 on success
+ */
+int render_clip_segment(Sequence *seq, Clip *clip, OutputParameters *op, char *url) {
+    char *tmp_url = malloc(strlen(url) + strlen(".tmp" RENDER_CACHE_EXTENSION) + 1);
+    if(tmp_url == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    sprintf(tmp_url, "%s.tmp" RENDER_CACHE_EXTENSION, url);
+
+    // sequence holding only this clip, starting at pts 0
+    Sequence seg_seq;
+    int ret = init_sequence(&seg_seq, seq->fps, seq->audio_time_base.den);
+    if(ret < 0) {
+        free(tmp_url);
+        return ret;
+    }
+    Clip *seg_clip = copy_clip_vc(clip);
+    if(seg_clip == NULL) {
+        log_error("render_clip_segment() error: Failed to copy clip\n");
+        free_sequence(&seg_seq);
+        free(tmp_url);
+        return -1;
+    }
+    // bounds are copied as they are: set_clip_bounds_pts() seeks, and fails when the
+    // shared VideoContext was closed by the last segment (the clip would span the whole file)
+    seg_clip->orig_start_pts = clip->orig_start_pts;
+    seg_clip->orig_end_pts = clip->orig_end_pts;
+    sequence_append_clip(&seg_seq, seg_clip);
+    if((ret = open_clip(seg_clip)) < 0) {
+        log_error("render_clip_segment() error: Failed to open clip[%s]\n", clip->vid_ctx->url);
+        free_sequence(&seg_seq);
+        free(tmp_url);
+        return ret;
+    }
+
+    OutputParameters seg_op = *op;
+    seg_op.filename = tmp_url;
+    seg_op.stats = NULL;
+    seg_op.stats_filename = NULL;
+    ret = write_sequence(&seg_seq, &seg_op, 1);
+    free_sequence(&seg_seq);
+    if(ret >= 0 && rename(tmp_url, url) != 0) {
+        log_error("render_clip_segment() error: Failed to move segment to[%s]\n", url);
+        ret = -1;
+    }
+    if(ret < 0) {
+        remove(tmp_url);
+    }
+    free(tmp_url);
+    return ret;
+}
+
+/**
+ * Get the audio parameters of cached segments: the output sample format, rate and layout
+ * stored as PCM. Audio is encoded once over the whole render (from these samples),
+ * so the priming and padding of lossy encoders never lands at a segment boundary
+ * @param ap AudioOutParams of output (updated to the segment parameters)
+ */
+void set_render_cache_segment_audio(AudioOutParams *ap) {
+    if(ap->codec_id == AV_CODEC_ID_NONE) {
+        return;
+    }
+    ap->sample_fmt = av_get_packed_sample_fmt(ap->sample_fmt);
+    ap->codec_id = av_get_pcm_codec(ap->sample_fmt, 0);
+    ap->bit_rate = 0;
+}
+
+/**
+ * Open the output file: the video stream is copied from the parameters of the first
+ * segment, the audio stream is encoded with the audio parameters of the output
+ * @param  oc      OutputContext to open
+ * @param  op      OutputParameters with resolved codecs
+ * @param  seq     Sequence (audio time base of the encoder)
+ * @param  seg_url filename of the first segment
+ * @return         >= 0 on success
+ */
+int open_render_cache_output(OutputContext *oc, OutputParameters *op, Sequence *seq, char *seg_url) {
+    init_video_output(oc);
+    AVFormatContext *in = NULL;
+    int ret = avformat_open_input(&in, seg_url, NULL, NULL);
+    if(ret < 0) {
+        log_error("open_render_cache_output() error: Failed to open segment[%s]\n", seg_url);
+        close_video_output(oc, false);
+        return ret;
+    }
+    ret = avformat_find_stream_info(in, NULL);
+    if(ret < 0) {
+        log_error("open_render_cache_output() error: Failed to find stream info of[%s]\n", seg_url);
+        avformat_close_input(&in);
+        close_video_output(oc, false);
+        return ret;
+    }
+    avformat_alloc_output_context2(&(oc->fmt_ctx), NULL, NULL, op->filename);
+    if(oc->fmt_ctx == NULL) {
+        avformat_alloc_output_context2(&(oc->fmt_ctx), NULL, "mp4", op->filename);
+    }
+    if(oc->fmt_ctx == NULL) {
+        log_error("open_render_cache_output() error: Failed to allocate output[%s]\n", op->filename);
+        avformat_close_input(&in);
+        close_video_output(oc, false);
+        return -1;
+    }
+    // video packets are stream copied from the segments
+    int video_idx = av_find_best_stream(in, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if(video_idx >= 0) {
+        oc->video.stream = avformat_new_stream(oc->fmt_ctx, NULL);
+        if(oc->video.stream == NULL) {
+            ret = AVERROR(ENOMEM);
+        } else {
+            ret = avcodec_parameters_copy(oc->video.stream->codecpar, in->streams[video_idx]->codecpar);
+            // tags are specific to the container of the segment
+            oc->video.stream->codecpar->codec_tag = 0;
+            oc->video.stream->time_base = in->streams[video_idx]->time_base;
+        }
+    }
+    avformat_close_input(&in);
+    // audio is encoded once from the PCM samples of every segment
+    if(ret >= 0 && op->audio.codec_id != AV_CODEC_ID_NONE) {
+        ret = add_stream(oc, &(oc->audio), op->audio.codec_id);
+        if(ret >= 0) {
+            set_audio_codec_params(oc, &(op->audio));
+            oc->audio.codec_ctx->time_base = seq->audio_time_base;
+            ret = open_codec(oc, &(oc->audio));
+        }
+        if(ret >= 0) {
+            ret = open_audio_converter(&(oc->audio_convert), oc->audio.codec_ctx);
+        }
+    }
+    if(ret >= 0 && !(oc->fmt_ctx->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&(oc->fmt_ctx->pb), op->filename, AVIO_FLAG_WRITE);
+    }
+    if(ret >= 0) {
+        ret = avformat_write_header(oc->fmt_ctx, NULL);
+    }
+    if(ret < 0) {
+        log_error("open_render_cache_output() error: Failed to open output[%s]: %s\n", op->filename, av_err2str(ret));
+        close_video_output(oc, false);
+        return ret;
+    }
+    return 0;
+}
+
+/**
+ * Write a cached segment into the output at the start of its clip in the sequence.
+ * Video packets are stream copied with one constant offset per segment (the first
+ * packet lands on the start of the clip), so presentation order and the decode delay of
+ * the encoder are kept. Audio is decoded and sent to the output audio encoder
+ * @param  oc             opened OutputContext (open_render_cache_output())
+ * @param  seq            Sequence containing clip
+ * @param  clip           Clip of segment
+ * @param  seg_url        filename of segment
+ * @param  last_video_dts last video dts written to output (updated)
+ * @return                >= 0 on success
+ */
+int copy_clip_segment(OutputContext *oc, Sequence *seq, Clip *clip, char *seg_url, int64_t *last_video_dts) {
+    AVFormatContext *in = NULL;
+    int ret = avformat_open_input(&in, seg_url, NULL, NULL);
+    if(ret < 0) {
+        log_error("copy_clip_segment() error: Failed to open segment[%s]\n", seg_url);
+        return ret;
+    }
+    int video_idx = av_find_best_stream(in, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    int audio_idx = av_find_best_stream(in, AVMEDIA_TYPE_AUDIO, -1, -1, NULL, 0);
+    if((video_idx >= 0) != (oc->video.stream != NULL)) {
+        log_error("copy_clip_segment() error: segment[%s] streams do not match output\n", seg_url);
+        avformat_close_input(&in);
+        return -1;
+    }
+    AVCodecContext *dec = NULL;
+    if(audio_idx >= 0 && oc->audio.codec_ctx != NULL) {
+        ret = open_segment_audio_decoder(in->streams[audio_idx], seq->audio_time_base, &dec);
+        if(ret < 0) {
+            avformat_close_input(&in);
+            return ret;
+        }
+    }
+    AVFrame *frame = av_frame_alloc();
+    if(frame == NULL) {
+        avcodec_free_context(&dec);
+        avformat_close_input(&in);
+        return AVERROR(ENOMEM);
+    }
+    // one offset per stream for the whole segment (set on its first packet)
+    int64_t video_offset = AV_NOPTS_VALUE, audio_offset = AV_NOPTS_VALUE;
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while((ret = av_read_frame(in, &pkt)) >= 0) {
+        if(pkt.stream_index == video_idx) {
+            AVStream *out_stream = oc->video.stream;
+            av_packet_rescale_ts(&pkt, in->streams[video_idx]->time_base, out_stream->time_base);
+            if(video_offset == AV_NOPTS_VALUE) {
+                video_offset = get_segment_offset(&pkt, av_rescale_q(clip->start_pts,
+                                    seq->video_time_base, out_stream->time_base), *last_video_dts);
+            }
+            if(pkt.pts != AV_NOPTS_VALUE) {
+                pkt.pts += video_offset;
+            }
+            if(pkt.dts != AV_NOPTS_VALUE) {
+                pkt.dts += video_offset;
+                *last_video_dts = pkt.dts;
+            }
+            pkt.stream_index = out_stream->index;
+            pkt.pos = -1;
+            ret = output_write_packet(oc, &pkt);
+        } else if(pkt.stream_index == audio_idx && dec != NULL) {
+            av_packet_rescale_ts(&pkt, in->streams[audio_idx]->time_base, seq->audio_time_base);
+            if(audio_offset == AV_NOPTS_VALUE) {
+                audio_offset = get_segment_offset(&pkt, av_rescale_q(clip->start_pts,
+                                    seq->video_time_base, seq->audio_time_base), AV_NOPTS_VALUE);
+            }
+            ret = encode_segment_audio(oc, dec, &pkt, frame, audio_offset);
+        }
+        av_packet_unref(&pkt);
+        if(ret < 0) {
+            log_error("copy_clip_segment() error: Failed to write segment[%s]: %s\n", seg_url, av_err2str(ret));
+            break;
+        }
+    }
+    if(ret == AVERROR_EOF) {
+        // decoder may hold samples of the last packets
+        ret = dec != NULL ? encode_segment_audio(oc, dec, NULL, frame, audio_offset) : 0;
+    }
+    av_frame_free(&frame);
+    avcodec_free_context(&dec);
+    avformat_close_input(&in);
+    return ret;
+}
+
+/**
+ * Get the constant timestamp offset of a segment stream: the first packet is moved to
+ * the start of its clip, then later if needed so its dts follows the last dts written
+ * @param  pkt      first packet of the stream in segment
+ * @param  start    start of the clip in the time base of pkt
+ * @param  last_dts last dts written to the output stream (AV_NOPTS_VALUE if none)
+ * @return          offset to add to every timestamp of the stream in segment
+ */
+int64_t get_segment_offset(AVPacket *pkt, int64_t start, int64_t last_dts) {
+    int64_t first = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    int64_t offset = first != AV_NOPTS_VALUE ? start - first : start;
+    if(last_dts != AV_NOPTS_VALUE && pkt->dts != AV_NOPTS_VALUE && pkt->dts + offset <= last_dts) {
+        offset = last_dts + 1 - pkt->dts;
+    }
+    return offset;
+}
+
+/**
+ * Open a decoder for the audio stream of a segment
+ * @param  stream    audio stream of segment
+ * @param  time_base time base of the packets sent to the decoder
+ * @param  dec       output decoder context
+ * @return           >= 0 on success
+ */
+int open_segment_audio_decoder(AVStream *stream, AVRational time_base, AVCodecContext **dec) {
+    AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if(codec == NULL) {
+        log_error("open_segment_audio_decoder() error: Could not find decoder for '%s'\n",
+                    avcodec_get_name(stream->codecpar->codec_id));
+        return -1;
+    }
+    *dec = avcodec_alloc_context3(codec);
+    if(*dec == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    int ret = avcodec_parameters_to_context(*dec, stream->codecpar);
+    if(ret >= 0) {
+        (*dec)->pkt_timebase = time_base;
+        ret = avcodec_open2(*dec, codec, NULL);
+    }
+    if(ret < 0) {
+        log_error("open_segment_audio_decoder() error: Failed to open decoder: %s\n", av_err2str(ret));
+        avcodec_free_context(dec);
+    }
+    return ret;
+}
+
+/**
+ * Decode a packet of segment audio and send the samples to the output audio encoder
+ * @param  oc     OutputContext with opened audio encoder
+ * @param  dec    segment audio decoder
+ * @param  pkt    packet with timestamps in the time base of the encoder (NULL to flush decoder)
+ * @param  frame  frame to receive decoded samples
+ * @param  offset offset of segment audio in sequence
+ * @return        >= 0 on success
+ */
+int encode_segment_audio(OutputContext *oc, AVCodecContext *dec, AVPacket *pkt, AVFrame *frame, int64_t offset) {
+    int ret = avcodec_send_packet(dec, pkt);
+    if(ret < 0) {
+        log_error("encode_segment_audio() error: Failed to send packet to decoder: %s\n", av_err2str(ret));
+        return ret;
+    }
+    while((ret = avcodec_receive_frame(dec, frame)) == 0) {
+        if(frame->pts != AV_NOPTS_VALUE) {
+            frame->pts += offset;
+        }
+        ret = output_encode_frame(oc, frame, AVMEDIA_TYPE_AUDIO);
+        av_frame_unref(frame);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    if(ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return 0;
+    }
+    return ret;
+}
+
+/**
+ * Encode the samples remaining in the output audio converter and flush the audio encoder
+ * @param  oc OutputContext opened with open_render_cache_output()
+ * @return    >= 0 on success
+ */
+int flush_render_cache_audio(OutputContext *oc) {
+    if(oc->audio.codec_ctx == NULL) {
+        return 0;
+    }
+    int ret = flush_audio_converter(&(oc->audio_convert));
+    if(ret >= 0) {
+        ret = output_send_audio_frames(oc);
+    }
+    if(ret >= 0) {
+        ret = output_send_frame(oc, &(oc->audio), NULL);
+    }
+    return ret;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file RenderStats.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for RenderStats API:
+ * Low overhead timers and counters around each stage of a render (demux, decode,
+ * seek, encode, mux), aggregated per stream. Clips and OutputContexts each own
+ * a RenderStats, and timing is only taken while render stats are enabled.
+ */
+
+#include "RenderStats.h"
+
+/* timing is skipped entirely (no clock reads) while this is false */
+bool render_stats_enabled = false;
+
+/**
+ * Initialize (clear) render stats
+ * @param rs RenderStats
+ */
+void init_render_stats(RenderStats *rs) {
+    memset(rs, 0, sizeof(struct RenderStats));
+}
+
+/**
+ * Enable or disable timing of all render stages (disabled by default)
+ * @param enabled true to collect render stats
+ */
+void set_render_stats_enabled(bool enabled) {
+    render_stats_enabled = enabled;
+}
+
+/**
+ * Get whether render stats are collected
+ * @return true if enabled
+ */
+bool get_render_stats_enabled() {
+    return render_stats_enabled;
+}
+
+/**
+ * Get monotonic time in nanoseconds
+ * @return nanoseconds
+ */
+int64_t render_stats_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Start timing a stage
+ * @return start time to pass to render_stats_add(), 0 when render stats are disabled
+ */
+int64_t render_stats_start() {
+    return render_stats_enabled ? render_stats_now() : 0;
+}
+
+/**
+ * Stop timing a stage and add it to render stats
+ * @param rs        RenderStats
+ * @param type      AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO (anything else is RENDER_STATS_OTHER)
+ * @param stage     RenderStage
+ * @param start_ns  return from render_stats_start() (nothing is added when 0)
+ * @param count     items completed by this call (packets, frames or seeks)
+ */
+void render_stats_add(RenderStats *rs, enum AVMediaType type, enum RenderStage stage, int64_t start_ns, int count) {
+    if(start_ns == 0 || rs == NULL) {
+        return;
+    }
+    int stream = RENDER_STATS_OTHER;
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        stream = RENDER_STATS_VIDEO;
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        stream = RENDER_STATS_AUDIO;
+    }
+    StageStats *s = &(rs->stages[stream][stage]);
+    s->count += count;
+    s->time_ns += render_stats_now() - start_ns;
+}
+
+/**
+ * Add all stages of src into dst
+ * @param dst RenderStats
+ * @param src RenderStats
+ */
+void merge_render_stats(RenderStats *dst, RenderStats *src) {
+    for(int i = 0; i < RENDER_STATS_NB_STREAMS; i++) {
+        for(int j = 0; j < RENDER_STAGE_NB; j++) {
+            dst->stages[i][j].count += src->stages[i][j].count;
+            dst->stages[i][j].time_ns += src->stages[i][j].time_ns;
+        }
+    }
+}
+
+/**
+ * Get stats of a stage summed over all streams
+ * @param  rs    RenderStats
+ * @param  stage RenderStage
+ * @return       StageStats of stage
+ */
+StageStats get_render_stage_total(RenderStats *rs, enum RenderStage stage) {
+    StageStats total = {0, 0};
+    for(int i = 0; i < RENDER_STATS_NB_STREAMS; i++) {
+        total.count += rs->stages[i][stage].count;
+        total.time_ns += rs->stages[i][stage].time_ns;
+    }
+    return total;
+}
+
+/**
+ * Get the name of a stage (used in reports)
+ * @param  stage RenderStage
+ * @return       name of stage
+ */
+const char *get_render_stage_name(enum RenderStage stage) {
+    switch(stage) {
+        case RENDER_STAGE_DEMUX:    return "demux";
+        case RENDER_STAGE_DECODE:   return "decode";
+        case RENDER_STAGE_PREROLL:  return "preroll";
+        case RENDER_STAGE_SEEK:     return "seek";
+        case RENDER_STAGE_ENCODE:   return "encode";
+        case RENDER_STAGE_MUX:      return "mux";
+        default:                    return "unknown";
+    }
+}
+
+/**
+ * Write render stats as a JSON object: {"video": {"demux": {"count": n, "ms": t}, ..}, ..}
+ * @param f  file to write
+ * @param rs RenderStats
+ */
+void write_render_stats_json(FILE *f, RenderStats *rs) {
+    const char *streams[RENDER_STATS_NB_STREAMS] = {"video", "audio", "other"};
+    fprintf(f, "{");
+    for(int i = 0; i < RENDER_STATS_NB_STREAMS; i++) {
+        fprintf(f, "%s\"%s\": {", i > 0 ? ", " : "", streams[i]);
+        for(int j = 0; j < RENDER_STAGE_NB; j++) {
+            StageStats *s = &(rs->stages[i][j]);
+            fprintf(f, "%s\"%s\": {\"count\": %" PRId64 ", \"ms\": %.3f}", j > 0 ? ", " : "",
+                    get_render_stage_name(j), s->count, s->time_ns / 1000000.0);
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "}");
+}
+
+/**
+ * Write a string as a quoted JSON string
+ * @param f   file to write
+ * @param str string to escape
+ */
+void write_json_string(FILE *f, const char *str) {
+    fputc('"', f);
+    for(const char *c = str; c != NULL && *c != '\0'; c++) {
+        if(*c == '"' || *c == '\\') {
+            fprintf(f, "\\%c", *c);
+        } else if((unsigned char) *c < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned char) *c);
+        } else {
+            fputc(*c, f);
+        }
+    }
+    fputc('"', f);
+}
@@ -0,0 +1,389 @@
+/**
+ * @file ReverseDecode.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for ReverseDecode API:
+ * Reading the video frames of a clip or sequence backwards, one GOP at a time,
+ * with the previous GOP decoded on a worker thread.
+ */
+
+#include "ReverseDecode.h"
+
+/**
+ * Initialize a reader of the video frames of a clip, from its last frame to its first
+ * @param  rr         ReverseReader
+ * @param  clip       Clip (opened if needed). It must not be read by anything else until the
+ *                    reader is freed, then seek_clip_pts() before reading it forward again
+ * @param  max_frames max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES).
+ *                    Two segments are held at once
+ * @param  prefetch   decode the previous segment on a worker thread
+ * @return            >= 0 on success
+ */
+int init_clip_reverse_reader(ReverseReader *rr, Clip *clip, int max_frames, bool prefetch) {
+    if(rr == NULL || clip == NULL) {
+        log_error("init_clip_reverse_reader() error: Invalid params\n");
+        return -1;
+    }
+    rr->seq = NULL;
+    rr->close_clips = false;
+    rr->next_clip = clip;
+    rr->next_node = NULL;
+    rr->next_end_pts = -1;
+    return init_reverse_reader(rr, max_frames, prefetch);
+}
+
+/**
+ * Initialize a reader of the video frames of a sequence, from its last frame to its first
+ * @param  rr          ReverseReader
+ * @param  seq         Sequence. It must not be read by anything else until the reader is freed,
+ *                     then sequence_seek() before reading it forward again
+ * @param  max_frames  max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES)
+ * @param  prefetch    decode the previous segment on a worker thread
+ * @param  close_clips if true, close each clip when done reading it (as sequence_read_frame())
+ * @return             >= 0 on success
+ */
+int init_sequence_reverse_reader(ReverseReader *rr, Sequence *seq, int max_frames, bool prefetch, bool close_clips) {
+    if(rr == NULL || seq == NULL) {
+        log_error("init_sequence_reverse_reader() error: Invalid params\n");
+        return -1;
+    }
+    rr->seq = seq;
+    rr->close_clips = close_clips;
+    rr->next_node = seq->clips.tail;
+    rr->next_clip = rr->next_node != NULL ? (Clip *) rr->next_node->data : NULL;
+    rr->next_end_pts = -1;
+    return init_reverse_reader(rr, max_frames, prefetch);
+}
+
+/**
+ * Read the previous video frame
+ * @param  rr    ReverseReader
+ * @param  frame output frame, with the pts it has when read forward (file pts for clips,
+ *               sequence pts for sequences)
+ * @return       >= 0 on success, AVERROR_EOF after the first frame, < 0 on error
+ */
+int reverse_read_frame(ReverseReader *rr, AVFrame *frame) {
+    // current segment is done: swap to the one decoded meanwhile
+    while(rr->pos < 0) {
+        if(rr->eof) {
+            return AVERROR_EOF;
+        }
+        int next = 1 - rr->cur;
+        int ret;
+        if(rr->threaded) {
+            ret = wait_reverse_job(rr);
+        } else {
+            ret = decode_next_reverse_segment(rr, &(rr->segs[next]));
+        }
+        if(ret < 0) {
+            if(ret != AVERROR_EOF) {
+                log_error("reverse_read_frame() error: Failed to decode segment (%s)\n", av_err2str(ret));
+            }
+            rr->eof = true;
+            return ret;
+        }
+        rr->cur = next;
+        rr->pos = rr->segs[next].nb - 1;
+        // the segment just output is free: decode the one before the current
+        if(rr->threaded) {
+            start_reverse_job(rr, &(rr->segs[1 - next]));
+        }
+    }
+    av_frame_unref(frame);
+    av_frame_move_ref(frame, rr->segs[rr->cur].frames[rr->pos]);
+    --(rr->pos);
+    return 0;
+}
+
+/**
+ * Stop the worker thread and free the frames of a reader
+ * @param rr ReverseReader
+ */
+void free_reverse_reader(ReverseReader *rr) {
+    if(rr->threaded) {
+        pthread_mutex_lock(&(rr->lock));
+        rr->exit = true;
+        pthread_cond_broadcast(&(rr->cond));
+        pthread_mutex_unlock(&(rr->lock));
+        pthread_join(rr->thread, NULL);
+        rr->threaded = false;
+    }
+    for(int s = 0; s < 2; s++) {
+        ReverseSegment *seg = &(rr->segs[s]);
+        if(seg->frames != NULL) {
+            for(int i = 0; i < rr->max_frames; i++) {
+                av_frame_free(&(seg->frames[i]));
+            }
+            free(seg->frames);
+            seg->frames = NULL;
+        }
+        seg->nb = 0;
+    }
+    av_frame_free(&(rr->decoded));
+    pthread_mutex_destroy(&(rr->lock));
+    pthread_cond_destroy(&(rr->cond));
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Allocate segment pools and start the worker thread (the first segment is given to it)
+ * @param  rr         ReverseReader with seq, close_clips, next_clip, next_node and next_end_pts set
+ * @param  max_frames max frames buffered per segment (<= 0 for REVERSE_DEFAULT_MAX_FRAMES)
+ * @param  prefetch   start the worker thread
+ * @return            >= 0 on success
+ */
+int init_reverse_reader(ReverseReader *rr, int max_frames, bool prefetch) {
+    rr->max_frames = max_frames > 0 ? max_frames : REVERSE_DEFAULT_MAX_FRAMES;
+    rr->cur = 0;
+    rr->pos = -1;
+    rr->eof = false;
+    rr->threaded = false;
+    rr->job = NULL;
+    rr->exit = false;
+    pthread_mutex_init(&(rr->lock), NULL);
+    pthread_cond_init(&(rr->cond), NULL);
+    rr->decoded = av_frame_alloc();
+    bool alloc_failed = (rr->decoded == NULL);
+    for(int s = 0; s < 2; s++) {
+        ReverseSegment *seg = &(rr->segs[s]);
+        seg->nb = 0;
+        seg->clip = NULL;
+        seg->start_pts = -1;
+        seg->end_pts = -1;
+        seg->ret = 0;
+        seg->frames = calloc(rr->max_frames, sizeof(AVFrame *));
+        for(int i = 0; seg->frames != NULL && i < rr->max_frames; i++) {
+            alloc_failed |= (seg->frames[i] = av_frame_alloc()) == NULL;
+        }
+        alloc_failed |= (seg->frames == NULL);
+    }
+    if(alloc_failed) {
+        log_error("init_reverse_reader() error: Failed to allocate frame pools\n");
+        free_reverse_reader(rr);
+        return AVERROR(ENOMEM);
+    }
+    if(prefetch) {
+        if(pthread_create(&(rr->thread), NULL, &reverse_reader_thread, rr) != 0) {
+            log_warning("init_reverse_reader(): Failed to start worker thread, decoding without prefetch\n");
+        } else {
+            rr->threaded = true;
+            start_reverse_job(rr, &(rr->segs[1]));
+        }
+    }
+    return 0;
+}
+
+/**
+ * Decode the segment before the last one decoded (moving on to the previous clip
+ * of the sequence when the start of a clip is reached)
+ * @param  rr  ReverseReader
+ * @param  seg output segment (its frames are unreferenced first)
+ * @return     >= 0 on success, AVERROR_EOF when there are no segments left
+ */
+int decode_next_reverse_segment(ReverseReader *rr, ReverseSegment *seg) {
+    for(int i = 0; i < seg->nb; i++) {
+        av_frame_unref(seg->frames[i]);
+    }
+    seg->nb = 0;
+    int ret;
+    while(rr->next_clip != NULL) {
+        Clip *clip = rr->next_clip;
+        if((ret = open_clip(clip)) < 0) {
+            log_error("decode_next_reverse_segment() error: Failed to open clip[%s]\n", clip->vid_ctx->url);
+            return ret;
+        }
+        // the end of a clip is only known once it is open
+        if(rr->next_end_pts < 0) {
+            rr->next_end_pts = clip->orig_end_pts;
+        }
+        if(rr->next_end_pts > clip->orig_start_pts) {
+            VideoContext *vc = clip->vid_ctx;
+            int64_t dur = get_video_frame_pts(vc, 1);
+            if(dur <= 0) {
+                dur = 1;
+            }
+            int64_t end = rr->next_end_pts;
+            int64_t max_start = end - rr->max_frames * dur;
+            // GOP of the last frame, split when longer than the pool (each part is decoded
+            // from the key frame). Without an index the seek finds the key frame
+            int64_t start = get_video_key_frame_pts(vc, end - dur);
+            if(start < max_start) {
+                start = max_start;
+            }
+            seg->clip = clip;
+            seg->start_pts = FFMAX(start, clip->orig_start_pts);
+            seg->end_pts = end;
+            if((ret = decode_reverse_segment(rr, seg)) < 0) {
+                return ret;
+            }
+            rr->next_end_pts = seg->start_pts;
+            if(seg->nb > 0) {
+                return 0;
+            }
+            continue;
+        }
+        // start of clip reached: last frame of the previous clip
+        Node *prev = rr->next_node != NULL ? rr->next_node->previous : NULL;
+        Clip *prev_clip = prev != NULL ? (Clip *) prev->data : NULL;
+        if(rr->close_clips && (prev_clip == NULL || prev_clip->vid_ctx != clip->vid_ctx)) {
+            // frames already decoded keep their buffers
+            close_clip(clip);
+        }
+        rr->next_node = prev;
+        rr->next_clip = prev_clip;
+        rr->next_end_pts = -1;
+    }
+    return AVERROR_EOF;
+}
+
+/**
+ * Decode the frames of seg->clip within [seg->start_pts, seg->end_pts) into the segment.
+ * When more than max_frames are found, the earliest are dropped and start_pts is raised
+ * @param  rr  ReverseReader
+ * @param  seg segment with clip and range set
+ * @return     >= 0 on success
+ */
+int decode_reverse_segment(ReverseReader *rr, ReverseSegment *seg) {
+    Clip *clip = seg->clip;
+    VideoContext *vc = clip->vid_ctx;
+    AVCodecContext *dec = vc->video_codec_ctx;
+    int ret = seek_video_pts(vc, seg->start_pts);
+    if(ret < 0) {
+        log_error("decode_reverse_segment() error: Failed to seek to pts[%ld] in [%s]\n", seg->start_pts, vc->url);
+        return ret;
+    }
+    // a sequential reader may have left frames in the decoder
+    avcodec_flush_buffers(dec);
+    // clips reading this VideoContext sequentially must seek again (see is_vc_out_bounds())
+    vc->seek_pts = -1;
+    vc->last_decoder_packet_stream = DEC_STREAM_NONE;
+    set_stream_discard(vc, vc->audio_stream_idx, true);
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    bool done = false, eof = false;
+    while(!done && !(eof && ret == AVERROR_EOF)) {
+        if(!eof) {
+            ret = av_read_frame(vc->fmt_ctx, &pkt);
+            if(ret == AVERROR_EOF) {
+                eof = true;
+                ret = avcodec_send_packet(dec, NULL);
+            } else if(ret < 0) {
+                break;
+            } else if(pkt.stream_index != vc->video_stream_idx) {
+                av_packet_unref(&pkt);
+                continue;
+            } else {
+                ret = avcodec_send_packet(dec, &pkt);
+                av_packet_unref(&pkt);
+            }
+            if(ret < 0) {
+                log_error("decode_reverse_segment() error: Failed to send packet (%s)\n", av_err2str(ret));
+                break;
+            }
+        }
+        while(!done && (ret = avcodec_receive_frame(dec, rr->decoded)) >= 0) {
+            int64_t pts = rr->decoded->best_effort_timestamp;
+            if(pts != AV_NOPTS_VALUE) {
+                vc->last_decoded_pts = pts;
+                done = pts >= seg->end_pts;
+                if(!done && pts >= seg->start_pts) {
+                    bool full = seg->nb == rr->max_frames;
+                    if(full) {
+                        // more frames than the range should hold (variable frame rate):
+                        // the earliest is dropped and decoded again with the previous segment
+                        AVFrame *first = seg->frames[0];
+                        av_frame_unref(first);
+                        memmove(seg->frames, seg->frames + 1, (seg->nb - 1) * sizeof(AVFrame *));
+                        seg->frames[--(seg->nb)] = first;
+                    }
+                    rr->decoded->pts = pts;
+                    av_frame_move_ref(seg->frames[(seg->nb)++], rr->decoded);
+                    if(full) {
+                        seg->start_pts = seg->frames[0]->pts;
+                    }
+                }
+            }
+            av_frame_unref(rr->decoded);
+        }
+        if(ret == AVERROR(EAGAIN)) {
+            ret = 0;
+        } else if(ret < 0 && ret != AVERROR_EOF) {
+            log_error("decode_reverse_segment() error: Failed to decode frame (%s)\n", av_err2str(ret));
+            break;
+        }
+    }
+    av_frame_unref(rr->decoded);
+    if(eof) {
+        // a drained decoder must be flushed before it is used again
+        avcodec_flush_buffers(dec);
+        vc->last_decoded_pts = -1;
+    }
+    if(ret < 0 && ret != AVERROR_EOF) {
+        vc->last_decoded_pts = -1;
+        return ret;
+    }
+    if(rr->seq != NULL) {
+        // sequence timestamps (converted here: the reading thread does not touch clips)
+        for(int i = 0; i < seg->nb; i++) {
+            AVFrame *f = seg->frames[i];
+            f->pts = video_pkt_to_seq_ts(rr->seq, clip, f->pts);
+            f->key_frame = 0;
+            f->pict_type = AV_PICTURE_TYPE_NONE;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Give a segment to the worker thread to decode
+ * @param rr  ReverseReader
+ * @param seg segment to decode (not in use)
+ */
+void start_reverse_job(ReverseReader *rr, ReverseSegment *seg) {
+    pthread_mutex_lock(&(rr->lock));
+    rr->job = seg;
+    pthread_cond_broadcast(&(rr->cond));
+    pthread_mutex_unlock(&(rr->lock));
+}
+
+/**
+ * Wait for the worker thread to finish its segment
+ * @param  rr ReverseReader
+ * @return    result of decoding the segment
+ */
+int wait_reverse_job(ReverseReader *rr) {
+    pthread_mutex_lock(&(rr->lock));
+    while(rr->job != NULL) {
+        pthread_cond_wait(&(rr->cond), &(rr->lock));
+    }
+    pthread_mutex_unlock(&(rr->lock));
+    // the worker only decodes the segment that is not being output
+    return rr->segs[1 - rr->cur].ret;
+}
+
+/**
+ * Worker thread main loop. Decodes each segment it is given
+ * @param  arg ReverseReader
+ * @return     NULL
+ */
+void *reverse_reader_thread(void *arg) {
+    ReverseReader *rr = (ReverseReader *) arg;
+    pthread_mutex_lock(&(rr->lock));
+    while(!rr->exit) {
+        if(rr->job == NULL) {
+            pthread_cond_wait(&(rr->cond), &(rr->lock));
+            continue;
+        }
+        ReverseSegment *seg = rr->job;
+        pthread_mutex_unlock(&(rr->lock));
+        seg->ret = decode_next_reverse_segment(rr, seg);
+        pthread_mutex_lock(&(rr->lock));
+        rr->job = NULL;
+        pthread_cond_broadcast(&(rr->cond));
+    }
+    pthread_mutex_unlock(&(rr->lock));
+    return NULL;
+}
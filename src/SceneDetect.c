@@ -0,0 +1,593 @@
+/**
+ * @file SceneDetect.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for SceneDetect API:
+ * Analysis pass over a clip or sequence finding shot boundaries (cut candidates).
+ * Frames are compared on downscaled luma planes and luma histograms, with SSE2
+ * kernels when available (scalar fallback otherwise).
+ */
+
+#include "SceneDetect.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Set default scene detection parameters
+ * @param params SceneParams
+ */
+void set_scene_params_default(SceneParams *params) {
+    params->threshold = 0.15;
+    params->adaptive_ratio = 2.5;
+    params->window = 12;
+    params->min_scene_len = 8;
+    params->lowres = 1;
+    params->fast_decode = true;
+}
+
+/**
+ * Initialize an empty scene list
+ * @param list SceneList
+ */
+void init_scene_list(SceneList *list) {
+    list->cuts = NULL;
+    list->nb_cuts = 0;
+    list->cuts_size = 0;
+    list->scores = NULL;
+    list->nb_scores = 0;
+    list->scores_size = 0;
+}
+
+/**
+ * Find the shot boundaries of a clip. Frame indices are relative to the start of the clip
+ * @param  clip   Clip to analyse (the clip is seeked back to its start when done)
+ * @param  params SceneParams (NULL for defaults)
+ * @param  list   SceneList initialized with init_scene_list() (results are added)
+ * @return        >= 0 on success
+ */
+int detect_clip_scenes(Clip *clip, SceneParams *params, SceneList *list) {
+    if(clip == NULL || list == NULL) {
+        log_error("detect_clip_scenes() error: NULL params\n");
+        return -1;
+    }
+    SceneDetector sd;
+    init_scene_detector(&sd, params);
+    // decoding options of the caller are restored when done
+    int lowres = clip->vid_ctx->lowres;
+    bool fast_decode = clip->vid_ctx->fast_decode;
+    int ret = set_scene_decode_options(clip, sd.params.lowres, sd.params.fast_decode);
+    if(ret >= 0) {
+        ret = detect_scenes_internal(&sd, clip, NULL, list);
+    }
+    free_scene_detector(&sd);
+    int restore_ret = set_scene_decode_options(clip, lowres, fast_decode);
+    return ret < 0 ? ret : restore_ret;
+}
+
+/**
+ * Find the shot boundaries of a sequence. Frame indices are sequence frame indices
+ * @param  seq    Sequence to analyse (sequence is seeked back to its start when done)
+ * @param  params SceneParams (NULL for defaults)
+ * @param  list   SceneList initialized with init_scene_list() (results are added)
+ * @return        >= 0 on success
+ */
+int detect_sequence_scenes(Sequence *seq, SceneParams *params, SceneList *list) {
+    if(seq == NULL || list == NULL) {
+        log_error("detect_sequence_scenes() error: NULL params\n");
+        return -1;
+    }
+    int nb_clips = getLength(seq->clips);
+    int *lowres = malloc(sizeof(int) * FFMAX(nb_clips, 1));
+    bool *fast_decode = malloc(sizeof(bool) * FFMAX(nb_clips, 1));
+    if(lowres == NULL || fast_decode == NULL) {
+        log_error("detect_sequence_scenes() error: Failed to allocate decoding options\n");
+        free(lowres);
+        free(fast_decode);
+        return AVERROR(ENOMEM);
+    }
+    SceneDetector sd;
+    init_scene_detector(&sd, params);
+    // decoding options are changed once per VideoContext for the whole pass
+    // (clips sharing a VideoContext are no-ops after the first)
+    int i = 0, ret = 0;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next, ++i) {
+        Clip *clip = (Clip *) curr->data;
+        lowres[i] = clip->vid_ctx->lowres;
+        fast_decode[i] = clip->vid_ctx->fast_decode;
+    }
+    for(Node *curr = seq->clips.head; curr != NULL && ret >= 0; curr = curr->next) {
+        ret = set_scene_decode_options((Clip *) curr->data, sd.params.lowres, sd.params.fast_decode);
+    }
+    // the detector is kept across clips, so each edit point is scored like any other frame
+    for(Node *curr = seq->clips.head; curr != NULL && ret >= 0; curr = curr->next) {
+        ret = detect_scenes_internal(&sd, (Clip *) curr->data, seq, list);
+    }
+    free_scene_detector(&sd);
+    // restore the decoding options of the caller
+    i = 0;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next, ++i) {
+        int restore_ret = set_scene_decode_options((Clip *) curr->data, lowres[i], fast_decode[i]);
+        if(ret >= 0 && restore_ret < 0) {
+            ret = restore_ret;
+        }
+    }
+    free(lowres);
+    free(fast_decode);
+    if(ret < 0) {
+        log_error("detect_sequence_scenes() error: Failed to analyse sequence\n");
+        return ret;
+    }
+    if(seq->clips.head != NULL) {
+        ret = sequence_seek(seq, 0);
+    }
+    return ret;
+}
+
+/**
+ * Snap a frame index to the closest shot boundary
+ * @param  list        SceneList
+ * @param  frame_index frame index to snap
+ * @param  max_dist    max distance (in frames) of the shot boundary
+ * @return             closest shot boundary within max_dist, else frame_index
+ */
+int64_t snap_to_scene_cut(SceneList *list, int64_t frame_index, int max_dist) {
+    // binary search for the first cut >= frame_index
+    int lo = 0, hi = list->nb_cuts;
+    while(lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if(list->cuts[mid] < frame_index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    int64_t best = frame_index;
+    int64_t best_dist = (int64_t) max_dist + 1;
+    if(lo < list->nb_cuts && list->cuts[lo] - frame_index < best_dist) {
+        best = list->cuts[lo];
+        best_dist = list->cuts[lo] - frame_index;
+    }
+    if(lo > 0 && frame_index - list->cuts[lo - 1] < best_dist) {
+        best = list->cuts[lo - 1];
+    }
+    return best;
+}
+
+/**
+ * Remove a range of frames from a scene list (shot boundaries and scores after
+ * the range move back). Keeps the list in sync with sequence_ripple_delete_clip()
+ * @param list  SceneList
+ * @param start first frame removed
+ * @param end   end of removed frames (exclusive)
+ */
+void scene_list_ripple_delete(SceneList *list, int64_t start, int64_t end) {
+    if(start < 0 || end <= start) {
+        return;
+    }
+    int64_t len = end - start;
+    int nb = 0;
+    for(int i = 0; i < list->nb_cuts; i++) {
+        int64_t cut = list->cuts[i];
+        if(cut < start) {
+            list->cuts[nb++] = cut;
+        } else if(cut >= end) {
+            list->cuts[nb++] = cut - len;
+        }
+    }
+    list->nb_cuts = nb;
+    if(start >= list->nb_scores) {
+        return;
+    }
+    if(end >= list->nb_scores) {
+        list->nb_scores = start;
+        return;
+    }
+    memmove(list->scores + start, list->scores + end, (list->nb_scores - end) * sizeof(float));
+    list->nb_scores -= len;
+}
+
+/**
+ * Free the cuts and scores of a scene list
+ * @param list SceneList
+ */
+void free_scene_list(SceneList *list) {
+    free(list->cuts);
+    free(list->scores);
+    init_scene_list(list);
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Initialize the analysis state
+ * @param sd     SceneDetector
+ * @param params SceneParams (NULL for defaults)
+ */
+void init_scene_detector(SceneDetector *sd, SceneParams *params) {
+    if(params != NULL) {
+        sd->params = *params;
+    } else {
+        set_scene_params_default(&(sd->params));
+    }
+    sd->params.window = FFMAX(1, FFMIN(sd->params.window, SCENE_MAX_WINDOW));
+    sd->planes[0] = NULL;
+    sd->planes[1] = NULL;
+    sd->width = 0;
+    sd->height = 0;
+    sd->curr = 0;
+    sd->has_prev = false;
+    sd->window_nb = 0;
+    sd->window_pos = 0;
+    sd->last_cut = 0;
+    init_video_converter(&(sd->convert));
+}
+
+/**
+ * Free the planes and converter of the analysis state
+ * @param sd SceneDetector
+ */
+void free_scene_detector(SceneDetector *sd) {
+    free(sd->planes[0]);
+    free(sd->planes[1]);
+    sd->planes[0] = NULL;
+    sd->planes[1] = NULL;
+    close_video_converter(&(sd->convert));
+}
+
+/**
+ * Decode every video frame of a clip and analyse it. The decoding options of
+ * the analysis are set by the caller, once for the whole pass (set_scene_decode_options())
+ * @param  sd   SceneDetector
+ * @param  clip Clip
+ * @param  seq  Sequence of the clip (frames get sequence indices), NULL for clip indices
+ * @param  list SceneList to add results
+ * @return      >= 0 on success
+ */
+int detect_scenes_internal(SceneDetector *sd, Clip *clip, Sequence *seq, SceneList *list) {
+    VideoContext *vc = clip->vid_ctx;
+    int ret = open_clip(clip);
+    if(ret < 0 || (ret = seek_clip_pts(clip, 0)) < 0) {
+        log_error("detect_scenes_internal() error: Failed to open clip[%s]\n", vc->url);
+        return ret;
+    }
+    // analysis only needs video: audio packets are never demuxed or decoded
+    clip->done_reading_audio = true;
+    set_stream_discard(vc, vc->audio_stream_idx, true);
+
+    AVFrame *frame = av_frame_alloc();
+    if(frame == NULL) {
+        log_error("detect_scenes_internal() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    enum AVMediaType type;
+    while(ret >= 0 && clip_read_frame(clip, frame, &type) >= 0) {
+        if(type == AVMEDIA_TYPE_VIDEO) {
+            int64_t frame_index = clip->frame_index - 1;
+            if(seq != NULL) {
+                frame_index = seq_pts_to_frame_index(seq, video_pkt_to_seq_ts(seq, clip, frame->pts));
+            }
+            if(frame_index >= 0) {
+                ret = analyse_scene_frame(sd, frame, frame_index, list);
+            }
+        }
+        av_frame_unref(frame);
+    }
+    av_frame_free(&frame);
+    if(ret < 0) {
+        log_error("detect_scenes_internal() error: Failed to analyse clip[%s]\n", vc->url);
+        return ret;
+    }
+    // leave the clip at its start
+    return seek_clip_pts(clip, 0);
+}
+
+/**
+ * Change the decoding options of a clip VideoContext (reopened when it was open)
+ * @param  clip        Clip
+ * @param  lowres      decode at 1/(2^lowres) resolution
+ * @param  fast_decode non spec compliant speedups
+ * @return             >= 0 on success
+ */
+int set_scene_decode_options(Clip *clip, int lowres, bool fast_decode) {
+    VideoContext *vc = clip->vid_ctx;
+    if(vc->lowres == lowres && vc->fast_decode == fast_decode) {
+        return 0;
+    }
+    bool was_open = vc->open;
+    close_video_context(vc);
+    vc->lowres = lowres;
+    vc->fast_decode = fast_decode;
+    if(was_open) {
+        int ret = open_clip(clip);
+        if(ret < 0) {
+            log_error("set_scene_decode_options() error: Failed to reopen clip[%s]\n", vc->url);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Score a decoded frame against the previous frame, and add a shot boundary when
+ * the score passes both thresholds
+ * @param  sd          SceneDetector
+ * @param  frame       decoded video frame (may be replaced by a converted frame)
+ * @param  frame_index index of the frame
+ * @param  list        SceneList to add results
+ * @return             >= 0 on success
+ */
+int analyse_scene_frame(SceneDetector *sd, AVFrame *frame, int64_t frame_index, SceneList *list) {
+    int prev_width = sd->width, prev_height = sd->height;
+    int ret = load_scene_plane(sd, frame);
+    if(ret < 0) {
+        return ret;
+    }
+    int n = sd->width * sd->height;
+    int curr = sd->curr, prev = !curr;
+    scene_histogram(sd->planes[curr], n, sd->hist[curr]);
+
+    float score = 0;
+    if(!sd->has_prev) {
+        // first frame starts a shot
+        sd->last_cut = frame_index;
+    } else {
+        if(sd->width != prev_width || sd->height != prev_height) {
+            // a new source size is always a new shot
+            score = 1;
+        } else {
+            double mad = (double) scene_sad(sd->planes[curr], sd->planes[prev], n) / n / 255.0;
+            double hist = (double) scene_histogram_diff(sd->hist[curr], sd->hist[prev]) / (2.0 * n);
+            score = (mad + hist) / 2.0;
+        }
+        double avg = 0;
+        for(int i = 0; i < sd->window_nb; i++) {
+            avg += sd->window[i];
+        }
+        avg = sd->window_nb > 0 ? avg / sd->window_nb : 0;
+        if(score >= sd->params.threshold && score >= sd->params.adaptive_ratio * avg &&
+            frame_index - sd->last_cut >= sd->params.min_scene_len) {
+            if((ret = add_scene_cut(list, frame_index)) < 0) {
+                return ret;
+            }
+            sd->last_cut = frame_index;
+        }
+        sd->window[sd->window_pos] = score;
+        sd->window_pos = (sd->window_pos + 1) % sd->params.window;
+        sd->window_nb = FFMIN(sd->window_nb + 1, sd->params.window);
+    }
+    if((ret = set_scene_score(list, frame_index, score)) < 0) {
+        return ret;
+    }
+    sd->has_prev = true;
+    sd->curr = prev;
+    return 0;
+}
+
+/**
+ * Downscale the luma of a frame into the current plane of the detector
+ * (reallocates the planes when the size changes)
+ * @param  sd    SceneDetector
+ * @param  frame decoded video frame
+ * @return       >= 0 on success
+ */
+int load_scene_plane(SceneDetector *sd, AVFrame *frame) {
+    int width = frame->width / SCENE_BLOCK_SIZE;
+    int height = frame->height / SCENE_BLOCK_SIZE;
+    if(width <= 0 || height <= 0) {
+        log_error("load_scene_plane() error: Frame[%dx%d] is too small\n", frame->width, frame->height);
+        return -1;
+    }
+    if(width != sd->width || height != sd->height) {
+        free(sd->planes[0]);
+        free(sd->planes[1]);
+        sd->planes[0] = malloc(width * height);
+        sd->planes[1] = malloc(width * height);
+        if(sd->planes[0] == NULL || sd->planes[1] == NULL) {
+            log_error("load_scene_plane() error: Failed to allocate planes\n");
+            sd->width = sd->height = 0;
+            return AVERROR(ENOMEM);
+        }
+        sd->width = width;
+        sd->height = height;
+    }
+    uint8_t *dst = sd->planes[sd->curr];
+    if(scene_luma_plane(frame->format)) {
+        scene_downscale(frame->data[0], frame->linesize[0], width, height, dst);
+        return 0;
+    }
+    // no 8 bit luma plane (RGB, high bit depth..): let swscale downscale into GRAY8
+    int ret;
+    if(sd->convert.open && (sd->convert.width != width || sd->convert.height != height)) {
+        close_video_converter(&(sd->convert));
+    }
+    if(!sd->convert.open && (ret = open_video_converter(&(sd->convert), width, height, AV_PIX_FMT_GRAY8, 1)) < 0) {
+        return ret;
+    }
+    if((ret = convert_video_frame(&(sd->convert), frame)) < 0) {
+        log_error("load_scene_plane() error: Failed to convert frame to GRAY8\n");
+        return ret;
+    }
+    for(int y = 0; y < height; y++) {
+        memcpy(dst + y * width, frame->data[0] + y * frame->linesize[0], width);
+    }
+    return 0;
+}
+
+/**
+ * Check if the first plane of a pixel format holds 8 bit luma, one byte per pixel
+ * @param  pix_fmt pixel format
+ * @return         true when the luma plane can be read directly
+ */
+bool scene_luma_plane(enum AVPixelFormat pix_fmt) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
+    if(desc == NULL || (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL))) {
+        return false;
+    }
+    return desc->comp[0].plane == 0 && desc->comp[0].step == 1 && desc->comp[0].depth == 8;
+}
+
+/**
+ * Average SCENE_BLOCK_SIZE x SCENE_BLOCK_SIZE blocks of a luma plane
+ * @param src      luma plane
+ * @param linesize bytes per row of src
+ * @param width    width of dst (blocks per row)
+ * @param height   height of dst (rows of blocks)
+ * @param dst      downscaled plane (width * height bytes)
+ */
+void scene_downscale(const uint8_t *src, int linesize, int width, int height, uint8_t *dst) {
+    const int area = SCENE_BLOCK_SIZE * SCENE_BLOCK_SIZE;
+    for(int y = 0; y < height; y++) {
+        const uint8_t *rows = src + (ptrdiff_t) y * SCENE_BLOCK_SIZE * linesize;
+        uint8_t *out = dst + y * width;
+        int x = 0;
+#if defined(__SSE2__) && SCENE_BLOCK_SIZE == 8
+        // two blocks per 16 byte load: _mm_sad_epu8 against zero sums each 8 byte half
+        const __m128i zero = _mm_setzero_si128();
+        for(; x + 2 <= width; x += 2) {
+            __m128i sum = zero;
+            for(int r = 0; r < SCENE_BLOCK_SIZE; r++) {
+                __m128i px = _mm_loadu_si128((const __m128i *) (rows + (ptrdiff_t) r * linesize + x * SCENE_BLOCK_SIZE));
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(px, zero));
+            }
+            out[x] = (_mm_cvtsi128_si32(sum) + area / 2) / area;
+            out[x + 1] = (_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)) + area / 2) / area;
+        }
+#endif
+        for(; x < width; x++) {
+            int sum = 0;
+            for(int r = 0; r < SCENE_BLOCK_SIZE; r++) {
+                const uint8_t *p = rows + (ptrdiff_t) r * linesize + x * SCENE_BLOCK_SIZE;
+                for(int c = 0; c < SCENE_BLOCK_SIZE; c++) {
+                    sum += p[c];
+                }
+            }
+            out[x] = (sum + area / 2) / area;
+        }
+    }
+}
+
+/**
+ * Sum of absolute differences between two planes
+ * @param  a first plane
+ * @param  b second plane
+ * @param  n number of pixels
+ * @return   sum of |a[i] - b[i]|
+ */
+uint64_t scene_sad(const uint8_t *a, const uint8_t *b, int n) {
+    uint64_t sad = 0;
+    int i = 0;
+#ifdef __SSE2__
+    __m128i sum = _mm_setzero_si128();
+    for(; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+    }
+    sad = (uint64_t) _mm_cvtsi128_si32(sum) + (uint64_t) _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#endif
+    for(; i < n; i++) {
+        sad += abs(a[i] - b[i]);
+    }
+    return sad;
+}
+
+/**
+ * Luma histogram of a plane (SCENE_HIST_BINS bins)
+ * @param plane downscaled plane
+ * @param n     number of pixels
+ * @param hist  output histogram
+ */
+void scene_histogram(const uint8_t *plane, int n, uint32_t *hist) {
+    // four partial histograms, so consecutive pixels of the same bin do not stall on one counter
+    uint32_t part[4][SCENE_HIST_BINS] = {{0}};
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        ++part[0][plane[i] >> SCENE_HIST_SHIFT];
+        ++part[1][plane[i + 1] >> SCENE_HIST_SHIFT];
+        ++part[2][plane[i + 2] >> SCENE_HIST_SHIFT];
+        ++part[3][plane[i + 3] >> SCENE_HIST_SHIFT];
+    }
+    for(; i < n; i++) {
+        ++part[0][plane[i] >> SCENE_HIST_SHIFT];
+    }
+    for(int b = 0; b < SCENE_HIST_BINS; b++) {
+        hist[b] = part[0][b] + part[1][b] + part[2][b] + part[3][b];
+    }
+}
+
+/**
+ * Sum of absolute differences between two histograms
+ * @param  a first histogram
+ * @param  b second histogram
+ * @return   sum of |a[i] - b[i]|
+ */
+uint64_t scene_histogram_diff(const uint32_t *a, const uint32_t *b) {
+    uint64_t diff = 0;
+    int i = 0;
+#ifdef __SSE2__
+    // |d| = (d ^ sign) - sign (SSE2 has no 32 bit abs)
+    __m128i sum = _mm_setzero_si128();
+    for(; i + 4 <= SCENE_HIST_BINS; i += 4) {
+        __m128i d = _mm_sub_epi32(_mm_loadu_si128((const __m128i *) (a + i)),
+                                  _mm_loadu_si128((const __m128i *) (b + i)));
+        __m128i sign = _mm_srai_epi32(d, 31);
+        sum = _mm_add_epi32(sum, _mm_sub_epi32(_mm_xor_si128(d, sign), sign));
+    }
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *) lanes, sum);
+    diff = (uint64_t) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for(; i < SCENE_HIST_BINS; i++) {
+        diff += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+    return diff;
+}
+
+/**
+ * Set the score of a frame (grows the scores array)
+ * @param  list        SceneList
+ * @param  frame_index index of frame
+ * @param  score       score of frame
+ * @return             >= 0 on success
+ */
+int set_scene_score(SceneList *list, int64_t frame_index, float score) {
+    if(frame_index >= list->scores_size) {
+        int64_t size = FFMAX(frame_index + 1, list->scores_size * 2);
+        float *scores = realloc(list->scores, size * sizeof(float));
+        if(scores == NULL) {
+            log_error("set_scene_score() error: Failed to grow scores\n");
+            return AVERROR(ENOMEM);
+        }
+        list->scores = scores;
+        list->scores_size = size;
+    }
+    // frames skipped between analysed frames (gaps in a sequence) score 0
+    for(int64_t i = list->nb_scores; i < frame_index; i++) {
+        list->scores[i] = 0;
+    }
+    list->scores[frame_index] = score;
+    list->nb_scores = FFMAX(list->nb_scores, frame_index + 1);
+    return 0;
+}
+
+/**
+ * Add a shot boundary at the end of the list
+ * @param  list        SceneList
+ * @param  frame_index first frame of the new shot
+ * @return             >= 0 on success
+ */
+int add_scene_cut(SceneList *list, int64_t frame_index) {
+    if(list->nb_cuts == list->cuts_size) {
+        int size = list->cuts_size > 0 ? list->cuts_size * 2 : 64;
+        int64_t *cuts = realloc(list->cuts, size * sizeof(int64_t));
+        if(cuts == NULL) {
+            log_error("add_scene_cut() error: Failed to grow cuts\n");
+            return AVERROR(ENOMEM);
+        }
+        list->cuts = cuts;
+        list->cuts_size = size;
+    }
+    list->cuts[list->nb_cuts++] = frame_index;
+    return 0;
+}
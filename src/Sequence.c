@@ -31,7 +31,7 @@ int init_sequence(Sequence *seq, double fps, int sample_rate) {
  */
 int init_sequence_cmp(Sequence *seq, double fps, int sample_rate, int (*compareFunc)(const void* first,const void* second)) {
     if(seq == NULL || compareFunc == NULL) {
-        fprintf(stderr, "init_sequence_cmp() error: params cannot be NULL\n");
+        log_error("init_sequence_cmp() error: params cannot be NULL\n");
         return -1;
     }
     seq->clips = initializeList(&list_print_clip, &list_delete_clip, compareFunc);
@@ -40,6 +40,14 @@ int init_sequence_cmp(Sequence *seq, double fps, int sample_rate, int (*compareF
     seq->audio_time_base = (AVRational){1, sample_rate};
     seq->fps = fps;
     seq->video_frame_duration = SEQ_VIDEO_FRAME_DURATION;
+    seq->index = NULL;
+    seq->index_nb = 0;
+    seq->index_size = 0;
+    seq->index_dirty = true;
+    init_sequence_transition(&(seq->transition));
+    seq->tracks = NULL;
+    seq->nb_tracks = 0;
+    init_sequence_compositor(&(seq->compositor));
     return 0;
 }
 
@@ -73,7 +81,7 @@ Clip *seq_alloc_clip(Sequence *seq, char *url) {
  */
 Clip *find_clip(Sequence *seq, char *url) {
     if(seq == NULL || url == NULL) {
-        fprintf(stderr, "find_clip() error: Invalid params\n");
+        log_error("find_clip() error: Invalid params\n");
     }
     Node *currNode = seq->clips.head;
     while(currNode != NULL) {
@@ -122,7 +130,7 @@ int64_t get_sequence_duration_pts(Sequence *seq) {
  */
 void sequence_add_clip(Sequence *seq, Clip *clip, int start_frame_index) {
     if(seq == NULL || clip == NULL) {
-        fprintf(stderr, "sequence_add_clip error: parameters cannot be NULL");
+        log_error("sequence_add_clip error: parameters cannot be NULL");
         return;
     }
     int64_t pts = get_video_frame_pts(clip->vid_ctx, start_frame_index);
@@ -137,13 +145,14 @@ void sequence_add_clip(Sequence *seq, Clip *clip, int start_frame_index) {
  * @return          >= 0 on success
  */
 void sequence_add_clip_pts(Sequence *seq, Clip *clip, int64_t start_pts) {
-    printf("sequence add clip [%s], start_pts: %ld\n", clip->vid_ctx->url, start_pts);
+    log_debug("sequence add clip [%s], start_pts: %ld\n", clip->vid_ctx->url, start_pts);
     if(seq == NULL || clip == NULL) {
-        fprintf(stderr, "sequence_add_clip error: parameters cannot be NULL");
+        log_error("sequence_add_clip error: parameters cannot be NULL");
         return;
     }
     move_clip_pts(seq, clip, start_pts);
     insertSorted(&(seq->clips), clip);
+    seq->index_dirty = true;
     if(seq->clips.length == 1) {
         seq->clips_iter.current = seq->clips.head;
     }
@@ -156,7 +165,7 @@ void sequence_add_clip_pts(Sequence *seq, Clip *clip, int64_t start_pts) {
  */
 void sequence_append_clip(Sequence *seq, Clip *clip) {
     if(seq == NULL || clip == NULL) {
-        fprintf(stderr, "sequence_add_clip error: parameters cannot be NULL");
+        log_error("sequence_add_clip error: parameters cannot be NULL");
         return;
     }
     void *data = getFromBack(seq->clips);
@@ -180,15 +189,16 @@ void sequence_append_clip(Sequence *seq, Clip *clip) {
  */
 int sequence_insert_clip_sorted(Sequence *seq, Clip *clip) {
     if(seq == NULL || clip == NULL) {
-        fprintf(stderr, "sequence_insert_clip_sorted() error: parameters cannot be NULL\n");
+        log_error("sequence_insert_clip_sorted() error: parameters cannot be NULL\n");
         return -1;
     }
     Node *node = insertSortedGetNode(&(seq->clips), clip);
     if(node == NULL) {
-        fprintf(stderr, "sequence_insert_clip_sorted() error: could not insert clip in sorted order\n");
+        log_error("sequence_insert_clip_sorted() error: could not insert clip in sorted order\n");
         return -1;
     }
     seq->clips_iter.current = seq->clips.head;
+    seq->index_dirty = true;
     if(node->previous == NULL) {
         move_clip_pts(seq, clip, 0);
     } else {
@@ -205,12 +215,13 @@ int sequence_insert_clip_sorted(Sequence *seq, Clip *clip) {
  */
 int shift_clips_after(Sequence *seq, Node *curr_node) {
     if(seq == NULL || curr_node == NULL) {
-        fprintf(stderr, "shift_clips_after() error: parameters cannot be NULL\n");
+        log_error("shift_clips_after() error: parameters cannot be NULL\n");
         return -1;
     }
     Clip *curr = (Clip *) (curr_node->data);
     int64_t shift = curr->end_pts - curr->start_pts;
     Node *node = curr_node->next;
+    seq->index_dirty = true;
     while(node != NULL) {
         Clip *next = (Clip *) (node->data);
         next->start_pts += shift;
@@ -228,18 +239,19 @@ int shift_clips_after(Sequence *seq, Node *curr_node) {
  */
 int sequence_ripple_delete_clip(Sequence *seq, Clip *clip) {
     if(seq == NULL || clip == NULL) {
-        fprintf(stderr, "sequence_delete_clip() error: parameters cannot be NULL");
+        log_error("sequence_delete_clip() error: parameters cannot be NULL");
         return -1;
     }
     Node *curr = getNodeFromData(&(seq->clips), clip);
     if(curr == NULL) {
-        fprintf(stderr, "sequence_delete_clip() error: clip data does not exist in sequence\n");
+        log_error("sequence_delete_clip() error: clip data does not exist in sequence\n");
         return -1;
     }
     Node *next = curr->next;
+    seq->index_dirty = true;
     void *data = deleteDataFromList(&(seq->clips), clip);
     if(data == NULL) {
-        fprintf(stderr, "sequence_delete_clip() error: Failed to delete clip from sequence\n");
+        log_error("sequence_delete_clip() error: Failed to delete clip from sequence\n");
         return -1;
     }
     if(next == NULL) {
@@ -258,6 +270,195 @@ int sequence_ripple_delete_clip(Sequence *seq, Clip *clip) {
     return 0;
 }
 
+/**
+ * Add a transition from the previous clip into a clip. The clip and all following clips
+ * move back by the duration of the transition, so the two clips overlap for that long
+ * (the sequence gets shorter). Any transition already on the clip is replaced
+ * @param  seq        Sequence
+ * @param  clip       Clip within sequence (not the first)
+ * @param  transition type (and color) of transition
+ * @param  nb_frames  duration of transition in sequence frames (shorter than both clips)
+ * @return            >= 0 on success
+ */
+int sequence_add_transition(Sequence *seq, Clip *clip, Transition *transition, int nb_frames) {
+    if(seq == NULL || clip == NULL || transition == NULL || transition->type == TRANSITION_NONE || nb_frames <= 0) {
+        log_error("sequence_add_transition() error: Invalid params\n");
+        return -1;
+    }
+    Node *node = getNodeFromData(&(seq->clips), clip);
+    if(node == NULL || node->previous == NULL) {
+        log_error("sequence_add_transition() error: clip must follow another clip in sequence\n");
+        return -1;
+    }
+    Clip *prev = (Clip *) node->previous->data;
+    int64_t duration = (int64_t) nb_frames * seq->video_frame_duration;
+    // each clip must be longer than the transitions at both of its ends
+    int64_t prev_start = prev->start_pts, clip_end = clip->end_pts;
+    int64_t start, end, overlap = 0;
+    if(get_clip_transition_pts(node->previous, &start, &end)) {
+        prev_start = end;
+    }
+    if(node->next != NULL && get_clip_transition_pts(node->next, &start, &end)) {
+        clip_end -= end - start;
+    }
+    if(get_clip_transition_pts(node, &start, &end)) {
+        overlap = end - start;
+    }
+    if(duration >= prev->end_pts - prev_start || duration >= clip_end - clip->start_pts) {
+        log_error("sequence_add_transition() error: transition of %d frames is longer than its clips\n", nb_frames);
+        return -1;
+    }
+    clip->transition = *transition;
+    shift_clips_from(seq, node, overlap - duration);
+    return 0;
+}
+
+/**
+ * Remove the transition into a clip. The clip and all following clips move forward
+ * so the clip starts where the previous one ends (a cut)
+ * @param  seq  Sequence
+ * @param  clip Clip within sequence
+ * @return      >= 0 on success
+ */
+int sequence_remove_transition(Sequence *seq, Clip *clip) {
+    if(seq == NULL || clip == NULL) {
+        log_error("sequence_remove_transition() error: Invalid params\n");
+        return -1;
+    }
+    Node *node = getNodeFromData(&(seq->clips), clip);
+    if(node == NULL) {
+        log_error("sequence_remove_transition() error: clip data does not exist in sequence\n");
+        return -1;
+    }
+    int64_t start, end;
+    if(get_clip_transition_pts(node, &start, &end)) {
+        shift_clips_from(seq, node, end - start);
+    }
+    clip->transition.type = TRANSITION_NONE;
+    return 0;
+}
+
+/**
+ * Get the overlap of a clip with the previous clip (its transition)
+ * @param  node      list node of clip within sequence
+ * @param  start_pts output start of overlap (sequence pts)
+ * @param  end_pts   output end of overlap (sequence pts, exclusive)
+ * @return           true if the clip has a transition
+ */
+bool get_clip_transition_pts(Node *node, int64_t *start_pts, int64_t *end_pts) {
+    Clip *clip = (Clip *) node->data;
+    if(node->previous == NULL || clip->transition.type == TRANSITION_NONE) {
+        return false;
+    }
+    Clip *prev = (Clip *) node->previous->data;
+    if(clip->start_pts >= prev->end_pts) {
+        return false;
+    }
+    *start_pts = clip->start_pts;
+    *end_pts = prev->end_pts;
+    return true;
+}
+
+/**
+ * Add a track on top of the tracks of a sequence. Clips are added to track->seq
+ * @param  seq   Sequence
+ * @param  video layer the video of the track over the sequence
+ * @param  audio mix the audio of the track into the sequence
+ * @return       SequenceTrack (freed with the sequence), NULL on error
+ */
+SequenceTrack *sequence_add_track(Sequence *seq, bool video, bool audio) {
+    size_t size = (seq->nb_tracks + 1) * sizeof(SequenceTrack *);
+    SequenceTrack **tracks = realloc(seq->tracks, size);
+    if(tracks == NULL) {
+        log_error("sequence_add_track() error: Failed to allocate tracks\n");
+        return NULL;
+    }
+    seq->tracks = tracks;
+    SequenceTrack **job_tracks = realloc(seq->compositor.job_tracks, size);
+    if(job_tracks == NULL) {
+        log_error("sequence_add_track() error: Failed to allocate tracks\n");
+        return NULL;
+    }
+    seq->compositor.job_tracks = job_tracks;
+    SequenceTrack *track = calloc(1, sizeof(struct SequenceTrack));
+    if(track == NULL || init_sequence(&(track->seq), seq->fps, seq->audio_time_base.den) < 0) {
+        log_error("sequence_add_track() error: Failed to allocate track\n");
+        free(track);
+        return NULL;
+    }
+    track->video = video;
+    track->audio = audio;
+    track->opacity = 1;
+    track->volume = 1;
+    track->layer_pts = AV_NOPTS_VALUE;
+    track->read_pts = AV_NOPTS_VALUE;
+    track->swr_fmt = AV_SAMPLE_FMT_NONE;
+    seq->tracks[(seq->nb_tracks)++] = track;
+    // every track starts again from the position of the next frame read
+    reset_sequence_tracks(seq);
+    return track;
+}
+
+/**
+ * Remove a track from a sequence and free it (along with its clips)
+ * @param  seq   Sequence
+ * @param  track SequenceTrack within sequence
+ * @return       >= 0 on success
+ */
+int sequence_remove_track(Sequence *seq, SequenceTrack *track) {
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        if(seq->tracks[i] == track) {
+            free_sequence_track(track);
+            memmove(seq->tracks + i, seq->tracks + i + 1, (seq->nb_tracks - i - 1) * sizeof(SequenceTrack *));
+            --(seq->nb_tracks);
+            return 0;
+        }
+    }
+    log_error("sequence_remove_track() error: track does not exist in sequence\n");
+    return -1;
+}
+
+/**
+ * Set the position, size and opacity of the video of a track
+ * (aligned down to the chroma subsampling of the sequence frames when composited)
+ * @param  track   SequenceTrack
+ * @param  x       left of video in frames of the sequence (can be negative)
+ * @param  y       top of video in frames of the sequence (can be negative)
+ * @param  width   width of video (0 for the width of the frames)
+ * @param  height  height of video (0 for the height of the frames)
+ * @param  opacity opacity of video (0 to 1)
+ * @return         >= 0 on success
+ */
+int set_track_layout(SequenceTrack *track, int x, int y, int width, int height, double opacity) {
+    if(track == NULL || width < 0 || height < 0 || opacity < 0 || opacity > 1) {
+        log_error("set_track_layout() error: Invalid params\n");
+        return -1;
+    }
+    track->x = x;
+    track->y = y;
+    track->width = width;
+    track->height = height;
+    track->opacity = opacity;
+    // scale the current frame again
+    track->layer_pts = AV_NOPTS_VALUE;
+    return 0;
+}
+
+/**
+ * Set the gain of the audio of a track
+ * @param  track  SequenceTrack
+ * @param  volume gain (1 to keep the level of the track)
+ * @return        >= 0 on success
+ */
+int set_track_volume(SequenceTrack *track, double volume) {
+    if(track == NULL || volume < 0) {
+        log_error("set_track_volume() error: Invalid params\n");
+        return -1;
+    }
+    track->volume = volume;
+    return 0;
+}
+
 /**
  * Convert sequence frame index to pts (presentation time stamp)
  * @param  seq         Sequence
@@ -266,7 +467,7 @@ int sequence_ripple_delete_clip(Sequence *seq, Clip *clip) {
  */
 int64_t seq_frame_index_to_pts(Sequence *seq, int frame_index) {
     if(seq == NULL || frame_index < 0) {
-        fprintf(stderr, "seq_frame_index_to_pts() error: Invalid parameters\n");
+        log_error("seq_frame_index_to_pts() error: Invalid parameters\n");
         return -1;
     }
     return seq->video_frame_duration * frame_index;
@@ -280,7 +481,7 @@ int64_t seq_frame_index_to_pts(Sequence *seq, int frame_index) {
  */
 int seq_pts_to_frame_index(Sequence *seq, int64_t pts) {
     if(seq == NULL || pts < 0) {
-        fprintf(stderr, "seq_pts_to_frame_index() error: Invalid parameters\n");
+        log_error("seq_pts_to_frame_index() error: Invalid parameters\n");
         return -1;
     }
     return pts / seq->video_frame_duration;
@@ -299,7 +500,7 @@ int cut_clip(Sequence *seq, int frame_index) {
     Clip *clip = NULL, *split_clip = NULL;
     int64_t clip_pts = find_clip_at_index(seq, frame_index, &clip);
     if(clip == NULL) {
-        fprintf(stderr, "cut_clip() error: Failed to find clip at index\n");
+        log_error("cut_clip() error: Failed to find clip at index\n");
         return -1;
     }
     int ret = cut_clip_internal(clip, clip_pts, &split_clip);
@@ -311,6 +512,7 @@ int cut_clip(Sequence *seq, int frame_index) {
     split_clip->start_pts = frame_index_pts;
     clip->end_pts = frame_index_pts;
     insertSorted(&(seq->clips), split_clip);
+    seq->index_dirty = true;
     return 0;
 }
 
@@ -324,19 +526,119 @@ int cut_clip(Sequence *seq, int frame_index) {
  *                      and clip timebase (where zero represents clip->orig_start_pts)
  */
 int64_t find_clip_at_index(Sequence *seq, int frame_index, Clip **found_clip) {
-    Node *currNode = seq->clips.head;
+    int64_t clip_pts;
+    Node *node = find_clip_node_at_index(seq, frame_index, &clip_pts);
+    if(node == NULL) {
+        *found_clip = NULL;
+        return -1;
+    }
+    *found_clip = (Clip *) node->data;
+    return clip_pts;
+}
+
+/**
+ * Find the list node of the clip that contains this frame_index in sequence
+ * (the clip lookup of sequence_seek(), without seeking the clip)
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @param  clip_pts    output pts relative to the clip, and clip timebase
+ *                     (where zero represents clip->orig_start_pts)
+ * @return             Node of clip, NULL if no clip contains frame_index
+ */
+Node *find_clip_node_at_index(Sequence *seq, int frame_index, int64_t *clip_pts) {
+    Node *found = find_sequence_index_node(seq, frame_index);
+    if(found != NULL) {
+        *clip_pts = seq_frame_within_clip(seq, (Clip *) found->data, frame_index);
+        return found;
+    }
+    // not in the index (gap in the sequence, or the index could not be built)
+    Node *currNode = seq->index_dirty ? seq->clips.head : NULL;
     while(currNode != NULL) {
-        Clip *clip = (Clip *) currNode->data;
-        int64_t clip_pts;
         // If clip is found at this frame index (in sequence)
-        if((clip_pts = seq_frame_within_clip(seq, clip, frame_index)) >= 0) {
-            *found_clip = clip;
-            return clip_pts;
+        if((*clip_pts = seq_frame_within_clip(seq, (Clip *) currNode->data, frame_index)) >= 0) {
+            return currNode;
         }
         currNode = currNode->next;
     }
-    *found_clip = NULL;
-    return -1;
+    *clip_pts = -1;
+    return NULL;
+}
+
+/**
+ * Build the clip index of a sequence (clips sorted by start_pts)
+ * @param  seq Sequence
+ * @return     >= 0 on success
+ */
+int build_sequence_index(Sequence *seq) {
+    if(seq->clips.length > seq->index_size) {
+        int size = FFMAX(seq->clips.length, seq->index_size * 2);
+        SequenceIndexEntry *index = realloc(seq->index, size * sizeof(struct SequenceIndexEntry));
+        if(index == NULL) {
+            log_error("build_sequence_index() error: Failed to allocate index\n");
+            return AVERROR(ENOMEM);
+        }
+        seq->index = index;
+        seq->index_size = size;
+    }
+    seq->index_nb = 0;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next) {
+        Clip *clip = (Clip *) curr->data;
+        SequenceIndexEntry *e = &(seq->index[seq->index_nb]);
+        // the list is kept in sequence order: anything else cannot be binary searched
+        if(seq->index_nb > 0 && clip->start_pts < e[-1].start_pts) {
+            log_warning("build_sequence_index(): clips are not in sequence order\n");
+            return -1;
+        }
+        e->start_pts = clip->start_pts;
+        e->end_pts = clip->end_pts;
+        e->node = curr;
+        ++(seq->index_nb);
+    }
+    seq->index_dirty = false;
+    return 0;
+}
+
+/**
+ * Binary search the clip index for the clip that contains this frame_index.
+ * The entry found is checked against the clip (so clips changed outside of the
+ * Sequence API only cost a rebuild)
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @return             Node of clip, NULL if no clip contains frame_index (or on error)
+ */
+Node *find_sequence_index_node(Sequence *seq, int frame_index) {
+    int64_t pts = seq_frame_index_to_pts(seq, frame_index);
+    if(pts < 0) {
+        return NULL;
+    }
+    for(int attempt = 0; attempt < 2; attempt++) {
+        if((seq->index_dirty || seq->index_nb != seq->clips.length) && build_sequence_index(seq) < 0) {
+            seq->index_dirty = true;
+            return NULL;
+        }
+        // last clip starting at or before pts
+        int lo = 0, hi = seq->index_nb - 1, found = -1;
+        while(lo <= hi) {
+            int mid = lo + (hi - lo) / 2;
+            if(seq->index[mid].start_pts <= pts) {
+                found = mid;
+                lo = mid + 1;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        if(found < 0 || pts >= seq->index[found].end_pts) {
+            return NULL;
+        }
+        SequenceIndexEntry *e = &(seq->index[found]);
+        Clip *clip = (Clip *) e->node->data;
+        if(clip->start_pts == e->start_pts && clip->end_pts == e->end_pts) {
+            return e->node;
+        }
+        // the clip moved without going through the Sequence API
+        seq->index_dirty = true;
+    }
+    return NULL;
 }
 
 /**
@@ -374,28 +676,35 @@ int64_t seq_frame_within_clip(Sequence *seq, Clip *clip, int frame_index) {
  * @return             >= 0 on success
  */
 int sequence_seek(Sequence *seq, int frame_index) {
-    Node *currNode = seq->clips.head;
-    while(currNode != NULL) {
-        Clip *clip = (Clip *) currNode->data;
-        int64_t clip_pts;
-        // If clip is found at this frame index (in sequence)
-        if((clip_pts = seq_frame_within_clip(seq, clip, frame_index)) >= 0) {
-            if(seq->clips_iter.current != NULL) {
-                Clip *previous = (Clip *) seq->clips_iter.current->data;
-                // If clips are different, close previous
-                if(compare_clips(clip, previous) != 0) {
-                    close_clip(previous);
-                }
-            }
-            seq->clips_iter.current = currNode;
-            // seek to the correct pts within the clip!
-            return seek_clip_pts(clip, clip_pts);
+    int64_t clip_pts;
+    Node *currNode = find_clip_node_at_index(seq, frame_index, &clip_pts);
+    if(currNode == NULL) {
+        log_error("Failed to find a clip at sequence frame index[%d] :(\n", frame_index);
+        return -1;
+    }
+    // inside a transition the outgoing clip is read (the incoming clip is decoded along with it)
+    int64_t start, end, seq_pts = seq_frame_index_to_pts(seq, frame_index);
+    if(get_clip_transition_pts(currNode, &start, &end) && seq_pts < end) {
+        currNode = currNode->previous;
+        clip_pts = seq_frame_within_clip(seq, (Clip *) currNode->data, frame_index);
+    }
+    reset_sequence_transition(&(seq->transition));
+    reset_sequence_tracks(seq);
+    Clip *clip = (Clip *) currNode->data;
+    if(seq->clips_iter.current != NULL) {
+        Clip *previous = (Clip *) seq->clips_iter.current->data;
+        // If clips read different files, close previous (clips of one file share the VideoContext)
+        if(previous->vid_ctx != clip->vid_ctx) {
+            close_clip(previous);
         }
-        currNode = currNode->next;
     }
-    // If we got down here, then we did not find a clip at this frame index
-    fprintf(stderr, "Failed to find a clip at sequence frame index[%d] :(\n", frame_index);
-    return -1;
+    seq->clips_iter.current = currNode;
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    // seek to the correct pts within the clip!
+    return seek_clip_pts(clip, clip_pts);
 }
 
 /**
@@ -415,42 +724,37 @@ int sequence_seek(Sequence *seq, int frame_index) {
  * @return     >= 0 on success (returns packet.stream_index), < 0 when reached end of sequence or error.
  */
 int sequence_read_packet(Sequence *seq, AVPacket *pkt, bool close_clips_flag) {
-    Node *currNode = seq->clips_iter.current;
-    if(currNode == NULL) {
-        printf("sequence_read_packet() currNode == NULL\n");
-        return -1;
-    }
-    Clip *curr_clip = (Clip *) currNode->data;    // current clip
-    AVPacket tmpPkt;
-    int ret = clip_read_packet(curr_clip, &tmpPkt);
-    // End of clip!
-    if(ret < 0) {
-        printf("End of clip[%s]\n", curr_clip->vid_ctx->url);
+    Node *currNode;
+    // iterate clips until one returns a packet (or we run out of clips)
+    while((currNode = seq->clips_iter.current) != NULL) {
+        Clip *curr_clip = (Clip *) currNode->data;    // current clip
+        int ret = clip_read_packet(curr_clip, pkt);
+        if(ret >= 0) {
+            // valid packet
+            return pkt->stream_index;
+        }
+        // End of clip!
+        log_debug("End of clip[%s]\n", curr_clip->vid_ctx->url);
         if(close_clips_flag) {
             close_clip(curr_clip);
         }
         // move iterator to next element
         nextElement(&(seq->clips_iter));
-        void *next = seq->clips_iter.current;       // get next clip Node
+        Node *next = seq->clips_iter.current;       // get next clip Node
         if(next == NULL) {
             // We're done reading all clips! (reset to start)
-            printf("We're done reading all clips! (reset to start)\n");
+            log_debug("We're done reading all clips! (reset to start)\n");
             sequence_seek(seq, 0);
             return -1;
-        } else {
-            // move onto next clip
-            Clip *next_clip = (Clip *) ((Node *)next)->data;
-            ret = open_clip(next_clip);
-            if(ret < 0) {
-                return ret;
-            }
-            return sequence_read_packet(seq, pkt, close_clips_flag);
         }
-    } else {
-        // valid packet down here
-        *pkt = tmpPkt;
-        return tmpPkt.stream_index;
+        // move onto next clip
+        ret = open_clip((Clip *) next->data);
+        if(ret < 0) {
+            return ret;
+        }
     }
+    log_warning("sequence_read_packet() currNode == NULL\n");
+    return -1;
 }
 
 /**
@@ -477,6 +781,7 @@ int move_clip(Sequence *seq, Clip *clip, int start_frame_index) {
  * @return                   >= 0 on success
  */
 void move_clip_pts(Sequence *seq, Clip *clip, int64_t start_pts) {
+    seq->index_dirty = true;
     clip->start_pts = start_pts;
     // Automatically set the end_pts to the duration of the clip (which is set by set_clip_bounds())
     int64_t clip_dur = clip->orig_end_pts - clip->orig_start_pts;
@@ -510,7 +815,7 @@ int64_t video_pkt_to_seq_ts(Sequence *seq, Clip *clip, int64_t orig_pkt_ts) {
     int64_t clip_ts = clip_ts_video(clip, orig_pkt_ts);
     AVRational clip_tb = get_clip_video_time_base(clip);
     if(clip_tb.num < 0 || clip_tb.den < 0) {
-        fprintf(stderr, "video time_base is invalid for clip[%s]\n", clip->vid_ctx->url);
+        log_error("video time_base is invalid for clip[%s]\n", clip->vid_ctx->url);
         return -1;
     }
     // rescale clip_ts to sequence time_base
@@ -530,7 +835,7 @@ int64_t audio_pkt_to_seq_ts(Sequence *seq, Clip *clip, int64_t orig_pkt_ts) {
     int64_t clip_ts = clip_ts_audio(clip, orig_pkt_ts);
     AVRational clip_tb = get_clip_audio_time_base(clip);
     if(clip_tb.num < 0 || clip_tb.den < 0) {
-        fprintf(stderr, "audio time_base is invalid for clip[%s]\n", clip->vid_ctx->url);
+        log_error("audio time_base is invalid for clip[%s]\n", clip->vid_ctx->url);
         return -1;
     }
     // rescale clip_ts into sequence time_base
@@ -541,12 +846,158 @@ int64_t audio_pkt_to_seq_ts(Sequence *seq, Clip *clip, int64_t orig_pkt_ts) {
     return audio_start_ts + seq_ts;
 }
 
+/**
+ * Set the video decoding options of every clip in a sequence and its tracks (draft or full quality).
+ * Open clips are reopened with the new options.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq          Sequence
+ * @param  lowres       decode at 1/(2^lowres) resolution where the codec supports it (0 for full)
+ * @param  fast_decode  skip the loop filter and allow non spec compliant speedups
+ * @return              >= 0 on success
+ */
+int sequence_set_decode_options(Sequence *seq, int lowres, bool fast_decode) {
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        int ret = set_clip_decode_options((Clip *) curr->data, lowres, fast_decode);
+        if(ret < 0) {
+            return ret;
+        }
+        curr = curr->next;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        int ret = sequence_set_decode_options(&(seq->tracks[i]->seq), lowres, fast_decode);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Save the video decoding options of every clip in a sequence and its tracks,
+ * to be restored with restore_sequence_decode_options()
+ * @param  seq          Sequence
+ * @param  lowres       output: lowres of every clip (allocated, to be freed by caller)
+ * @param  fast_decode  output: fast_decode of every clip (allocated, to be freed by caller)
+ * @return              >= 0 on success
+ */
+int save_sequence_decode_options(Sequence *seq, int **lowres, bool **fast_decode) {
+    int nb_clips = count_sequence_clips(seq);
+    *lowres = malloc(sizeof(int) * FFMAX(nb_clips, 1));
+    *fast_decode = malloc(sizeof(bool) * FFMAX(nb_clips, 1));
+    if(*lowres == NULL || *fast_decode == NULL) {
+        log_error("save_sequence_decode_options() error: Failed to allocate decoding options\n");
+        free(*lowres);
+        free(*fast_decode);
+        *lowres = NULL;
+        *fast_decode = NULL;
+        return AVERROR(ENOMEM);
+    }
+    get_sequence_decode_options(seq, *lowres, *fast_decode);
+    return 0;
+}
+
+/**
+ * Restore the video decoding options saved by save_sequence_decode_options()
+ * (clips must not be added or removed in between). Open clips are reopened with their options.
+ * Call sequence_seek() before reading the sequence again
+ * @param  seq          Sequence
+ * @param  lowres       lowres of every clip
+ * @param  fast_decode  fast_decode of every clip
+ * @return              >= 0 on success
+ */
+int restore_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode) {
+    int ret = set_sequence_decode_options(seq, lowres, fast_decode);
+    return ret < 0 ? ret : 0;
+}
+
+/**
+ * Clear the render stats of every clip in a sequence (and its tracks)
+ * @param seq Sequence
+ */
+void clear_sequence_render_stats(Sequence *seq) {
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        init_render_stats(&(((Clip *) curr->data)->stats));
+        curr = curr->next;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        clear_sequence_render_stats(&(seq->tracks[i]->seq));
+    }
+}
+
+/**
+ * Sum the render stats (demux, decode, preroll, seek) of every clip in a sequence (and its tracks)
+ * @param seq   Sequence
+ * @param total RenderStats to add the stats of every clip into
+ */
+void get_sequence_render_stats(Sequence *seq, RenderStats *total) {
+    Node *curr = seq->clips.head;
+    while(curr != NULL) {
+        merge_render_stats(total, &(((Clip *) curr->data)->stats));
+        curr = curr->next;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        get_sequence_render_stats(&(seq->tracks[i]->seq), total);
+    }
+}
+
+/**
+ * Stop reading the current transition (frames decoded ahead are dropped,
+ * buffers are kept for the next transition)
+ * @param st SequenceTransition
+ */
+void reset_sequence_transition(SequenceTransition *st) {
+    if(st->own_clip && st->clip != NULL) {
+        free_clip(&(st->clip));
+    }
+    st->clip = NULL;
+    st->own_clip = false;
+    st->node = NULL;
+    st->eof = false;
+    for(int i = 0; i < st->nb_frames; i++) {
+        av_frame_unref(st->frames[i]);
+    }
+    st->nb_frames = 0;
+    if(st->fifo != NULL) {
+        av_audio_fifo_reset(st->fifo);
+    }
+    st->fifo_pts = AV_NOPTS_VALUE;
+    st->video_out_pts = AV_NOPTS_VALUE;
+    st->audio_out_pts = AV_NOPTS_VALUE;
+}
+
+/**
+ * Stop reading the tracks of a sequence (frames decoded ahead are dropped). The tracks
+ * are seeked to the position of the sequence on the next sequence_read_frame()
+ * @param seq Sequence
+ */
+void reset_sequence_tracks(Sequence *seq) {
+    seq->compositor.started = false;
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        reset_sequence_track(seq->tracks[i]);
+    }
+}
+
 /**
  * Free entire sequence and all clips within
  * @param seq Sequence containing clips and clip data to be freed
  */
 void free_sequence(Sequence *seq) {
+    free_sequence_transition(&(seq->transition));
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        free_sequence_track(seq->tracks[i]);
+    }
+    free(seq->tracks);
+    seq->tracks = NULL;
+    seq->nb_tracks = 0;
+    free_sequence_compositor(&(seq->compositor));
     clearList(&(seq->clips));
+    free(seq->index);
+    seq->index = NULL;
+    seq->index_nb = 0;
+    seq->index_size = 0;
+    seq->index_dirty = true;
 }
 
 /**
@@ -597,3 +1048,201 @@ void example_sequence_read_packets(Sequence *seq, bool close_clips_flag) {
         av_packet_unref(&orig_pkt);
     }
 }
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Count the clips of a sequence and its tracks
+ * @param  seq Sequence
+ * @return     number of clips
+ */
+int count_sequence_clips(Sequence *seq) {
+    int nb_clips = getLength(seq->clips);
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        nb_clips += count_sequence_clips(&(seq->tracks[i]->seq));
+    }
+    return nb_clips;
+}
+
+/**
+ * Copy the video decoding options of every clip in a sequence and its tracks
+ * @param  seq          Sequence
+ * @param  lowres       output: lowres of every clip (count_sequence_clips() entries)
+ * @param  fast_decode  output: fast_decode of every clip (count_sequence_clips() entries)
+ * @return              number of clips copied
+ */
+int get_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode) {
+    int i = 0;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next, ++i) {
+        VideoContext *vc = ((Clip *) curr->data)->vid_ctx;
+        lowres[i] = vc->lowres;
+        fast_decode[i] = vc->fast_decode;
+    }
+    for(int t = 0; t < seq->nb_tracks; t++) {
+        i += get_sequence_decode_options(&(seq->tracks[t]->seq), lowres + i, fast_decode + i);
+    }
+    return i;
+}
+
+/**
+ * Set the video decoding options of every clip in a sequence and its tracks, one entry per clip
+ * @param  seq          Sequence
+ * @param  lowres       lowres of every clip
+ * @param  fast_decode  fast_decode of every clip
+ * @return              number of clips set, < 0 on error
+ */
+int set_sequence_decode_options(Sequence *seq, int *lowres, bool *fast_decode) {
+    int i = 0, ret;
+    for(Node *curr = seq->clips.head; curr != NULL; curr = curr->next, ++i) {
+        if((ret = set_clip_decode_options((Clip *) curr->data, lowres[i], fast_decode[i])) < 0) {
+            return ret;
+        }
+    }
+    for(int t = 0; t < seq->nb_tracks; t++) {
+        if((ret = set_sequence_decode_options(&(seq->tracks[t]->seq), lowres + i, fast_decode + i)) < 0) {
+            return ret;
+        }
+        i += ret;
+    }
+    return i;
+}
+
+/**
+ * Change the video decoding options of a clip VideoContext (reopened when it was open).
+ * Clips sharing the VideoContext are changed together
+ * @param  clip        Clip
+ * @param  lowres      decode at 1/(2^lowres) resolution
+ * @param  fast_decode non spec compliant speedups
+ * @return             >= 0 on success
+ */
+int set_clip_decode_options(Clip *clip, int lowres, bool fast_decode) {
+    VideoContext *vc = clip->vid_ctx;
+    if(vc->lowres == lowres && vc->fast_decode == fast_decode) {
+        return 0;
+    }
+    bool was_open = vc->open;
+    close_video_context(vc);
+    vc->lowres = lowres;
+    vc->fast_decode = fast_decode;
+    if(was_open) {
+        int ret = open_clip(clip);
+        if(ret < 0) {
+            log_error("set_clip_decode_options() error: Failed to reopen clip[%s]\n", vc->url);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Initialize the transition state of a sequence (does not allocate)
+ * @param st SequenceTransition
+ */
+void init_sequence_transition(SequenceTransition *st) {
+    memset(st, 0, sizeof(struct SequenceTransition));
+    st->sample_fmt = AV_SAMPLE_FMT_NONE;
+    st->fifo_pts = AV_NOPTS_VALUE;
+    st->video_out_pts = AV_NOPTS_VALUE;
+    st->audio_out_pts = AV_NOPTS_VALUE;
+}
+
+/**
+ * Free the transition state of a sequence
+ * @param st SequenceTransition
+ */
+void free_sequence_transition(SequenceTransition *st) {
+    reset_sequence_transition(st);
+    for(int i = 0; i < SEQ_TRANSITION_MAX_FRAMES; i++) {
+        av_frame_free(&(st->frames[i]));
+    }
+    if(st->fifo != NULL) {
+        av_audio_fifo_free(st->fifo);
+    }
+    av_frame_free(&(st->decoded));
+    av_frame_free(&(st->mix));
+    av_frame_free(&(st->color));
+    av_frame_free(&(st->scaled));
+    av_frame_free(&(st->samples));
+    sws_freeContext(st->sws_ctx);
+    init_sequence_transition(st);
+}
+
+/**
+ * Shift clips sequence pts starting at a node
+ * @param seq   Sequence
+ * @param node  first node to shift
+ * @param shift pts added to start_pts and end_pts of each clip
+ */
+void shift_clips_from(Sequence *seq, Node *node, int64_t shift) {
+    seq->index_dirty = true;
+    for(; node != NULL; node = node->next) {
+        Clip *clip = (Clip *) node->data;
+        clip->start_pts += shift;
+        clip->end_pts += shift;
+    }
+}
+
+/**
+ * Initialize the compositing state of a sequence (does not allocate)
+ * @param sc SequenceCompositor
+ */
+void init_sequence_compositor(SequenceCompositor *sc) {
+    memset(sc, 0, sizeof(struct SequenceCompositor));
+    sc->job_format = AV_PIX_FMT_NONE;
+    sc->swr_fmt = AV_SAMPLE_FMT_NONE;
+}
+
+/**
+ * Free the compositing state of a sequence (threads and buffers)
+ * @param sc SequenceCompositor
+ */
+void free_sequence_compositor(SequenceCompositor *sc) {
+    if(sc->pool_open) {
+        free_thread_pool(&(sc->pool));
+    }
+    free(sc->job_tracks);
+    av_frame_free(&(sc->mix));
+    av_frame_free(&(sc->base));
+    av_frame_free(&(sc->audio));
+    sws_freeContext(sc->sws_ctx);
+    swr_free(&(sc->swr_ctx));
+    init_sequence_compositor(sc);
+}
+
+/**
+ * Stop reading a track (frames decoded ahead are dropped, buffers are kept)
+ * @param track SequenceTrack
+ */
+void reset_sequence_track(SequenceTrack *track) {
+    track->eof = false;
+    for(int i = 0; i < track->nb_frames; i++) {
+        av_frame_unref(track->frames[i]);
+    }
+    track->nb_frames = 0;
+    for(int i = 0; i < track->nb_audio_frames; i++) {
+        av_frame_free(&(track->audio_frames[i]));
+    }
+    track->nb_audio_frames = 0;
+    track->read_pts = AV_NOPTS_VALUE;
+    track->layer_ready = false;
+    track->layer_pts = AV_NOPTS_VALUE;
+    // samples delayed within the resampler belong to the old position
+    swr_free(&(track->swr_ctx));
+    track->swr_fmt = AV_SAMPLE_FMT_NONE;
+}
+
+/**
+ * Free a track, its clips and buffers
+ * @param track SequenceTrack allocated on heap
+ */
+void free_sequence_track(SequenceTrack *track) {
+    reset_sequence_track(track);
+    for(int i = 0; i < SEQ_TRACK_MAX_FRAMES; i++) {
+        av_frame_free(&(track->frames[i]));
+    }
+    free(track->audio_frames);
+    av_frame_free(&(track->decoded));
+    av_frame_free(&(track->layer));
+    sws_freeContext(track->sws_ctx);
+    free_sequence(&(track->seq));
+    free(track);
+}
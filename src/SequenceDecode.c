@@ -10,73 +10,91 @@
 #include "SequenceDecode.h"
 
 /**
- * Read decoded frames from our editing sequence
+ * Read decoded frames from our editing sequence.
+ * Where a clip has a transition (see sequence_add_transition()), both clips of the overlap
+ * are decoded together and their frames are mixed (sequence_read_packet() only cuts).
+ * The tracks of the sequence (see sequence_add_track()) are decoded along with the clips:
+ * their video is layered over each video frame and their audio summed into each audio frame
  * @param  seq              Sequence with clips to be read
  * @param  frame            decoded output frame
  * @param  frame_type       type of output frame
- * @param  close_clips_flag if true, close clips after read
- * @return                  >= 0 on success (returned a frame)
- *                          < 0 when reached end of sequence or error
+ * @param  close_clips_flag if true, close clips after read (clips of tracks are always closed)
+ * @return                  >= 0 on success (returned a frame),
+ *                          AVERROR_EOF when reached end of sequence, other < 0 on error
  */
 int sequence_read_frame(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool close_clips_flag) {
-    Node *currNode = seq->clips_iter.current;
-    if(currNode == NULL) {
-        printf("sequence_read_frame() currNode == NULL\n");
+    int ret = read_sequence_clips_frame(seq, frame, frame_type, close_clips_flag, true);
+    if(ret < 0 || seq->nb_tracks == 0) {
+        return ret;
+    }
+    return composite_sequence_tracks(seq, frame, *frame_type);
+}
+
+/**
+ * Get a video frame of the sequence by index, in any order. Stateless: the clip is found
+ * through the clip index, and the iterator of sequence_read_frame() is not moved (clips
+ * reading a VideoContext used here seek again on their next read). The decoder keeps going
+ * forward when the frame is just ahead of its last position, and only seeks when that is cheaper
+ * @param  seq         Sequence
+ * @param  fc          FrameCache consulted before decoding (NULL to decode without caching)
+ * @param  frame_index index of frame in sequence
+ * @param  frame       output frame with sequence pts (its data may be shared with the
+ *                     cache: do not write into it)
+ * @return             >= 0 on success
+ */
+int sequence_get_frame(Sequence *seq, FrameCache *fc, int frame_index, AVFrame *frame) {
+    int64_t clip_pts;
+    Node *node = find_clip_node_at_index(seq, frame_index, &clip_pts);
+    if(node == NULL || clip_pts < 0) {
+        log_error("sequence_get_frame() error: No clip at sequence frame[%d]\n", frame_index);
         return -1;
     }
-    Clip *curr_clip = (Clip *) currNode->data;    // current clip
-    int ret;
-    // If VideoContext was used by another clip, and is now out of bounds of current clip. Reset seek
-    if(is_vc_out_bounds(curr_clip)) {
-        ret = seek_clip_pts(curr_clip, 0);
-        if(ret < 0) {
+    Clip *clip = (Clip *) node->data;
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    // without a cache, frames are still decoded forward from the last request
+    FrameCache no_cache;
+    bool own_cache = (fc == NULL);
+    if(own_cache) {
+        if((ret = init_frame_cache(&no_cache, 0, 0)) < 0) {
             return ret;
         }
+        fc = &no_cache;
+    }
+    ret = get_cached_video_frame(fc, clip->vid_ctx, clip->orig_start_pts + clip_pts, frame);
+    if(own_cache) {
+        free_frame_cache(&no_cache);
     }
-    ret = clip_read_frame(curr_clip, frame, frame_type);
-    // End of clip!
     if(ret < 0) {
-        printf("End of clip[%s]\n", curr_clip->vid_ctx->url);
-        if(close_clips_flag) {
-            close_clip(curr_clip);
-        }
-        // move iterator to next element
-        nextElement(&(seq->clips_iter));
-        void *next = seq->clips_iter.current;       // get next clip Node
-        if(next == NULL) {
-            // We're done reading all clips! (reset to start)
-            printf("We're done reading all clips! (reset to start)\n");
-            if(seq->clips.head != NULL) {
-                open_clip((Clip *)(seq->clips.head->data));
-            }
-            ret = sequence_seek(seq, 0);
-            if(ret < 0) {
-                fprintf(stderr, "sequence_read_frame() error: Failed to seek to the start of sequence\n");
-                return ret;
-            }
-            return -1;
-        } else {
-            // move onto next clip
-            Clip *next_clip = (Clip *) ((Node *)next)->data;
-            open_clip(next_clip);
-            return sequence_read_frame(seq, frame, frame_type, close_clips_flag);
-        }
-    } else {
-        clear_frame_decoding_garbage(frame);
-        // Convert original packet timestamps into sequence timestamps
-        if(*frame_type == AVMEDIA_TYPE_VIDEO) {
-            // set first frame to be an I frame
-            if(curr_clip->frame_index == 1) {
-                frame->key_frame = 1;
-                frame->pict_type = AV_PICTURE_TYPE_I;
-            }
-            frame->pts = video_pkt_to_seq_ts(seq, curr_clip, frame->pts);
-            // frame->pkt_dts = video_pkt_to_seq_ts(seq, curr_clip, frame->pkt_dts);
-        } else if(*frame_type == AVMEDIA_TYPE_AUDIO) {
-            frame->pts = audio_pkt_to_seq_ts(seq, curr_clip, frame->pts);
-            // frame->pkt_dts = audio_pkt_to_seq_ts(seq, curr_clip, frame->pkt_dts);
+        log_error("sequence_get_frame() error: Failed to get sequence frame[%d]\n", frame_index);
+        return ret;
+    }
+    frame->pts = seq_frame_index_to_pts(seq, frame_index);
+    return 0;
+}
+
+/**
+ * Convert a decoded clip frame into a sequence frame
+ * (sequence timestamps, and an I frame at the start of each clip)
+ * @param seq   Sequence containing clip
+ * @param clip  Clip that decoded the frame
+ * @param frame decoded frame from clip_read_frame()
+ * @param type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ */
+void seq_frame_to_seq_ts(Sequence *seq, Clip *clip, AVFrame *frame, enum AVMediaType type) {
+    clear_frame_decoding_garbage(frame);
+    // Convert original packet timestamps into sequence timestamps
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        // set first frame to be an I frame
+        if(clip->frame_index == 1) {
+            frame->key_frame = 1;
+            frame->pict_type = AV_PICTURE_TYPE_I;
         }
-        return 0;
+        frame->pts = video_pkt_to_seq_ts(seq, clip, frame->pts);
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        frame->pts = audio_pkt_to_seq_ts(seq, clip, frame->pts);
     }
 }
 
@@ -110,7 +128,7 @@ void clear_frame_decoding_garbage(AVFrame *f) {
      enum AVMediaType type;
      AVFrame *frame = av_frame_alloc();
      if(!frame) {
-         fprintf(stderr, "Could not allocate frame\n");
+         log_error("Could not allocate frame\n");
          return AVERROR(ENOMEM);
      }
      while(sequence_read_frame(seq, frame, &type, close_clips_flag) >= 0) {
@@ -129,4 +147,1356 @@ void clear_frame_decoding_garbage(AVFrame *f) {
      }
      av_frame_free(&frame);
      return 0;
- }
\ No newline at end of file
+ }
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Read the next frame of the clips of a sequence (sequence_read_frame() without the tracks)
+ * @param  seq              Sequence with clips to be read
+ * @param  frame            decoded output frame
+ * @param  frame_type       type of output frame
+ * @param  close_clips_flag if true, close clips after read
+ * @param  seek_start       if true, seek back to the first clip at the end of the sequence
+ *                          (tracks are seeked when they start again instead)
+ * @return                  >= 0 on success (returned a frame),
+ *                          AVERROR_EOF when reached end of sequence, other < 0 on error
+ */
+int read_sequence_clips_frame(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool close_clips_flag,
+                                bool seek_start) {
+    Node *currNode;
+    int ret;
+    // iterate clips until one returns a frame (or we run out of clips)
+    while((currNode = seq->clips_iter.current) != NULL) {
+        Clip *curr_clip = (Clip *) currNode->data;    // current clip
+        bool clip_done = false;
+        // frames of this clip decoded ahead by the transition into it go first
+        if(seq->transition.node == currNode) {
+            ret = read_transition_leftover(seq, frame, frame_type, &clip_done);
+            if(ret != AVERROR_EOF) {
+                return ret;
+            }
+        }
+        if(!clip_done) {
+            // If VideoContext was used by another clip, and is now out of bounds of current clip.
+            // Read on from the end of the last clip of this file when cheaper, otherwise seek
+            if(is_vc_out_bounds(curr_clip)) {
+                ret = resume_clip_read(curr_clip);
+                if(ret < 0) {
+                    return ret;
+                }
+            }
+            ret = clip_read_frame(curr_clip, frame, frame_type);
+            if(ret >= 0) {
+                seq_frame_to_seq_ts(seq, curr_clip, frame, *frame_type);
+                // frames within the transition into the next clip are mixed with it
+                return mix_transition_frame(seq, currNode, frame, *frame_type);
+            }
+        }
+        // End of clip!
+        log_debug("End of clip[%s]\n", curr_clip->vid_ctx->url);
+        // move iterator to next element
+        nextElement(&(seq->clips_iter));
+        Node *next = seq->clips_iter.current;       // get next clip Node
+        // a file also read by the next clip stays open (it may read on without seeking)
+        if(close_clips_flag && (next == NULL || ((Clip *) next->data)->vid_ctx != curr_clip->vid_ctx)) {
+            close_clip(curr_clip);
+        }
+        if(next == NULL) {
+            // We're done reading all clips! (reset to start)
+            log_debug("We're done reading all clips! (reset to start)\n");
+            if(!seek_start) {
+                return AVERROR_EOF;
+            }
+            Clip *first = (Clip *) seq->clips.head->data;
+            open_clip(first);
+            // the first clip of a track can start after 0
+            ret = sequence_seek(seq, seq_pts_to_frame_index(seq, first->start_pts));
+            if(ret < 0) {
+                log_error("read_sequence_clips_frame() error: Failed to seek to the start of sequence\n");
+                return ret;
+            }
+            return AVERROR_EOF;
+        }
+        // move onto next clip
+        open_clip((Clip *) next->data);
+        ret = end_sequence_transition(seq, next);
+        if(ret < 0) {
+            return ret;
+        }
+    }
+    log_warning("read_sequence_clips_frame() currNode == NULL\n");
+    return -1;
+}
+
+/**
+ * Mix a frame of the outgoing clip of a transition with the incoming clip
+ * (frames outside of a transition are left untouched)
+ * @param  seq   Sequence
+ * @param  node  list node of the clip that decoded the frame
+ * @param  frame frame with sequence pts (replaced by the mixed frame)
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int mix_transition_frame(Sequence *seq, Node *node, AVFrame *frame, enum AVMediaType type) {
+    int64_t start, end, pts;
+    if(node->next == NULL || !get_clip_transition_pts(node->next, &start, &end)) {
+        return 0;
+    }
+    // position of the frame in sequence video time base
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        pts = frame->pts;
+        if(pts < start) {
+            return 0;
+        }
+    } else if(type == AVMEDIA_TYPE_AUDIO && frame->sample_rate > 0) {
+        int64_t frame_end = frame->pts + av_rescale_q(frame->nb_samples, (AVRational){1, frame->sample_rate},
+                                                        seq->audio_time_base);
+        if(frame_end <= av_rescale_q(start, seq->video_time_base, seq->audio_time_base)) {
+            return 0;
+        }
+        pts = FFMAX(av_rescale_q(frame->pts, seq->audio_time_base, seq->video_time_base), start);
+    } else {
+        return 0;
+    }
+    int ret;
+    if(seq->transition.node != node->next && (ret = start_sequence_transition(seq, node->next, pts)) < 0) {
+        return ret;
+    }
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        return mix_transition_video(seq, frame);
+    }
+    return mix_transition_audio_frame(seq, frame);
+}
+
+/**
+ * Start reading a transition: the incoming clip is seeked to a position of the overlap.
+ * When both clips read the same file, the incoming side reads a copy of the clip
+ * through a clone of the file (see clone_video_context())
+ * @param  seq  Sequence
+ * @param  node list node of the incoming clip
+ * @param  pts  position to start from (sequence video pts)
+ * @return      >= 0 on success
+ */
+int start_sequence_transition(Sequence *seq, Node *node, int64_t pts) {
+    SequenceTransition *st = &(seq->transition);
+    reset_sequence_transition(st);
+    Clip *clip = (Clip *) node->data;
+    Clip *prev = (Clip *) node->previous->data;
+    get_clip_transition_pts(node, &(st->start_pts), &(st->end_pts));
+    st->audio_start_pts = av_rescale_q(st->start_pts, seq->video_time_base, seq->audio_time_base);
+    st->audio_end_pts = av_rescale_q(st->end_pts, seq->video_time_base, seq->audio_time_base);
+    if(st->decoded == NULL && (st->decoded = av_frame_alloc()) == NULL) {
+        log_error("start_sequence_transition() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    // the dip color is filled again for this transition
+    if(st->color != NULL) {
+        av_frame_unref(st->color);
+    }
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    if(clip->vid_ctx == prev->vid_ctx) {
+        // one VideoContext cannot read two positions at once
+        Clip *copy = alloc_clip_internal();
+        if(copy == NULL) {
+            log_error("start_sequence_transition() error: Failed to allocate clip\n");
+            return AVERROR(ENOMEM);
+        }
+        if((ret = clone_video_context(clip->vid_ctx, &(copy->vid_ctx))) < 0) {
+            log_error("start_sequence_transition() error: Failed to clone [%s]\n", clip->vid_ctx->url);
+            free(copy);
+            return ret;
+        }
+        copy->orig_start_pts = clip->orig_start_pts;
+        copy->orig_end_pts = clip->orig_end_pts;
+        copy->start_pts = clip->start_pts;
+        copy->end_pts = clip->end_pts;
+        st->clip = copy;
+        st->own_clip = true;
+    } else {
+        st->clip = clip;
+    }
+    st->node = node;
+    int64_t offset = av_rescale_q(FFMAX(pts - clip->start_pts, 0), seq->video_time_base,
+                                    get_clip_video_time_base(clip));
+    if((ret = seek_clip_pts(st->clip, offset)) < 0) {
+        log_error("start_sequence_transition() error: Failed to seek incoming clip[%s]\n", clip->vid_ctx->url);
+        reset_sequence_transition(st);
+    }
+    return ret;
+}
+
+/**
+ * Finish the transition into the next clip, once the outgoing clip is done.
+ * The incoming clip continues from where the transition decoded it (a copy reading through
+ * a clone is dropped, and the clip itself seeks to the end of the overlap)
+ * @param  seq  Sequence
+ * @param  next list node of the clip read next
+ * @return      >= 0 on success
+ */
+int end_sequence_transition(Sequence *seq, Node *next) {
+    SequenceTransition *st = &(seq->transition);
+    if(st->node == NULL) {
+        return 0;
+    } else if(st->node != next) {
+        reset_sequence_transition(st);
+        return 0;
+    }
+    if(st->own_clip) {
+        Clip *clip = (Clip *) next->data;
+        int64_t offset = av_rescale_q(st->end_pts - clip->start_pts, seq->video_time_base,
+                                        get_clip_video_time_base(clip));
+        reset_sequence_transition(st);
+        return seek_clip_pts(clip, offset);
+    }
+    // incoming frames at or before the last frames output were shown (or passed over) already
+    while(st->nb_frames > 0 && st->video_out_pts != AV_NOPTS_VALUE && st->frames[0]->pts <= st->video_out_pts) {
+        pop_transition_frame(st);
+    }
+    if(st->audio_out_pts != AV_NOPTS_VALUE) {
+        drop_transition_samples(seq, st->audio_out_pts);
+    }
+    return 0;
+}
+
+/**
+ * Get the next frame of the incoming clip decoded ahead by a transition and not output yet
+ * @param  seq        Sequence
+ * @param  frame      output frame
+ * @param  frame_type output type of frame
+ * @param  clip_done  set to true when the incoming clip was read to the end
+ * @return            0 when a frame was output, AVERROR_EOF when there are none left
+ *                    (the transition is then reset), other < 0 on error
+ */
+int read_transition_leftover(Sequence *seq, AVFrame *frame, enum AVMediaType *frame_type, bool *clip_done) {
+    SequenceTransition *st = &(seq->transition);
+    if(st->nb_frames > 0) {
+        av_frame_unref(frame);
+        av_frame_move_ref(frame, st->frames[0]);
+        pop_transition_frame(st);
+        *frame_type = AVMEDIA_TYPE_VIDEO;
+        return 0;
+    }
+    int size = st->fifo != NULL ? av_audio_fifo_size(st->fifo) : 0;
+    if(size > 0) {
+        av_frame_unref(frame);
+        frame->format = st->sample_fmt;
+        frame->channels = st->channels;
+        frame->channel_layout = st->channel_layout;
+        frame->sample_rate = st->sample_rate;
+        frame->nb_samples = size;
+        int ret = av_frame_get_buffer(frame, 0);
+        if(ret < 0) {
+            log_error("read_transition_leftover() error: Failed to allocate audio frame\n");
+            return ret;
+        }
+        if(av_audio_fifo_read(st->fifo, (void **) frame->extended_data, size) < size) {
+            log_error("read_transition_leftover() error: Failed to read samples\n");
+            return -1;
+        }
+        frame->pts = st->fifo_pts;
+        *frame_type = AVMEDIA_TYPE_AUDIO;
+        return 0;
+    }
+    *clip_done = st->eof;
+    reset_sequence_transition(st);
+    return AVERROR_EOF;
+}
+
+/**
+ * Decode the next frame of the incoming clip of a transition. Video frames are queued
+ * and audio samples are written into the transition fifo
+ * @param  seq Sequence
+ * @return     >= 0 on success, AVERROR_EOF when the incoming clip has no more frames
+ */
+int read_transition_frame(Sequence *seq) {
+    SequenceTransition *st = &(seq->transition);
+    enum AVMediaType type;
+    if(clip_read_frame(st->clip, st->decoded, &type) < 0) {
+        st->eof = true;
+        return AVERROR_EOF;
+    }
+    seq_frame_to_seq_ts(seq, st->clip, st->decoded, type);
+    int ret = 0;
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        if(st->nb_frames == SEQ_TRANSITION_MAX_FRAMES) {
+            log_warning("read_transition_frame(): too many incoming frames ahead, dropping the oldest\n");
+            pop_transition_frame(st);
+        }
+        AVFrame **slot = &(st->frames[st->nb_frames]);
+        if(*slot == NULL && (*slot = av_frame_alloc()) == NULL) {
+            log_error("read_transition_frame() error: Failed to allocate frame\n");
+            av_frame_unref(st->decoded);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_move_ref(*slot, st->decoded);
+        ++(st->nb_frames);
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        ret = write_transition_audio(seq, st->decoded);
+    }
+    av_frame_unref(st->decoded);
+    return ret;
+}
+
+/**
+ * Blend a video frame of the outgoing clip with the incoming frame shown at the same time
+ * @param  seq   Sequence
+ * @param  frame outgoing frame with sequence pts (replaced by the blended frame)
+ * @return       >= 0 on success
+ */
+int mix_transition_video(Sequence *seq, AVFrame *frame) {
+    SequenceTransition *st = &(seq->transition);
+    int64_t pts = frame->pts;
+    int ret;
+    // decode the incoming clip up to this pts, keeping the last frame at or before it
+    while(true) {
+        while(st->nb_frames >= 2 && st->frames[1]->pts <= pts) {
+            pop_transition_frame(st);
+        }
+        if(st->eof || (st->nb_frames > 0 && st->frames[st->nb_frames - 1]->pts >= pts)) {
+            break;
+        }
+        if((ret = read_transition_frame(seq)) < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+    }
+    st->video_out_pts = pts;
+    if(st->nb_frames == 0) {
+        // no incoming frame to mix with
+        return 0;
+    }
+    Transition *tr = &(((Clip *) st->node->data)->transition);
+    AVFrame *b = st->frames[0];
+    double t = (double) (pts - st->start_pts) / (st->end_pts - st->start_pts);
+    if(b->width != frame->width || b->height != frame->height || b->format != frame->format) {
+        if((ret = scale_transition_frame(st, b, frame)) < 0) {
+            return ret;
+        }
+        b = st->scaled;
+    }
+    if(!transition_pix_fmt_supported(frame->format)) {
+        // cannot be blended: cut in the middle of the transition
+        if(t >= 0.5) {
+            av_frame_unref(frame);
+            if((ret = av_frame_ref(frame, b)) < 0) {
+                return ret;
+            }
+            frame->pts = pts;
+        }
+        return 0;
+    }
+    // the color frame is filled once per transition (and format)
+    if(tr->type == TRANSITION_DIP_TO_COLOR && (ret = get_transition_buffer(&(st->color), frame)) != 0) {
+        if(ret < 0) {
+            return ret;
+        }
+        st->color->color_range = frame->color_range;
+        st->color->colorspace = frame->colorspace;
+        if((ret = fill_video_frame_color(st->color, tr->color)) < 0) {
+            return ret;
+        }
+    }
+    if((ret = get_transition_buffer(&(st->mix), frame)) < 0) {
+        return ret;
+    }
+    blend_transition_frame(tr, st->mix, frame, b, st->color, t);
+    if((ret = av_frame_copy_props(st->mix, frame)) < 0) {
+        return ret;
+    }
+    av_frame_unref(frame);
+    return av_frame_ref(frame, st->mix);
+}
+
+/**
+ * Mix an audio frame of the outgoing clip with the incoming samples at the same time
+ * (planar float at the same sample rate and channels only: otherwise the outgoing audio
+ * is kept until the end of the transition)
+ * @param  seq   Sequence
+ * @param  frame outgoing frame with sequence pts (mixed in place)
+ * @return       >= 0 on success
+ */
+int mix_transition_audio_frame(Sequence *seq, AVFrame *frame) {
+    SequenceTransition *st = &(seq->transition);
+    AVRational sample_tb = (AVRational){1, frame->sample_rate};
+    int n = frame->nb_samples;
+    int64_t end = frame->pts + av_rescale_q(n, sample_tb, seq->audio_time_base);
+    int ret;
+    // decode the incoming clip until its samples cover this frame
+    // (bounded by the video frames queued, for clips without audio)
+    while(!st->eof && st->nb_frames < SEQ_TRANSITION_MAX_FRAMES &&
+            (st->fifo == NULL || av_audio_fifo_size(st->fifo) == 0 ||
+            st->fifo_pts + av_rescale_q(av_audio_fifo_size(st->fifo), (AVRational){1, st->sample_rate},
+                                        seq->audio_time_base) < end)) {
+        if((ret = read_transition_frame(seq)) < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+    }
+    drop_transition_samples(seq, frame->pts);
+    st->audio_out_pts = end;
+    if(frame->format != AV_SAMPLE_FMT_FLTP || st->fifo == NULL || st->sample_fmt != AV_SAMPLE_FMT_FLTP ||
+        st->sample_rate != frame->sample_rate || st->channels != frame->channels) {
+        // cannot be mixed: the incoming audio starts after this frame
+        return 0;
+    }
+    // incoming samples, starting at offset when the incoming audio starts within this frame
+    int size = av_audio_fifo_size(st->fifo);
+    int offset = 0;
+    if(size > 0 && st->fifo_pts > frame->pts) {
+        offset = FFMIN(av_rescale_q(st->fifo_pts - frame->pts, seq->audio_time_base, sample_tb), n);
+    }
+    int nb = FFMIN(n - offset, size);
+    AVFrame *s = st->samples;
+    if(s == NULL || s->nb_samples != n || s->channels != frame->channels) {
+        if(s == NULL && (s = st->samples = av_frame_alloc()) == NULL) {
+            return AVERROR(ENOMEM);
+        }
+        av_frame_unref(s);
+        s->format = AV_SAMPLE_FMT_FLTP;
+        s->channels = frame->channels;
+        s->channel_layout = frame->channel_layout;
+        s->nb_samples = n;
+        if((ret = av_frame_get_buffer(s, 0)) < 0) {
+            log_error("mix_transition_audio_frame() error: Failed to allocate samples\n");
+            return ret;
+        }
+    }
+    av_samples_set_silence(s->extended_data, 0, n, s->channels, AV_SAMPLE_FMT_FLTP);
+    if(nb > 0) {
+        if(av_audio_fifo_read(st->fifo, (void **) s->extended_data, nb) < nb) {
+            log_error("mix_transition_audio_frame() error: Failed to read samples\n");
+            return -1;
+        }
+        st->fifo_pts += av_rescale_q(nb, sample_tb, seq->audio_time_base);
+        if(offset > 0) {
+            for(int c = 0; c < s->channels; c++) {
+                float *d = (float *) s->extended_data[c];
+                memmove(d + offset, d, nb * sizeof(float));
+                memset(d, 0, offset * sizeof(float));
+            }
+        }
+    }
+    if((ret = av_frame_make_writable(frame)) < 0) {
+        return ret;
+    }
+    double duration = st->audio_end_pts - st->audio_start_pts;
+    double t0 = (frame->pts - st->audio_start_pts) / duration;
+    double dt = av_q2d(av_div_q(sample_tb, seq->audio_time_base)) / duration;
+    mix_transition_audio(&(((Clip *) st->node->data)->transition), frame, s, t0, dt);
+    return 0;
+}
+
+/**
+ * Write decoded samples of the incoming clip into the transition fifo
+ * @param  seq   Sequence
+ * @param  frame audio frame with sequence pts
+ * @return       >= 0 on success
+ */
+int write_transition_audio(Sequence *seq, AVFrame *frame) {
+    SequenceTransition *st = &(seq->transition);
+    bool same_format = st->fifo != NULL && frame->format == st->sample_fmt &&
+                        frame->sample_rate == st->sample_rate && frame->channels == st->channels;
+    if(!same_format) {
+        if(st->fifo != NULL && av_audio_fifo_size(st->fifo) > 0) {
+            log_warning("write_transition_audio(): incoming audio format changed, dropping frame\n");
+            return 0;
+        }
+        if(st->fifo != NULL) {
+            av_audio_fifo_free(st->fifo);
+        }
+        st->fifo = av_audio_fifo_alloc(frame->format, frame->channels, frame->nb_samples);
+        if(st->fifo == NULL) {
+            log_error("write_transition_audio() error: Failed to allocate fifo\n");
+            return AVERROR(ENOMEM);
+        }
+        st->sample_fmt = frame->format;
+        st->sample_rate = frame->sample_rate;
+        st->channels = frame->channels;
+        st->channel_layout = frame->channel_layout;
+    }
+    if(av_audio_fifo_size(st->fifo) == 0) {
+        st->fifo_pts = frame->pts;
+    }
+    if(av_audio_fifo_write(st->fifo, (void **) frame->extended_data, frame->nb_samples) < frame->nb_samples) {
+        log_error("write_transition_audio() error: Failed to write samples\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Drop the samples of the transition fifo before a pts
+ * @param seq Sequence
+ * @param pts sequence audio pts
+ */
+void drop_transition_samples(Sequence *seq, int64_t pts) {
+    SequenceTransition *st = &(seq->transition);
+    if(st->fifo == NULL || av_audio_fifo_size(st->fifo) == 0 || st->fifo_pts >= pts) {
+        return;
+    }
+    AVRational sample_tb = (AVRational){1, st->sample_rate};
+    int nb = FFMIN(av_rescale_q(pts - st->fifo_pts, seq->audio_time_base, sample_tb), av_audio_fifo_size(st->fifo));
+    av_audio_fifo_drain(st->fifo, nb);
+    st->fifo_pts += av_rescale_q(nb, sample_tb, seq->audio_time_base);
+}
+
+/**
+ * Drop the oldest queued video frame of the incoming clip
+ * @param st SequenceTransition
+ */
+void pop_transition_frame(SequenceTransition *st) {
+    if(st->nb_frames <= 0) {
+        return;
+    }
+    AVFrame *f = st->frames[0];
+    av_frame_unref(f);
+    memmove(st->frames, st->frames + 1, (st->nb_frames - 1) * sizeof(AVFrame *));
+    st->frames[--(st->nb_frames)] = f;
+}
+
+/**
+ * Make sure a frame has a writable buffer of the same format and size as another frame
+ * @param  frame frame to allocate (allocated itself when NULL)
+ * @param  like  frame with the format and size wanted
+ * @return       0 when the buffer was kept, 1 when a new buffer was allocated, < 0 on error
+ */
+int get_transition_buffer(AVFrame **frame, const AVFrame *like) {
+    if(*frame == NULL && (*frame = av_frame_alloc()) == NULL) {
+        log_error("get_transition_buffer() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    AVFrame *f = *frame;
+    if(f->buf[0] != NULL && av_frame_is_writable(f) && f->width == like->width &&
+        f->height == like->height && f->format == like->format) {
+        return 0;
+    }
+    // still referenced by the encoder (or there is none yet): get a new one
+    av_frame_unref(f);
+    f->width = like->width;
+    f->height = like->height;
+    f->format = like->format;
+    int ret = av_frame_get_buffer(f, 32);
+    if(ret < 0) {
+        log_error("get_transition_buffer() error: Failed to allocate frame buffer (%s)\n", av_err2str(ret));
+        return ret;
+    }
+    return 1;
+}
+
+/**
+ * Scale an incoming frame into the format and size of the outgoing frame (into st->scaled)
+ * @param  st   SequenceTransition
+ * @param  src  incoming frame
+ * @param  like outgoing frame
+ * @return      >= 0 on success
+ */
+int scale_transition_frame(SequenceTransition *st, const AVFrame *src, const AVFrame *like) {
+    st->sws_ctx = sws_getCachedContext(st->sws_ctx, src->width, src->height, src->format,
+                                        like->width, like->height, like->format,
+                                        SWS_BICUBIC, NULL, NULL, NULL);
+    if(st->sws_ctx == NULL) {
+        log_error("scale_transition_frame() error: Failed to get SwsContext\n");
+        return -1;
+    }
+    int ret = get_transition_buffer(&(st->scaled), like);
+    if(ret < 0) {
+        return ret;
+    }
+    sws_scale(st->sws_ctx, (const uint8_t * const *) src->data, src->linesize, 0, src->height,
+                st->scaled->data, st->scaled->linesize);
+    st->scaled->pts = src->pts;
+    return 0;
+}
+
+/**
+ * Layer the tracks of a sequence over a frame of its clips (video),
+ * or sum them into it (audio). Tracks are seeked to the frame on the first call
+ * @param  seq   Sequence with tracks
+ * @param  frame frame of the clips with sequence pts (replaced by the composited frame)
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int composite_sequence_tracks(Sequence *seq, AVFrame *frame, enum AVMediaType type) {
+    int ret;
+    if(!seq->compositor.started && (ret = start_sequence_tracks(seq, frame, type)) < 0) {
+        return ret;
+    }
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        return composite_tracks_video(seq, frame);
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        return mix_tracks_audio(seq, frame);
+    }
+    return 0;
+}
+
+/**
+ * Start reading the tracks of a sequence from the position of a frame: every track is
+ * seeked (in parallel), and the audio mix format is set from the clip being read
+ * @param  seq   Sequence with tracks
+ * @param  frame first frame read from the clips since the last seek
+ * @param  type  type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+ * @return       >= 0 on success
+ */
+int start_sequence_tracks(Sequence *seq, AVFrame *frame, enum AVMediaType type) {
+    SequenceCompositor *sc = &(seq->compositor);
+    int ret;
+    if(!sc->pool_open) {
+        if((ret = init_thread_pool(&(sc->pool), 0)) < 0) {
+            log_error("start_sequence_tracks() error: Failed to start threads\n");
+            return ret;
+        }
+        sc->pool_open = true;
+    }
+    // tracks start from the video frame shown at this frame
+    int64_t pts = frame->pts;
+    if(type == AVMEDIA_TYPE_AUDIO) {
+        pts = av_rescale_q(frame->pts, seq->audio_time_base, seq->video_time_base);
+    }
+    sc->job_pts = seq_frame_index_to_pts(seq, seq_pts_to_frame_index(seq, FFMAX(pts, 0)));
+    // audio of the tracks is mixed with the channels of the clip (stereo without audio)
+    Clip *clip = get_current_clip(seq);
+    AVCodecContext *audio_ctx = clip != NULL ? clip->vid_ctx->audio_codec_ctx : NULL;
+    if(type == AVMEDIA_TYPE_AUDIO) {
+        sc->channel_layout = frame->channel_layout != 0 ? frame->channel_layout :
+                                av_get_default_channel_layout(frame->channels);
+    } else if(audio_ctx != NULL) {
+        sc->channel_layout = audio_ctx->channel_layout != 0 ? audio_ctx->channel_layout :
+                                av_get_default_channel_layout(audio_ctx->channels);
+    } else {
+        sc->channel_layout = AV_CH_LAYOUT_STEREO;
+    }
+    sc->channels = av_get_channel_layout_nb_channels(sc->channel_layout);
+    if(audio_ctx != NULL && audio_ctx->sample_rate != seq->audio_time_base.den) {
+        log_warning("start_sequence_tracks(): clip[%s] sample rate %d is not the sequence rate %d, "
+                    "tracks are not mixed into its audio\n", clip->vid_ctx->url, audio_ctx->sample_rate,
+                    seq->audio_time_base.den);
+    }
+    // one VideoContext cannot be read at two positions (or by two threads)
+    if((ret = isolate_track_video_contexts(seq)) < 0) {
+        return ret;
+    }
+    set_job_tracks(seq, AVMEDIA_TYPE_UNKNOWN);
+    if((ret = run_track_jobs(seq, seek_track_job)) < 0) {
+        log_error("start_sequence_tracks() error: Failed to seek tracks\n");
+        return ret;
+    }
+    set_track_audio_mixing(seq, type == AVMEDIA_TYPE_AUDIO ? frame->sample_rate == seq->audio_time_base.den :
+                                    audio_ctx != NULL && audio_ctx->sample_rate == seq->audio_time_base.den);
+    sc->started = true;
+    return 0;
+}
+
+/**
+ * Set if the audio of the tracks is mixed into the clip of the sequence being read.
+ * When it is not, the audio queued by the tracks is dropped and no more is queued
+ * @param seq       Sequence with tracks
+ * @param mix_audio the clip has audio at the sequence sample rate
+ */
+void set_track_audio_mixing(Sequence *seq, bool mix_audio) {
+    seq->compositor.mix_audio = mix_audio;
+    if(mix_audio) {
+        return;
+    }
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        while(seq->tracks[i]->nb_audio_frames > 0) {
+            pop_track_audio(seq->tracks[i]);
+        }
+    }
+}
+
+/**
+ * Give the clips of a track their own clone of every VideoContext also read by the clips
+ * of the sequence or of a track below it (see clone_video_context()), so each track reads
+ * its files at its own position, from its own thread. Clips of one track share the clone
+ * (a sequence reads its clips one after the other). The clips keep the clone until freed
+ * @param  seq Sequence with tracks
+ * @return     >= 0 on success
+ */
+int isolate_track_video_contexts(Sequence *seq) {
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        Sequence *ts = &(seq->tracks[i]->seq);
+        for(Node *node = ts->clips.head; node != NULL; node = node->next) {
+            Clip *clip = (Clip *) node->data;
+            if(video_context_read_below(seq, i, clip->vid_ctx)) {
+                int ret = clone_track_video_context(ts, clip);
+                if(ret < 0) {
+                    return ret;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Check if a VideoContext is read by a clip of a sequence or of its tracks below a track
+ * @param  seq       Sequence with tracks
+ * @param  track_idx index of the track
+ * @param  vc        VideoContext
+ * @return           true when the VideoContext is read below the track
+ */
+bool video_context_read_below(Sequence *seq, int track_idx, VideoContext *vc) {
+    for(int i = -1; i < track_idx; i++) {
+        Sequence *s = i < 0 ? seq : &(seq->tracks[i]->seq);
+        for(Node *node = s->clips.head; node != NULL; node = node->next) {
+            if(((Clip *) node->data)->vid_ctx == vc) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Switch every clip of a track reading the VideoContext of a clip onto one clone of it
+ * @param  ts   Sequence of the track
+ * @param  clip Clip of the track
+ * @return      >= 0 on success
+ */
+int clone_track_video_context(Sequence *ts, Clip *clip) {
+    VideoContext *vc = clip->vid_ctx;
+    // a VideoContext is cloned from its open format and decoders
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    VideoContext *clone;
+    if((ret = clone_video_context(vc, &clone)) < 0) {
+        log_error("clone_track_video_context() error: Failed to clone [%s]\n", vc->url);
+        return ret;
+    }
+    for(Node *node = ts->clips.head; node != NULL; node = node->next) {
+        Clip *c = (Clip *) node->data;
+        if(c->vid_ctx == vc) {
+            c->vid_ctx = clone;
+            ++(clone->clip_count);
+            // still read by the clips below the track
+            --(vc->clip_count);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Set the tracks of the next job, bottom to top
+ * @param seq  Sequence with tracks
+ * @param type AVMEDIA_TYPE_VIDEO for tracks with video, AVMEDIA_TYPE_AUDIO for tracks with audio,
+ *             AVMEDIA_TYPE_UNKNOWN for every track
+ */
+void set_job_tracks(Sequence *seq, enum AVMediaType type) {
+    SequenceCompositor *sc = &(seq->compositor);
+    sc->nb_job_tracks = 0;
+    for(int i = 0; i < seq->nb_tracks; i++) {
+        SequenceTrack *track = seq->tracks[i];
+        if(type == AVMEDIA_TYPE_UNKNOWN || (type == AVMEDIA_TYPE_VIDEO && track->video) ||
+            (type == AVMEDIA_TYPE_AUDIO && track->audio)) {
+            sc->job_tracks[(sc->nb_job_tracks)++] = track;
+        }
+    }
+}
+
+/**
+ * Run a job on each track of the current job, in parallel
+ * @param  seq Sequence with tracks
+ * @param  job function run with seq as arg, and the index of the track in sc->job_tracks
+ * @return     >= 0 on success, the first error of a track otherwise
+ */
+int run_track_jobs(Sequence *seq, ThreadPoolJob job) {
+    SequenceCompositor *sc = &(seq->compositor);
+    if(sc->nb_job_tracks > 1) {
+        int ret = thread_pool_execute(&(sc->pool), job, seq, sc->nb_job_tracks);
+        if(ret < 0) {
+            return ret;
+        }
+    } else {
+        for(int i = 0; i < sc->nb_job_tracks; i++) {
+            job(seq, i, 0);
+        }
+    }
+    for(int i = 0; i < sc->nb_job_tracks; i++) {
+        if(sc->job_tracks[i]->ret < 0) {
+            return sc->job_tracks[i]->ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * ThreadPoolJob seeking a track to sc->job_pts
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void seek_track_job(void *arg, int job_idx, int thread_idx) {
+    SequenceCompositor *sc = &(((Sequence *) arg)->compositor);
+    SequenceTrack *track = sc->job_tracks[job_idx];
+    track->ret = seek_sequence_track(track, sc->job_pts);
+}
+
+/**
+ * Seek a track to a position of the sequence. Over a gap of the track,
+ * it is seeked to the start of the next clip
+ * @param  track SequenceTrack
+ * @param  pts   sequence pts
+ * @return       >= 0 on success
+ */
+int seek_sequence_track(SequenceTrack *track, int64_t pts) {
+    Sequence *ts = &(track->seq);
+    reset_sequence_track(track);
+    Node *node = ts->clips.head;
+    while(node != NULL && ((Clip *) node->data)->end_pts <= pts) {
+        node = node->next;
+    }
+    if(node == NULL) {
+        // no clips left after pts
+        track->eof = true;
+        return 0;
+    }
+    Clip *clip = (Clip *) node->data;
+    int ret = open_clip(clip);
+    if(ret < 0) {
+        return ret;
+    }
+    if(clip->start_pts <= pts) {
+        return sequence_seek(ts, seq_pts_to_frame_index(ts, pts));
+    }
+    // the sequence_seek() of a gap: read from the start of the next clip
+    reset_sequence_transition(&(ts->transition));
+    if(ts->clips_iter.current != NULL && compare_clips(clip, (Clip *) ts->clips_iter.current->data) != 0) {
+        close_clip((Clip *) ts->clips_iter.current->data);
+    }
+    ts->clips_iter.current = node;
+    return seek_clip_pts(clip, 0);
+}
+
+/**
+ * Read the next frame of a track. Video frames are queued (when the track has video)
+ * and audio frames are converted into the mix format and queued (when the track has audio)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @return       >= 0 on success, AVERROR_EOF when the track has no more frames
+ */
+int read_track_frame(Sequence *seq, SequenceTrack *track) {
+    Sequence *ts = &(track->seq);
+    enum AVMediaType type;
+    if(track->decoded == NULL && (track->decoded = av_frame_alloc()) == NULL) {
+        log_error("read_track_frame() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    if(read_sequence_clips_frame(ts, track->decoded, &type, true, false) < 0) {
+        track->eof = true;
+        return AVERROR_EOF;
+    }
+    int ret = 0;
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        track->read_pts = track->decoded->pts;
+    }
+    if(type == AVMEDIA_TYPE_VIDEO && track->video) {
+        if(track->nb_frames == SEQ_TRACK_MAX_FRAMES) {
+            log_warning("read_track_frame(): too many track frames ahead, dropping the oldest\n");
+            pop_track_frame(track);
+        }
+        AVFrame **slot = &(track->frames[track->nb_frames]);
+        if(*slot == NULL && (*slot = av_frame_alloc()) == NULL) {
+            log_error("read_track_frame() error: Failed to allocate frame\n");
+            av_frame_unref(track->decoded);
+            return AVERROR(ENOMEM);
+        }
+        av_frame_move_ref(*slot, track->decoded);
+        // the frame is shown until the next frame, or the end of its clip
+        track->frames_end_pts[track->nb_frames] = get_current_clip(ts)->end_pts;
+        ++(track->nb_frames);
+    } else if(type == AVMEDIA_TYPE_AUDIO && track->audio) {
+        ret = write_track_audio(seq, track, track->decoded);
+    }
+    av_frame_unref(track->decoded);
+    return ret;
+}
+
+/**
+ * Drop the oldest queued video frame of a track
+ * @param track SequenceTrack
+ */
+void pop_track_frame(SequenceTrack *track) {
+    if(track->nb_frames <= 0) {
+        return;
+    }
+    AVFrame *f = track->frames[0];
+    av_frame_unref(f);
+    memmove(track->frames, track->frames + 1, (track->nb_frames - 1) * sizeof(AVFrame *));
+    memmove(track->frames_end_pts, track->frames_end_pts + 1, (track->nb_frames - 1) * sizeof(int64_t));
+    track->frames[--(track->nb_frames)] = f;
+}
+
+/**
+ * Drop the oldest queued audio frame of a track
+ * @param track SequenceTrack
+ */
+void pop_track_audio(SequenceTrack *track) {
+    if(track->nb_audio_frames <= 0) {
+        return;
+    }
+    av_frame_free(&(track->audio_frames[0]));
+    memmove(track->audio_frames, track->audio_frames + 1, (track->nb_audio_frames - 1) * sizeof(AVFrame *));
+    --(track->nb_audio_frames);
+}
+
+/**
+ * ThreadPoolJob decoding a track up to sc->job_pts and scaling its frame into a layer
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void read_track_video_job(void *arg, int job_idx, int thread_idx) {
+    Sequence *seq = (Sequence *) arg;
+    SequenceTrack *track = seq->compositor.job_tracks[job_idx];
+    track->ret = advance_track_video(seq, track, seq->compositor.job_pts);
+    if(track->ret >= 0) {
+        track->ret = get_track_layer(seq, track);
+    }
+}
+
+/**
+ * Decode a track up to a pts, keeping the last video frame at or before it
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  pts   sequence pts
+ * @return       >= 0 on success
+ */
+int advance_track_video(Sequence *seq, SequenceTrack *track, int64_t pts) {
+    int ret;
+    while(true) {
+        while(track->nb_frames >= 2 && track->frames[1]->pts <= pts) {
+            pop_track_frame(track);
+        }
+        if(track->eof || (track->nb_frames > 0 && track->frames[track->nb_frames - 1]->pts >= pts)) {
+            break;
+        }
+        if((ret = read_track_frame(seq, track)) < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Scale the video frame of a track shown at sc->job_pts into its layer
+ * (track->layer_ready is false when the track shows nothing there)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @return       >= 0 on success
+ */
+int get_track_layer(Sequence *seq, SequenceTrack *track) {
+    SequenceCompositor *sc = &(seq->compositor);
+    int64_t pts = sc->job_pts;
+    track->layer_ready = false;
+    // over a gap (or before the first frame) the track shows nothing
+    if(track->nb_frames == 0 || track->frames[0]->pts > pts || pts >= track->frames_end_pts[0] ||
+        track->opacity <= 0) {
+        return 0;
+    }
+    AVFrame *src = track->frames[0];
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(sc->job_format);
+    int aw = 1 << desc->log2_chroma_w, ah = 1 << desc->log2_chroma_h;
+    int width = FFMAX((track->width > 0 ? track->width : sc->job_width) & ~(aw - 1), aw);
+    int height = FFMAX((track->height > 0 ? track->height : sc->job_height) & ~(ah - 1), ah);
+    track->layer_x = track->x & ~(aw - 1);
+    track->layer_y = track->y & ~(ah - 1);
+    if(track->layer_x >= sc->job_width || track->layer_y >= sc->job_height ||
+        track->layer_x + width <= 0 || track->layer_y + height <= 0) {
+        return 0;
+    }
+    // a track with alpha is blended by its own alpha
+    enum AVPixelFormat format = sc->job_format;
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(src->format);
+    if(src_desc != NULL && (src_desc->flags & AV_PIX_FMT_FLAG_ALPHA) &&
+        get_composite_alpha_format(sc->job_format) != AV_PIX_FMT_NONE) {
+        format = get_composite_alpha_format(sc->job_format);
+    }
+    AVFrame *layer = track->layer;
+    if(layer != NULL && track->layer_pts == src->pts && layer->width == width &&
+        layer->height == height && layer->format == format) {
+        // same frame as the last one composited
+        track->layer_ready = true;
+        return 0;
+    }
+    int ret;
+    if(src->width == width && src->height == height && src->format == format) {
+        if(layer == NULL && (layer = track->layer = av_frame_alloc()) == NULL) {
+            log_error("get_track_layer() error: Failed to allocate frame\n");
+            return AVERROR(ENOMEM);
+        }
+        av_frame_unref(layer);
+        if((ret = av_frame_ref(layer, src)) < 0) {
+            return ret;
+        }
+    } else {
+        track->sws_ctx = sws_getCachedContext(track->sws_ctx, src->width, src->height, src->format,
+                                                width, height, format, SWS_BICUBIC, NULL, NULL, NULL);
+        if(track->sws_ctx == NULL) {
+            log_error("get_track_layer() error: Failed to get SwsContext\n");
+            return -1;
+        }
+        if((ret = get_composite_buffer(&(track->layer), width, height, format)) < 0) {
+            return ret;
+        }
+        sws_scale(track->sws_ctx, (const uint8_t * const *) src->data, src->linesize, 0, src->height,
+                    track->layer->data, track->layer->linesize);
+    }
+    track->layer_pts = src->pts;
+    track->layer_ready = true;
+    return 0;
+}
+
+/**
+ * Layer the video of the tracks over a frame of the clips. Tracks are decoded in parallel,
+ * then bands of rows are composited in parallel. Frames in a pixel format that cannot be
+ * composited are converted into yuv420p
+ * @param  seq   Sequence with tracks
+ * @param  frame video frame of the clips with sequence pts (replaced by the composited frame)
+ * @return       >= 0 on success
+ */
+int composite_tracks_video(Sequence *seq, AVFrame *frame) {
+    SequenceCompositor *sc = &(seq->compositor);
+    sc->job_pts = frame->pts;
+    sc->job_format = composite_pix_fmt_supported(frame->format) ? frame->format : AV_PIX_FMT_YUV420P;
+    sc->job_width = frame->width;
+    sc->job_height = frame->height;
+    // tracks queue audio only while the clip read has audio to mix it into
+    Clip *clip = get_current_clip(seq);
+    AVCodecContext *audio_ctx = clip != NULL ? clip->vid_ctx->audio_codec_ctx : NULL;
+    set_track_audio_mixing(seq, audio_ctx != NULL && audio_ctx->sample_rate == seq->audio_time_base.den);
+    set_job_tracks(seq, AVMEDIA_TYPE_VIDEO);
+    int ret = run_track_jobs(seq, read_track_video_job);
+    if(ret < 0) {
+        return ret;
+    }
+    // layers shown at this pts, bottom to top
+    int nb_layers = 0;
+    for(int i = 0; i < sc->nb_job_tracks; i++) {
+        if(sc->job_tracks[i]->layer_ready) {
+            sc->job_tracks[nb_layers++] = sc->job_tracks[i];
+        }
+    }
+    sc->nb_job_tracks = nb_layers;
+    if(nb_layers == 0) {
+        return 0;
+    }
+    AVFrame *src = frame;
+    if(frame->format != sc->job_format) {
+        sc->sws_ctx = sws_getCachedContext(sc->sws_ctx, frame->width, frame->height, frame->format,
+                                            frame->width, frame->height, sc->job_format,
+                                            SWS_BICUBIC, NULL, NULL, NULL);
+        if(sc->sws_ctx == NULL) {
+            log_error("composite_tracks_video() error: Failed to get SwsContext\n");
+            return -1;
+        }
+        if((ret = get_composite_buffer(&(sc->base), frame->width, frame->height, sc->job_format)) < 0) {
+            return ret;
+        }
+        sws_scale(sc->sws_ctx, (const uint8_t * const *) frame->data, frame->linesize, 0, frame->height,
+                    sc->base->data, sc->base->linesize);
+        src = sc->base;
+    }
+    // composite in place when the frame is not shared (with the decoder)
+    AVFrame *dst = src;
+    if(src == frame && !av_frame_is_writable(frame)) {
+        if((ret = get_composite_buffer(&(sc->mix), frame->width, frame->height, sc->job_format)) < 0) {
+            return ret;
+        }
+        dst = sc->mix;
+    }
+    sc->job_src = src;
+    sc->job_dst = dst;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(sc->job_format);
+    int nb_tiles = FFMAX(1, FFMIN(get_thread_pool_size(&(sc->pool)), sc->job_height / COMPOSITE_MIN_TILE_H));
+    sc->job_tile_h = FFALIGN((sc->job_height + nb_tiles - 1) / nb_tiles, 1 << desc->log2_chroma_h);
+    nb_tiles = (sc->job_height + sc->job_tile_h - 1) / sc->job_tile_h;
+    if((ret = thread_pool_execute(&(sc->pool), composite_tile_job, seq, nb_tiles)) < 0) {
+        return ret;
+    }
+    if(dst == frame) {
+        return 0;
+    }
+    if((ret = av_frame_copy_props(dst, frame)) < 0) {
+        return ret;
+    }
+    av_frame_unref(frame);
+    return av_frame_ref(frame, dst);
+}
+
+/**
+ * ThreadPoolJob compositing the layers of the current job over a band of rows
+ * @param arg        Sequence
+ * @param job_idx    index of the band (of sc->job_tile_h rows)
+ * @param thread_idx index of the thread
+ */
+void composite_tile_job(void *arg, int job_idx, int thread_idx) {
+    SequenceCompositor *sc = &(((Sequence *) arg)->compositor);
+    int y0 = job_idx * sc->job_tile_h;
+    int y1 = FFMIN(y0 + sc->job_tile_h, sc->job_height);
+    if(sc->job_src != sc->job_dst) {
+        copy_frame_rows(sc->job_dst, sc->job_src, y0, y1);
+    }
+    for(int i = 0; i < sc->nb_job_tracks; i++) {
+        SequenceTrack *track = sc->job_tracks[i];
+        composite_layer_rows(sc->job_dst, track->layer, track->layer_x, track->layer_y, track->opacity, y0, y1);
+    }
+}
+
+/**
+ * ThreadPoolJob decoding the audio of a track over sc->job_audio_pts to sc->job_audio_end
+ * @param arg        Sequence
+ * @param job_idx    index of the track in sc->job_tracks
+ * @param thread_idx index of the thread
+ */
+void read_track_audio_job(void *arg, int job_idx, int thread_idx) {
+    Sequence *seq = (Sequence *) arg;
+    SequenceCompositor *sc = &(seq->compositor);
+    SequenceTrack *track = sc->job_tracks[job_idx];
+    track->ret = advance_track_audio(seq, track, sc->job_audio_pts, sc->job_audio_end);
+}
+
+/**
+ * Decode a track until its queued audio covers a range of the sequence
+ * (audio ending before the range is dropped)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  start start of range (sequence audio pts)
+ * @param  end   end of range (exclusive)
+ * @return       >= 0 on success
+ */
+int advance_track_audio(Sequence *seq, SequenceTrack *track, int64_t start, int64_t end) {
+    // clips without audio are not read further ahead than the video queue of a track
+    int64_t read_end = av_rescale_q(end, seq->audio_time_base, seq->video_time_base) +
+                        SEQ_TRACK_MAX_FRAMES * seq->video_frame_duration;
+    int ret;
+    while(true) {
+        while(track->nb_audio_frames > 0 &&
+                track->audio_frames[0]->pts + track->audio_frames[0]->nb_samples <= start) {
+            pop_track_audio(track);
+        }
+        if(track->eof || track->nb_audio_frames == SEQ_TRACK_MAX_AUDIO_FRAMES ||
+            (track->read_pts != AV_NOPTS_VALUE && track->read_pts >= read_end)) {
+            break;
+        }
+        if(track->nb_audio_frames > 0) {
+            AVFrame *last = track->audio_frames[track->nb_audio_frames - 1];
+            if(last->pts + last->nb_samples >= end) {
+                break;
+            }
+        }
+        if((ret = read_track_frame(seq, track)) < 0 && ret != AVERROR_EOF) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Sum the audio of the tracks into an audio frame of the clips. Tracks are decoded in parallel.
+ * The frame is converted into the mix format (planar float) when it has another format
+ * @param  seq   Sequence with tracks
+ * @param  frame audio frame of the clips with sequence pts (mixed in place, or replaced)
+ * @return       >= 0 on success
+ */
+int mix_tracks_audio(Sequence *seq, AVFrame *frame) {
+    SequenceCompositor *sc = &(seq->compositor);
+    // tracks are resampled to the sequence rate only (see start_sequence_tracks())
+    set_track_audio_mixing(seq, frame->sample_rate == seq->audio_time_base.den);
+    if(!sc->mix_audio) {
+        return 0;
+    }
+    // sequence audio pts count samples at the sequence rate
+    sc->job_audio_pts = frame->pts;
+    sc->job_audio_end = frame->pts + frame->nb_samples;
+    set_job_tracks(seq, AVMEDIA_TYPE_AUDIO);
+    int ret = run_track_jobs(seq, read_track_audio_job);
+    if(ret < 0) {
+        return ret;
+    }
+    // tracks with samples within this frame
+    int nb_mixed = 0;
+    for(int i = 0; i < sc->nb_job_tracks; i++) {
+        SequenceTrack *track = sc->job_tracks[i];
+        if(track->nb_audio_frames > 0 && track->audio_frames[0]->pts < sc->job_audio_end && track->volume > 0) {
+            sc->job_tracks[nb_mixed++] = track;
+        }
+    }
+    sc->nb_job_tracks = nb_mixed;
+    if(nb_mixed == 0) {
+        return 0;
+    }
+    uint64_t layout = frame->channel_layout != 0 ? frame->channel_layout :
+                        av_get_default_channel_layout(frame->channels);
+    if(frame->format != AV_SAMPLE_FMT_FLTP || layout != sc->channel_layout) {
+        ret = convert_sequence_audio(seq, frame, layout);
+    } else {
+        ret = av_frame_make_writable(frame);
+    }
+    if(ret < 0) {
+        return ret;
+    }
+    for(int i = 0; i < sc->nb_job_tracks; i++) {
+        mix_track_audio(sc->job_tracks[i], frame);
+    }
+    return 0;
+}
+
+/**
+ * Convert an audio frame of the clips into the mix format (same sample rate)
+ * @param  seq    Sequence with tracks
+ * @param  frame  audio frame (replaced by the converted frame)
+ * @param  layout channel layout of frame
+ * @return        >= 0 on success
+ */
+int convert_sequence_audio(Sequence *seq, AVFrame *frame, uint64_t layout) {
+    SequenceCompositor *sc = &(seq->compositor);
+    int ret;
+    if(sc->swr_ctx == NULL || sc->swr_fmt != frame->format || sc->swr_layout != layout) {
+        swr_free(&(sc->swr_ctx));
+        sc->swr_ctx = swr_alloc_set_opts(NULL, sc->channel_layout, AV_SAMPLE_FMT_FLTP, frame->sample_rate,
+                                            layout, frame->format, frame->sample_rate, 0, NULL);
+        ret = sc->swr_ctx == NULL ? AVERROR(ENOMEM) : swr_init(sc->swr_ctx);
+        if(ret < 0) {
+            log_error("convert_sequence_audio() error: Failed to open SwrContext (%s)\n", av_err2str(ret));
+            swr_free(&(sc->swr_ctx));
+            return ret;
+        }
+        sc->swr_fmt = frame->format;
+        sc->swr_layout = layout;
+    }
+    AVFrame *a = sc->audio;
+    if(a == NULL && (a = sc->audio = av_frame_alloc()) == NULL) {
+        log_error("convert_sequence_audio() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    a->format = AV_SAMPLE_FMT_FLTP;
+    a->channel_layout = sc->channel_layout;
+    a->channels = sc->channels;
+    a->sample_rate = frame->sample_rate;
+    a->nb_samples = frame->nb_samples;
+    if((ret = av_frame_get_buffer(a, 0)) < 0) {
+        log_error("convert_sequence_audio() error: Failed to allocate samples\n");
+        return ret;
+    }
+    // same rate: every sample is converted without delay
+    ret = swr_convert(sc->swr_ctx, a->extended_data, a->nb_samples,
+                        (const uint8_t **) frame->extended_data, frame->nb_samples);
+    if(ret < 0) {
+        log_error("convert_sequence_audio() error: Failed to convert samples\n");
+        av_frame_unref(a);
+        return ret;
+    }
+    if((ret = av_frame_copy_props(a, frame)) < 0) {
+        av_frame_unref(a);
+        return ret;
+    }
+    av_frame_unref(frame);
+    av_frame_move_ref(frame, a);
+    return 0;
+}
+
+/**
+ * Convert an audio frame of a track into the mix format (resampled to the sequence rate)
+ * and queue it (dropped while the sequence has no audio to mix it into)
+ * @param  seq   Sequence with tracks
+ * @param  track SequenceTrack
+ * @param  frame audio frame with sequence pts
+ * @return       >= 0 on success
+ */
+int write_track_audio(Sequence *seq, SequenceTrack *track, AVFrame *frame) {
+    SequenceCompositor *sc = &(seq->compositor);
+    if(!sc->mix_audio) {
+        return 0;
+    }
+    int rate = seq->audio_time_base.den;
+    uint64_t layout = frame->channel_layout != 0 ? frame->channel_layout :
+                        av_get_default_channel_layout(frame->channels);
+    int ret;
+    if(track->swr_ctx == NULL || track->swr_fmt != frame->format || track->swr_layout != layout ||
+        track->swr_rate != frame->sample_rate || track->swr_out_layout != sc->channel_layout) {
+        swr_free(&(track->swr_ctx));
+        track->swr_ctx = swr_alloc_set_opts(NULL, sc->channel_layout, AV_SAMPLE_FMT_FLTP, rate,
+                                            layout, frame->format, frame->sample_rate, 0, NULL);
+        ret = track->swr_ctx == NULL ? AVERROR(ENOMEM) : swr_init(track->swr_ctx);
+        if(ret < 0) {
+            log_error("write_track_audio() error: Failed to open SwrContext (%s)\n", av_err2str(ret));
+            swr_free(&(track->swr_ctx));
+            return ret;
+        }
+        track->swr_fmt = frame->format;
+        track->swr_layout = layout;
+        track->swr_rate = frame->sample_rate;
+        track->swr_out_layout = sc->channel_layout;
+    }
+    int nb = swr_get_out_samples(track->swr_ctx, frame->nb_samples);
+    if(nb <= 0) {
+        return nb;
+    }
+    AVFrame *a = av_frame_alloc();
+    if(a == NULL) {
+        log_error("write_track_audio() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    a->format = AV_SAMPLE_FMT_FLTP;
+    a->channel_layout = sc->channel_layout;
+    a->channels = sc->channels;
+    a->sample_rate = rate;
+    a->nb_samples = nb;
+    if((ret = av_frame_get_buffer(a, 0)) < 0) {
+        log_error("write_track_audio() error: Failed to allocate samples\n");
+        av_frame_free(&a);
+        return ret;
+    }
+    // the first sample out was delayed within the resampler
+    a->pts = frame->pts - swr_get_delay(track->swr_ctx, rate);
+    ret = swr_convert(track->swr_ctx, a->extended_data, nb, (const uint8_t **) frame->extended_data,
+                        frame->nb_samples);
+    if(ret <= 0) {
+        if(ret < 0) {
+            log_error("write_track_audio() error: Failed to convert samples\n");
+        }
+        av_frame_free(&a);
+        return ret;
+    }
+    a->nb_samples = ret;
+    if(track->nb_audio_frames == SEQ_TRACK_MAX_AUDIO_FRAMES) {
+        log_warning("write_track_audio(): too many track audio frames ahead, dropping the oldest\n");
+        pop_track_audio(track);
+    }
+    if(track->nb_audio_frames == track->audio_frames_size) {
+        int size = FFMIN(FFMAX(16, track->audio_frames_size * 2), SEQ_TRACK_MAX_AUDIO_FRAMES);
+        AVFrame **frames = realloc(track->audio_frames, size * sizeof(AVFrame *));
+        if(frames == NULL) {
+            log_error("write_track_audio() error: Failed to allocate audio frames\n");
+            av_frame_free(&a);
+            return AVERROR(ENOMEM);
+        }
+        track->audio_frames = frames;
+        track->audio_frames_size = size;
+    }
+    track->audio_frames[(track->nb_audio_frames)++] = a;
+    return 0;
+}
+
+/**
+ * Sum the queued audio of a track into the samples of a frame it overlaps
+ * @param track SequenceTrack
+ * @param frame audio frame in the mix format with sequence pts (writable)
+ */
+void mix_track_audio(SequenceTrack *track, AVFrame *frame) {
+    int64_t end = frame->pts + frame->nb_samples;
+    for(int i = 0; i < track->nb_audio_frames; i++) {
+        AVFrame *a = track->audio_frames[i];
+        if(a->pts >= end) {
+            break;
+        }
+        int64_t start = FFMAX(a->pts, frame->pts);
+        int64_t stop = FFMIN(a->pts + a->nb_samples, end);
+        if(stop > start) {
+            mix_audio_samples(frame, start - frame->pts, a, start - a->pts, stop - start, (float) track->volume);
+        }
+    }
+}
@@ -15,20 +15,34 @@
   * @param  oc           OutputContext already allocated with codecs
   * @param  seq_ts       Sequence containing clips to encode
   * @param  pkt          output encoded packet
-  * @return      >= 0 on success, < 0 when reach EOF, end of clip boundary or error.
+  * @return      >= 0 on success, AVERROR_EOF when the sequence is fully encoded, other < 0 on error.
   */
  int sequence_encode_frame(OutputContext *oc, Sequence *seq, AVPacket *pkt) {
-     if(oc->video.done_flush && oc->audio.done_flush) {
-         return AVERROR_EOF;
-     } else {
-         if(oc->last_encoder_frame_type == AVMEDIA_TYPE_VIDEO || oc->video.flushing) {
-             return seq_receive_enc_packet(oc, &(oc->video), seq, pkt);
-         } else if(oc->last_encoder_frame_type == AVMEDIA_TYPE_AUDIO || oc->audio.flushing) {
-             return seq_receive_enc_packet(oc, &(oc->audio), seq, pkt);
-         } else {
-             return seq_send_frame_to_encoder(oc, seq, pkt);
+     int ret;
+     while(!(oc->video.done_flush && oc->audio.done_flush)) {
+         OutputStream *os = seq_get_drain_stream(oc);
+         if(os != NULL) {
+             // drain every packet available from this encoder before sending it more input
+             int64_t start_ns = render_stats_start();
+             ret = seq_receive_enc_packet(os, pkt);
+             render_stats_add(&(oc->stats), os == &(oc->video) ? AVMEDIA_TYPE_VIDEO : AVMEDIA_TYPE_AUDIO,
+                                 RENDER_STAGE_ENCODE, start_ns, ret == 0);
+             if(ret == 0) {
+                 return ret;
+             } else if(ret == AVERROR_EOF) {
+                 // encoder is fully flushed, move onto the next one
+                 continue;
+             } else if(ret != AVERROR(EAGAIN)) {
+                 return ret;
+             }
+         }
+         // encoder needs more input
+         ret = seq_send_frame_to_encoder(oc, seq);
+         if(ret < 0) {
+             return ret;
          }
      }
+     return AVERROR_EOF;
  }
 
  /*************** EXAMPLE FUNCTIONS ***************/
@@ -51,14 +65,30 @@
 
  /*************** INTERNAL FUNCTIONS ***************/
  /**
-  * Receive an encoded packet given an output stream, and handle the return value
-  * @param  oc   OutputContext
+  * Get the output stream which must be drained of packets before more frames are sent.
+  * This is the stream of the last frame sent, or the stream currently being flushed
+  * @param  oc OutputContext
+  * @return    OutputStream to receive packets from, NULL if a new frame must be sent
+  */
+ OutputStream *seq_get_drain_stream(OutputContext *oc) {
+     if(oc->last_encoder_frame_type == AVMEDIA_TYPE_VIDEO || oc->video.flushing) {
+         return &(oc->video);
+     } else if(oc->last_encoder_frame_type == AVMEDIA_TYPE_AUDIO || oc->audio.flushing) {
+         return &(oc->audio);
+     }
+     return NULL;
+ }
+
+ /**
+  * Receive an encoded packet given an output stream
   * @param  os   OutputStream within OutputContext (video or audio)
-  * @param  seq  Sequence being encoded
   * @param  pkt  output encoded packet
-  * @return      >= 0 on success
+  * @return      0 when a packet was received,
+  *              AVERROR(EAGAIN) when the encoder needs more input,
+  *              AVERROR_EOF when the encoder has been fully flushed,
+  *              other < 0 on error
   */
- int seq_receive_enc_packet(OutputContext *oc, OutputStream *os, Sequence *seq, AVPacket *pkt) {
+ int seq_receive_enc_packet(OutputStream *os, AVPacket *pkt) {
      int ret = avcodec_receive_packet(os->codec_ctx, pkt);
      if(ret == 0) {
          // successfully received packet from encoder
@@ -66,30 +96,16 @@
 
          // rescale packet timestamp values from codec_ctx(sequence) to output stream timebase
          av_packet_rescale_ts(pkt, os->codec_ctx->time_base, os->stream->time_base);
-
-         // printf("rescale %d/%d to %d/%d\n", seq->video_time_base.num, seq->video_time_base.den,
-         // os->stream->time_base.num, os->stream->time_base.den);
-         // rescale packet timestamp values from sequence/codec_ctx to output stream timebase
-         // if(pkt->stream_index == oc->video.stream->index) {
-         //     av_packet_rescale_ts(pkt, os->codec_ctx->time_base, os->stream->time_base);
-         // } else if(pkt->stream_index == oc->audio.stream->index) {
-         //     av_packet_rescale_ts(pkt, os->codec_ctx->time_base, os->stream->time_base);
-         // }
-         return ret;
-     } else if(ret == AVERROR(EAGAIN)) {
-         // output is not available in the current state - user must try to send input
-         return seq_send_frame_to_encoder(oc, seq, pkt);
      } else if(ret == AVERROR_EOF) {
          // the encoder has been fully flushed, and there will be no more output frames
          os->flushing = false;
          os->done_flush = true;
-         return sequence_encode_frame(oc, seq, pkt);
-     } else {
+     } else if(ret != AVERROR(EAGAIN)) {
          // legitimate encoding errors
-         fprintf(stderr, "Legitmate encoding error when handling receive frame[%s]\n",
+         log_error("Legitmate encoding error when handling receive frame[%s]\n",
                              av_err2str(ret));
-         return ret;
      }
+     return ret;
  }
 
  void clear_frame_encoding_garbage(AVFrame *f) {
@@ -111,76 +127,180 @@
 
  /**
   * Send a frame to encoder. This function builds ontop of seq_read_frame().
+  * If the last frame was refused by the encoder, it is sent again instead of reading a new one.
+  * When the sequence has no more frames, both encoders are put into flushing mode
+  * (after the remaining audio samples are sent).
   * @param  oc   OutputContext already allocated
   * @param  seq  Sequence to encode
-  * @param  pkt  packet output
   * @return      >= 0 on success
   */
- int seq_send_frame_to_encoder(OutputContext *oc, Sequence *seq, AVPacket *pkt) {
-     enum AVMediaType type;
-     // read decoded frame from sequence
-     int ret = sequence_read_frame(seq, oc->buffer_frame, &type, true);
-     // no more frames or error
-     if(ret < 0) {
-         oc->last_encoder_frame_type = AVMEDIA_TYPE_NB;
-
-         // if last clip(iterator will be reset to start), then flush video and audio streams
-         if(seq->clips_iter.current == seq->clips.head) {
-             ret = avcodec_send_frame(oc->video.codec_ctx, NULL);
-             if(ret < 0) {
-                 fprintf(stderr, "Failed to flush the video stream (%s)\n", av_err2str(ret));
-                 return ret;
+ int seq_send_frame_to_encoder(OutputContext *oc, Sequence *seq) {
+     enum AVMediaType type = oc->last_encoder_frame_type;
+     int ret;
+     if(!oc->frame_pending) {
+         ret = seq_get_encoder_frame(oc, seq, &type);
+         if(ret < 0) {
+             oc->last_encoder_frame_type = AVMEDIA_TYPE_NB;
+             if(ret == AVERROR(EAGAIN)) {
+                 // audio samples were buffered, nothing to send yet
+                 return 0;
+             } else if(ret == AVERROR_EOF) {
+                 // no more frames, flush video and audio streams
+                 return seq_flush_encoders(oc);
              }
-             oc->video.flushing = true;
-
-             ret = avcodec_send_frame(oc->audio.codec_ctx, NULL);
-             if(ret < 0) {
-                 fprintf(stderr, "Failed to flush the audio stream (%s)\n", av_err2str(ret));
-                 return ret;
-             }
-             oc->audio.flushing = true;
-
-             return sequence_encode_frame(oc, seq, pkt);   // try to receive a flushed packet out
-         } else {
              return ret;
          }
      }
      // supply a raw video or audio frame to the encoder
+     int64_t start_ns = render_stats_start();
      if(type == AVMEDIA_TYPE_VIDEO) {
          ret = avcodec_send_frame(oc->video.codec_ctx, oc->buffer_frame);
-         return seq_handle_send_frame(oc, seq, type, ret, pkt);
      } else if(type == AVMEDIA_TYPE_AUDIO) {
          ret = avcodec_send_frame(oc->audio.codec_ctx, oc->buffer_frame);
-         return seq_handle_send_frame(oc, seq, type, ret, pkt);
      } else {
          // this should never happen
-         fprintf(stderr, "AVFrame type is invalid (must be AVMEDIA_TYPE_VIDEO or AVMEDIA_TYPE_AUDIO)\n");
+         log_error("AVFrame type is invalid (must be AVMEDIA_TYPE_VIDEO or AVMEDIA_TYPE_AUDIO)\n");
          return -1;
      }
+     render_stats_add(&(oc->stats), type, RENDER_STAGE_ENCODE, start_ns, 0);
+     return seq_handle_send_frame(oc, type, ret);
+ }
+
+ /**
+  * Get the next frame to be sent to an encoder into oc->buffer_frame.
+  * Video frames are converted into the encoder format. Audio frames are resampled
+  * and re-chunked into the encoder frame_size, so a decoded audio frame can give
+  * zero, one or more encoder frames.
+  * @param  oc   OutputContext already allocated
+  * @param  seq  Sequence to encode
+  * @param  type output type of frame (AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO)
+  * @return      0 when oc->buffer_frame is ready to be sent,
+  *              AVERROR(EAGAIN) when there is no frame ready yet,
+  *              AVERROR_EOF when the sequence and audio samples are all sent,
+  *              other < 0 on error
+  */
+ int seq_get_encoder_frame(OutputContext *oc, Sequence *seq, enum AVMediaType *type) {
+     AudioConverter *ac = &(oc->audio_convert);
+     // encoder sized audio frames waiting in the converter go first
+     int ret = receive_audio_convert_frame(ac, oc->buffer_frame);
+     if(ret != AVERROR(EAGAIN)) {
+         *type = AVMEDIA_TYPE_AUDIO;
+         return ret;
+     }
+     // read decoded frame from sequence
+     ret = sequence_read_frame(seq, oc->buffer_frame, type, true);
+     if(ret < 0) {
+         // end of sequence (not an error), then output the remaining audio samples
+         if(ret == AVERROR_EOF) {
+             ret = flush_audio_converter(ac);
+             return ret < 0 ? ret : AVERROR(EAGAIN);
+         }
+         return ret;
+     }
+     if(*type == AVMEDIA_TYPE_VIDEO) {
+         if(drop_video_frame(oc)) {
+             // draft preview at a lower frame rate, nothing to send
+             av_frame_unref(oc->buffer_frame);
+             return AVERROR(EAGAIN);
+         }
+         // scale/convert video frame into the encoder format (if needed)
+         ret = convert_video_frame(&(oc->video_convert), oc->buffer_frame);
+         if(ret < 0) {
+             log_error("seq_get_encoder_frame() error: Failed to convert video frame\n");
+             return ret;
+         }
+         set_segment_key_frame(oc, oc->buffer_frame);
+         return 0;
+     }
+     // resample audio frame and re-chunk it into the encoder frame size
+     ret = send_audio_convert_frame(ac, oc->buffer_frame);
+     if(ret < 0) {
+         log_error("seq_get_encoder_frame() error: Failed to convert audio frame\n");
+         return ret;
+     }
+     return receive_audio_convert_frame(ac, oc->buffer_frame);
+ }
+
+ /**
+  * Force a key frame on the first video frame of each segment
+  * @param oc    OutputContext
+  * @param frame video frame about to be sent to the encoder
+  */
+ void set_segment_key_frame(OutputContext *oc, AVFrame *frame) {
+     if(oc->segment_duration_pts <= 0 || frame->pts == AV_NOPTS_VALUE) {
+         return;
+     }
+     if(oc->next_segment_pts == AV_NOPTS_VALUE) {
+         // first frame starts the first segment
+         oc->next_segment_pts = frame->pts;
+     }
+     if(frame->pts >= oc->next_segment_pts) {
+         frame->pict_type = AV_PICTURE_TYPE_I;
+         frame->key_frame = 1;
+         // skip boundaries without any frame (ex: gap in sequence)
+         int64_t skipped = (frame->pts - oc->next_segment_pts) / oc->segment_duration_pts;
+         oc->next_segment_pts += (skipped + 1) * oc->segment_duration_pts;
+     }
+ }
+
+ /**
+  * Check if a video frame is dropped by a lower output frame rate (draft preview).
+  * Must be called once for every video frame read
+  * @param  oc   OutputContext
+  * @return      true if the frame must not be encoded
+  */
+ bool drop_video_frame(OutputContext *oc) {
+     bool drop = oc->frame_step > 1 && (oc->frame_count % oc->frame_step) != 0;
+     ++(oc->frame_count);
+     return drop;
  }
 
  /**
   * Handle the return from avcodec_send_frame().
   * This function is to be used inside of seq_send_frame_to_encoder()
   * @param  oc   OutputContext already allocated
-  * @param  seq  Sequence to encode
   * @param  type AVMediaType of frame that was sent
   * @param  ret  return from avcodec_send_frame()
-  * @param  pkt  output packet
   * @return      >= 0 on success
   */
- int seq_handle_send_frame(OutputContext *oc, Sequence *seq, enum AVMediaType type, int ret, AVPacket *pkt) {
+ int seq_handle_send_frame(OutputContext *oc, enum AVMediaType type, int ret) {
+     // packets will be drained from this encoder next
+     oc->last_encoder_frame_type = type;
      if(ret == 0) {
          // successfully sent frame to encoder
-         oc->last_encoder_frame_type = type;
-         return sequence_encode_frame(oc, seq, pkt);    // receive the packet from encoder
+         oc->frame_pending = false;
+         return 0;
      } else if(ret == AVERROR(EAGAIN)) {
          // input is not accepted in the current state - user must read output
-         return sequence_encode_frame(oc, seq, pkt);
+         // (keep the frame and send it again once the encoder is drained)
+         oc->frame_pending = true;
+         return 0;
      } else {
          // legitimate encoding error
-         fprintf(stderr, "Legitmate encoding error when handling send frame[%s]\n",
+         log_error("Legitmate encoding error when handling send frame[%s]\n",
                              av_err2str(ret));
          return ret;
      }
- }
\ No newline at end of file
+ }
+
+ /**
+  * Send NULL frames to the video and audio encoders to enter flushing mode
+  * @param  oc OutputContext already allocated
+  * @return    >= 0 on success
+  */
+ int seq_flush_encoders(OutputContext *oc) {
+     int ret = avcodec_send_frame(oc->video.codec_ctx, NULL);
+     if(ret < 0) {
+         log_error("Failed to flush the video stream (%s)\n", av_err2str(ret));
+         return ret;
+     }
+     oc->video.flushing = true;
+
+     ret = avcodec_send_frame(oc->audio.codec_ctx, NULL);
+     if(ret < 0) {
+         log_error("Failed to flush the audio stream (%s)\n", av_err2str(ret));
+         return ret;
+     }
+     oc->audio.flushing = true;
+     return 0;
+ }
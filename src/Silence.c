@@ -0,0 +1,501 @@
+/**
+ * @file Silence.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for Silence API:
+ * Silence detection and auto-trim from an audio-only decode pass.
+ * Sample kernels use SSE/SSE2 when available (scalar fallback otherwise).
+ */
+
+#include "Silence.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Set default silence parameters (-45 dBFS for 0.75 seconds, with 0.15 seconds of padding)
+ * @param params SilenceParams
+ */
+void set_silence_params_default(SilenceParams *params) {
+    params->threshold_db = -45.0;
+    params->window = 0.02;
+    params->min_silence = 0.75;
+    params->padding = 0.15;
+    params->min_keep = 0.25;
+}
+
+/**
+ * Initialize an empty envelope
+ * @param env SilenceEnvelope
+ */
+void init_silence_envelope(SilenceEnvelope *env) {
+    env->rms = NULL;
+    env->peak = NULL;
+    env->nb = 0;
+    env->size = 0;
+    env->sample_rate = 0;
+    env->window_samples = 0;
+    env->start_sample = 0;
+    env->acc_sq = 0;
+    env->acc_peak = 0;
+    env->acc_samples = 0;
+    env->acc_values = 0;
+}
+
+/**
+ * Decode the audio of a clip (without decoding video) into an RMS/peak envelope
+ * @param  clip   Clip (seeked back to its start when done)
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  env    SilenceEnvelope initialized with init_silence_envelope()
+ * @return        >= 0 on success
+ */
+int get_clip_silence_envelope(Clip *clip, SilenceParams *params, SilenceEnvelope *env) {
+    SilenceParams def;
+    if(params == NULL) {
+        set_silence_params_default(&def);
+        params = &def;
+    }
+    int ret = open_clip(clip);
+    if(ret < 0 || (ret = seek_clip_pts(clip, 0)) < 0) {
+        log_error("get_clip_silence_envelope() error: Failed to open clip\n");
+        return ret;
+    }
+    VideoContext *vc = clip->vid_ctx;
+    if(vc->audio_stream_idx < 0) {
+        log_error("get_clip_silence_envelope() error: clip[%s] has no audio\n", vc->url);
+        return -1;
+    }
+    // audio-only pass: video packets are never demuxed or decoded
+    clip->done_reading_video = true;
+    set_stream_discard(vc, vc->video_stream_idx, true);
+
+    env->sample_rate = vc->audio_codec_ctx->sample_rate;
+    env->window_samples = FFMAX(1, (int) lrint(params->window * env->sample_rate));
+    AVRational audio_tb = get_audio_time_base(vc);
+    int64_t audio_start = av_rescale_q(clip->orig_start_pts, get_video_time_base(vc), audio_tb);
+    bool first = true;
+
+    AVFrame *frame = av_frame_alloc();
+    if(frame == NULL) {
+        log_error("get_clip_silence_envelope() error: Failed to allocate frame\n");
+        return AVERROR(ENOMEM);
+    }
+    enum AVMediaType type;
+    while(ret >= 0 && clip_read_frame(clip, frame, &type) >= 0) {
+        if(type == AVMEDIA_TYPE_AUDIO) {
+            if(first) {
+                env->start_sample = av_rescale_q(frame->pts - audio_start, audio_tb,
+                                                 (AVRational){1, env->sample_rate});
+                first = false;
+            }
+            ret = add_silence_frame(env, frame);
+        }
+        av_frame_unref(frame);
+    }
+    av_frame_free(&frame);
+    if(ret >= 0) {
+        ret = flush_silence_window(env);
+    }
+    if(ret < 0) {
+        log_error("get_clip_silence_envelope() error: Failed to read audio of clip[%s]\n", vc->url);
+        return ret;
+    }
+    return seek_clip_pts(clip, 0);
+}
+
+/**
+ * Find the silent ranges of a clip that should be trimmed
+ * @param  clip   Clip with an audio stream
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  ranges output array of ranges (free() when done), NULL when there are none
+ * @return        number of ranges, < 0 on error
+ */
+int detect_clip_silence(Clip *clip, SilenceParams *params, SilenceRange **ranges) {
+    SilenceParams def;
+    if(params == NULL) {
+        set_silence_params_default(&def);
+        params = &def;
+    }
+    *ranges = NULL;
+    SilenceEnvelope env;
+    init_silence_envelope(&env);
+    int ret = get_clip_silence_envelope(clip, params, &env);
+    if(ret < 0) {
+        free_silence_envelope(&env);
+        return ret;
+    }
+    int nb = find_silence_ranges(&env, params, ranges);
+    free_silence_envelope(&env);
+    if(nb <= 0) {
+        return nb;
+    }
+    // samples into video pts relative to the clip
+    AVRational sample_tb = (AVRational){1, env.sample_rate};
+    AVRational video_tb = get_clip_video_time_base(clip);
+    int64_t length = clip->orig_end_pts - clip->orig_start_pts;
+    int nb_out = 0;
+    for(int i = 0; i < nb; i++) {
+        SilenceRange r = (*ranges)[i];
+        r.start_pts = av_rescale_q(r.start_pts, sample_tb, video_tb);
+        r.end_pts = FFMIN(av_rescale_q(r.end_pts, sample_tb, video_tb), length);
+        if(r.end_pts > r.start_pts) {
+            (*ranges)[nb_out++] = r;
+        }
+    }
+    return nb_out;
+}
+
+/**
+ * Build a sequence without the silences of another. The clips of seq are split around
+ * their silent ranges and appended to out in one pass (out shares the VideoContexts of seq)
+ * @param  seq    Sequence to trim (not changed, apart from being seeked to its start)
+ * @param  params SilenceParams (NULL for defaults)
+ * @param  out    empty Sequence (initialized with the fps and sample rate of seq)
+ * @return        number of silent ranges removed, < 0 on error
+ */
+int trim_sequence_silence(Sequence *seq, SilenceParams *params, Sequence *out) {
+    if(seq == NULL || out == NULL) {
+        log_error("trim_sequence_silence() error: NULL params\n");
+        return -1;
+    }
+    int ret = 0, total = 0;
+    for(Node *curr = seq->clips.head; curr != NULL && ret >= 0; curr = curr->next) {
+        Clip *clip = (Clip *) curr->data;
+        SilenceRange *ranges = NULL;
+        int nb = 0;
+        if((ret = open_clip(clip)) < 0) {
+            break;
+        }
+        // clips without audio are kept whole
+        if(clip->vid_ctx->audio_stream_idx >= 0) {
+            nb = detect_clip_silence(clip, params, &ranges);
+            if(nb < 0) {
+                ret = nb;
+                break;
+            }
+        }
+        // batched cuts: every part kept is appended once, nothing is ripple deleted
+        int64_t cursor = 0, length = clip->orig_end_pts - clip->orig_start_pts;
+        for(int i = 0; i < nb && ret >= 0; i++) {
+            if(ranges[i].start_pts > cursor) {
+                ret = append_silence_trimmed_clip(out, clip, cursor, ranges[i].start_pts);
+            }
+            cursor = ranges[i].end_pts;
+        }
+        if(ret >= 0 && cursor < length) {
+            ret = append_silence_trimmed_clip(out, clip, cursor, length);
+        }
+        free(ranges);
+        total += nb;
+    }
+    if(ret < 0) {
+        log_error("trim_sequence_silence() error: Failed to trim sequence\n");
+        return ret;
+    }
+    if(seq->clips.head != NULL && (ret = sequence_seek(seq, 0)) < 0) {
+        return ret;
+    }
+    return total;
+}
+
+/**
+ * Free the windows of an envelope
+ * @param env SilenceEnvelope
+ */
+void free_silence_envelope(SilenceEnvelope *env) {
+    free(env->rms);
+    free(env->peak);
+    env->rms = NULL;
+    env->peak = NULL;
+    env->nb = 0;
+    env->size = 0;
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Add the samples of a decoded audio frame to the envelope
+ * @param  env   SilenceEnvelope
+ * @param  frame decoded audio frame
+ * @return       >= 0 on success
+ */
+int add_silence_frame(SilenceEnvelope *env, AVFrame *frame) {
+    int offset = 0;
+    while(offset < frame->nb_samples) {
+        int n = FFMIN(frame->nb_samples - offset, env->window_samples - env->acc_samples);
+        add_silence_samples(env, frame, offset, n);
+        env->acc_samples += n;
+        offset += n;
+        if(env->acc_samples == env->window_samples) {
+            int ret = flush_silence_window(env);
+            if(ret < 0) {
+                return ret;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Add sum of squares and peak of samples [offset, offset+n) of every channel of a frame
+ * @param env    SilenceEnvelope
+ * @param frame  decoded audio frame
+ * @param offset first sample
+ * @param n      number of samples per channel
+ */
+void add_silence_samples(SilenceEnvelope *env, AVFrame *frame, int offset, int n) {
+    enum AVSampleFormat fmt = frame->format;
+    enum AVSampleFormat packed = av_get_packed_sample_fmt(fmt);
+    int bps = av_get_bytes_per_sample(fmt);
+    int channels = frame->channels;
+    // planar: one run of n samples per channel. packed: a single run of n * channels
+    int nb_runs = av_sample_fmt_is_planar(fmt) ? channels : 1;
+    int run_len = av_sample_fmt_is_planar(fmt) ? n : n * channels;
+    int run_offset = av_sample_fmt_is_planar(fmt) ? offset * bps : offset * channels * bps;
+    for(int i = 0; i < nb_runs; i++) {
+        const uint8_t *data = frame->extended_data[i] + run_offset;
+        if(packed == AV_SAMPLE_FMT_FLT) {
+            silence_float_stats((const float *) data, run_len, &(env->acc_sq), &(env->acc_peak));
+        } else if(packed == AV_SAMPLE_FMT_S16) {
+            silence_s16_stats((const int16_t *) data, run_len, &(env->acc_sq), &(env->acc_peak));
+        } else {
+            silence_sample_stats(data, packed, run_len, &(env->acc_sq), &(env->acc_peak));
+        }
+    }
+    env->acc_values += (int64_t) n * channels;
+}
+
+/**
+ * Output the window being filled (when it has samples)
+ * @param  env SilenceEnvelope
+ * @return     >= 0 on success
+ */
+int flush_silence_window(SilenceEnvelope *env) {
+    if(env->acc_samples == 0) {
+        return 0;
+    }
+    if(env->nb == env->size) {
+        int size = env->size > 0 ? env->size * 2 : 1024;
+        float *rms = realloc(env->rms, size * sizeof(float));
+        if(rms == NULL) {
+            log_error("flush_silence_window() error: Failed to grow envelope\n");
+            return AVERROR(ENOMEM);
+        }
+        env->rms = rms;
+        float *peak = realloc(env->peak, size * sizeof(float));
+        if(peak == NULL) {
+            log_error("flush_silence_window() error: Failed to grow envelope\n");
+            return AVERROR(ENOMEM);
+        }
+        env->peak = peak;
+        env->size = size;
+    }
+    env->rms[env->nb] = env->acc_values > 0 ? sqrt(env->acc_sq / env->acc_values) : 0;
+    env->peak[env->nb] = env->acc_peak;
+    ++(env->nb);
+    env->acc_sq = 0;
+    env->acc_peak = 0;
+    env->acc_samples = 0;
+    env->acc_values = 0;
+    return 0;
+}
+
+/**
+ * Find the trimmed ranges of an envelope
+ * @param  env    SilenceEnvelope
+ * @param  params SilenceParams
+ * @param  ranges output array of ranges in samples from the start of the clip
+ * @return        number of ranges, < 0 on error
+ */
+int find_silence_ranges(SilenceEnvelope *env, SilenceParams *params, SilenceRange **ranges) {
+    float threshold = pow(10.0, params->threshold_db / 20.0);
+    int64_t ws = env->window_samples;
+    int64_t min_silence = llrint(params->min_silence * env->sample_rate);
+    int64_t padding = llrint(params->padding * env->sample_rate);
+    int64_t min_keep = llrint(params->min_keep * env->sample_rate);
+    int nb = 0, size = 0;
+    *ranges = NULL;
+    int run_start = -1;
+    for(int i = 0; i <= env->nb; i++) {
+        bool silent = i < env->nb && env->rms[i] < threshold;
+        if(silent) {
+            if(run_start < 0) {
+                run_start = i;
+            }
+            continue;
+        }
+        if(run_start < 0) {
+            continue;
+        }
+        int64_t start = env->start_sample + run_start * ws;
+        int64_t end = env->start_sample + i * ws;
+        // padding only on the side that touches sound (not at the start or end of the clip)
+        if(run_start > 0) {
+            start += padding;
+        }
+        if(i < env->nb) {
+            end -= padding;
+        }
+        start = FFMAX(start, 0);
+        bool long_enough = (i - run_start) * ws >= min_silence;
+        run_start = -1;
+        if(!long_enough || end <= start) {
+            continue;
+        }
+        // merge with the previous range when only a blip of sound is left between them
+        if(nb > 0 && start - (*ranges)[nb - 1].end_pts < min_keep) {
+            (*ranges)[nb - 1].end_pts = end;
+            continue;
+        }
+        if(nb == size) {
+            size = size > 0 ? size * 2 : 16;
+            SilenceRange *r = realloc(*ranges, size * sizeof(SilenceRange));
+            if(r == NULL) {
+                log_error("find_silence_ranges() error: Failed to grow ranges\n");
+                free(*ranges);
+                *ranges = NULL;
+                return AVERROR(ENOMEM);
+            }
+            *ranges = r;
+        }
+        (*ranges)[nb].start_pts = start;
+        (*ranges)[nb].end_pts = end;
+        ++nb;
+    }
+    return nb;
+}
+
+/**
+ * Sum of squares and peak of float samples
+ * @param s      samples
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_float_stats(const float *s, int n, double *sum_sq, float *peak) {
+    int i = 0;
+    double sq = 0;
+    float pk = *peak;
+#ifdef __SSE2__
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 vsq = _mm_setzero_ps();
+    __m128 vpk = _mm_setzero_ps();
+    for(; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(s + i);
+        vsq = _mm_add_ps(vsq, _mm_mul_ps(x, x));
+        vpk = _mm_max_ps(vpk, _mm_and_ps(x, abs_mask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vsq);
+    sq = (double) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_storeu_ps(lanes, vpk);
+    pk = FFMAX(pk, FFMAX(FFMAX(lanes[0], lanes[1]), FFMAX(lanes[2], lanes[3])));
+#endif
+    for(; i < n; i++) {
+        sq += s[i] * s[i];
+        pk = FFMAX(pk, fabsf(s[i]));
+    }
+    *sum_sq += sq;
+    *peak = pk;
+}
+
+/**
+ * Sum of squares and peak of signed 16 bit samples (scaled into -1 to 1)
+ * @param s      samples
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_s16_stats(const int16_t *s, int n, double *sum_sq, float *peak) {
+    int i = 0;
+    double sq = 0;
+    int pk = 0;
+#ifdef __SSE2__
+    __m128 vsq = _mm_setzero_ps();
+    __m128i vmax = _mm_setzero_si128();
+    __m128i vmin = _mm_setzero_si128();
+    for(; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *) (s + i));
+        vmax = _mm_max_epi16(vmax, x);
+        vmin = _mm_min_epi16(vmin, x);
+        // sign extend into two vectors of 32 bit ints, then square as floats
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+        vsq = _mm_add_ps(vsq, _mm_add_ps(_mm_mul_ps(lo, lo), _mm_mul_ps(hi, hi)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vsq);
+    sq = (double) lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    int16_t maxs[8], mins[8];
+    _mm_storeu_si128((__m128i *) maxs, vmax);
+    _mm_storeu_si128((__m128i *) mins, vmin);
+    for(int j = 0; j < 8; j++) {
+        pk = FFMAX(pk, FFMAX(maxs[j], -mins[j]));
+    }
+#endif
+    for(; i < n; i++) {
+        sq += s[i] * s[i];
+        pk = FFMAX(pk, abs(s[i]));
+    }
+    *sum_sq += sq / (32768.0 * 32768.0);
+    *peak = FFMAX(*peak, pk / 32768.0f);
+}
+
+/**
+ * Sum of squares and peak of samples in any other packed format (scaled into -1 to 1)
+ * @param data   samples
+ * @param fmt    packed sample format
+ * @param n      number of samples
+ * @param sum_sq sum of squares (added to)
+ * @param peak   max absolute sample (maxed with)
+ */
+void silence_sample_stats(const uint8_t *data, enum AVSampleFormat fmt, int n, double *sum_sq, float *peak) {
+    for(int i = 0; i < n; i++) {
+        double v;
+        switch(fmt) {
+            case AV_SAMPLE_FMT_U8:
+                v = (data[i] - 128) / 128.0;
+                break;
+            case AV_SAMPLE_FMT_S32:
+                v = ((const int32_t *) data)[i] / 2147483648.0;
+                break;
+            case AV_SAMPLE_FMT_DBL:
+                v = ((const double *) data)[i];
+                break;
+            case AV_SAMPLE_FMT_FLT:
+                v = ((const float *) data)[i];
+                break;
+            case AV_SAMPLE_FMT_S16:
+                v = ((const int16_t *) data)[i] / 32768.0;
+                break;
+            default:
+                return;
+        }
+        *sum_sq += v * v;
+        *peak = FFMAX(*peak, (float) fabs(v));
+    }
+}
+
+/**
+ * Append a copy of part of a clip to a sequence
+ * @param  out   Sequence
+ * @param  clip  source clip
+ * @param  start start of part, in video pts relative to the clip
+ * @param  end   end of part (exclusive)
+ * @return       >= 0 on success
+ */
+int append_silence_trimmed_clip(Sequence *out, Clip *clip, int64_t start, int64_t end) {
+    Clip *copy = copy_clip_vc(clip);
+    if(copy == NULL) {
+        log_error("append_silence_trimmed_clip() error: Failed to copy clip\n");
+        return -1;
+    }
+    int ret = set_clip_bounds_pts(copy, clip->orig_start_pts + start, clip->orig_start_pts + end);
+    if(ret < 0) {
+        log_error("append_silence_trimmed_clip() error: Failed to set bounds [%ld, %ld)\n", start, end);
+        free_clip(&copy);
+        return ret;
+    }
+    sequence_append_clip(out, copy);
+    return 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file SyntheticMedia.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for SyntheticMedia API:
+ * Generates test sources (video and audio) with a controlled codec, resolution,
+ * frame rate (constant or variable), GOP structure, duration and audio format.
+ * Builds on the synthesis in examples/ffmpeg/muxing.c and solidColor.c
+ */
+
+#include "SyntheticMedia.h"
+
+/**
+ * Set default synthetic params: 640x360 MPEG-4 at 30fps, GOP 12 without B frames,
+ * 4 seconds, frame number pattern, 48kHz stereo AAC
+ * @param p SyntheticParams
+ */
+void set_synthetic_params_default(SyntheticParams *p) {
+    p->video_codec_id = AV_CODEC_ID_MPEG4;
+    p->pix_fmt = AV_PIX_FMT_YUV420P;
+    p->width = 640;
+    p->height = 360;
+    p->fps = (AVRational){30, 1};
+    p->vfr = false;
+    p->gop_size = 12;
+    p->max_b_frames = 0;
+    p->bit_rate = 0;
+    p->frame_number_pattern = true;
+    p->duration = 4;
+    p->audio_codec_id = AV_CODEC_ID_AAC;
+    p->sample_rate = 48000;
+    p->channel_layout = AV_CH_LAYOUT_STEREO;
+    p->audio_bit_rate = 128000;
+}
+
+/**
+ * Generate a synthetic media file (container deduced from the filename extension)
+ * @param  filename output filename
+ * @param  p        SyntheticParams
+ * @return          >= 0 on success
+ */
+int generate_synthetic_media(char *filename, SyntheticParams *p) {
+    AVFormatContext *fmt_ctx = NULL;
+    AVCodecContext *vc = NULL, *ac = NULL;
+    AVStream *vs = NULL, *as = NULL;
+    AVFrame *vf = av_frame_alloc(), *af = av_frame_alloc();
+    int ret = avformat_alloc_output_context2(&fmt_ctx, NULL, NULL, filename);
+    if(ret < 0 || vf == NULL || af == NULL) {
+        log_error("generate_synthetic_media() error: Failed to allocate output[%s]\n", filename);
+        if(ret >= 0) {
+            ret = AVERROR(ENOMEM);
+        }
+        goto end;
+    }
+    if(p->video_codec_id != AV_CODEC_ID_NONE) {
+        vc = open_synthetic_encoder(fmt_ctx, p, p->video_codec_id, &vs);
+        if(vc == NULL) {
+            ret = -1;
+            goto end;
+        }
+        vf->format = vc->pix_fmt;
+        vf->width = vc->width;
+        vf->height = vc->height;
+        if((ret = av_frame_get_buffer(vf, 0)) < 0) {
+            goto end;
+        }
+    }
+    if(p->audio_codec_id != AV_CODEC_ID_NONE) {
+        ac = open_synthetic_encoder(fmt_ctx, p, p->audio_codec_id, &as);
+        if(ac == NULL) {
+            ret = -1;
+            goto end;
+        }
+        af->format = ac->sample_fmt;
+        af->channel_layout = ac->channel_layout;
+        af->channels = ac->channels;
+        af->sample_rate = ac->sample_rate;
+        af->nb_samples = ac->frame_size > 0 ? ac->frame_size : 1024;
+        if((ret = av_frame_get_buffer(af, 0)) < 0) {
+            goto end;
+        }
+    }
+    if(!(fmt_ctx->oformat->flags & AVFMT_NOFILE) &&
+        (ret = avio_open(&(fmt_ctx->pb), filename, AVIO_FLAG_WRITE)) < 0) {
+        log_error("generate_synthetic_media() error: Failed to open file[%s]\n", filename);
+        goto end;
+    }
+    if((ret = avformat_write_header(fmt_ctx, NULL)) < 0) {
+        log_error("generate_synthetic_media() error: Failed to write header[%s]\n", filename);
+        goto end;
+    }
+
+    // end of each stream in its encoder time base
+    int64_t video_end = vc != NULL ? (int64_t) (p->duration / av_q2d(vc->time_base)) : 0;
+    int64_t audio_end = ac != NULL ? (int64_t) (p->duration * ac->sample_rate) : 0;
+    int64_t frame_index = 0, video_pts = 0, audio_pts = 0;
+    while(ret >= 0 && (video_pts < video_end || audio_pts < audio_end)) {
+        // interleave video and audio by time
+        bool video_next = video_pts < video_end && (audio_pts >= audio_end ||
+                av_compare_ts(video_pts, vc->time_base, audio_pts, ac->time_base) <= 0);
+        if(video_next) {
+            if((ret = av_frame_make_writable(vf)) < 0 ||
+                (ret = fill_synthetic_video_frame(vf, frame_index, p->frame_number_pattern)) < 0) {
+                break;
+            }
+            vf->pts = video_pts;
+            video_pts += get_synthetic_frame_duration(p, frame_index);
+            ++frame_index;
+            ret = write_synthetic_frame(fmt_ctx, vc, vs, vf);
+        } else {
+            if((ret = av_frame_make_writable(af)) < 0 ||
+                (ret = fill_synthetic_audio_frame(af, audio_pts)) < 0) {
+                break;
+            }
+            af->pts = audio_pts;
+            audio_pts += af->nb_samples;
+            ret = write_synthetic_frame(fmt_ctx, ac, as, af);
+        }
+    }
+    if(ret >= 0 && vc != NULL) {
+        ret = write_synthetic_frame(fmt_ctx, vc, vs, NULL);
+    }
+    if(ret >= 0 && ac != NULL) {
+        ret = write_synthetic_frame(fmt_ctx, ac, as, NULL);
+    }
+    if(ret >= 0) {
+        ret = av_write_trailer(fmt_ctx);
+    }
+    if(ret >= 0) {
+        log_debug("Generated synthetic media[%s]: %ld video frames\n", filename, frame_index);
+    }
+
+    end:
+    if(ret < 0) {
+        log_error("generate_synthetic_media() error: Failed to generate[%s]\n", filename);
+    }
+    av_frame_free(&vf);
+    av_frame_free(&af);
+    avcodec_free_context(&vc);
+    avcodec_free_context(&ac);
+    if(fmt_ctx != NULL) {
+        avio_closep(&(fmt_ctx->pb));
+        avformat_free_context(fmt_ctx);
+    }
+    return ret < 0 ? ret : 0;
+}
+
+/**
+ * Read the frame number embedded in a decoded video frame by generate_synthetic_media().
+ * The frame must keep the aspect ratio of the source and have a planar YUV format
+ * (the pattern survives scaling and lossy compression)
+ * @param  frame decoded video frame
+ * @return       frame number, < 0 if the frame has no readable pattern
+ */
+int64_t read_frame_number_pattern(AVFrame *frame) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    int block = frame->width / SYNTH_PATTERN_BITS;
+    if(desc == NULL || (desc->flags & AV_PIX_FMT_FLAG_RGB) || !(desc->flags & AV_PIX_FMT_FLAG_PLANAR) ||
+        desc->comp[0].depth != 8 || block < 2 || frame->height < block) {
+        return -1;
+    }
+    int64_t number = 0;
+    for(int bit = 0; bit < SYNTH_PATTERN_BITS; bit++) {
+        // average the center half of the block (edges bleed with lossy compression)
+        int sum = 0, count = 0;
+        for(int y = block / 4; y < block - block / 4; y++) {
+            uint8_t *row = frame->data[0] + y * frame->linesize[0] + bit * block;
+            for(int x = block / 4; x < block - block / 4; x++) {
+                sum += row[x];
+                ++count;
+            }
+        }
+        if(sum / count > (SYNTH_PATTERN_BLACK + SYNTH_PATTERN_WHITE) / 2) {
+            number |= (int64_t) 1 << bit;
+        }
+    }
+    return number;
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Allocate a stream and open its encoder
+ * @param  fmt_ctx  output format context
+ * @param  p        SyntheticParams
+ * @param  codec_id codec of stream (video or audio)
+ * @param  stream   output stream allocated
+ * @return          opened encoder or NULL on fail
+ */
+AVCodecContext *open_synthetic_encoder(AVFormatContext *fmt_ctx, SyntheticParams *p,
+                                        enum AVCodecID codec_id, AVStream **stream) {
+    AVCodec *codec = avcodec_find_encoder(codec_id);
+    if(codec == NULL) {
+        log_error("open_synthetic_encoder() error: Encoder[%s] not found\n", avcodec_get_name(codec_id));
+        return NULL;
+    }
+    *stream = avformat_new_stream(fmt_ctx, NULL);
+    AVCodecContext *c = avcodec_alloc_context3(codec);
+    if(*stream == NULL || c == NULL) {
+        log_error("open_synthetic_encoder() error: Failed to allocate stream\n");
+        avcodec_free_context(&c);
+        return NULL;
+    }
+    if(codec->type == AVMEDIA_TYPE_VIDEO) {
+        c->width = p->width;
+        c->height = p->height;
+        c->pix_fmt = p->pix_fmt;
+        c->framerate = p->fps;
+        c->time_base = av_inv_q(p->fps);
+        if(p->vfr) {
+            c->time_base.den *= SYNTH_VFR_TICKS;
+        }
+        c->gop_size = p->gop_size;
+        c->max_b_frames = p->max_b_frames;
+        if(p->bit_rate > 0) {
+            c->bit_rate = p->bit_rate;
+        }
+    } else if(codec->type == AVMEDIA_TYPE_AUDIO) {
+        c->sample_fmt = codec->sample_fmts != NULL ? codec->sample_fmts[0] : AV_SAMPLE_FMT_FLTP;
+        c->sample_rate = p->sample_rate;
+        c->channel_layout = p->channel_layout;
+        c->channels = av_get_channel_layout_nb_channels(p->channel_layout);
+        c->time_base = (AVRational){1, p->sample_rate};
+        c->bit_rate = p->audio_bit_rate;
+    } else {
+        log_error("open_synthetic_encoder() error: Codec[%s] is not video or audio\n", codec->name);
+        avcodec_free_context(&c);
+        return NULL;
+    }
+    if(fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) {
+        c->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    int ret = avcodec_open2(c, codec, NULL);
+    if(ret >= 0) {
+        ret = avcodec_parameters_from_context((*stream)->codecpar, c);
+    }
+    if(ret < 0) {
+        log_error("open_synthetic_encoder() error: Failed to open encoder[%s]: %s\n", codec->name, av_err2str(ret));
+        avcodec_free_context(&c);
+        return NULL;
+    }
+    (*stream)->time_base = c->time_base;
+    if(codec->type == AVMEDIA_TYPE_VIDEO) {
+        (*stream)->avg_frame_rate = p->fps;
+    }
+    return c;
+}
+
+/**
+ * Get the duration of a video frame in time base ticks (SYNTH_VFR_TICKS per nominal frame)
+ * @param  p           SyntheticParams
+ * @param  frame_index index of frame
+ * @return             duration of frame
+ */
+int get_synthetic_frame_duration(SyntheticParams *p, int64_t frame_index) {
+    if(!p->vfr) {
+        return 1;
+    }
+    // deterministic pseudo random duration between 1/2 and 3/2 of a nominal frame
+    uint32_t h = (uint32_t) frame_index * 2654435761u;
+    return SYNTH_VFR_TICKS / 2 + (h >> 16) % (SYNTH_VFR_TICKS + 1);
+}
+
+/**
+ * Draw a moving gradient and the frame number pattern into a video frame
+ * @param  frame        writable video frame
+ * @param  frame_index  index of frame
+ * @param  pattern      true to draw the frame number pattern
+ * @return              >= 0 on success
+ */
+int fill_synthetic_video_frame(AVFrame *frame, int64_t frame_index, bool pattern) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    if(desc == NULL || (desc->flags & AV_PIX_FMT_FLAG_RGB) || !(desc->flags & AV_PIX_FMT_FLAG_PLANAR) ||
+        desc->comp[0].depth != 8) {
+        log_error("fill_synthetic_video_frame() error: pixel format must be 8 bit planar YUV\n");
+        return -1;
+    }
+    // luma gradient moving right, chroma changing over time
+    for(int y = 0; y < frame->height; y++) {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        for(int x = 0; x < frame->width; x++) {
+            row[x] = x + y + frame_index * 3;
+        }
+    }
+    int cw = AV_CEIL_RSHIFT(frame->width, desc->log2_chroma_w);
+    int ch = AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h);
+    for(int y = 0; y < ch; y++) {
+        memset(frame->data[1] + y * frame->linesize[1], 128 + y + frame_index * 2, cw);
+        memset(frame->data[2] + y * frame->linesize[2], 64 + frame_index * 5, cw);
+    }
+    if(pattern) {
+        // one block per bit in the top row, white for 1 and black for 0 (neutral chroma)
+        int block = frame->width / SYNTH_PATTERN_BITS;
+        for(int bit = 0; bit < SYNTH_PATTERN_BITS && block > 0; bit++) {
+            uint8_t luma = (frame_index >> bit) & 1 ? SYNTH_PATTERN_WHITE : SYNTH_PATTERN_BLACK;
+            for(int y = 0; y < block && y < frame->height; y++) {
+                memset(frame->data[0] + y * frame->linesize[0] + bit * block, luma, block);
+            }
+            int cx = bit * block >> desc->log2_chroma_w, cb = block >> desc->log2_chroma_w;
+            for(int y = 0; y < (block >> desc->log2_chroma_h); y++) {
+                memset(frame->data[1] + y * frame->linesize[1] + cx, 128, cb);
+                memset(frame->data[2] + y * frame->linesize[2] + cx, 128, cb);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Fill an audio frame with a 440Hz tone (float and signed 16 bit, planar or packed)
+ * @param  frame        writable audio frame
+ * @param  sample_index index of first sample in frame
+ * @return              >= 0 on success
+ */
+int fill_synthetic_audio_frame(AVFrame *frame, int64_t sample_index) {
+    enum AVSampleFormat fmt = frame->format;
+    bool planar = av_sample_fmt_is_planar(fmt);
+    enum AVSampleFormat packed = av_get_packed_sample_fmt(fmt);
+    if(packed != AV_SAMPLE_FMT_FLT && packed != AV_SAMPLE_FMT_S16) {
+        log_error("fill_synthetic_audio_frame() error: unsupported sample format[%s]\n",
+                    av_get_sample_fmt_name(fmt));
+        return -1;
+    }
+    for(int i = 0; i < frame->nb_samples; i++) {
+        float v = 0.2f * sinf(2 * M_PI * 440 * (sample_index + i) / frame->sample_rate);
+        for(int c = 0; c < frame->channels; c++) {
+            int plane = planar ? c : 0;
+            int idx = planar ? i : i * frame->channels + c;
+            if(packed == AV_SAMPLE_FMT_FLT) {
+                ((float *) frame->extended_data[plane])[idx] = v;
+            } else {
+                ((int16_t *) frame->extended_data[plane])[idx] = (int16_t) (v * INT16_MAX);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Send a frame (NULL to flush) to an encoder and write every packet it returns
+ * @param  fmt_ctx  output format context
+ * @param  c        encoder
+ * @param  stream   output stream of encoder
+ * @param  frame    frame to encode, NULL to flush
+ * @return          >= 0 on success
+ */
+int write_synthetic_frame(AVFormatContext *fmt_ctx, AVCodecContext *c, AVStream *stream, AVFrame *frame) {
+    int ret = avcodec_send_frame(c, frame);
+    if(ret < 0) {
+        log_error("write_synthetic_frame() error: Failed to send frame to encoder: %s\n", av_err2str(ret));
+        return ret;
+    }
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    while((ret = avcodec_receive_packet(c, &pkt)) >= 0) {
+        av_packet_rescale_ts(&pkt, c->time_base, stream->time_base);
+        pkt.stream_index = stream->index;
+        ret = av_interleaved_write_frame(fmt_ctx, &pkt);
+        if(ret < 0) {
+            log_error("write_synthetic_frame() error: Failed to write packet: %s\n", av_err2str(ret));
+            return ret;
+        }
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file ThreadPool.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the source for ThreadPool API:
+ * A fixed set of worker threads used to split work (such as frame slices)
+ * across cpu cores. The calling thread takes part in the work.
+ */
+
+#include "ThreadPool.h"
+#include <unistd.h>
+
+/**
+ * Initialize a thread pool and start the worker threads
+ * @param  tp          ThreadPool
+ * @param  nb_threads  total number of threads to use, including the calling thread.
+ *                     <= 0 will use one thread per cpu core
+ * @return             >= 0 on success
+ */
+int init_thread_pool(ThreadPool *tp, int nb_threads) {
+    if(tp == NULL) {
+        log_error("init_thread_pool() error: Invalid params\n");
+        return -1;
+    }
+    if(nb_threads <= 0) {
+        nb_threads = get_cpu_count();
+    }
+    tp->threads = NULL;
+    tp->nb_threads = 0;
+    tp->job = NULL;
+    tp->arg = NULL;
+    tp->nb_jobs = 0;
+    tp->next_job = 0;
+    tp->jobs_done = 0;
+    tp->exit = false;
+    pthread_mutex_init(&(tp->lock), NULL);
+    pthread_cond_init(&(tp->work_cond), NULL);
+    pthread_cond_init(&(tp->done_cond), NULL);
+
+    if(nb_threads > 1) {
+        tp->threads = malloc(sizeof(pthread_t) * (nb_threads - 1));
+        if(tp->threads == NULL) {
+            log_error("init_thread_pool() error: Failed to allocate threads\n");
+            free_thread_pool(tp);
+            return -1;
+        }
+    }
+    for(int i = 0; i < nb_threads - 1; i++) {
+        ThreadPoolWorker *wa = malloc(sizeof(struct ThreadPoolWorker));
+        if(wa == NULL) {
+            log_error("init_thread_pool() error: Failed to allocate worker arg\n");
+            free_thread_pool(tp);
+            return -1;
+        }
+        wa->tp = tp;
+        wa->thread_idx = i;
+        if(pthread_create(&(tp->threads[i]), NULL, &thread_pool_worker, wa) != 0) {
+            log_error("init_thread_pool() error: Failed to create thread[%d]\n", i);
+            free(wa);
+            free_thread_pool(tp);
+            return -1;
+        }
+        ++(tp->nb_threads);
+    }
+    return 0;
+}
+
+/**
+ * Run nb_jobs jobs across all threads of the pool (and the calling thread).
+ * Blocks until every job is complete
+ * @param  tp      ThreadPool
+ * @param  job     function to run once per job index
+ * @param  arg     user data passed to job
+ * @param  nb_jobs number of jobs
+ * @return         >= 0 on success
+ */
+int thread_pool_execute(ThreadPool *tp, ThreadPoolJob job, void *arg, int nb_jobs) {
+    if(tp == NULL || job == NULL) {
+        log_error("thread_pool_execute() error: Invalid params\n");
+        return -1;
+    }
+    // no workers, or nothing to share: run on the calling thread
+    if(tp->nb_threads == 0 || nb_jobs <= 1) {
+        for(int i = 0; i < nb_jobs; i++) {
+            job(arg, i, tp->nb_threads);
+        }
+        return 0;
+    }
+    pthread_mutex_lock(&(tp->lock));
+    tp->job = job;
+    tp->arg = arg;
+    tp->nb_jobs = nb_jobs;
+    tp->next_job = 0;
+    tp->jobs_done = 0;
+    pthread_cond_broadcast(&(tp->work_cond));
+
+    // calling thread takes part in the work
+    thread_pool_run_jobs(tp, tp->nb_threads);
+    while(tp->jobs_done < tp->nb_jobs) {
+        pthread_cond_wait(&(tp->done_cond), &(tp->lock));
+    }
+    tp->nb_jobs = 0;
+    tp->next_job = 0;
+    pthread_mutex_unlock(&(tp->lock));
+    return 0;
+}
+
+/**
+ * Get the total number of threads used by the pool (including the calling thread)
+ * @param  tp ThreadPool
+ * @return    number of threads
+ */
+int get_thread_pool_size(ThreadPool *tp) {
+    return tp->nb_threads + 1;
+}
+
+/**
+ * Stop and join the worker threads and free thread pool data
+ * @param tp ThreadPool
+ */
+void free_thread_pool(ThreadPool *tp) {
+    if(tp == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&(tp->lock));
+    tp->exit = true;
+    pthread_cond_broadcast(&(tp->work_cond));
+    pthread_mutex_unlock(&(tp->lock));
+    for(int i = 0; i < tp->nb_threads; i++) {
+        pthread_join(tp->threads[i], NULL);
+    }
+    free(tp->threads);
+    tp->threads = NULL;
+    tp->nb_threads = 0;
+    pthread_mutex_destroy(&(tp->lock));
+    pthread_cond_destroy(&(tp->work_cond));
+    pthread_cond_destroy(&(tp->done_cond));
+}
+
+/**
+ * Get the number of online cpu cores
+ * @return number of cores (>= 1)
+ */
+int get_cpu_count() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Take and run jobs from the current batch until there are none left.
+ * Must be called with tp->lock held, returns with tp->lock held
+ * @param tp         ThreadPool
+ * @param thread_idx index of the thread running the jobs
+ */
+void thread_pool_run_jobs(ThreadPool *tp, int thread_idx) {
+    while(tp->next_job < tp->nb_jobs) {
+        int job_idx = tp->next_job++;
+        pthread_mutex_unlock(&(tp->lock));
+        tp->job(tp->arg, job_idx, thread_idx);
+        pthread_mutex_lock(&(tp->lock));
+        if(++(tp->jobs_done) == tp->nb_jobs) {
+            pthread_cond_signal(&(tp->done_cond));
+        }
+    }
+}
+
+/**
+ * Worker thread main loop. Waits for a batch of jobs and helps run it
+ * @param  arg ThreadPoolWorker allocated on heap (freed by this function)
+ * @return     NULL
+ */
+void *thread_pool_worker(void *arg) {
+    ThreadPoolWorker w = *((ThreadPoolWorker *) arg);
+    free(arg);
+    ThreadPool *tp = w.tp;
+    pthread_mutex_lock(&(tp->lock));
+    while(true) {
+        while(!tp->exit && tp->next_job >= tp->nb_jobs) {
+            pthread_cond_wait(&(tp->work_cond), &(tp->lock));
+        }
+        if(tp->exit) {
+            break;
+        }
+        thread_pool_run_jobs(tp, w.thread_idx);
+    }
+    pthread_mutex_unlock(&(tp->lock));
+    return NULL;
+}
@@ -0,0 +1,518 @@
+/**
+ * @file Thumbnail.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for Thumbnail API:
+ * Frame accurate thumbnails of many sequence or source frames at once.
+ * Requests are grouped by file and GOP (so each GOP is decoded once) and the groups
+ * are decoded in parallel, each thread with its own VideoContext.
+ */
+
+#include "Thumbnail.h"
+
+/**
+ * Set default thumbnail parameters (160 pixels wide RGB24, one thread per cpu core)
+ * @param params ThumbnailParams
+ */
+void set_thumbnail_params_default(ThumbnailParams *params) {
+    params->width = 160;
+    params->height = -1;
+    params->format = THUMBNAIL_RGB24;
+    params->jpeg_quality = 5;
+    params->lowres = 0;
+    params->fast_decode = false;
+    params->nb_threads = 0;
+}
+
+/**
+ * Initialize an empty thumbnail request
+ * @param t Thumbnail
+ */
+void init_thumbnail(Thumbnail *t) {
+    t->url = NULL;
+    t->frame_index = -1;
+    t->pts = -1;
+    t->frame = NULL;
+    t->jpeg = NULL;
+    t->ret = -1;
+    t->key_pts = -1;
+}
+
+/**
+ * Request a thumbnail of a source file frame
+ * @param  t           Thumbnail initialized with init_thumbnail()
+ * @param  url         filename
+ * @param  frame_index index of frame in the file
+ * @return             >= 0 on success
+ */
+int set_source_thumbnail(Thumbnail *t, char *url, int64_t frame_index) {
+    if(url == NULL || frame_index < 0) {
+        log_error("set_source_thumbnail() error: Invalid params\n");
+        return -1;
+    }
+    free(t->url);
+    t->url = strdup(url);
+    if(t->url == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    t->frame_index = frame_index;
+    t->pts = -1;
+    return 0;
+}
+
+/**
+ * Request a thumbnail of a sequence frame (the frame of the clip at this index).
+ * Uses the proxy of the clip when the sequence is using proxies
+ * @param  t           Thumbnail initialized with init_thumbnail()
+ * @param  seq         Sequence
+ * @param  frame_index index of frame in sequence
+ * @return             >= 0 on success
+ */
+int set_sequence_thumbnail(Thumbnail *t, Sequence *seq, int frame_index) {
+    Clip *clip = NULL;
+    int64_t clip_pts = find_clip_at_index(seq, frame_index, &clip);
+    if(clip == NULL || clip_pts < 0) {
+        log_error("set_sequence_thumbnail() error: No clip at sequence frame[%d]\n", frame_index);
+        return -1;
+    }
+    free(t->url);
+    t->url = strdup(get_video_context_url(clip->vid_ctx));
+    if(t->url == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    t->frame_index = -1;
+    t->pts = get_abs_clip_pts(clip, clip_pts);
+    return 0;
+}
+
+/**
+ * Extract thumbnails. Requests are grouped by file and GOP, and groups are decoded
+ * across threads (each with its own VideoContext)
+ * @param  thumbs array of requests
+ * @param  nb     number of requests
+ * @param  params ThumbnailParams
+ * @return        number of thumbnails that failed (see Thumbnail.ret), < 0 on error
+ */
+int extract_thumbnails(Thumbnail *thumbs, int nb, ThumbnailParams *params) {
+    if(thumbs == NULL || params == NULL || nb < 0 || params->width <= 0) {
+        log_error("extract_thumbnails() error: Invalid params\n");
+        return -1;
+    }
+    if(nb == 0) {
+        return 0;
+    }
+    ThreadPool tp;
+    ThumbnailJobs jobs;
+    jobs.params = params;
+    jobs.order = malloc(sizeof(Thumbnail *) * nb);
+    jobs.groups = malloc(sizeof(struct ThumbnailGroup) * nb);
+    jobs.nb_groups = 0;
+    jobs.workers = NULL;
+    int ret = init_thread_pool(&tp, params->nb_threads);
+    int nb_workers = get_thread_pool_size(&tp);
+    if(ret >= 0) {
+        jobs.workers = malloc(sizeof(struct ThumbnailWorker) * nb_workers);
+    }
+    if(ret < 0 || jobs.order == NULL || jobs.groups == NULL || jobs.workers == NULL) {
+        log_error("extract_thumbnails() error: Failed to allocate jobs\n");
+        if(ret >= 0) {
+            free_thread_pool(&tp);
+        }
+        free(jobs.order);
+        free(jobs.groups);
+        free(jobs.workers);
+        return -1;
+    }
+    for(int i = 0; i < nb_workers; i++) {
+        ThumbnailWorker *w = &(jobs.workers[i]);
+        init_video_context(&(w->vid_ctx));
+        w->url = NULL;
+        init_video_converter(&(w->convert));
+        w->jpeg_ctx = NULL;
+        w->frame = av_frame_alloc();
+    }
+    for(int i = 0; i < nb; i++) {
+        thumbs[i].ret = thumbs[i].url != NULL ? 0 : -1;
+        thumbs[i].key_pts = -1;
+        jobs.order[i] = &(thumbs[i]);
+    }
+
+    // find the pts and key frame of every request (one job per file)
+    qsort(jobs.order, nb, sizeof(Thumbnail *), &compare_thumbnails);
+    group_thumbnails(&jobs, nb, false);
+    thread_pool_execute(&tp, &resolve_thumbnail_file, &jobs, jobs.nb_groups);
+
+    // decode each GOP once (one job per GOP)
+    qsort(jobs.order, nb, sizeof(Thumbnail *), &compare_thumbnails);
+    group_thumbnails(&jobs, nb, true);
+    log_debug("extract_thumbnails(): %d thumbnails in %d GOPs on %d threads\n", nb, jobs.nb_groups, nb_workers);
+    thread_pool_execute(&tp, &decode_thumbnail_group, &jobs, jobs.nb_groups);
+
+    int failed = 0;
+    for(int i = 0; i < nb; i++) {
+        if(thumbs[i].ret < 0 || thumbs[i].ret == THUMBNAIL_PENDING) {
+            if(thumbs[i].ret == THUMBNAIL_PENDING) {
+                thumbs[i].ret = AVERROR_EOF;
+            }
+            ++failed;
+        }
+    }
+    if(failed > 0) {
+        log_warning("extract_thumbnails(): %d of %d thumbnails failed\n", failed, nb);
+    }
+    for(int i = 0; i < nb_workers; i++) {
+        close_thumbnail_worker(&(jobs.workers[i]));
+        av_frame_free(&(jobs.workers[i].frame));
+    }
+    free_thread_pool(&tp);
+    free(jobs.order);
+    free(jobs.groups);
+    free(jobs.workers);
+    return failed;
+}
+
+/**
+ * Write a JPEG thumbnail to a file
+ * @param  t        Thumbnail extracted as THUMBNAIL_JPEG
+ * @param  filename output filename
+ * @return          >= 0 on success
+ */
+int write_thumbnail_jpeg(Thumbnail *t, char *filename) {
+    if(t->jpeg == NULL || t->jpeg->size <= 0) {
+        log_error("write_thumbnail_jpeg() error: Thumbnail has no JPEG image\n");
+        return -1;
+    }
+    FILE *f = fopen(filename, "wb");
+    if(f == NULL) {
+        log_error("write_thumbnail_jpeg() error: Failed to open file[%s]\n", filename);
+        return -1;
+    }
+    size_t written = fwrite(t->jpeg->data, 1, t->jpeg->size, f);
+    fclose(f);
+    return written == (size_t) t->jpeg->size ? 0 : -1;
+}
+
+/**
+ * Free thumbnail request and result
+ * @param t Thumbnail
+ */
+void free_thumbnail(Thumbnail *t) {
+    free(t->url);
+    t->url = NULL;
+    av_frame_free(&(t->frame));
+    av_packet_free(&(t->jpeg));
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Compare two requests by url, key_pts and pts (qsort of Thumbnail pointers)
+ * @param  first  Thumbnail **
+ * @param  second Thumbnail **
+ * @return        < 0, 0 or > 0 as strcmp
+ */
+int compare_thumbnails(const void *first, const void *second) {
+    Thumbnail *f = *((Thumbnail **) first);
+    Thumbnail *s = *((Thumbnail **) second);
+    if(f->url == NULL || s->url == NULL) {
+        return (f->url == NULL) - (s->url == NULL);
+    }
+    int cmp = strcmp(f->url, s->url);
+    if(cmp != 0) {
+        return cmp;
+    }
+    if(f->key_pts != s->key_pts) {
+        return f->key_pts < s->key_pts ? -1 : 1;
+    }
+    if(f->pts != s->pts) {
+        return f->pts < s->pts ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Split the sorted requests into groups of the same file (and the same GOP)
+ * @param jobs   ThumbnailJobs with sorted requests
+ * @param nb     number of requests
+ * @param by_gop true to split files into GOPs
+ */
+void group_thumbnails(ThumbnailJobs *jobs, int nb, bool by_gop) {
+    jobs->nb_groups = 0;
+    for(int i = 0; i < nb; i++) {
+        Thumbnail *t = jobs->order[i];
+        if(t->url == NULL) {
+            continue;
+        }
+        ThumbnailGroup *last = jobs->nb_groups > 0 ? &(jobs->groups[jobs->nb_groups - 1]) : NULL;
+        if(last != NULL) {
+            Thumbnail *first = jobs->order[last->start];
+            if(strcmp(first->url, t->url) == 0 && (!by_gop || first->key_pts == t->key_pts)) {
+                ++(last->nb);
+                continue;
+            }
+        }
+        jobs->groups[jobs->nb_groups].start = i;
+        jobs->groups[jobs->nb_groups].nb = 1;
+        ++(jobs->nb_groups);
+    }
+}
+
+/**
+ * Open a file in a worker (nothing is done if the file is already open)
+ * @param  w      ThumbnailWorker
+ * @param  url    filename
+ * @param  params ThumbnailParams
+ * @return        >= 0 on success
+ */
+int open_thumbnail_worker(ThumbnailWorker *w, char *url, ThumbnailParams *params) {
+    if(w->vid_ctx.open && w->url != NULL && strcmp(w->url, url) == 0) {
+        return 0;
+    }
+    close_video_context(&(w->vid_ctx));
+    init_video_context(&(w->vid_ctx));
+    w->vid_ctx.lowres = params->lowres;
+    w->vid_ctx.fast_decode = params->fast_decode;
+    w->url = url;
+    int ret = open_video_context(&(w->vid_ctx), url);
+    if(ret < 0) {
+        log_error("open_thumbnail_worker() error: Failed to open[%s]\n", url);
+        close_video_context(&(w->vid_ctx));
+        w->url = NULL;
+        return ret;
+    }
+    // thumbnails only need video packets
+    set_stream_discard(&(w->vid_ctx), w->vid_ctx.audio_stream_idx, true);
+    return 0;
+}
+
+/**
+ * Close the file, converter and encoder of a worker
+ * @param w ThumbnailWorker
+ */
+void close_thumbnail_worker(ThumbnailWorker *w) {
+    close_video_context(&(w->vid_ctx));
+    w->url = NULL;
+    close_video_converter(&(w->convert));
+    avcodec_free_context(&(w->jpeg_ctx));
+}
+
+/**
+ * ThreadPoolJob finding the pts and key frame of every request of a file
+ * @param arg        ThumbnailJobs
+ * @param job_idx    index of file group
+ * @param thread_idx index of worker
+ */
+void resolve_thumbnail_file(void *arg, int job_idx, int thread_idx) {
+    ThumbnailJobs *jobs = (ThumbnailJobs *) arg;
+    ThumbnailGroup *g = &(jobs->groups[job_idx]);
+    Thumbnail **thumbs = jobs->order + g->start;
+    ThumbnailWorker *w = &(jobs->workers[thread_idx]);
+    int ret = open_thumbnail_worker(w, thumbs[0]->url, jobs->params);
+    for(int i = 0; i < g->nb; i++) {
+        Thumbnail *t = thumbs[i];
+        if(ret < 0) {
+            t->ret = ret;
+            continue;
+        }
+        if(t->pts < 0) {
+            t->pts = get_video_frame_pts(&(w->vid_ctx), t->frame_index);
+        }
+        if(t->pts < 0) {
+            log_error("resolve_thumbnail_file() error: Invalid frame[%ld] of [%s]\n", t->frame_index, t->url);
+            t->ret = -1;
+            continue;
+        }
+        t->key_pts = get_thumbnail_key_pts(&(w->vid_ctx), t->pts);
+        t->ret = THUMBNAIL_PENDING;
+    }
+}
+
+/**
+ * Get pts of the key frame at or before pts (from the index of the demuxer)
+ * @param  vid_ctx opened VideoContext
+ * @param  pts     pts in video time base
+ * @return         pts of key frame, pts itself when the file has no index
+ */
+int64_t get_thumbnail_key_pts(VideoContext *vid_ctx, int64_t pts) {
+    int64_t key_pts = get_video_key_frame_pts(vid_ctx, pts);
+    // no index: every request is decoded on its own
+    return key_pts < 0 ? pts : key_pts;
+}
+
+/**
+ * ThreadPoolJob decoding a GOP once and extracting every thumbnail requested in it
+ * @param arg        ThumbnailJobs
+ * @param job_idx    index of GOP group
+ * @param thread_idx index of worker
+ */
+void decode_thumbnail_group(void *arg, int job_idx, int thread_idx) {
+    ThumbnailJobs *jobs = (ThumbnailJobs *) arg;
+    ThumbnailGroup *g = &(jobs->groups[job_idx]);
+    Thumbnail **thumbs = jobs->order + g->start;
+    ThumbnailWorker *w = &(jobs->workers[thread_idx]);
+    // skip requests that failed to resolve
+    int start = 0;
+    while(start < g->nb && thumbs[start]->ret != THUMBNAIL_PENDING) {
+        ++start;
+    }
+    if(start == g->nb) {
+        return;
+    }
+    int ret = open_thumbnail_worker(w, thumbs[start]->url, jobs->params);
+    if(ret >= 0) {
+        ret = decode_thumbnails(w, jobs->params, thumbs + start, g->nb - start);
+    }
+    for(int i = start; i < g->nb; i++) {
+        if(thumbs[i]->ret == THUMBNAIL_PENDING) {
+            thumbs[i]->ret = ret < 0 ? ret : AVERROR_EOF;
+        }
+    }
+}
+
+/**
+ * Seek to the first request, then decode until every request has its frame
+ * (the first frame at or after the pts of the request)
+ * @param  w      ThumbnailWorker with the file open
+ * @param  params ThumbnailParams
+ * @param  thumbs requests sorted by pts
+ * @param  nb     number of requests
+ * @return        >= 0 on success
+ */
+int decode_thumbnails(ThumbnailWorker *w, ThumbnailParams *params, Thumbnail **thumbs, int nb) {
+    VideoContext *vc = &(w->vid_ctx);
+    AVCodecContext *dec = vc->video_codec_ctx;
+    int ret = seek_video_pts(vc, thumbs[0]->pts);
+    if(ret < 0) {
+        log_error("decode_thumbnails() error: Failed to seek to pts[%ld] in [%s]\n", thumbs[0]->pts, w->url);
+        return ret;
+    }
+    avcodec_flush_buffers(dec);
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    int next = 0;
+    bool eof = false;
+    while(next < nb && !(eof && ret == AVERROR_EOF)) {
+        if(!eof) {
+            ret = av_read_frame(vc->fmt_ctx, &pkt);
+            if(ret == AVERROR_EOF) {
+                eof = true;
+                ret = avcodec_send_packet(dec, NULL);
+            } else if(ret < 0) {
+                break;
+            } else if(pkt.stream_index != vc->video_stream_idx) {
+                av_packet_unref(&pkt);
+                continue;
+            } else {
+                ret = avcodec_send_packet(dec, &pkt);
+                av_packet_unref(&pkt);
+            }
+            if(ret < 0) {
+                log_error("decode_thumbnails() error: Failed to send packet (%s)\n", av_err2str(ret));
+                break;
+            }
+        }
+        while(next < nb && (ret = avcodec_receive_frame(dec, w->frame)) >= 0) {
+            int64_t pts = w->frame->best_effort_timestamp;
+            // every request at or before this frame gets it (earlier frames are pre-roll)
+            while(next < nb && thumbs[next]->pts <= pts) {
+                thumbs[next]->ret = output_thumbnail(w, params, w->frame, thumbs[next]);
+                ++next;
+            }
+            av_frame_unref(w->frame);
+        }
+        if(ret == AVERROR(EAGAIN)) {
+            ret = 0;
+        } else if(ret < 0 && ret != AVERROR_EOF) {
+            log_error("decode_thumbnails() error: Failed to decode frame (%s)\n", av_err2str(ret));
+            break;
+        }
+    }
+    av_frame_unref(w->frame);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+/**
+ * Scale a decoded frame into a thumbnail (and encode it in JPEG format)
+ * @param  w      ThumbnailWorker
+ * @param  params ThumbnailParams
+ * @param  frame  decoded frame (replaced by the scaled frame)
+ * @param  t      Thumbnail to set
+ * @return        >= 0 on success
+ */
+int output_thumbnail(ThumbnailWorker *w, ThumbnailParams *params, AVFrame *frame, Thumbnail *t) {
+    // size from the stream (not the frame) so every thumbnail of a file matches
+    AVCodecParameters *par = get_video_stream(&(w->vid_ctx))->codecpar;
+    int width = params->width & ~1;
+    int height = params->height > 0 ? params->height :
+                 (int) av_rescale(width, par->height, FFMAX(par->width, 1)) & ~1;
+    enum AVPixelFormat pix_fmt = params->format == THUMBNAIL_JPEG ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_RGB24;
+    int ret;
+    if(!w->convert.open || w->convert.width != width || w->convert.height != height) {
+        close_video_converter(&(w->convert));
+        init_video_converter(&(w->convert));
+        // each worker is already one thread of the pool: convert on this thread
+        if((ret = open_video_converter(&(w->convert), width, height, pix_fmt, 1)) < 0) {
+            return ret;
+        }
+    }
+    if((ret = convert_video_frame(&(w->convert), frame)) < 0) {
+        return ret;
+    }
+    if(params->format == THUMBNAIL_RGB24) {
+        av_frame_free(&(t->frame));
+        t->frame = av_frame_clone(frame);
+        return t->frame != NULL ? 0 : AVERROR(ENOMEM);
+    }
+    if((ret = open_thumbnail_encoder(w, params, width, height)) < 0) {
+        return ret;
+    }
+    frame->quality = w->jpeg_ctx->global_quality;
+    frame->pict_type = AV_PICTURE_TYPE_I;
+    if((ret = avcodec_send_frame(w->jpeg_ctx, frame)) < 0) {
+        log_error("output_thumbnail() error: Failed to encode thumbnail (%s)\n", av_err2str(ret));
+        return ret;
+    }
+    if(t->jpeg == NULL && (t->jpeg = av_packet_alloc()) == NULL) {
+        return AVERROR(ENOMEM);
+    }
+    av_packet_unref(t->jpeg);
+    ret = avcodec_receive_packet(w->jpeg_ctx, t->jpeg);
+    if(ret < 0) {
+        log_error("output_thumbnail() error: Failed to get JPEG (%s)\n", av_err2str(ret));
+    }
+    return ret;
+}
+
+/**
+ * Open (or reopen at a new size) the JPEG encoder of a worker
+ * @param  w      ThumbnailWorker
+ * @param  params ThumbnailParams
+ * @param  width  width of thumbnails
+ * @param  height height of thumbnails
+ * @return        >= 0 on success
+ */
+int open_thumbnail_encoder(ThumbnailWorker *w, ThumbnailParams *params, int width, int height) {
+    if(w->jpeg_ctx != NULL && w->jpeg_ctx->width == width && w->jpeg_ctx->height == height) {
+        return 0;
+    }
+    avcodec_free_context(&(w->jpeg_ctx));
+    AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if(codec == NULL || (w->jpeg_ctx = avcodec_alloc_context3(codec)) == NULL) {
+        log_error("open_thumbnail_encoder() error: Failed to allocate JPEG encoder\n");
+        return -1;
+    }
+    AVCodecContext *c = w->jpeg_ctx;
+    c->width = width;
+    c->height = height;
+    c->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    c->time_base = (AVRational){1, 25};
+    c->flags |= AV_CODEC_FLAG_QSCALE;
+    c->global_quality = FF_QP2LAMBDA * av_clip(params->jpeg_quality, 2, 31);
+    int ret = avcodec_open2(c, codec, NULL);
+    if(ret < 0) {
+        log_error("open_thumbnail_encoder() error: Failed to open JPEG encoder (%s)\n", av_err2str(ret));
+        avcodec_free_context(&(w->jpeg_ctx));
+    }
+    return ret;
+}
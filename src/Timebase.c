@@ -20,7 +20,7 @@ int64_t cov_video_pts(VideoContext *vid_ctx, int64_t pts) {
     }
     AVStream *video_stream = get_video_stream(vid_ctx);
     if(!video_stream) {
-        fprintf(stderr, "Video stream does not exist for VideoContext[%s]\n", vid_ctx->fmt_ctx->url);
+        log_error("Video stream does not exist for VideoContext[%s]\n", vid_ctx->fmt_ctx->url);
         return -1;
     }
     int64_t timebase = video_stream->duration / video_stream->nb_frames;
@@ -36,7 +36,7 @@ int64_t get_video_frame_pts(VideoContext *vid_ctx, int frameIndex) {
     }
     AVStream *video_stream = get_video_stream(vid_ctx);
     if(!video_stream) {
-        fprintf(stderr, "Video stream does not exist\n");
+        log_error("Video stream does not exist\n");
         return -1;
     } else {
         // Duration of one frame in AVStream.time_base units
@@ -59,12 +59,74 @@ int seek_video(VideoContext *vid_ctx, int frameIndex) {
  */
 int seek_video_pts(VideoContext *vid_ctx, int pts) {
     if(vid_ctx == NULL || vid_ctx->fmt_ctx == NULL) {
-        fprintf(stderr, "seek_video_pts() error: invalid params\n");
+        log_error("seek_video_pts() error: invalid params\n");
         return -1;
     }
+    // random access decoding leaves frames in the video decoder
+    if(vid_ctx->last_decoded_pts >= 0) {
+        avcodec_flush_buffers(vid_ctx->video_codec_ctx);
+        vid_ctx->last_decoded_pts = -1;
+    }
+    // packets kept for reading on from the last clip end are before or after the seek
+    clear_read_ahead_packets(vid_ctx);
+    vid_ctx->read_end_pts = -1;
     return av_seek_frame(vid_ctx->fmt_ctx, vid_ctx->video_stream_idx, pts, FFMPEG_SEEK_FLAG);
 }
 
+/**
+ * Get pts of the key frame at or before pts (from the index of the demuxer)
+ * @param  vid_ctx opened VideoContext
+ * @param  pts     pts in video time base
+ * @return         pts of key frame, -1 when the file has no index
+ */
+int64_t get_video_key_frame_pts(VideoContext *vid_ctx, int64_t pts) {
+    AVStream *stream = get_video_stream(vid_ctx);
+    int idx = av_index_search_timestamp(stream, pts, AVSEEK_FLAG_BACKWARD);
+    if(idx < 0) {
+        return -1;
+    }
+    return stream->index_entries[idx].timestamp;
+}
+
+/**
+ * Check if reading and decoding on from pos reaches pts more cheaply than seeking.
+ * Reading on is cheaper until a key frame lies after pos, at or before pts
+ * (a seek lands on that key frame). The index of the demuxer can be incomplete (mpegts,
+ * mkv without cues: it only holds key frames read so far), so reading on is only chosen
+ * within max_dist
+ * @param  vid_ctx  opened VideoContext
+ * @param  pos      pts the demuxer and decoder are at (video time base)
+ * @param  pts      pts of the frame wanted (>= pos)
+ * @param  max_dist max distance to read on
+ * @return          true to read on, false to seek
+ */
+bool video_read_forward_cheaper(VideoContext *vid_ctx, int64_t pos, int64_t pts, int64_t max_dist) {
+    if(pos < 0 || pts < pos) {
+        return false;
+    }
+    if(pts - pos > max_dist) {
+        return false;
+    }
+    int64_t key = get_video_key_frame_pts(vid_ctx, pts);
+    return key < 0 || key <= pos;
+}
+
+/**
+ * Check if the video decoder can reach pts by decoding forward from the last random access
+ * frame (vid_ctx->last_decoded_pts) more cheaply than seeking. Decoding forward is cheaper
+ * until a key frame lies between the decoder and pts (a seek lands on that key frame),
+ * and is only chosen within max_dist
+ * @param  vid_ctx  opened VideoContext
+ * @param  pts      pts of the frame wanted (video time base)
+ * @param  max_dist max distance to decode forward
+ * @return          true to decode forward, false to seek
+ */
+bool video_decode_forward_cheaper(VideoContext *vid_ctx, int64_t pts, int64_t max_dist) {
+    int64_t pos = vid_ctx->last_decoded_pts;
+    // the frame at pos was already output
+    return pts > pos && video_read_forward_cheaper(vid_ctx, pos, pts, max_dist);
+}
+
 int64_t get_audio_frame_pts(VideoContext *vid_ctx, int frameIndex) {
     int vid_pts = get_video_frame_pts(vid_ctx, frameIndex);
     if(vid_pts < 0) {
@@ -88,7 +150,7 @@ char *print_time_base(AVRational *tb) {
     sprintf(buf, "%d/%d\n", tb->num, tb->den);
     char *str = malloc(sizeof(char) * (strlen(buf) + 1));
     if(str == NULL) {
-        fprintf(stderr, "print_time_base(): Failed to allocate memory\n");
+        log_error("print_time_base(): Failed to allocate memory\n");
         return NULL;
     }
     strcpy(str, buf);
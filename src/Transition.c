@@ -0,0 +1,324 @@
+/**
+ * @file Transition.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for Transition API:
+ * Video dissolve and dip to color, audio crossfade.
+ * Row kernels use SSE2 when available (scalar fallback otherwise).
+ */
+
+#include "Transition.h"
+
+#include <math.h>
+#include <libavutil/intreadwrite.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Check if frames of a pixel format can be blended (every component is a whole 8 bit byte,
+ * or a native 16 bit word holding 9 to 14 bits)
+ * @param  pix_fmt pixel format
+ * @return         true if supported by blend_video_frames()
+ */
+bool transition_pix_fmt_supported(enum AVPixelFormat pix_fmt) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
+    if(desc == NULL || desc->nb_components == 0 ||
+        (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_BE))) {
+        return false;
+    }
+    bool words = desc->comp[0].depth > 8;
+    for(int c = 0; c < desc->nb_components; c++) {
+        const AVComponentDescriptor *comp = &(desc->comp[c]);
+        // blending 2 * (b - a) must fit a signed 16 bit word
+        bool ok = words ? (comp->depth > 8 && comp->depth <= 14 && comp->step % 2 == 0)
+                        : (comp->depth == 8);
+        if(!ok || comp->shift != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fill a frame with a color
+ * @param  frame frame with format, width, height and buffers set (supported pixel format)
+ * @param  rgb   color (converted into YUV for YUV formats, using the color range of the frame)
+ * @return       >= 0 on success
+ */
+int fill_video_frame_color(AVFrame *frame, const uint8_t rgb[3]) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    if(!transition_pix_fmt_supported(frame->format)) {
+        log_error("fill_video_frame_color() error: Unsupported pixel format\n");
+        return -1;
+    }
+    bool is_rgb = desc->flags & AV_PIX_FMT_FLAG_RGB;
+    bool is_gray = !is_rgb && desc->nb_components <= 2;
+    double r = rgb[0] / 255.0, g = rgb[1] / 255.0, b = rgb[2] / 255.0;
+    // component values in 8 bit scale: R G B (A), Y U V (A) or Y (A)
+    double values[4];
+    if(is_rgb) {
+        values[0] = rgb[0];
+        values[1] = rgb[1];
+        values[2] = rgb[2];
+    } else {
+        double kr = 0.299, kb = 0.114;
+        if(frame->colorspace == AVCOL_SPC_BT709) {
+            kr = 0.2126;
+            kb = 0.0722;
+        }
+        double y = kr * r + (1 - kr - kb) * g + kb * b;
+        double cb = (b - y) / (2 * (1 - kb));
+        double cr = (r - y) / (2 * (1 - kr));
+        bool full = frame->color_range == AVCOL_RANGE_JPEG || strncmp(desc->name, "yuvj", 4) == 0;
+        values[0] = full ? y * 255 : 16 + y * 219;
+        values[1] = 128 + cb * (full ? 255 : 224);
+        values[2] = 128 + cr * (full ? 255 : 224);
+    }
+    int alpha_comp = (desc->flags & AV_PIX_FMT_FLAG_ALPHA) ? desc->nb_components - 1 : -1;
+    for(int c = 0; c < desc->nb_components; c++) {
+        const AVComponentDescriptor *comp = &(desc->comp[c]);
+        int max = (1 << comp->depth) - 1;
+        int v = (c == alpha_comp) ? max : (int) lrint(values[is_gray ? 0 : c] * (1 << (comp->depth - 8)));
+        v = av_clip(v, 0, max);
+        bool chroma = !is_rgb && !is_gray && (c == 1 || c == 2);
+        int w = chroma ? AV_CEIL_RSHIFT(frame->width, desc->log2_chroma_w) : frame->width;
+        int h = chroma ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+        for(int y = 0; y < h; y++) {
+            uint8_t *row = frame->data[comp->plane] + (ptrdiff_t) y * frame->linesize[comp->plane] + comp->offset;
+            if(comp->depth > 8) {
+                for(int x = 0; x < w; x++) {
+                    AV_WN16(row + x * comp->step, v);
+                }
+            } else {
+                for(int x = 0; x < w; x++) {
+                    row[x * comp->step] = v;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Blend two frames: dst = a * (1 - t) + b * t.
+ * All frames have the same supported pixel format and size (dst can be a or b)
+ * @param dst output frame with buffers
+ * @param a   first frame
+ * @param b   second frame
+ * @param t   weight of b (0 to 1)
+ */
+void blend_video_frames(AVFrame *dst, const AVFrame *a, const AVFrame *b, double t) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int bytes[4];
+    if(desc == NULL || av_image_fill_linesizes(bytes, a->format, a->width) < 0) {
+        return;
+    }
+    // weight in 1/32768 (t = 1 is a copy of b)
+    int w = (int) lrint(av_clipd(t, 0, 1) * 32768);
+    const AVFrame *copy = (w <= 0) ? a : ((w >= 32768) ? b : NULL);
+    bool words = desc->comp[0].depth > 8;
+    int nb_planes = av_pix_fmt_count_planes(a->format);
+    for(int p = 0; p < nb_planes; p++) {
+        int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h) : a->height;
+        if(copy != NULL) {
+            if(copy != dst) {
+                av_image_copy_plane(dst->data[p], dst->linesize[p], copy->data[p], copy->linesize[p], bytes[p], h);
+            }
+            continue;
+        }
+        for(int y = 0; y < h; y++) {
+            uint8_t *d = dst->data[p] + (ptrdiff_t) y * dst->linesize[p];
+            const uint8_t *ra = a->data[p] + (ptrdiff_t) y * a->linesize[p];
+            const uint8_t *rb = b->data[p] + (ptrdiff_t) y * b->linesize[p];
+            if(words) {
+                blend_row_16((uint16_t *) d, (const uint16_t *) ra, (const uint16_t *) rb, bytes[p] / 2, w);
+            } else {
+                blend_row_8(d, ra, rb, bytes[p], w);
+            }
+        }
+    }
+}
+
+/**
+ * Blend a video frame of a transition
+ * @param tr    Transition
+ * @param dst   output frame with buffers
+ * @param a     frame of the outgoing clip
+ * @param b     frame of the incoming clip (same format and size)
+ * @param color frame filled with the dip color (TRANSITION_DIP_TO_COLOR only)
+ * @param t     progress of the transition (0 to 1)
+ */
+void blend_transition_frame(Transition *tr, AVFrame *dst, const AVFrame *a, const AVFrame *b,
+                                const AVFrame *color, double t) {
+    if(tr->type == TRANSITION_DIP_TO_COLOR && color != NULL) {
+        if(t < 0.5) {
+            blend_video_frames(dst, a, color, t * 2);
+        } else {
+            blend_video_frames(dst, color, b, t * 2 - 1);
+        }
+    } else {
+        blend_video_frames(dst, a, b, t);
+    }
+}
+
+/**
+ * Mix the samples of the incoming clip into the samples of the outgoing clip (planar float).
+ * Gains follow the progress of the transition sample by sample
+ * @param tr         Transition
+ * @param dst        outgoing frame (AV_SAMPLE_FMT_FLTP, writable), mixed in place
+ * @param src        incoming samples (AV_SAMPLE_FMT_FLTP, same channels), at least nb_samples of dst
+ * @param t0         progress at the first sample of dst
+ * @param dt         progress between two samples
+ */
+void mix_transition_audio(Transition *tr, AVFrame *dst, const AVFrame *src, double t0, double dt) {
+    int n = dst->nb_samples;
+    int i = 0;
+    while(i < n) {
+        float ga, gb, da, db;
+        double next = get_transition_gains(tr->type, t0 + i * dt, &ga, &gb, &da, &db);
+        // gains are linear up to the next change of slope
+        int end = n;
+        if(dt > 0 && next != INFINITY) {
+            double e = ceil((next - t0) / dt);
+            if(e < end) {
+                end = FFMAX((int) e, i + 1);
+            }
+        }
+        for(int c = 0; c < dst->channels; c++) {
+            float *d = (float *) dst->extended_data[c] + i;
+            mix_row_float(d, d, (const float *) src->extended_data[c] + i, end - i, ga, da * dt, gb, db * dt);
+        }
+        i = end;
+    }
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Get the gains of the outgoing and incoming clips at a point of a transition,
+ * and how fast they change. Gains are piecewise linear in t (constant outside 0 to 1)
+ * @param type  TransitionType
+ * @param t     progress of the transition
+ * @param ga    output gain of the outgoing clip
+ * @param gb    output gain of the incoming clip
+ * @param da    output change of ga per unit of t
+ * @param db    output change of gb per unit of t
+ * @return      next value of t where the gains change slope (> t), or INFINITY
+ */
+double get_transition_gains(TransitionType type, double t, float *ga, float *gb, float *da, float *db) {
+    *da = 0;
+    *db = 0;
+    if(type == TRANSITION_NONE || t < 0) {
+        *ga = 1;
+        *gb = 0;
+        return type == TRANSITION_NONE ? INFINITY : 0;
+    } else if(t >= 1) {
+        *ga = 0;
+        *gb = 1;
+        return INFINITY;
+    } else if(type == TRANSITION_DIP_TO_COLOR) {
+        if(t < 0.5) {
+            *ga = 1 - 2 * t;
+            *gb = 0;
+            *da = -2;
+            return 0.5;
+        }
+        *ga = 0;
+        *gb = 2 * t - 1;
+        *db = 2;
+        return 1;
+    }
+    *ga = 1 - t;
+    *gb = t;
+    *da = -1;
+    *db = 1;
+    return 1;
+}
+
+/**
+ * Blend a row of bytes: dst = a + (b - a) * w / 32768
+ * @param dst output row (can be a or b)
+ * @param a   first row
+ * @param b   second row
+ * @param n   number of bytes
+ * @param w   weight of b (0 to 32767)
+ */
+void blend_row_8(uint8_t *dst, const uint8_t *a, const uint8_t *b, int n, int w) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vw = _mm_set1_epi16((int16_t) w);
+    for(; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        __m128i alo = _mm_unpacklo_epi8(va, zero);
+        __m128i ahi = _mm_unpackhi_epi8(va, zero);
+        __m128i dlo = _mm_sub_epi16(_mm_unpacklo_epi8(vb, zero), alo);
+        __m128i dhi = _mm_sub_epi16(_mm_unpackhi_epi8(vb, zero), ahi);
+        // (2 * d * w) >> 16 = d * w / 32768
+        alo = _mm_add_epi16(alo, _mm_mulhi_epi16(_mm_add_epi16(dlo, dlo), vw));
+        ahi = _mm_add_epi16(ahi, _mm_mulhi_epi16(_mm_add_epi16(dhi, dhi), vw));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(alo, ahi));
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = a[i] + ((2 * (b[i] - a[i]) * w) >> 16);
+    }
+}
+
+/**
+ * Blend a row of 16 bit words holding at most 14 bits: dst = a + (b - a) * w / 32768
+ * @param dst output row (can be a or b)
+ * @param a   first row
+ * @param b   second row
+ * @param n   number of words
+ * @param w   weight of b (0 to 32767)
+ */
+void blend_row_16(uint16_t *dst, const uint16_t *a, const uint16_t *b, int n, int w) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i vw = _mm_set1_epi16((int16_t) w);
+    for(; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *) (b + i)), va);
+        va = _mm_add_epi16(va, _mm_mulhi_epi16(_mm_add_epi16(d, d), vw));
+        _mm_storeu_si128((__m128i *) (dst + i), va);
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = a[i] + ((2 * (b[i] - a[i]) * w) >> 16);
+    }
+}
+
+/**
+ * Mix two rows of float samples with linear gain ramps:
+ * dst[i] = a[i] * (ga + i * da) + b[i] * (gb + i * db)
+ * @param dst output samples (can be a)
+ * @param a   first samples
+ * @param b   second samples
+ * @param n   number of samples
+ * @param ga  gain of a at the first sample
+ * @param da  change of the gain of a per sample
+ * @param gb  gain of b at the first sample
+ * @param db  change of the gain of b per sample
+ */
+void mix_row_float(float *dst, const float *a, const float *b, int n, float ga, float da, float gb, float db) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 ramp = _mm_set_ps(3, 2, 1, 0);
+    const __m128 vga = _mm_set1_ps(ga), vda = _mm_set1_ps(da);
+    const __m128 vgb = _mm_set1_ps(gb), vdb = _mm_set1_ps(db);
+    for(; i + 4 <= n; i += 4) {
+        __m128 vi = _mm_add_ps(_mm_set1_ps((float) i), ramp);
+        __m128 g1 = _mm_add_ps(vga, _mm_mul_ps(vi, vda));
+        __m128 g2 = _mm_add_ps(vgb, _mm_mul_ps(vi, vdb));
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(a + i), g1);
+        x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(b + i), g2));
+        _mm_storeu_ps(dst + i, x);
+    }
+#endif
+    for(; i < n; i++) {
+        dst[i] = a[i] * (ga + i * da) + b[i] * (gb + i * db);
+    }
+}
@@ -45,11 +45,21 @@ void init_video_context(VideoContext *vc) {
     vc->last_decoder_packet_stream = DEC_STREAM_NONE;
     vc->open = false;
     vc->url = NULL;
+    vc->proxy_url = NULL;
+    vc->use_proxy = false;
+    vc->lowres = 0;
+    vc->fast_decode = false;
     vc->video_time_base = (AVRational){0,0};
     vc->audio_time_base = (AVRational){0,0};
     vc->fps = 0;
     vc->seek_pts = 0;
     vc->curr_pts = 0;
+    vc->last_decoded_pts = -1;
+    vc->read_ahead = NULL;
+    vc->read_ahead_start = 0;
+    vc->read_ahead_nb = 0;
+    vc->read_ahead_size = 0;
+    vc->read_end_pts = -1;
     vc->clip_count = 0;
 }
 
@@ -72,12 +82,13 @@ int open_video_context(VideoContext *vid_ctx, char *filename) {
             return ret;
         }
         if(ret == 1 && types[i] == AVMEDIA_TYPE_VIDEO) {
-            fprintf(stderr, "Video stream is required and could not be found");
+            log_error("Video stream is required and could not be found");
             return -1;
         }
     }
-    if(stat(filename, &(vid_ctx->file_stats)) != 0) {
-        fprintf(stderr, "open_video_context() error: Failed to get file stats\n");
+    // file stats always come from the original file (even when a proxy is opened)
+    if(stat(vid_ctx->url != NULL ? vid_ctx->url : filename, &(vid_ctx->file_stats)) != 0) {
+        log_error("open_video_context() error: Failed to get file stats\n");
         return -1;
     }
     AVStream *video_stream = get_video_stream(vid_ctx);
@@ -85,7 +96,7 @@ int open_video_context(VideoContext *vid_ctx, char *filename) {
     vid_ctx->audio_time_base = get_audio_time_base(vid_ctx);
 
     if(!valid_rational(vid_ctx->video_time_base) || !valid_rational(vid_ctx->audio_time_base)) {
-        fprintf(stderr, "open_video_context() error: Invalid timebase for video[%d/%d] or audio [%d/%d]\n",
+        log_error("open_video_context() error: Invalid timebase for video[%d/%d] or audio [%d/%d]\n",
             vid_ctx->video_time_base.num, vid_ctx->video_time_base.den, vid_ctx->audio_time_base.num, vid_ctx->audio_time_base.den);
         return -1;
     }
@@ -94,7 +105,7 @@ int open_video_context(VideoContext *vid_ctx, char *filename) {
     if(video_stream->duration <= 0 || video_stream->nb_frames <= 0) {
         AVRational avg_fps = video_stream->avg_frame_rate;
         if(!valid_rational(avg_fps)) {
-            fprintf(stderr, "open_video_context() error: Invalid duration[%ld], nb_frames[%ld] and avg_frame_rate[%d/%d]\n", video_stream->duration, video_stream->nb_frames, avg_fps.num, avg_fps.den);
+            log_error("open_video_context() error: Invalid duration[%ld], nb_frames[%ld] and avg_frame_rate[%d/%d]\n", video_stream->duration, video_stream->nb_frames, avg_fps.num, avg_fps.den);
             return -1;
         }
         vid_ctx->fps = avg_fps.num / (double)avg_fps.den;
@@ -105,25 +116,26 @@ int open_video_context(VideoContext *vid_ctx, char *filename) {
         int64_t frame_duration = video_stream->duration / video_stream->nb_frames;
         vid_ctx->fps = vid_ctx->video_time_base.den / (double)frame_duration;
     }
-    printf("OPEN VIDEO CONTEXT [%s]\n", filename);
+    discard_unused_streams(vid_ctx);
+    log_debug("OPEN VIDEO CONTEXT [%s]\n", filename);
     return 0;
 }
 
 /* Return >=0 if OK, < 0 on fail */
 int open_format_context(VideoContext *vid_ctx, char *filename) {
     if(vid_ctx->fmt_ctx) {
-        fprintf(stderr, "open_format_context() error: Invalid params. vid_ctx->fmt_ctx must be NULL (initialized with init_video_context())\n");
+        log_error("open_format_context() error: Invalid params. vid_ctx->fmt_ctx must be NULL (initialized with init_video_context())\n");
         return -1;
     }
     // open input file and allocate format context
     if(avformat_open_input(&(vid_ctx->fmt_ctx), filename, NULL, NULL) < 0) {
-        fprintf(stderr, "Could not open source file %s\n", filename);
+        log_error("Could not open source file %s\n", filename);
         return -1;
     }
     vid_ctx->open = true;
     // retrieve stream information
     if(avformat_find_stream_info(vid_ctx->fmt_ctx, NULL) < 0) {
-        fprintf(stderr, "Could not find stream information for file [%s]\n", filename);
+        log_error("Could not find stream information for file [%s]\n", filename);
         return -1;
     }
     return 0;
@@ -136,54 +148,167 @@ int open_format_context(VideoContext *vid_ctx, char *filename) {
 */
 int open_codec_context(VideoContext *vid_ctx, enum AVMediaType type) {
     if(type != AVMEDIA_TYPE_VIDEO && type != AVMEDIA_TYPE_AUDIO) {
-        fprintf(stderr, "Unsupported type '%s'. Video_Context does not support this stream\n",
+        log_error("Unsupported type '%s'. Video_Context does not support this stream\n",
                 av_get_media_type_string(type));
         return -1;
     }
     AVCodec *codec;
-    AVCodecContext *codec_ctx;
     AVFormatContext *fmt_ctx = vid_ctx->fmt_ctx;
-    AVDictionary *opts = NULL;
-    int ret, refcount = 0;
 
     // finds the stream index given an AVMediaType (and gets codec on success)
     int stream_index = av_find_best_stream(fmt_ctx, type, -1, -1, &codec, 0);
     if(stream_index < 0) {
-        fprintf(stderr, "Could not find %s stream in input file '%s'\n",
+        log_error("Could not find %s stream in input file '%s'\n",
                 av_get_media_type_string(type), fmt_ctx->url);
         return 1;
-    } else {
-        /* Create codec context */
-        codec_ctx = avcodec_alloc_context3(codec);
-        if(!codec_ctx) {
-            fprintf(stderr, "Failed to allocate the %s codec context\n",
-                    av_get_media_type_string(type));
-            return AVERROR(ENOMEM);
+    }
+    return open_stream_decoder(vid_ctx, type, stream_index, codec);
+}
+
+/**
+ * Open the decoder of a stream and attach it to the VideoContext
+ * @param  vid_ctx      VideoContext with open format context
+ * @param  type         AVMEDIA_TYPE_VIDEO/AVMEDIA_TYPE_AUDIO
+ * @param  stream_index index of stream in fmt_ctx->streams
+ * @param  codec        decoder of the stream
+ * @return              >= 0 on success
+ */
+int open_stream_decoder(VideoContext *vid_ctx, enum AVMediaType type, int stream_index, AVCodec *codec) {
+    AVFormatContext *fmt_ctx = vid_ctx->fmt_ctx;
+    AVDictionary *opts = NULL;
+    int ret, refcount = 0;
+    /* Create codec context */
+    AVCodecContext *codec_ctx = avcodec_alloc_context3(codec);
+    if(!codec_ctx) {
+        log_error("Failed to allocate the %s codec context\n",
+                av_get_media_type_string(type));
+        return AVERROR(ENOMEM);
+    }
+    // Fill the codec context based on the values from the supplied codec parameters.
+    avcodec_parameters_to_context(codec_ctx, fmt_ctx->streams[stream_index]->codecpar);
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        set_video_decode_options(vid_ctx, codec, codec_ctx);
+    }
+
+    /* Init the codec context, with or without reference counting */
+    av_dict_set(&opts, "refcounted_frames", refcount ? "1" : "0", 0);
+    ret = avcodec_open2(codec_ctx, codec, &opts);
+    av_dict_free(&opts);
+    if(ret < 0) {
+        log_error("Failed to open %s codec\n",
+                av_get_media_type_string(type));
+        avcodec_free_context(&codec_ctx);
+        return ret;
+    }
+    codec_ctx->time_base = fmt_ctx->streams[stream_index]->time_base;
+    // Attach codec and codec context to vid_ctx
+    if(type == AVMEDIA_TYPE_VIDEO) {
+        vid_ctx->video_codec = codec;
+        vid_ctx->video_codec_ctx = codec_ctx;
+        vid_ctx->video_stream_idx = stream_index;
+    } else if(type == AVMEDIA_TYPE_AUDIO) {
+        vid_ctx->audio_codec = codec;
+        vid_ctx->audio_codec_ctx = codec_ctx;
+        vid_ctx->audio_stream_idx = stream_index;
+    }
+    return 0;
+}
+
+/**
+ * Open a clone of an opened VideoContext: the same file and streams, with its own demuxer,
+ * decoders and read position, so another thread can read it at the same time.
+ * The probe of the source is reused (input format, stream info, codec parameters, file stats):
+ * only the container header is read again. The source must not be read while it is cloned
+ * @param  src   opened VideoContext
+ * @param  clone output VideoContext allocated on heap (free with free_video_context())
+ * @return       >= 0 on success
+ */
+int clone_video_context(VideoContext *src, VideoContext **clone) {
+    *clone = NULL;
+    if(src == NULL || !src->open) {
+        log_error("clone_video_context() error: Invalid params (source must be open)\n");
+        return -1;
+    }
+    VideoContext *vc = malloc(sizeof(struct VideoContext));
+    if(vc == NULL) {
+        log_error("clone_video_context() error: Failed to allocate VideoContext\n");
+        return AVERROR(ENOMEM);
+    }
+    init_video_context(vc);
+    vc->lowres = src->lowres;
+    vc->fast_decode = src->fast_decode;
+    vc->use_proxy = src->use_proxy;
+    int ret = 0;
+    vc->url = strdup(src->url);
+    if(vc->url == NULL || (src->proxy_url != NULL && set_video_context_proxy(vc, src->proxy_url) < 0)) {
+        log_error("clone_video_context() error: Failed to copy filenames\n");
+        ret = AVERROR(ENOMEM);
+    }
+    if(ret < 0 || (ret = open_cloned_video_context(vc, src)) < 0) {
+        free_video_context(&vc);
+        return ret;
+    }
+    *clone = vc;
+    return 0;
+}
+
+/**
+ * Open the format context and decoders of a clone (see clone_video_context())
+ * @param  vid_ctx VideoContext initialized with the options of src
+ * @param  src     opened VideoContext
+ * @return         >= 0 on success
+ */
+int open_cloned_video_context(VideoContext *vid_ctx, VideoContext *src) {
+    char *filename = get_video_context_url(src);
+    AVFormatContext *in = src->fmt_ctx;
+    // same input format: the file is not probed again
+    if(avformat_open_input(&(vid_ctx->fmt_ctx), filename, in->iformat, NULL) < 0) {
+        log_error("open_cloned_video_context() error: Could not open source file %s\n", filename);
+        return -1;
+    }
+    vid_ctx->open = true;
+    AVFormatContext *fmt_ctx = vid_ctx->fmt_ctx;
+    if(fmt_ctx->nb_streams != in->nb_streams) {
+        // streams found while probing (ex: mpegts): probe this clone too
+        if(avformat_find_stream_info(fmt_ctx, NULL) < 0 || fmt_ctx->nb_streams != in->nb_streams) {
+            log_error("open_cloned_video_context() error: Streams of [%s] differ from its source\n", filename);
+            return -1;
         }
-        // Fill the codec context based on the values from the supplied codec parameters.
-        avcodec_parameters_to_context(codec_ctx, fmt_ctx->streams[stream_index]->codecpar);
-
-        /* Init the codec context, with or without reference counting */
-        av_dict_set(&opts, "refcounted_frames", refcount ? "1" : "0", 0);
-        if ((ret = avcodec_open2(codec_ctx, codec, &opts)) < 0) {
-            fprintf(stderr, "Failed to open %s codec\n",
-                    av_get_media_type_string(type));
-            return ret;
-        } else {
-            codec_ctx->time_base = fmt_ctx->streams[stream_index]->time_base;
-            // Attach codec and codec context to vid_ctx
-            if(type == AVMEDIA_TYPE_VIDEO) {
-                vid_ctx->video_codec = codec;
-                vid_ctx->video_codec_ctx = codec_ctx;
-                vid_ctx->video_stream_idx = stream_index;
-            } else if(type == AVMEDIA_TYPE_AUDIO) {
-                vid_ctx->audio_codec = codec;
-                vid_ctx->audio_codec_ctx = codec_ctx;
-                vid_ctx->audio_stream_idx = stream_index;
+    } else {
+        // stream info of the source (including durations estimated by open_video_context())
+        for(unsigned int i = 0; i < in->nb_streams; i++) {
+            AVStream *s = in->streams[i], *d = fmt_ctx->streams[i];
+            if(avcodec_parameters_copy(d->codecpar, s->codecpar) < 0) {
+                log_error("open_cloned_video_context() error: Failed to copy codec parameters\n");
+                return AVERROR(ENOMEM);
             }
-            return 0;
+            d->time_base = s->time_base;
+            d->start_time = s->start_time;
+            d->duration = s->duration;
+            d->nb_frames = s->nb_frames;
+            d->avg_frame_rate = s->avg_frame_rate;
+            d->r_frame_rate = s->r_frame_rate;
+            d->sample_aspect_ratio = s->sample_aspect_ratio;
         }
+        fmt_ctx->start_time = in->start_time;
+        fmt_ctx->duration = in->duration;
+        fmt_ctx->bit_rate = in->bit_rate;
+    }
+    int ret;
+    if((ret = open_stream_decoder(vid_ctx, AVMEDIA_TYPE_VIDEO, src->video_stream_idx, src->video_codec)) < 0) {
+        return ret;
+    }
+    if(src->audio_stream_idx >= 0 &&
+        (ret = open_stream_decoder(vid_ctx, AVMEDIA_TYPE_AUDIO, src->audio_stream_idx, src->audio_codec)) < 0) {
+        return ret;
     }
+    vid_ctx->file_stats = src->file_stats;
+    vid_ctx->video_time_base = src->video_time_base;
+    vid_ctx->audio_time_base = src->audio_time_base;
+    vid_ctx->fps = src->fps;
+    discard_unused_streams(vid_ctx);
+    log_debug("CLONE VIDEO CONTEXT [%s]\n", filename);
+    return 0;
 }
 
 /** free codecs and ffmpeg struct data inside VideoContext **/
@@ -192,8 +317,11 @@ void close_video_context(VideoContext *vc) {
         avcodec_free_context(&(vc->video_codec_ctx));
         avcodec_free_context(&(vc->audio_codec_ctx));
         avformat_close_input(&(vc->fmt_ctx));
+        clear_read_ahead_packets(vc);
+        vc->last_decoded_pts = -1;
+        vc->read_end_pts = -1;
         vc->open = false;
-        printf("CLOSE VIDEO CONTEXT [%s]\n", vc->url);
+        log_debug("CLOSE VIDEO CONTEXT [%s]\n", vc->url);
     }
 }
 
@@ -206,14 +334,180 @@ void free_video_context(VideoContext **vc) {
         return;
     }
     close_video_context(*vc);
+    free((*vc)->read_ahead);
     if((*vc)->url != NULL) {
         free((*vc)->url);
         (*vc)->url = NULL;
     }
+    if((*vc)->proxy_url != NULL) {
+        free((*vc)->proxy_url);
+        (*vc)->proxy_url = NULL;
+    }
     free(*vc);
     *vc = NULL;
 }
 
+/**
+ * Get the filename opened by a VideoContext (proxy when in use, url otherwise)
+ * @param  vid_ctx VideoContext
+ * @return         filename to open
+ */
+char *get_video_context_url(VideoContext *vid_ctx) {
+    if(vid_ctx->use_proxy && vid_ctx->proxy_url != NULL) {
+        return vid_ctx->proxy_url;
+    }
+    return vid_ctx->url;
+}
+
+/**
+ * Map a VideoContext to its proxy media
+ * @param  vid_ctx   VideoContext of original file
+ * @param  proxy_url filename of proxy (copied)
+ * @return           >= 0 on success
+ */
+int set_video_context_proxy(VideoContext *vid_ctx, char *proxy_url) {
+    char *url = malloc(strlen(proxy_url) + 1);
+    if(url == NULL) {
+        log_error("set_video_context_proxy() error: Failed to allocate proxy url\n");
+        return -1;
+    }
+    strcpy(url, proxy_url);
+    free(vid_ctx->proxy_url);
+    vid_ctx->proxy_url = url;
+    return 0;
+}
+
+/**
+ * Apply the decoding speed/quality options of a VideoContext to a video decoder
+ * (before the decoder is opened)
+ * @param vid_ctx   VideoContext
+ * @param codec     video decoder
+ * @param codec_ctx video decoder context
+ */
+void set_video_decode_options(VideoContext *vid_ctx, AVCodec *codec, AVCodecContext *codec_ctx) {
+    // only some decoders (ex: mjpeg, h263) can decode at reduced resolution
+    codec_ctx->lowres = FFMIN(vid_ctx->lowres, codec->max_lowres);
+    if(vid_ctx->fast_decode) {
+        codec_ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+        codec_ctx->skip_loop_filter = AVDISCARD_ALL;
+    }
+}
+
+/**
+ * Tell the demuxer to skip every stream except the selected video and audio streams.
+ * Packets from discarded streams (data, timecode, extra audio tracks..) are never
+ * returned by av_read_frame(), so we don't pay to copy and unref them.
+ * Call this function after open_codec_context() has selected the streams
+ * @param vid_ctx VideoContext with open format context
+ */
+void discard_unused_streams(VideoContext *vid_ctx) {
+    AVFormatContext *fmt_ctx = vid_ctx->fmt_ctx;
+    for(int i = 0; i < (int)fmt_ctx->nb_streams; i++) {
+        bool used = (i == vid_ctx->video_stream_idx || i == vid_ctx->audio_stream_idx);
+        set_stream_discard(vid_ctx, i, !used);
+    }
+}
+
+/**
+ * Enable or disable demuxing of a single stream
+ * @param vid_ctx    VideoContext with open format context
+ * @param stream_idx index of stream in fmt_ctx->streams (ignored if -1)
+ * @param discard    when true, the demuxer will skip all packets of this stream
+ */
+void set_stream_discard(VideoContext *vid_ctx, int stream_idx, bool discard) {
+    if(stream_idx < 0 || vid_ctx->fmt_ctx == NULL) {
+        return;
+    }
+    vid_ctx->fmt_ctx->streams[stream_idx]->discard = discard ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+}
+
+/**
+ * Read the next packet of a file: packets kept by keep_read_ahead_packet() first,
+ * then av_read_frame()
+ * @param  vid_ctx opened VideoContext
+ * @param  pkt     output packet
+ * @return         >= 0 on success, < 0 on EOF or error (as av_read_frame())
+ */
+int read_video_context_packet(VideoContext *vid_ctx, AVPacket *pkt) {
+    if(vid_ctx->read_ahead_nb > 0) {
+        AVPacket *kept = vid_ctx->read_ahead[vid_ctx->read_ahead_start];
+        av_packet_move_ref(pkt, kept);
+        av_packet_free(&kept);
+        ++(vid_ctx->read_ahead_start);
+        if(--(vid_ctx->read_ahead_nb) == 0) {
+            vid_ctx->read_ahead_start = 0;
+        }
+        return 0;
+    }
+    return av_read_frame(vid_ctx->fmt_ctx, pkt);
+}
+
+/**
+ * Keep a packet to be returned by read_video_context_packet()
+ * @param  vid_ctx opened VideoContext
+ * @param  pkt     packet (the reference is moved, or unreferenced on failure)
+ * @return         >= 0 on success, < 0 when VIDEO_READ_AHEAD_MAX_PACKETS are already kept
+ */
+int keep_read_ahead_packet(VideoContext *vid_ctx, AVPacket *pkt) {
+    if(vid_ctx->read_ahead_nb >= VIDEO_READ_AHEAD_MAX_PACKETS) {
+        av_packet_unref(pkt);
+        return -1;
+    }
+    int end = vid_ctx->read_ahead_start + vid_ctx->read_ahead_nb;
+    if(end == vid_ctx->read_ahead_size && vid_ctx->read_ahead_start > 0) {
+        // reuse the slots of packets already returned
+        memmove(vid_ctx->read_ahead, vid_ctx->read_ahead + vid_ctx->read_ahead_start,
+                vid_ctx->read_ahead_nb * sizeof(AVPacket *));
+        vid_ctx->read_ahead_start = 0;
+        end = vid_ctx->read_ahead_nb;
+    } else if(end == vid_ctx->read_ahead_size) {
+        int size = FFMAX(16, vid_ctx->read_ahead_size * 2);
+        AVPacket **read_ahead = realloc(vid_ctx->read_ahead, size * sizeof(AVPacket *));
+        if(read_ahead == NULL) {
+            log_error("keep_read_ahead_packet() error: Failed to allocate packets\n");
+            av_packet_unref(pkt);
+            return AVERROR(ENOMEM);
+        }
+        vid_ctx->read_ahead = read_ahead;
+        vid_ctx->read_ahead_size = size;
+    }
+    AVPacket *kept = av_packet_alloc();
+    if(kept == NULL) {
+        log_error("keep_read_ahead_packet() error: Failed to allocate packet\n");
+        av_packet_unref(pkt);
+        return AVERROR(ENOMEM);
+    }
+    av_packet_move_ref(kept, pkt);
+    vid_ctx->read_ahead[end] = kept;
+    ++(vid_ctx->read_ahead_nb);
+    return 0;
+}
+
+/**
+ * Drop the packets kept by keep_read_ahead_packet()
+ * @param vid_ctx VideoContext
+ */
+void clear_read_ahead_packets(VideoContext *vid_ctx) {
+    for(int i = 0; i < vid_ctx->read_ahead_nb; i++) {
+        av_packet_free(&(vid_ctx->read_ahead[vid_ctx->read_ahead_start + i]));
+    }
+    vid_ctx->read_ahead_start = 0;
+    vid_ctx->read_ahead_nb = 0;
+}
+
+/**
+ * Check if a stream is discarded by the demuxer
+ * @param  vid_ctx    VideoContext with open format context
+ * @param  stream_idx index of stream in fmt_ctx->streams (-1 is never discarded)
+ * @return            true if the demuxer skips all packets of this stream
+ */
+bool is_stream_discarded(VideoContext *vid_ctx, int stream_idx) {
+    if(stream_idx < 0 || vid_ctx->fmt_ctx == NULL) {
+        return false;
+    }
+    return vid_ctx->fmt_ctx->streams[stream_idx]->discard == AVDISCARD_ALL;
+}
+
 /**
  * Check if AVRational is valid
  * @param  r AVRational to check
@@ -0,0 +1,163 @@
+/**
+ * @file VideoContextPool.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the function definitions for VideoContextPool API:
+ * One clone of each source VideoContext per worker thread.
+ */
+
+#include "VideoContextPool.h"
+
+/**
+ * Initialize an empty pool
+ * @param  pool       VideoContextPool
+ * @param  nb_threads number of threads taking clones (ex: get_thread_pool_size())
+ * @return            >= 0 on success
+ */
+int init_video_context_pool(VideoContextPool *pool, int nb_threads) {
+    if(pool == NULL || nb_threads <= 0) {
+        log_error("init_video_context_pool() error: Invalid params\n");
+        return -1;
+    }
+    pool->sources = NULL;
+    pool->nb_sources = 0;
+    pool->sources_size = 0;
+    pool->nb_threads = nb_threads;
+    pthread_mutex_init(&(pool->lock), NULL);
+    return 0;
+}
+
+/**
+ * Get the clone of a source VideoContext owned by a thread, opening it on first use.
+ * The source must not be read while clones are opened
+ * @param  pool       VideoContextPool
+ * @param  src        opened source VideoContext
+ * @param  thread_idx index of the calling thread
+ * @return            clone, NULL on error
+ */
+VideoContext *get_pooled_video_context(VideoContextPool *pool, VideoContext *src, int thread_idx) {
+    if(thread_idx < 0 || thread_idx >= pool->nb_threads) {
+        log_error("get_pooled_video_context() error: Invalid thread[%d]\n", thread_idx);
+        return NULL;
+    }
+    pthread_mutex_lock(&(pool->lock));
+    VideoContextClones *vcc = find_video_context_clones(pool, src);
+    pthread_mutex_unlock(&(pool->lock));
+    if(vcc == NULL) {
+        return NULL;
+    }
+    // only this thread uses its slot: clones of different threads open in parallel
+    VideoContext **clone = &(vcc->clones[thread_idx]);
+    if(*clone == NULL) {
+        if(clone_video_context(src, clone) < 0) {
+            log_error("get_pooled_video_context() error: Failed to clone [%s]\n", src->url);
+            return NULL;
+        }
+        // the pool holds one reference (see free_clip())
+        (*clone)->clip_count = 1;
+    } else if(!(*clone)->open && open_cloned_video_context(*clone, src) < 0) {
+        log_error("get_pooled_video_context() error: Failed to reopen clone of [%s]\n", src->url);
+        close_video_context(*clone);
+        return NULL;
+    }
+    return *clone;
+}
+
+/**
+ * Copy a clip (same file and bounds) reading through the clone of a thread.
+ * The copy is opened and seeked to its start
+ * @param  pool       VideoContextPool
+ * @param  src        opened Clip
+ * @param  thread_idx index of the calling thread
+ * @return            Clip allocated on heap (free_clip() when done), NULL on error
+ */
+Clip *copy_clip_pooled_vc(VideoContextPool *pool, Clip *src, int thread_idx) {
+    if(src == NULL || src->vid_ctx == NULL) {
+        log_error("copy_clip_pooled_vc() error: Invalid params\n");
+        return NULL;
+    }
+    VideoContext *vc = get_pooled_video_context(pool, src->vid_ctx, thread_idx);
+    if(vc == NULL) {
+        return NULL;
+    }
+    Clip *copy = alloc_clip_internal();
+    if(copy == NULL) {
+        log_error("copy_clip_pooled_vc() error: Failed to allocate new clip\n");
+        return NULL;
+    }
+    copy->vid_ctx = vc;
+    ++(vc->clip_count);
+    copy->orig_start_pts = src->orig_start_pts;
+    copy->orig_end_pts = src->orig_end_pts;
+    copy->start_pts = src->start_pts;
+    copy->end_pts = src->end_pts;
+    if(seek_clip_pts(copy, 0) < 0) {
+        log_error("copy_clip_pooled_vc() error: Failed to seek clip[%s]\n", vc->url);
+        free_clip(&copy);
+        return NULL;
+    }
+    return copy;
+}
+
+/**
+ * Close and free every clone of the pool (clones still used by clips are freed
+ * with their last clip)
+ * @param pool VideoContextPool
+ */
+void free_video_context_pool(VideoContextPool *pool) {
+    for(int i = 0; i < pool->nb_sources; i++) {
+        VideoContextClones *vcc = pool->sources[i];
+        for(int t = 0; t < pool->nb_threads; t++) {
+            VideoContext *clone = vcc->clones[t];
+            if(clone == NULL) {
+                continue;
+            }
+            if(clone->clip_count <= 1) {
+                free_video_context(&clone);
+            } else {
+                --(clone->clip_count);
+            }
+        }
+        free(vcc->clones);
+        free(vcc);
+    }
+    free(pool->sources);
+    pool->sources = NULL;
+    pool->nb_sources = 0;
+    pool->sources_size = 0;
+    pthread_mutex_destroy(&(pool->lock));
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Find the clones of a source, adding them when missing
+ * @param  pool VideoContextPool
+ * @param  src  source VideoContext
+ * @return      clones of the source, NULL on error
+ */
+VideoContextClones *find_video_context_clones(VideoContextPool *pool, VideoContext *src) {
+    for(int i = 0; i < pool->nb_sources; i++) {
+        if(pool->sources[i]->src == src) {
+            return pool->sources[i];
+        }
+    }
+    if(pool->nb_sources == pool->sources_size) {
+        int size = FFMAX(8, pool->sources_size * 2);
+        VideoContextClones **sources = realloc(pool->sources, size * sizeof(VideoContextClones *));
+        if(sources == NULL) {
+            log_error("find_video_context_clones() error: Failed to allocate sources\n");
+            return NULL;
+        }
+        pool->sources = sources;
+        pool->sources_size = size;
+    }
+    VideoContextClones *vcc = malloc(sizeof(struct VideoContextClones));
+    if(vcc == NULL || (vcc->clones = calloc(pool->nb_threads, sizeof(VideoContext *))) == NULL) {
+        log_error("find_video_context_clones() error: Failed to allocate clones\n");
+        free(vcc);
+        return NULL;
+    }
+    vcc->src = src;
+    pool->sources[(pool->nb_sources)++] = vcc;
+    return vcc;
+}
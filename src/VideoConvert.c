@@ -0,0 +1,363 @@
+/**
+ * @file VideoConvert.c
+ * @author Devon Crawford
+ * @date October 18, 2026
+ * @brief File containing the source for VideoConvert API:
+ * Scaling and pixel format conversion of decoded video frames into the
+ * output (encoder) format. One set of SwsContexts is cached per source format,
+ * and frames that already match the output format are passed through untouched.
+ */
+
+#include "VideoConvert.h"
+
+/**
+ * Initialize VideoConverter with default values (does not allocate)
+ * @param vc VideoConverter
+ */
+void init_video_converter(VideoConverter *vc) {
+    vc->width = 0;
+    vc->height = 0;
+    vc->pix_fmt = AV_PIX_FMT_NONE;
+    vc->cache = initializeList(&list_print_video_convert_cache,
+                &list_delete_video_convert_cache, &list_compare_video_convert_cache);
+    vc->last = NULL;
+    vc->frame = NULL;
+    vc->job_src = NULL;
+    vc->job_cache = NULL;
+    vc->open = false;
+}
+
+/**
+ * Open a VideoConverter for an output format
+ * @param  vc         VideoConverter initialized with init_video_converter()
+ * @param  width      output width
+ * @param  height     output height
+ * @param  pix_fmt    output pixel format
+ * @param  nb_threads number of threads used to convert slices of a frame (<= 0 for one per cpu core)
+ * @return            >= 0 on success
+ */
+int open_video_converter(VideoConverter *vc, int width, int height, enum AVPixelFormat pix_fmt, int nb_threads) {
+    if(vc == NULL || vc->open || width <= 0 || height <= 0 || pix_fmt == AV_PIX_FMT_NONE) {
+        log_error("open_video_converter() error: Invalid params\n");
+        return -1;
+    }
+    vc->width = width;
+    vc->height = height;
+    vc->pix_fmt = pix_fmt;
+    vc->frame = av_frame_alloc();
+    if(vc->frame == NULL) {
+        log_error("open_video_converter() error: Failed to allocate output frame\n");
+        return AVERROR(ENOMEM);
+    }
+    int ret = init_thread_pool(&(vc->pool), nb_threads);
+    if(ret < 0) {
+        av_frame_free(&(vc->frame));
+        return ret;
+    }
+    vc->open = true;
+    return 0;
+}
+
+/**
+ * Convert a decoded frame into the output format.
+ * If the frame already matches the output format, it is left untouched.
+ * Otherwise the frame is replaced with a reference to the converted frame
+ * (all frame properties such as pts are kept)
+ * @param  vc    VideoConverter
+ * @param  frame decoded video frame (input and output)
+ * @return       >= 0 on success
+ */
+int convert_video_frame(VideoConverter *vc, AVFrame *frame) {
+    if(video_frame_matches(vc, frame)) {
+        return 0;
+    }
+    VideoConvertCache *vcc = get_video_convert_cache(vc, frame);
+    if(vcc == NULL) {
+        return -1;
+    }
+    int ret = get_video_convert_buffer(vc);
+    if(ret < 0) {
+        return ret;
+    }
+    // convert all slices in parallel
+    vc->job_src = frame;
+    vc->job_cache = vcc;
+    ret = thread_pool_execute(&(vc->pool), &convert_video_slice, vc, vcc->nb_slices);
+    vc->job_src = NULL;
+    vc->job_cache = NULL;
+    if(ret < 0) {
+        log_error("convert_video_frame() error: Failed to convert slices\n");
+        return ret;
+    }
+
+    ret = av_frame_copy_props(vc->frame, frame);
+    if(ret < 0) {
+        log_error("convert_video_frame() error: Failed to copy frame properties\n");
+        return ret;
+    }
+    // replace decoded frame with converted frame
+    av_frame_unref(frame);
+    return av_frame_ref(frame, vc->frame);
+}
+
+/**
+ * Check if a frame needs conversion to match the output format
+ * @param  vc    VideoConverter
+ * @param  frame video frame
+ * @return       true if frame already matches output format
+ */
+bool video_frame_matches(VideoConverter *vc, AVFrame *frame) {
+    return frame->width == vc->width && frame->height == vc->height
+            && frame->format == vc->pix_fmt;
+}
+
+/**
+ * Free all cached SwsContexts, threads and the output frame
+ * @param vc VideoConverter
+ */
+void close_video_converter(VideoConverter *vc) {
+    if(vc->open) {
+        clearList(&(vc->cache));
+        vc->cache.length = 0;
+        vc->last = NULL;
+        free_thread_pool(&(vc->pool));
+        av_frame_free(&(vc->frame));
+        vc->open = false;
+    }
+}
+
+/*************** INTERNAL FUNCTIONS ***************/
+/**
+ * Find the cache entry for the source format of a frame (allocating it if needed)
+ * @param  vc    VideoConverter
+ * @param  frame source frame
+ * @return       NULL on fail, not NULL on success
+ */
+VideoConvertCache *get_video_convert_cache(VideoConverter *vc, AVFrame *frame) {
+    VideoConvertCache key;
+    key.width = frame->width;
+    key.height = frame->height;
+    key.pix_fmt = frame->format;
+    // most frames come from the same clip as the last frame
+    if(vc->last != NULL && list_compare_video_convert_cache(vc->last, &key) == 0) {
+        return vc->last;
+    }
+    Node *curr = vc->cache.head;
+    while(curr != NULL) {
+        if(list_compare_video_convert_cache(curr->data, &key) == 0) {
+            vc->last = (VideoConvertCache *) curr->data;
+            return vc->last;
+        }
+        curr = curr->next;
+    }
+    VideoConvertCache *vcc = alloc_video_convert_cache(vc, key.width, key.height, key.pix_fmt);
+    if(vcc == NULL) {
+        return NULL;
+    }
+    insertBack(&(vc->cache), vcc);
+    vc->last = vcc;
+    return vcc;
+}
+
+/**
+ * Allocate a cache entry and its SwsContexts for a source format
+ * @param  vc      VideoConverter
+ * @param  width   source width
+ * @param  height  source height
+ * @param  pix_fmt source pixel format
+ * @return         NULL on fail, not NULL on success
+ */
+VideoConvertCache *alloc_video_convert_cache(VideoConverter *vc, int width, int height, enum AVPixelFormat pix_fmt) {
+    VideoConvertCache *vcc = malloc(sizeof(struct VideoConvertCache));
+    if(vcc == NULL) {
+        log_error("alloc_video_convert_cache() error: Failed to allocate cache\n");
+        return NULL;
+    }
+    vcc->width = width;
+    vcc->height = height;
+    vcc->pix_fmt = pix_fmt;
+    vcc->nb_slices = 0;
+    vcc->slices = NULL;
+    int nb_slices = FFMIN(get_thread_pool_size(&(vc->pool)), vc->height / VIDEO_CONVERT_MIN_SLICE_H);
+    vcc->slices = malloc(sizeof(struct VideoConvertSlice) * FFMAX(nb_slices, 1));
+    if(vcc->slices == NULL) {
+        log_error("alloc_video_convert_cache() error: Failed to allocate slices\n");
+        free(vcc);
+        return NULL;
+    }
+    vcc->nb_slices = set_video_convert_slices(vcc, vc, nb_slices);
+    for(int i = 0; i < vcc->nb_slices; i++) {
+        VideoConvertSlice *s = &(vcc->slices[i]);
+        s->sws_ctx = sws_getContext(width, s->src_h, pix_fmt,
+                                    vc->width, s->dst_h, vc->pix_fmt,
+                                    VIDEO_CONVERT_SWS_FLAGS, NULL, NULL, NULL);
+        if(s->sws_ctx == NULL) {
+            log_error("alloc_video_convert_cache() error: Cannot convert %dx%d %s into %dx%d %s\n",
+                    width, height, av_get_pix_fmt_name(pix_fmt),
+                    vc->width, vc->height, av_get_pix_fmt_name(vc->pix_fmt));
+            vcc->nb_slices = i;
+            list_delete_video_convert_cache(vcc);
+            return NULL;
+        }
+    }
+    log_debug("VideoConvert: %dx%d %s -> %dx%d %s (%d slices)\n", width, height,
+            av_get_pix_fmt_name(pix_fmt), vc->width, vc->height,
+            av_get_pix_fmt_name(vc->pix_fmt), vcc->nb_slices);
+    return vcc;
+}
+
+/**
+ * Split the output frame into horizontal bands, one per thread.
+ * Only frames converted without any vertical scaling are split (same height and vertical
+ * chroma subsampling): a band scaled on its own has no filter taps across its edges.
+ * Band edges are aligned to chroma rows
+ * @param  vcc        cache entry with source format set
+ * @param  vc         VideoConverter with output format
+ * @param  nb_slices  number of bands wanted
+ * @return            number of bands created (1 when the frame cannot be split)
+ */
+int set_video_convert_slices(VideoConvertCache *vcc, VideoConverter *vc, int nb_slices) {
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(vcc->pix_fmt);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(vc->pix_fmt);
+    bool splittable = nb_slices > 1 && src_desc != NULL && dst_desc != NULL
+                    && !((src_desc->flags | dst_desc->flags) & AV_PIX_FMT_FLAG_PAL)
+                    && vcc->height == vc->height && src_desc->log2_chroma_h == dst_desc->log2_chroma_h;
+    if(splittable) {
+        // rows map one to one between source and output
+        int align = 1 << dst_desc->log2_chroma_h;
+        int prev_y = 0;
+        for(int i = 1; i <= nb_slices; i++) {
+            int y = vc->height;
+            if(i < nb_slices) {
+                y = (i * vc->height / nb_slices) & ~(align - 1);
+            }
+            if(y <= prev_y) {
+                splittable = false;
+                break;
+            }
+            VideoConvertSlice *s = &(vcc->slices[i - 1]);
+            s->src_y = s->dst_y = prev_y;
+            s->src_h = s->dst_h = y - prev_y;
+            prev_y = y;
+        }
+    }
+    if(!splittable) {
+        // convert the whole frame at once
+        VideoConvertSlice *s = &(vcc->slices[0]);
+        s->src_y = 0;
+        s->src_h = vcc->height;
+        s->dst_y = 0;
+        s->dst_h = vc->height;
+        return 1;
+    }
+    return nb_slices;
+}
+
+/**
+ * Make sure the output frame has a buffer we can write into
+ * @param  vc VideoConverter
+ * @return    >= 0 on success
+ */
+int get_video_convert_buffer(VideoConverter *vc) {
+    AVFrame *f = vc->frame;
+    if(f->buf[0] != NULL && av_frame_is_writable(f)) {
+        return 0;
+    }
+    // the encoder still references the last buffer (or there is none yet): get a new one
+    av_frame_unref(f);
+    f->width = vc->width;
+    f->height = vc->height;
+    f->format = vc->pix_fmt;
+    int ret = av_frame_get_buffer(f, 32);
+    if(ret < 0) {
+        log_error("get_video_convert_buffer() error: Failed to allocate frame buffer (%s)\n", av_err2str(ret));
+    }
+    return ret;
+}
+
+/**
+ * ThreadPoolJob converting a single slice of the current frame
+ * @param arg        VideoConverter
+ * @param job_idx    index of slice
+ * @param thread_idx unused
+ */
+void convert_video_slice(void *arg, int job_idx, int thread_idx) {
+    VideoConverter *vc = (VideoConverter *) arg;
+    VideoConvertSlice *s = &(vc->job_cache->slices[job_idx]);
+    uint8_t *src[AV_NUM_DATA_POINTERS], *dst[AV_NUM_DATA_POINTERS];
+    get_frame_rows(vc->job_src, s->src_y, src);
+    get_frame_rows(vc->frame, s->dst_y, dst);
+    sws_scale(s->sws_ctx, (const uint8_t * const *) src, vc->job_src->linesize,
+              0, s->src_h, dst, vc->frame->linesize);
+}
+
+/**
+ * Get the plane pointers of a frame starting at a row
+ * @param frame  AVFrame
+ * @param y      row (in luma rows)
+ * @param data   output plane pointers
+ */
+void get_frame_rows(AVFrame *frame, int y, uint8_t *data[AV_NUM_DATA_POINTERS]) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    for(int p = 0; p < AV_NUM_DATA_POINTERS; p++) {
+        if(frame->data[p] == NULL) {
+            data[p] = NULL;
+            continue;
+        }
+        // chroma planes (1 and 2) are subsampled vertically
+        int shift = (p == 1 || p == 2) ? desc->log2_chroma_h : 0;
+        data[p] = frame->data[p] + (y >> shift) * frame->linesize[p];
+    }
+}
+
+/*************** LINKED LIST FUNCTIONS ***************/
+/**
+ * Get data about a cache entry in a string
+ * @param  toBePrinted VideoConvertCache
+ * @return             string allocated on heap, to be freed by caller
+ */
+char *list_print_video_convert_cache(void *toBePrinted) {
+    char buf[256];
+    buf[0] = 0;
+    if(toBePrinted != NULL) {
+        VideoConvertCache *vcc = (VideoConvertCache *) toBePrinted;
+        sprintf(buf, "%dx%d %s (slices: %d)", vcc->width, vcc->height,
+                av_get_pix_fmt_name(vcc->pix_fmt), vcc->nb_slices);
+    }
+    char *str = malloc(sizeof(char) * (strlen(buf) + 1));
+    strcpy(str, buf);
+    return str;
+}
+
+/**
+ * Free cache entry and all its SwsContexts
+ * @param toBeDeleted VideoConvertCache allocated on heap
+ */
+void list_delete_video_convert_cache(void *toBeDeleted) {
+    if(toBeDeleted == NULL) {
+        return;
+    }
+    VideoConvertCache *vcc = (VideoConvertCache *) toBeDeleted;
+    for(int i = 0; i < vcc->nb_slices; i++) {
+        sws_freeContext(vcc->slices[i].sws_ctx);
+    }
+    free(vcc->slices);
+    free(vcc);
+}
+
+/**
+ * Compare two cache entries by source format
+ * @param  first  first VideoConvertCache
+ * @param  second second VideoConvertCache
+ * @return        0 if source formats are equal, non zero otherwise
+ */
+int list_compare_video_convert_cache(const void *first, const void *second) {
+    VideoConvertCache *f = (VideoConvertCache *) first;
+    VideoConvertCache *s = (VideoConvertCache *) second;
+    if(f->width != s->width) {
+        return f->width - s->width;
+    } else if(f->height != s->height) {
+        return f->height - s->height;
+    }
+    return f->pix_fmt - s->pix_fmt;
+}